@@ -0,0 +1,49 @@
+#pragma once
+
+#ifndef _AUDIO_AUDIOEMITTER_H
+#define _AUDIO_AUDIOEMITTER_H
+
+#include "Component.h"
+#include "Vector3.h"
+#include <string>
+
+class Transform;
+
+//Fuente de sonido 3D que sigue al Transform de su entidad
+class AudioEmitter :
+	public Component
+{
+private:
+	Transform* tr_ = nullptr;
+	std::string sound_;
+	std::string bus_ = "sfx";
+	float volume_ = 0.0f;			//dB
+	bool playOnStart_ = true;
+	bool loop_ = false;
+
+	int channelId_ = -1;
+	Vector3 lastPos_;
+	//Si el emisor se movio el frame anterior hay que mandar velocidad nula al pararse
+	bool moving_ = false;
+
+	friend class AudioSystem;
+public:
+	AudioEmitter();
+	virtual ~AudioEmitter();
+
+	virtual void init() override;
+	virtual void load(const nlohmann::json& params) override;
+	virtual void update(float deltaTime) override;
+	virtual void setUp() override;
+	virtual void setActive(bool status) override;
+
+	//Reproduce el sonido en la posicion de la entidad
+	void play();
+	void stop();
+	bool isPlaying() const;
+	//Volumen en dB
+	void setVolume(float volume);
+	float getVolume() const;
+};
+
+#endif
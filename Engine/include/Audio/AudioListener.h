@@ -0,0 +1,32 @@
+#pragma once
+
+#ifndef _AUDIO_AUDIOLISTENER_H
+#define _AUDIO_AUDIOLISTENER_H
+
+#include "Component.h"
+#include "Vector3.h"
+
+class Transform;
+
+//Oido de la escena. El AudioSystem lee su Transform una vez por frame
+class AudioListener :
+	public Component
+{
+private:
+	Transform* tr_ = nullptr;
+	Vector3 lastPos_;
+	bool firstFrame_ = true;
+
+	friend class AudioSystem;
+public:
+	AudioListener();
+	virtual ~AudioListener();
+
+	virtual void init() override;
+	virtual void load(const nlohmann::json& params) override;
+	virtual void update(float deltaTime) override;
+	virtual void setUp() override;
+	virtual void setActive(bool status) override;
+};
+
+#endif
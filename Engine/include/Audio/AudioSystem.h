@@ -5,46 +5,170 @@
 
 #include <map>
 #include <string>
+#include <vector>
+#include <set>
 
 #include "fmod.hpp"
 #include "fmod_errors.h"
+#include <json.hpp>
+#include "Manager.h"
+#include "ComponentTypes.h"
+#include "ResourceCache.h"
 
 class Vector3;
+class AudioListener;
+class AudioEmitter;
 
-class AudioSystem {
+class AudioSystem : public Manager {
 public:
+    enum class AudioCmpId : int {
+        Listener = 0,
+        Emitter,
+
+        LastAudioCmpId
+    };
+
+    //Politica a seguir cuando un sonido llega a su limite de instancias
+    enum class StealPolicy : int {
+        Oldest = 0,     //Se roba la voz mas antigua
+        Quietest,       //Se roba la voz que menos se oye
+        None            //No se roba, se descarta la nueva reproduccion
+    };
+
+    //Configuracion de reproduccion de un sonido
+    struct SoundProps {
+        int maxInstances = 8;                       //Instancias simultaneas del mismo sonido
+        int priority = 128;                         //0 = mas importante, 256 = menos importante
+        StealPolicy steal = StealPolicy::Oldest;
+        float minDistance = 1.0f;                   //Distancia a partir de la que se atenua
+        float maxDistance = 100.0f;                 //Distancia a partir de la que la voz es virtual
+    };
+
+    //Forma de cargar un sonido
+    enum class LoadMode : int {
+        Auto = 0,       //Stream si el archivo supera STREAM_THRESHOLD, sample si no
+        Sample,         //Se descomprime al reproducir (FMOD_CREATECOMPRESSEDSAMPLE)
+        Stream          //Se lee del disco mientras suena
+    };
+
+    //Voz del pool de canales
+    struct Voice {
+        FMOD::Channel* channel = nullptr;
+        FMOD::Sound* sound = nullptr;
+        int id = -1;                //Id publico del canal, -1 si la voz esta libre
+        unsigned int order = 0;     //Orden de reproduccion, para saber cual es la mas antigua
+        SoundProps props;
+        //Mientras el sonido se carga la voz queda pendiente con sus parametros
+        bool pending = false;
+        FMOD::ChannelGroup* group = nullptr;
+        FMOD_VECTOR position = { 0.0f, 0.0f, 0.0f };
+        float volume = 1.0f;
+    };
+
     typedef std::map<std::string, FMOD::Sound*> SoundMap;
-    typedef std::map<int, FMOD::Channel*> ChannelMap;
-    typedef std::map<const char*, FMOD::ChannelGroup*> ChannelGroupMap;
+    typedef std::map<std::string, SoundProps> SoundPropsMap;
+    typedef std::vector<Voice> VoicePool;
+
+    //Bus del mezclador: un ChannelGroup con nombre, su volumen y sus efectos
+    struct Bus {
+        FMOD::ChannelGroup* group = nullptr;
+        std::string parent;
+        float volume = 0.0f;            //dB
+        FMOD::DSP* lowpass = nullptr;
+        FMOD::DSP* reverb = nullptr;
+        FMOD::DSP* ducker = nullptr;    //Compresor alimentado por el sidechain de otro bus
+        std::string duckTrigger;
+    };
+    typedef std::map<std::string, Bus> BusMap;
+
+    //Voces que se pueden gestionar a la vez (reales + virtuales)
+    static const int MAX_VOICES = 128;
+    //Voces que realmente se mezclan, el resto son virtuales
+    static const int MAX_REAL_VOICES = 48;
+    //Tamanyo (bytes) a partir del cual un sonido en modo Auto se carga como stream
+    static const long long STREAM_THRESHOLD = 1024 * 1024;
+    //Configuracion opcional del mezclador, si no existe se usa el grafo por defecto
+    static const std::string BUSES_FILE_PATH;
+    //Bus raiz, es el ChannelGroup maestro de FMOD
+    static const std::string MASTER_BUS;
 private:
     AudioSystem();
     ~AudioSystem();
     void init();
 
+    //Devuelve la voz asociada a un id o nullptr si ya no existe
+    Voice* getVoice(int nChannelId);
+    const Voice* getVoice(int nChannelId) const;
+    //Busca una voz libre o roba una segun la configuracion del sonido
+    int acquireVoice(FMOD::Sound* pSound, const SoundProps& props);
+    //Detiene una voz y la devuelve a la lista de libres
+    void releaseVoice(int nSlot, bool bStop);
+    //Reproduce en FMOD una voz cuyo sonido ya esta cargado
+    void startVoice(int nSlot);
+    //Libera el sonido y sus voces, sin tocar su entrada en el cache de recursos
+    void releaseSound(SoundMap::iterator itSound);
+    //Comprueba si un sonido sigue cargandose en segundo plano
+    bool isLoading(FMOD::Sound* pSound) const;
+    //Revisa los sonidos en carga y arranca las voces que los esperaban
+    void processLoadedSounds();
+    //Pasa a FMOD la posicion, velocidad y orientacion del listener activo
+    void updateListener(float deltaTime);
+    //Pasa a FMOD en una sola pasada la posicion de los emisores que se han movido
+    void updateEmitters(float deltaTime);
+    //Grafo master -> music / sfx / ui / voice con la musica atenuada bajo los dialogos
+    void createDefaultBuses();
+    Bus* getBus(const std::string& strBus);
+    const Bus* getBus(const std::string& strBus) const;
+    //Crea (si no existe) un efecto de tipo eType en la cabeza del bus
+    FMOD::DSP* getBusDSP(Bus& bus, FMOD::DSP*& pDSP, FMOD_DSP_TYPE eType);
+    //Deja al cache de recursos descargar los sonidos que no se usan
+    void registerResourceCache();
+    //Referencia del cache a un sonido del manifiesto de la escena actual
+    void holdSceneSound(const std::string& strSoundName);
+
     SoundMap mSounds;
-    ChannelMap mChannels;
-    ChannelGroupMap mGroup;
+    SoundPropsMap mSoundProps;
+    VoicePool mVoices;
+    std::vector<int> mFreeVoices;
+    std::vector<FMOD::Sound*> mLoadingSounds;
+    //Sonidos cargados por playMusic: 2D, en bucle y en stream
+    std::set<std::string> mMusicStreams;
+    BusMap mBuses;
+    //Sonidos del manifiesto de la escena, se sueltan en clean
+    ResourceCache::Handles mSceneSounds;
+    std::set<std::string> mSceneSoundNames;
+
+    AudioListener* mListener = nullptr;
+    std::vector<AudioEmitter*> mEmitters;
 
     FMOD::System* mpSystem;
 
     int mnNextChannelId = 0;
+    unsigned int mnPlayOrder = 0;
 
-    static AudioSystem* instance_;
 public:
     static AudioSystem* getInstance();
     static bool setupInstance();
-    static void update();
     static void clean();
     static void destroy();
 
+    virtual void start() override;
+    virtual void update(float deltaTime) override;
+
+    //Registro de los componentes de audio que se sincronizan cada frame
+    void setListener(AudioListener* listener);
+    void removeListener(AudioListener* listener);
+    void addEmitter(AudioEmitter* emitter);
+    void removeEmitter(AudioEmitter* emitter);
+
     SoundMap& getSoundMap();
     const SoundMap& getSoundMap() const;
 
-    ChannelMap& getSoundChannels();
-    const ChannelMap& getSoundChannels() const;
+    VoicePool& getSoundChannels();
+    const VoicePool& getSoundChannels() const;
 
-    ChannelGroupMap& getChanGroupMap();
-    const ChannelGroupMap& getChanGroupMap() const;
+    BusMap& getBusMap();
+    const BusMap& getBusMap() const;
 
     FMOD::System* getSystem();
     FMOD::System* getSystem() const;
@@ -54,21 +178,55 @@ public:
 
     static int errorCheck(FMOD_RESULT result);
 
-    void loadSound(const std::string& strSoundName, bool b3d = true, bool bLooping = false, bool bStream = false);
+    //Configura prioridad, limite de instancias y distancias de un sonido
+    void setSoundProperties(const std::string& strSoundName, const SoundProps& props);
+    const SoundProps& getSoundProperties(const std::string& strSoundName) const;
+    //Numero de voces ocupadas en el pool
+    int getActiveVoices() const;
+
+    void loadSound(const std::string& strSoundName, bool b3d = true, bool bLooping = false, LoadMode mode = LoadMode::Auto);
     void unloadSound(const std::string& strSoundName);
-    void set3dListenerAndOrientation(const Vector3& vPos, float fVolumedB = 0.0f);
-    int  playSound(const std::string& strSoundName, const Vector3& vPos ,const char* groupName = nullptr, float fVolumedB = 0.0f);
+    //Precarga (sin bloquear) los sonidos del manifiesto de una escena
+    void preloadSounds(const nlohmann::json& manifest);
+    //Reproduce una pista de musica: 2D, en bucle y siempre en stream
+    int  playMusic(const std::string& strSoundName, float fVolumedB = 0.0f);
+    //Devuelve true si el sonido esta cargado y listo para sonar
+    bool isSoundReady(const std::string& strSoundName) const;
+    void set3dListenerAndOrientation(const Vector3& vPos, const Vector3& vForward, const Vector3& vUp, const Vector3& vVel);
+    int  playSound(const std::string& strSoundName, const Vector3& vPos, const std::string& strBus = "sfx", float fVolumedB = 0.0f);
     void stopChannel(int nChannelId);
     void stopAllChannels();
     void setChannel3dPosition(int nChannelId, const Vector3& vPosition);
+    void setChannel3dAttributes(int nChannelId, const Vector3& vPosition, const Vector3& vVelocity);
     void setChannelvolume(int nChannelId, float fVolumedB);
     bool isPlaying(int nChannelId) const;
     void pause_Resume_Channel(int nChannelId);
     float dbToVolume(float db);
     float volumeTodb(float volume);
-    FMOD_VECTOR& vectorToFmod(const Vector3& vPosition);
-    FMOD::ChannelGroup* createChannelGroup(const char* name);
-    void muteChannelGroup(const char* name);
+    FMOD_VECTOR vectorToFmod(const Vector3& vPosition);
+
+    //---- Buses ----//
+    //Carga buses, efectos y ducking desde un json; los buses que ya existen se reconfiguran
+    void loadBuses(const std::string& strFile = BUSES_FILE_PATH);
+    void loadBuses(const nlohmann::json& config);
+    FMOD::ChannelGroup* createBus(const std::string& strBus, const std::string& strParent = MASTER_BUS);
+    bool hasBus(const std::string& strBus) const;
+    void setBusVolume(const std::string& strBus, float fVolumedB);
+    float getBusVolume(const std::string& strBus) const;
+    void setBusMute(const std::string& strBus, bool bMute);
+    bool isBusMuted(const std::string& strBus) const;
+    void setBusPaused(const std::string& strBus, bool bPaused);
+    //Filtro paso bajo, con 22000Hz o mas se desactiva
+    void setBusLowpass(const std::string& strBus, float fCutoffHz);
+    //Reverb con el decay en ms y el nivel de la senyal procesada en dB, con -80dB se desactiva
+    void setBusReverb(const std::string& strBus, float fDecayMs, float fWetdB);
+    //Atenua strTarget cuando suena strTrigger (compresor con sidechain)
+    void setBusDucking(const std::string& strTarget, const std::string& strTrigger, float fThresholddB = -30.0f,
+        float fRatio = 4.0f, float fAttackMs = 50.0f, float fReleaseMs = 500.0f);
+    void removeBusDucking(const std::string& strTarget);
 };
 
+COMPONENT_TYPE(AudioListener, ManID::Audio, AudioSystem::AudioCmpId::Listener)
+COMPONENT_TYPE(AudioEmitter, ManID::Audio, AudioSystem::AudioCmpId::Emitter)
+
 #endif // !AUDIO_AUDIOSYS
\ No newline at end of file
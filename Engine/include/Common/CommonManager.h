@@ -4,13 +4,49 @@
 #define _COMMON_COMMANAGER_H
 
 #include "Manager.h"
+#include "ComponentTypes.h"
+#include "SimdMath.h"
+#include <vector>
+
+class Transform;
+
+//Datos de todos los transforms en formato SoA (una array por componente)
+//para poder recorrerlos con SIMD. Los transforms cinematicos (los que piden
+//que se integre su velocidad y no mueve la fisica) estan al principio, en
+//[0, kinematicCount)
+struct TransformArrays {
+	std::vector<float> posX, posY, posZ;
+	std::vector<float> velX, velY, velZ;
+	std::vector<float> rotX, rotY, rotZ;
+	std::vector<float> scaleX, scaleY, scaleZ;
+	//Estado de mundo (con el padre), lo calcula updateWorldTransforms
+	std::vector<Matrix4> world;
+	std::vector<Quaternion> worldRot;
+	std::vector<Vector3> worldScale;
+	//El estado local ha cambiado desde la ultima pasada
+	std::vector<unsigned char> dirty;
+	std::vector<Transform*> owners;
+	size_t kinematicCount = 0;
+
+	size_t size() const { return owners.size(); }
+};
 
 class CommonManager: public Manager {
 private:
-	static CommonManager* _instance;
+
+	TransformArrays transforms_;
+	//Transforms ordenados por profundidad, los padres antes que los hijos
+	std::vector<Transform*> order_;
+	bool orderDirty_ = true;
+	//Huecos recalculados en la pasada actual, para propagar a los hijos
+	std::vector<unsigned char> changed_;
 
 	CommonManager();
 	~CommonManager();
+
+	void swapSlots(size_t a, size_t b);
+	void popSlot();
+	void composeWorld(size_t slot);
 public:
 	enum class CommonCmpId : int {
 		TransId = 0,
@@ -25,7 +61,29 @@ public:
 
 	void addComponent(Entity* ent, int compId);
 	void start();
+	/// <summary>
+	/// Recalcula el estado de mundo de los transforms que han cambiado y de
+	/// sus descendientes, en orden de profundidad
+	/// </summary>
 	void update(float deltaTime);
+	void updateWorldTransforms();
+	//Calcula ya el estado de mundo de un transform (y de sus padres), para
+	//los que se crean a mitad de frame
+	void updateWorldTransform(Transform* tr);
+	/// <summary>
+	/// Integra la velocidad de todos los transforms cinematicos de una vez
+	/// </summary>
+	void fixedUpdate(float deltaTime);
+
+	// Gestion de huecos en las arrays, los usa Transform
+	size_t addTransform(Transform* tr);
+	void removeTransform(size_t slot);
+	void setKinematic(size_t slot, bool kinematic);
+	void markDirty(size_t slot) { transforms_.dirty[slot] = 1; }
+	void markHierarchyChanged() { orderDirty_ = true; }
+	TransformArrays& getTransforms() { return transforms_; }
 };
 
-#endif 
\ No newline at end of file
+COMPONENT_TYPE(Transform, ManID::Common, CommonManager::CommonCmpId::TransId)
+
+#endif 
@@ -8,7 +8,15 @@
 class Entity;
 class Manager;
 
+namespace Reflection {
+	class TypeInfo;
+}
+
 class Component {
+	friend class Manager;
+private:
+	// Posicion en el almacen del manager, -1 si no esta
+	int _slot = -1;
 protected:
 	int _id;   // identificador del tipo de componente
 	bool _active = true;
@@ -47,6 +55,12 @@ public:
 	Manager* getManager() const;
 	//Obtener identificador del componente
 	int getId() const;
+
+	//Campos que se cargan sin parser propio (ver Reflection.h), nullptr si no declara ninguno
+	virtual const Reflection::TypeInfo* getTypeInfo() const;
+	//Aplica los campos declarados que esten en params. Lanza Reflection::Error
+	//con la ruta del campo si alguno esta mal
+	void loadFields(const nlohmann::json& params);
 };
 
 #endif
\ No newline at end of file
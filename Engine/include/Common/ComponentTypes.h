@@ -0,0 +1,52 @@
+#pragma once
+
+#ifndef _COMMON_COMPONENTTYPES_H
+#define _COMMON_COMPONENTTYPES_H
+
+#include "Manager.h"
+
+// Componentes nativos de cada manager, en el orden de ManID. Los de Lua se
+// registran en ejecucion (uno por script) y la entidad los guarda aparte.
+// Cada manager comprueba con un static_assert que su enum coincide
+constexpr int NATIVE_COMPONENTS[(int)ManID::LastManId] = {
+	1,	// Common
+	2,	// Physics
+	6,	// Render
+	0,	// LUA
+	5,	// UI
+	2,	// Audio
+	2,	// Navigation
+	1	// Network
+};
+
+constexpr int nativeComponentOffset(int man)
+{
+	return man <= 0 ? 0 : nativeComponentOffset(man - 1) + NATIVE_COMPONENTS[man - 1];
+}
+
+constexpr int NATIVE_COMPONENT_COUNT = nativeComponentOffset((int)ManID::LastManId);
+
+// Posicion del componente en el almacen de la entidad, -1 si no es nativo
+constexpr int nativeComponentIndex(int man, int compId)
+{
+	return man >= 0 && man < (int)ManID::LastManId && compId >= 0 && compId < NATIVE_COMPONENTS[man]
+		? nativeComponentOffset(man) + compId : -1;
+}
+
+/// <summary>
+/// Id de tipo en compilacion de cada componente nativo. Sin especializar no
+/// compila, asi Entity::get<T> solo acepta componentes registrados. Cada
+/// manager declara los suyos en su cabecera con COMPONENT_TYPE
+/// </summary>
+template<typename T>
+struct ComponentType;
+
+#define COMPONENT_TYPE(Type, Man, Id)														\
+	template<> struct ComponentType<Type> {													\
+		static constexpr ManID manager = Man;												\
+		static constexpr int id = (int)(Id);												\
+		static constexpr int index = nativeComponentIndex((int)(Man), (int)(Id));			\
+		static_assert(index >= 0, #Type " is not a native component of its manager");		\
+	};
+
+#endif
@@ -0,0 +1,113 @@
+#pragma once
+
+#ifndef _COMMON_ENGINECONTEXT_H
+#define _COMMON_ENGINECONTEXT_H
+
+#include <map>
+#include <string>
+#include "Manager.h"
+#include "NameHash.h"
+
+class InputSystem;
+class UIManager;
+class PhysicsManager;
+class RenderManager;
+class SceneManager;
+class CommonManager;
+class LUAManager;
+class AudioSystem;
+class NavigationManager;
+class NetworkManager;
+class StartupGraph;
+
+/// <summary>
+/// Managers de una instancia del motor. Cada hilo trabaja con el contexto que
+/// tenga enlazado y el getInstance() de cada manager devuelve el de ese
+/// contexto, asi varias simulaciones sin ventana pueden correr en paralelo en
+/// el mismo proceso. Ogre, la ventana y los recursos son unicos del proceso y
+/// solo los usa el contexto con ventana (el de PapagayoEngine)
+/// Uso sin ventana, cada uno en su hilo:
+///		EngineContext ctx(true);
+///		EngineContext::Scope scope(&ctx);
+///		ctx.setUp();
+///		ctx.loadScenes("Scenes/scenes.json");
+///		ctx.start();
+///		while (ctx.isRunning()) ctx.step(1.0f / 60.0f);
+///		ctx.destroy();
+/// </summary>
+class EngineContext
+{
+public:
+	// Enlaza un contexto al hilo mientras dura y deja el anterior al salir
+	class Scope {
+	private:
+		EngineContext* prev_;
+	public:
+		Scope(EngineContext* ctx);
+		~Scope();
+	};
+
+	EngineContext(bool headless);
+	~EngineContext();
+
+	// Contexto enlazado al hilo que llama
+	static EngineContext* current();
+	static void bind(EngineContext* ctx);
+
+	// Crea los managers en este contexto, que tiene que estar enlazado.
+	// Sin ventana no hay render, interfaz, audio ni input
+	void setUp(const std::string& appName = "");
+	// Lo mismo que setUp pero como pasos de un grafo de arranque mas grande.
+	// El ultimo es "managers", los que usen los managers deben depender de el
+	void addSetUpSteps(StartupGraph& graph, const std::string& appName);
+	// Carga la lista de escenas y la primera de ellas, despues hay que llamar a start
+	void loadScenes(const std::string& scenesFile);
+	void start();
+	void update(float deltaTime);
+	void fixedUpdate(float deltaTime);
+	// update y, cada fixedStep segundos, fixedUpdate
+	void step(float deltaTime);
+	void clean();
+	void destroy();
+
+	bool isHeadless() const;
+	bool isRunning() const;
+	void close();
+	void setFixedStep(float seconds);
+
+	const std::map<std::string, Manager*>& getManagers() const;
+	// Por el "Type" de los componentes en las escenas, nullptr si no esta
+	Manager* getManager(const std::string& type) const;
+	Manager* getManager(ManID id) const;
+
+	// Los rellenan setUpInstance y destroy de cada manager
+	CommonManager* common = nullptr;
+	PhysicsManager* phys = nullptr;
+	RenderManager* render = nullptr;
+	LUAManager* lua = nullptr;
+	UIManager* gui = nullptr;
+	AudioSystem* audio = nullptr;
+	NavigationManager* nav = nullptr;
+	NetworkManager* net = nullptr;
+	SceneManager* scenes = nullptr;
+	InputSystem* input = nullptr;
+
+private:
+	static thread_local EngineContext* current_;
+
+	bool headless_;
+	bool running_ = true;
+	float fixedStep_ = 0.15f;
+	float fixedTimer_ = 0.0f;
+	std::map<std::string, Manager*> manRegistry_;
+	// Lo mismo para la carga: nombre -> ManID con hash perfecto y array por id
+	NameHash manNames_;
+	Manager* managers_[(int)ManID::LastManId] = {};
+
+	void registerManager(const std::string& type, Manager* man);
+
+	EngineContext(const EngineContext&) = delete;
+	EngineContext& operator=(const EngineContext&) = delete;
+};
+
+#endif
@@ -5,12 +5,16 @@
 
 #include <map>
 #include <string>
+#include "ComponentTypes.h"
 
 class Component;
 
 class Entity
 {
 private:
+	// Componentes nativos por su indice de tipo (ComponentTypes.h)
+	Component* _native[NATIVE_COMPONENT_COUNT] = {};
+	// Los que se registran en ejecucion (scripts de Lua), por manager e id
 	std::map<int, std::map<int, Component*>> _componentMap;
 
 	std::string name_;
@@ -34,8 +38,20 @@ public:
 
 	void setName(const std::string& name);
 
-	// devuelve el compenente asociado a esa id
+	// devuelve el compenente asociado a esa id, nullptr si no lo tiene
 	Component* getComponent(int managerId, int compI);
+
+	// Acceso por tipo, se resuelve en compilacion a una posicion del array:
+	//		Transform* tr = ent->get<Transform>();
+	template<typename T>
+	T* get() const {
+		return static_cast<T*>(_native[ComponentType<T>::index]);
+	}
+
+	template<typename T>
+	bool has() const {
+		return _native[ComponentType<T>::index] != nullptr;
+	}
 		
     // comprueba si la entidad tiene el componente id
 	bool hasComponent(int managerId, int compId) const;
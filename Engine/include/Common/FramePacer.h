@@ -0,0 +1,81 @@
+#pragma once
+
+#ifndef _COMMON_FRAMEPACER_H
+#define _COMMON_FRAMEPACER_H
+
+#include <chrono>
+#include <cstdint>
+
+/// <summary>
+/// Controla el ritmo del bucle principal: limita los FPS, baja la frecuencia
+/// cuando la ventana no tiene el foco o esta minimizada y guarda estadisticas
+/// de los tiempos de frame
+/// </summary>
+class FramePacer
+{
+public:
+	struct FrameStats {
+		float lastMs = 0.0f;	// duracion total del ultimo frame
+		float workMs = 0.0f;	// parte del ultimo frame sin contar la espera
+		float avgMs = 0.0f;		// media de la ventana de frames
+		float minMs = 0.0f;
+		float maxMs = 0.0f;
+		float fps = 0.0f;
+		uint64_t frames = 0;
+	};
+
+	FramePacer();
+	~FramePacer();
+
+	// 0 = sin limite
+	void setTargetFps(int fps);
+	int getTargetFps() const;
+	// Frecuencia sin foco y minimizada
+	void setBackgroundFps(int fps);
+	void setMinimizedFps(int fps);
+	// Con vsync el swap ya espera, solo se limita en segundo plano
+	void setVSync(bool vsync);
+
+	void setFocused(bool focused);
+	void setMinimized(bool minimized);
+
+	// Empieza el frame y devuelve el delta en segundos desde el anterior
+	float beginFrame();
+	// Espera lo que falte para completar el periodo objetivo
+	void endFrame();
+	// Reinicia el reloj, p.ej. tras una carga larga
+	void reset();
+
+	const FrameStats& getStats() const;
+
+private:
+	using Clock = std::chrono::steady_clock;
+	static const int STATS_WINDOW = 120;
+
+	int targetFps_ = 60;
+	int backgroundFps_ = 15;
+	int minimizedFps_ = 5;
+	bool vsync_ = false;
+	bool focused_ = true;
+	bool minimized_ = false;
+
+	Clock::time_point frameStart_;
+	bool firstFrame_ = true;
+
+	// Estimacion del error de sleep (media + desviacion, algoritmo de Welford)
+	double sleepMean_ = 0.002;
+	double sleepM2_ = 0.0;
+	uint64_t sleepCount_ = 1;
+	double sleepEstimate_ = 0.002;
+
+	float history_[STATS_WINDOW] = {};
+	int historyIdx_ = 0;
+	int historySize_ = 0;
+	FrameStats stats_;
+
+	int currentFps() const;
+	void waitUntil(Clock::time_point target);
+	void pushStats(float frameMs);
+};
+
+#endif
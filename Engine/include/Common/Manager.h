@@ -3,14 +3,15 @@
 #ifndef _COMMON_MANAGER_H
 #define _COMMON_MANAGER_H
 
-#include <List>
+#include <vector>
 #include <memory>
 #include <functional>
 #include <string>
 #include <map>
+#include "Component.h"
+#include "NameHash.h"
 
 class Entity;
-class Component;
 
 enum class ManID
 {
@@ -19,20 +20,57 @@ enum class ManID
 	Render,
 	LUA,
 	UI,
+	Audio,
+	Navigation,
+	Network,
 
 	LastManId
 };
 
 class Manager {
 protected:
-	std::map <std::string, int> enum_map_;
-	std::map <int, std::function<Component* ()>> compsRegistry_;
-	std::list<Component*> _compsList;
+	// Nombre -> id, solo se usa al cargar
+	NameHash enum_map_;
+	// Constructoras por id
+	std::vector<std::function<Component* ()>> compsRegistry_;
+	// Almacen denso: los activos en [0, _activeCount) y los inactivos detras,
+	// asi las pasadas de update nunca pasan por los desactivados
+	std::vector<Component*> _compsList;
+	size_t _activeCount = 0;
 	ManID _manId;
+
+	// Mientras se recorren los activos no se mueve ninguno de particion, los
+	// cambios se aplican al acabar la pasada
+	int _iterating = 0;
+	std::vector<Component*> _pendingToggles;
+
+	void addToList(Component* comp);
+	void removeFromList(Component* comp);
+	// Lleva el componente a la particion que le toca segun isActive
+	void movePartition(Component* comp);
+
+	/// <summary>
+	/// Llama a f con cada componente activo. Se pueden crear, activar y
+	/// desactivar componentes desde f (los creados tambien se visitan)
+	/// </summary>
+	template<typename F>
+	void forEachActive(F f) {
+		++_iterating;
+		for (size_t i = 0; i < _activeCount; ++i) {
+			// Los desactivados en esta pasada siguen aqui hasta que acabe
+			if (_compsList[i]->isActive())
+				f(_compsList[i]);
+		}
+		if (--_iterating == 0) {
+			for (Component* c : _pendingToggles)
+				movePartition(c);
+			_pendingToggles.clear();
+		}
+	}
 public:
 	Manager(ManID id);
 	virtual ~Manager();
-	int getCompID(const std::string& s);
+	int getCompID(const std::string& s) const;
 	/// <summary>
 	/// Anyade un componente a la entidad
 	/// </summary>
@@ -45,8 +83,13 @@ public:
 	virtual void start() = 0;
 	virtual void update(float deltaTime) = 0;
 
-	const std::list<Component*>& getComponents();
-	const std::list<Component*>& getComponents() const;
+	// Todos los componentes, primero los activos
+	const std::vector<Component*>& getComponents();
+	const std::vector<Component*>& getComponents() const;
+	size_t getActiveCount() const;
+
+	// Lo llama Component::setActive para cambiarlo de particion
+	void setComponentActive(Component* comp);
 
 	virtual void destroyAllComponents();
 	virtual bool destroyComponent(Entity* ent, int compId);
@@ -54,6 +97,7 @@ public:
 	//-- Factory --//
 	void registerComponent(const std::string& name, int id, std::function<Component * ()>compConst);
 	Component* create(const std::string& name, Entity* ent);	//esto puede ser un puntero inteligente
+	Component* create(int compId, Entity* ent);
 	//-------------//
 
 	int getId();
@@ -0,0 +1,67 @@
+#pragma once
+
+#ifndef _COMMON_MATHCONVERSIONS_H
+#define _COMMON_MATHCONVERSIONS_H
+
+//Conversiones entre los tipos del motor, Bullet y Ogre. Son inline y solo
+//copian componentes, el compilador las deja en nada. Solo se incluye en los
+//.cpp que ya dependen de Bullet u Ogre
+
+#include "Vector3.h"
+#include "SimdMath.h"
+#include "LinearMath/btVector3.h"
+#include "LinearMath/btQuaternion.h"
+#include "OgreVector3.h"
+#include "OgreQuaternion.h"
+
+// Bullet
+inline Vector3 cvt(const btVector3& V) {
+	return Vector3(V.x(), V.y(), V.z());
+}
+
+inline btVector3 cvt(const Vector3& V) {
+	return btVector3(V.x, V.y, V.z);
+}
+
+inline Quaternion cvt(const btQuaternion& Q) {
+	return Quaternion(Q.w(), Q.x(), Q.y(), Q.z());
+}
+
+inline btQuaternion cvt(const Quaternion& Q) {
+	return btQuaternion(Q.x, Q.y, Q.z, Q.w);
+}
+
+// Ogre
+inline Ogre::Vector3 toOgre(const Vector3& V) {
+	return Ogre::Vector3(V.x, V.y, V.z);
+}
+
+inline Ogre::Vector3 toOgre(const btVector3& V) {
+	return Ogre::Vector3(V.x(), V.y(), V.z());
+}
+
+inline Ogre::Quaternion toOgre(const Quaternion& Q) {
+	return Ogre::Quaternion(Q.w, Q.x, Q.y, Q.z);
+}
+
+inline Ogre::Quaternion toOgre(const btQuaternion& Q) {
+	return Ogre::Quaternion(Q.w(), Q.x(), Q.y(), Q.z());
+}
+
+inline Vector3 cvt(const Ogre::Vector3& V) {
+	return Vector3(V.x, V.y, V.z);
+}
+
+inline Quaternion cvt(const Ogre::Quaternion& Q) {
+	return Quaternion(Q.w, Q.x, Q.y, Q.z);
+}
+
+inline btVector3 toBullet(const Ogre::Vector3& V) {
+	return btVector3(V.x, V.y, V.z);
+}
+
+inline btQuaternion toBullet(const Ogre::Quaternion& Q) {
+	return btQuaternion(Q.x, Q.y, Q.z, Q.w);
+}
+
+#endif
@@ -0,0 +1,38 @@
+#pragma once
+
+#ifndef _COMMON_NAMEHASH_H
+#define _COMMON_NAMEHASH_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/// <summary>
+/// Tabla de nombres a enteros con hash perfecto: al insertar se busca una
+/// semilla con la que ningun nombre comparte casilla, asi buscar es un hash y
+/// una comparacion. Pensada para pocos nombres que se registran al cargar
+/// (componentes, managers) y se buscan muchas veces
+/// </summary>
+class NameHash
+{
+private:
+	std::vector<std::pair<std::string, int>> entries_;
+	// Indice en entries_ de cada casilla, -1 si esta vacia
+	std::vector<int> slots_;
+	uint32_t seed_ = 0;
+
+	static uint32_t hash(const std::string& name, uint32_t seed);
+	// Busca tamanyo y semilla sin colisiones para los nombres que hay
+	void rebuild();
+public:
+	NameHash() = default;
+
+	// Si el nombre ya estaba se cambia su valor
+	void insert(const std::string& name, int value);
+	// -1 si no esta
+	int find(const std::string& name) const;
+	size_t size() const;
+	void clear();
+};
+
+#endif
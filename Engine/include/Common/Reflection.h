@@ -0,0 +1,144 @@
+#pragma once
+
+#ifndef _COMMON_REFLECTION_H
+#define _COMMON_REFLECTION_H
+
+#include "NameHash.h"
+#include "Vector3.h"
+#include <json.hpp>
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+
+class Component;
+
+/// <summary>
+/// Campos de los componentes declarados una vez (nombre, tipo y como se leen
+/// y escriben) para cargarlos sin un parser a mano por componente. Con la
+/// misma descripcion se cargan desde el json de la escena y desde tablas de
+/// Lua, y los errores llevan la ruta del campo
+/// (p.ej. "Transform.position[2]"). Lo que no es un valor simple (objetos
+/// anidados, ventanas de CEGUI...) lo sigue leyendo el load del componente
+/// </summary>
+namespace Reflection {
+
+	enum class FieldType : uint8_t {
+		Bool = 0,
+		Int,
+		Float,
+		String,
+		Vector2,		// std::pair<float, float>, el de la interfaz
+		Vector3,
+		FloatList
+	};
+
+	template<typename T> struct FieldTypeOf;
+	template<> struct FieldTypeOf<bool> { static constexpr FieldType value = FieldType::Bool; };
+	template<> struct FieldTypeOf<int> { static constexpr FieldType value = FieldType::Int; };
+	template<> struct FieldTypeOf<float> { static constexpr FieldType value = FieldType::Float; };
+	template<> struct FieldTypeOf<std::string> { static constexpr FieldType value = FieldType::String; };
+	template<> struct FieldTypeOf<std::pair<float, float>> { static constexpr FieldType value = FieldType::Vector2; };
+	template<> struct FieldTypeOf<Vector3> { static constexpr FieldType value = FieldType::Vector3; };
+	template<> struct FieldTypeOf<std::vector<float>> { static constexpr FieldType value = FieldType::FloatList; };
+
+	// Error de carga, con la ruta del campo que lo ha provocado
+	class Error : public std::runtime_error
+	{
+	private:
+		std::string path_;
+	public:
+		Error(const std::string& path, const std::string& problem);
+		const std::string& getPath() const;
+	};
+
+	/// <summary>
+	/// Un campo: get y set reciben un puntero al valor del tipo del campo
+	/// (bool, int, float, std::string, par, Vector3 o std::vector<float>).
+	/// Se crean con las macros REFLECT_*, no a mano
+	/// </summary>
+	class Field
+	{
+	public:
+		typedef void(*Getter)(const Component* c, void* out);
+		typedef void(*Setter)(Component* c, const void* in);
+
+		const char* name;
+		FieldType type;
+		Getter get;			// nullptr si no se puede leer
+		Setter set;
+		bool isRequired = false;
+		bool isLoadOnly = false;
+
+		Field(const char* name_, FieldType type_, Getter get_, Setter set_);
+		// Copia del campo que hay que poner siempre
+		Field required() const;
+		// Copia del campo que solo se usa al cargar (en load o setUp): cambiarlo
+		// despues no haria nada, asi que setParams desde Lua lo rechaza
+		Field loadOnly() const;
+	};
+
+	class TypeInfo
+	{
+	private:
+		std::string name_;
+		std::vector<Field> fields_;
+		NameHash index_;
+	public:
+		// Como mucho MAX_FIELDS campos, la carga no reserva memoria para buscarlos
+		static const int MAX_FIELDS = 32;
+
+		// Los campos de base (si hay) van antes que los propios
+		TypeInfo(const std::string& name, std::initializer_list<Field> fields, const TypeInfo* base = nullptr);
+
+		const std::string& getName() const;
+		const std::vector<Field>& getFields() const;
+		// -1 si no hay campo con ese nombre
+		int findField(const std::string& name) const;
+	};
+
+	// Aplica al componente los campos que esten en params, en el orden en el
+	// que se declararon. Las claves desconocidas se ignoran (las lee el
+	// componente). Lanza Error si un valor no es del tipo o falta uno obligatorio
+	void loadJson(const TypeInfo& type, Component* c, const nlohmann::json& params);
+
+	// Comprueba los obligatorios que no se han puesto (found[i] por campo)
+	void checkRequired(const TypeInfo& type, const bool* found);
+}
+
+// Campo con expresiones propias: GetExpr lee de self (const Class&) y el resto
+// es la sentencia que escribe v (const Type&) en self (Class&). Se usan dentro
+// de getTypeInfo de la clase, asi pueden tocar miembros privados
+#define REFLECT_FIELD(Class, Type, Name, GetExpr, ...)												\
+	Reflection::Field(Name, Reflection::FieldTypeOf<Type>::value,									\
+		[](const Component* c_, void* out_) {														\
+			const Class& self = *static_cast<const Class*>(c_);										\
+			*static_cast<Type*>(out_) = (GetExpr);													\
+		},																							\
+		[](Component* c_, const void* in_) {														\
+			Class& self = *static_cast<Class*>(c_);													\
+			const Type& v = *static_cast<const Type*>(in_);											\
+			__VA_ARGS__;																			\
+		})
+
+// Campo que solo se escribe (no se puede leer)
+#define REFLECT_SETTER(Class, Type, Name, ...)														\
+	Reflection::Field(Name, Reflection::FieldTypeOf<Type>::value, nullptr,							\
+		[](Component* c_, const void* in_) {														\
+			Class& self = *static_cast<Class*>(c_);													\
+			const Type& v = *static_cast<const Type*>(in_);											\
+			__VA_ARGS__;																			\
+		})
+
+// Campo con un getter y un setter de la clase
+#define REFLECT_PROPERTY(Class, Type, Name, Getter, Setter)										\
+	REFLECT_FIELD(Class, Type, Name, self.Getter(), self.Setter(v))
+
+// Campo que es directamente un miembro de la clase
+#define REFLECT_MEMBER(Class, Name, Member)															\
+	REFLECT_FIELD(Class, std::remove_cv_t<decltype(Class::Member)>, Name, self.Member, self.Member = v)
+
+#endif
@@ -0,0 +1,122 @@
+#pragma once
+
+#ifndef _COMMON_RESOURCECACHE_H
+#define _COMMON_RESOURCECACHE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <list>
+#include <mutex>
+#include <functional>
+#include <json.hpp>
+
+/// <summary>
+/// Cache de recursos del proceso (mallas, materiales, texturas y sonidos).
+/// Los componentes y las escenas cuentan referencias a lo que usan; lo que se
+/// queda sin referencias sigue cargado hasta que su tipo pasa del presupuesto
+/// de memoria, y entonces se descarga lo que lleva mas tiempo sin usarse.
+/// El cache no sabe cargar ni descargar nada, cada sistema pone un Backend
+/// para sus tipos (OgreContext para los de Ogre, AudioSystem para los sonidos)
+/// </summary>
+class ResourceCache
+{
+public:
+	enum class Type : int {
+		Mesh = 0,
+		Material,
+		Texture,
+		Sound,
+
+		LastType
+	};
+
+	// Lo que pone cada sistema para sus recursos
+	struct Backend {
+		std::function<size_t(const std::string&)> size;		// bytes que ocupa, 0 si no esta cargado
+		std::function<bool(const std::string&)> inUse;		// algo fuera del cache lo esta usando
+		std::function<void(const std::string&)> unload;
+	};
+
+	struct Stats {
+		size_t bytes = 0;			// memoria de lo que esta cargado
+		size_t budget = 0;			// 0 = sin limite
+		int resident = 0;			// recursos que conoce el cache
+		int referenced = 0;			// de ellos, los que tienen referencias
+		int evictions = 0;			// descargados por pasarse del presupuesto
+	};
+
+	// Referencias de un componente o escena, se sueltan al destruirse
+	class Handles {
+	private:
+		std::vector<std::pair<Type, std::string>> held_;
+	public:
+		Handles() = default;
+		~Handles();
+		void acquire(Type type, const std::string& name);
+		void releaseAll();
+	private:
+		Handles(const Handles&) = delete;
+		Handles& operator=(const Handles&) = delete;
+	};
+
+	// Presupuestos opcionales en MB por tipo: { "Mesh": 256, "Texture": 512, ... }
+	static const std::string BUDGETS_FILE_PATH;
+
+	static ResourceCache* getInstance();
+
+	// Sin backend los recursos de ese tipo se olvidan (sin descargarlos)
+	void setBackend(Type type, const Backend& backend);
+	void setBudget(Type type, size_t bytes);
+	void loadBudgets(const nlohmann::json& config);
+
+	void acquire(Type type, const std::string& name);
+	void release(Type type, const std::string& name);
+	// Marca como usado ahora un recurso (lo registra sin referencias si no estaba)
+	void touch(Type type, const std::string& name);
+	// El sistema lo ha descargado por su cuenta
+	void forget(Type type, const std::string& name);
+
+	// Descarga, de menos a mas reciente, lo que no tiene referencias hasta
+	// que cada tipo cabe en su presupuesto
+	void trim();
+	// Descarga todo lo que no tiene referencias
+	void purge();
+
+	Stats getStats(Type type) const;
+	void printStats() const;
+
+	static const char* typeName(Type type);
+
+private:
+	struct Entry {
+		int refs = 0;
+		unsigned long long lastUse = 0;
+		// Posicion en la lista de candidatos si no tiene referencias
+		std::list<std::string>::iterator lru;
+	};
+
+	struct Pool {
+		Backend backend;
+		std::map<std::string, Entry> entries;
+		// Sin referencias, del menos al mas reciente
+		std::list<std::string> lru;
+		size_t budget = 0;
+		int evictions = 0;
+	};
+
+	ResourceCache();
+	~ResourceCache() = default;
+
+	Entry& getEntry(Pool& pool, const std::string& name);
+	size_t poolBytes(const Pool& pool) const;
+	void evict(Pool& pool, bool all);
+
+	Pool pools_[(int)Type::LastType];
+	unsigned long long useClock_ = 0;
+	// El sonido se precarga en otro hilo durante el arranque; recursivo
+	// porque los backend pueden llamar a forget mientras se descarga
+	mutable std::recursive_mutex mutex_;
+};
+
+#endif
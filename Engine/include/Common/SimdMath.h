@@ -0,0 +1,305 @@
+#pragma once
+
+#ifndef _COMMON_SIMDMATH_H
+#define _COMMON_SIMDMATH_H
+
+#include <cmath>
+#include <cstddef>
+#include "Vector3.h"
+
+//Seleccion del conjunto de instrucciones. Sin SSE2 ni NEON de 64 bits se usa
+//la version escalar, con el mismo interfaz
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PAPAGAYO_SIMD_SSE
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define PAPAGAYO_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+//Operaciones sobre 4 floats a la vez
+namespace simd {
+#if defined(PAPAGAYO_SIMD_SSE)
+	typedef __m128 float4;
+
+	inline float4 load(const float* p) { return _mm_load_ps(p); }
+	inline float4 loadu(const float* p) { return _mm_loadu_ps(p); }
+	inline void store(float* p, float4 v) { _mm_store_ps(p, v); }
+	inline void storeu(float* p, float4 v) { _mm_storeu_ps(p, v); }
+	inline float4 splat(float f) { return _mm_set1_ps(f); }
+	inline float4 add(float4 a, float4 b) { return _mm_add_ps(a, b); }
+	inline float4 sub(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+	inline float4 mul(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+	inline float4 div(float4 a, float4 b) { return _mm_div_ps(a, b); }
+	inline float4 min(float4 a, float4 b) { return _mm_min_ps(a, b); }
+	inline float4 max(float4 a, float4 b) { return _mm_max_ps(a, b); }
+	//a * b + c
+	inline float4 madd(float4 a, float4 b, float4 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+	inline float4 sqrt(float4 a) { return _mm_sqrt_ps(a); }
+#elif defined(PAPAGAYO_SIMD_NEON)
+	typedef float32x4_t float4;
+
+	inline float4 load(const float* p) { return vld1q_f32(p); }
+	inline float4 loadu(const float* p) { return vld1q_f32(p); }
+	inline void store(float* p, float4 v) { vst1q_f32(p, v); }
+	inline void storeu(float* p, float4 v) { vst1q_f32(p, v); }
+	inline float4 splat(float f) { return vdupq_n_f32(f); }
+	inline float4 add(float4 a, float4 b) { return vaddq_f32(a, b); }
+	inline float4 sub(float4 a, float4 b) { return vsubq_f32(a, b); }
+	inline float4 mul(float4 a, float4 b) { return vmulq_f32(a, b); }
+	inline float4 div(float4 a, float4 b) { return vdivq_f32(a, b); }
+	inline float4 min(float4 a, float4 b) { return vminq_f32(a, b); }
+	inline float4 max(float4 a, float4 b) { return vmaxq_f32(a, b); }
+	inline float4 madd(float4 a, float4 b, float4 c) { return vmlaq_f32(c, a, b); }
+	inline float4 sqrt(float4 a) { return vsqrtq_f32(a); }
+#else
+	struct float4 { float v[4]; };
+
+	inline float4 load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+	inline float4 loadu(const float* p) { return load(p); }
+	inline void store(float* p, float4 a) { for (int i = 0; i < 4; i++) p[i] = a.v[i]; }
+	inline void storeu(float* p, float4 a) { store(p, a); }
+	inline float4 splat(float f) { return { { f, f, f, f } }; }
+	inline float4 add(float4 a, float4 b) { for (int i = 0; i < 4; i++) a.v[i] += b.v[i]; return a; }
+	inline float4 sub(float4 a, float4 b) { for (int i = 0; i < 4; i++) a.v[i] -= b.v[i]; return a; }
+	inline float4 mul(float4 a, float4 b) { for (int i = 0; i < 4; i++) a.v[i] *= b.v[i]; return a; }
+	inline float4 div(float4 a, float4 b) { for (int i = 0; i < 4; i++) a.v[i] /= b.v[i]; return a; }
+	inline float4 min(float4 a, float4 b) { for (int i = 0; i < 4; i++) a.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return a; }
+	inline float4 max(float4 a, float4 b) { for (int i = 0; i < 4; i++) a.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return a; }
+	inline float4 madd(float4 a, float4 b, float4 c) { for (int i = 0; i < 4; i++) a.v[i] = a.v[i] * b.v[i] + c.v[i]; return a; }
+	inline float4 sqrt(float4 a) { for (int i = 0; i < 4; i++) a.v[i] = std::sqrt(a.v[i]); return a; }
+#endif
+
+	//Suma de los 4 componentes
+	inline float hsum(float4 a)
+	{
+		alignas(16) float t[4];
+		store(t, a);
+		return (t[0] + t[1]) + (t[2] + t[3]);
+	}
+}
+
+//Vector de 4 componentes alineado a 16 bytes, se carga en un solo registro
+class alignas(16) Vector4
+{
+public:
+	float x, y, z, w;
+
+	constexpr Vector4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+	constexpr Vector4(float x1, float y1, float z1, float w1) : x(x1), y(y1), z(z1), w(w1) {}
+	//w = 1 para puntos y w = 0 para direcciones
+	constexpr Vector4(const Vector3& v, float w1) : x(v.x), y(v.y), z(v.z), w(w1) {}
+	Vector4(simd::float4 v) { simd::store(&x, v); }
+
+	simd::float4 get() const { return simd::load(&x); }
+	constexpr Vector3 xyz() const { return Vector3(x, y, z); }
+
+	Vector4 operator+(const Vector4& v) const { return simd::add(get(), v.get()); }
+	Vector4 operator-(const Vector4& v) const { return simd::sub(get(), v.get()); }
+	//Producto componente a componente
+	Vector4 operator*(const Vector4& v) const { return simd::mul(get(), v.get()); }
+	Vector4 operator*(float k) const { return simd::mul(get(), simd::splat(k)); }
+	Vector4 operator/(float k) const { return simd::mul(get(), simd::splat(1.0f / k)); }
+	void operator+=(const Vector4& v) { simd::store(&x, simd::add(get(), v.get())); }
+	void operator-=(const Vector4& v) { simd::store(&x, simd::sub(get(), v.get())); }
+	void operator*=(float k) { simd::store(&x, simd::mul(get(), simd::splat(k))); }
+	constexpr bool operator==(const Vector4& v) const { return x == v.x && y == v.y && z == v.z && w == v.w; }
+
+	constexpr float dot(const Vector4& v) const { return x * v.x + y * v.y + z * v.z + w * v.w; }
+	float magnitude() const { return std::sqrt(dot(*this)); }
+	Vector4 normalized() const
+	{
+		float m = magnitude();
+		return m > 0.0f ? *this * (1.0f / m) : *this;
+	}
+	static Vector4 min(const Vector4& a, const Vector4& b) { return simd::min(a.get(), b.get()); }
+	static Vector4 max(const Vector4& a, const Vector4& b) { return simd::max(a.get(), b.get()); }
+	static Vector4 lerp(const Vector4& a, const Vector4& b, float t) { return simd::madd(simd::sub(b.get(), a.get()), simd::splat(t), a.get()); }
+};
+
+//Cuaternion unitario para rotaciones (w + xi + yj + zk)
+class Quaternion
+{
+public:
+	float w, x, y, z;
+
+	constexpr Quaternion() : w(1.0f), x(0.0f), y(0.0f), z(0.0f) {}
+	constexpr Quaternion(float w1, float x1, float y1, float z1) : w(w1), x(x1), y(y1), z(z1) {}
+
+	static constexpr Quaternion identity() { return Quaternion(); }
+	//Rotacion de angle radianes alrededor de un eje unitario
+	static Quaternion fromAxisAngle(const Vector3& axis, float angle)
+	{
+		float s = std::sin(angle * 0.5f);
+		return Quaternion(std::cos(angle * 0.5f), axis.x * s, axis.y * s, axis.z * s);
+	}
+	//Yaw en Y, luego pitch en X y luego roll en Z, en ejes globales (como los nodos de Ogre)
+	static Quaternion fromYawPitchRoll(float yaw, float pitch, float roll)
+	{
+		return fromAxisAngle(Vector3(0, 0, 1), roll) * fromAxisAngle(Vector3(1, 0, 0), pitch) * fromAxisAngle(Vector3(0, 1, 0), yaw);
+	}
+
+	constexpr Quaternion operator*(const Quaternion& q) const
+	{
+		return Quaternion(w * q.w - x * q.x - y * q.y - z * q.z,
+			w * q.x + x * q.w + y * q.z - z * q.y,
+			w * q.y - x * q.z + y * q.w + z * q.x,
+			w * q.z + x * q.y - y * q.x + z * q.w);
+	}
+	constexpr Quaternion conjugate() const { return Quaternion(w, -x, -y, -z); }
+	constexpr float dot(const Quaternion& q) const { return w * q.w + x * q.x + y * q.y + z * q.z; }
+	Quaternion normalized() const
+	{
+		float m = std::sqrt(dot(*this));
+		return m > 0.0f ? Quaternion(w / m, x / m, y / m, z / m) : Quaternion();
+	}
+	//Rota un vector: v + 2w(q x v) + 2 q x (q x v)
+	constexpr Vector3 rotate(const Vector3& v) const
+	{
+		Vector3 q(x, y, z);
+		Vector3 t = q.cross(v) * 2.0f;
+		return v + t * w + q.cross(t);
+	}
+	//Interpolacion esferica por el camino corto
+	static Quaternion slerp(const Quaternion& a, const Quaternion& b, float t)
+	{
+		float cosTheta = a.dot(b);
+		Quaternion end = b;
+		if (cosTheta < 0.0f) {
+			cosTheta = -cosTheta;
+			end = Quaternion(-b.w, -b.x, -b.y, -b.z);
+		}
+		//Muy cerca, la interpolacion lineal es suficiente y evita dividir por ~0
+		if (cosTheta > 0.9995f)
+			return Quaternion(a.w + (end.w - a.w) * t, a.x + (end.x - a.x) * t,
+				a.y + (end.y - a.y) * t, a.z + (end.z - a.z) * t).normalized();
+		float theta = std::acos(cosTheta);
+		float sinTheta = std::sin(theta);
+		float wa = std::sin((1.0f - t) * theta) / sinTheta;
+		float wb = std::sin(t * theta) / sinTheta;
+		return Quaternion(a.w * wa + end.w * wb, a.x * wa + end.x * wb, a.y * wa + end.y * wb, a.z * wa + end.z * wb);
+	}
+};
+
+//Matriz 4x4 por columnas: c[3] es la traslacion
+class alignas(16) Matrix4
+{
+public:
+	Vector4 c[4];
+
+	constexpr Matrix4() : c{ Vector4(1, 0, 0, 0), Vector4(0, 1, 0, 0), Vector4(0, 0, 1, 0), Vector4(0, 0, 0, 1) } {}
+	constexpr Matrix4(const Vector4& c0, const Vector4& c1, const Vector4& c2, const Vector4& c3) : c{ c0, c1, c2, c3 } {}
+
+	static constexpr Matrix4 identity() { return Matrix4(); }
+	static constexpr Matrix4 translation(const Vector3& t)
+	{
+		return Matrix4(Vector4(1, 0, 0, 0), Vector4(0, 1, 0, 0), Vector4(0, 0, 1, 0), Vector4(t, 1));
+	}
+	static constexpr Matrix4 scale(const Vector3& s)
+	{
+		return Matrix4(Vector4(s.x, 0, 0, 0), Vector4(0, s.y, 0, 0), Vector4(0, 0, s.z, 0), Vector4(0, 0, 0, 1));
+	}
+	//Escala, luego rotacion y luego traslacion
+	static constexpr Matrix4 fromTRS(const Vector3& t, const Quaternion& q, const Vector3& s)
+	{
+		float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+		float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+		float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+		return Matrix4(
+			Vector4((1 - 2 * (yy + zz)) * s.x, 2 * (xy + wz) * s.x, 2 * (xz - wy) * s.x, 0),
+			Vector4(2 * (xy - wz) * s.y, (1 - 2 * (xx + zz)) * s.y, 2 * (yz + wx) * s.y, 0),
+			Vector4(2 * (xz + wy) * s.z, 2 * (yz - wx) * s.z, (1 - 2 * (xx + yy)) * s.z, 0),
+			Vector4(t, 1));
+	}
+
+	//Combinacion lineal de las columnas, 4 multiplicaciones y 3 sumas vectoriales
+	Vector4 operator*(const Vector4& v) const
+	{
+		simd::float4 r = simd::mul(c[0].get(), simd::splat(v.x));
+		r = simd::madd(c[1].get(), simd::splat(v.y), r);
+		r = simd::madd(c[2].get(), simd::splat(v.z), r);
+		r = simd::madd(c[3].get(), simd::splat(v.w), r);
+		return r;
+	}
+	Matrix4 operator*(const Matrix4& m) const
+	{
+		return Matrix4(*this * m.c[0], *this * m.c[1], *this * m.c[2], *this * m.c[3]);
+	}
+	Vector3 transformPoint(const Vector3& p) const { return (*this * Vector4(p, 1.0f)).xyz(); }
+	Vector3 transformVector(const Vector3& v) const { return (*this * Vector4(v, 0.0f)).xyz(); }
+	constexpr Matrix4 transposed() const
+	{
+		return Matrix4(Vector4(c[0].x, c[1].x, c[2].x, c[3].x), Vector4(c[0].y, c[1].y, c[2].y, c[3].y),
+			Vector4(c[0].z, c[1].z, c[2].z, c[3].z), Vector4(c[0].w, c[1].w, c[2].w, c[3].w));
+	}
+};
+
+//Kernels sobre arrays en formato SoA (una array por componente).
+//Procesan 4 elementos por iteracion y el resto en escalar
+namespace simd {
+	//out[i] += a[i] * k
+	inline void madd(float* out, const float* a, float k, size_t n)
+	{
+		size_t i = 0;
+		float4 vk = splat(k);
+		for (; i + 4 <= n; i += 4)
+			storeu(out + i, madd(loadu(a + i), vk, loadu(out + i)));
+		for (; i < n; i++)
+			out[i] += a[i] * k;
+	}
+
+	//out[i] += k
+	inline void addScalar(float* out, float k, size_t n)
+	{
+		size_t i = 0;
+		float4 vk = splat(k);
+		for (; i + 4 <= n; i += 4)
+			storeu(out + i, add(loadu(out + i), vk));
+		for (; i < n; i++)
+			out[i] += k;
+	}
+
+	//out[i] *= k
+	inline void mulScalar(float* out, float k, size_t n)
+	{
+		size_t i = 0;
+		float4 vk = splat(k);
+		for (; i + 4 <= n; i += 4)
+			storeu(out + i, mul(loadu(out + i), vk));
+		for (; i < n; i++)
+			out[i] *= k;
+	}
+
+	//p[i] += v[i] * dt en las tres componentes
+	inline void integrate(float* px, float* py, float* pz, const float* vx, const float* vy, const float* vz, float dt, size_t n)
+	{
+		madd(px, vx, dt, n);
+		madd(py, vy, dt, n);
+		madd(pz, vz, dt, n);
+	}
+
+	//out[i] = m * (in[i], 1). Puede usarse con in == out
+	inline void transformPoints(const Matrix4& m, const float* inX, const float* inY, const float* inZ,
+		float* outX, float* outY, float* outZ, size_t n)
+	{
+		const Matrix4 t = m.transposed();
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			float4 x = loadu(inX + i), y = loadu(inY + i), z = loadu(inZ + i);
+			float4 rx = madd(x, splat(t.c[0].x), madd(y, splat(t.c[0].y), madd(z, splat(t.c[0].z), splat(t.c[0].w))));
+			float4 ry = madd(x, splat(t.c[1].x), madd(y, splat(t.c[1].y), madd(z, splat(t.c[1].z), splat(t.c[1].w))));
+			float4 rz = madd(x, splat(t.c[2].x), madd(y, splat(t.c[2].y), madd(z, splat(t.c[2].z), splat(t.c[2].w))));
+			storeu(outX + i, rx);
+			storeu(outY + i, ry);
+			storeu(outZ + i, rz);
+		}
+		for (; i < n; i++) {
+			Vector3 p = m.transformPoint(Vector3(inX[i], inY[i], inZ[i]));
+			outX[i] = p.x;
+			outY[i] = p.y;
+			outZ[i] = p.z;
+		}
+	}
+}
+
+#endif
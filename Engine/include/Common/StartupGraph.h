@@ -0,0 +1,60 @@
+#pragma once
+
+#ifndef _COMMON_STARTUPGRAPH_H
+#define _COMMON_STARTUPGRAPH_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+
+class EngineContext;
+
+/// <summary>
+/// Pasos de arranque con sus dependencias. Cada paso empieza en cuanto han
+/// acabado todos de los que depende, los independientes en paralelo en un
+/// grupo de hilos. Los marcados como de hilo principal (Ogre, CEGUI) se
+/// ejecutan en el hilo que llama a run. Se mide lo que tarda cada paso
+/// </summary>
+class StartupGraph
+{
+public:
+	struct StepTiming {
+		std::string name;
+		float startMs = 0.0f;		// desde el principio de run
+		float durationMs = 0.0f;
+		bool mainThread = false;
+	};
+
+	void addStep(const std::string& name, std::function<void()> step,
+		const std::vector<std::string>& deps = {}, bool mainThread = false);
+	bool hasStep(const std::string& name) const;
+
+	// Todos los hilos trabajan con ctx enlazado. Si un paso lanza una excepcion
+	// no se empiezan mas pasos y se relanza cuando acaban los que estaban en marcha.
+	// threads = 0 elige segun los nucleos
+	void run(EngineContext* ctx, unsigned int threads = 0);
+
+	const std::vector<StepTiming>& getTimings() const;
+	float getTotalMs() const;
+	void printReport() const;
+
+private:
+	struct Step {
+		std::string name;
+		std::function<void()> fn;
+		std::vector<std::string> deps;
+		bool mainThread = false;
+		std::vector<size_t> next;
+		int pending = 0;
+	};
+
+	std::vector<Step> steps_;
+	std::map<std::string, size_t> byName_;
+	std::vector<StepTiming> timings_;
+	float totalMs_ = 0.0f;
+
+	void resolve();
+};
+
+#endif
@@ -5,18 +5,42 @@
 
 #include "Component.h"
 #include "Vector3.h"
+#include "SimdMath.h"
 #include <map>
 #include <string>
+#include <vector>
 
 //class Vector3;
 class CommonManager;
 
+//Los datos no se guardan aqui sino en las arrays SoA del CommonManager,
+//el transform solo conoce su hueco. Por eso los getters devuelven copias.
+//Posicion, rotacion y escala son relativas al padre; el estado de mundo lo
+//calcula el CommonManager una vez por frame y es lo que leen render y audio.
+//Un transform que mueve la fisica no hereda de su padre, la fisica ya lo
+//deja en coordenadas de mundo
 class Transform : public Component {
+	friend class CommonManager;
 private:
-	Vector3 _position;
-	Vector3 _velocity;
-	Vector3 _dimensions;
-	Vector3 _rotation;
+	size_t slot_;
+	bool physicsDriven_;
+	//Pide que el CommonManager integre su velocidad
+	bool kinematic_ = false;
+
+	Transform* parent_ = nullptr;
+	std::vector<Transform*> children_;
+	int depth_ = 0;
+	//Nombre de la entidad padre leido del json, se busca en setUp
+	std::string parentName_;
+	//Ya ha pasado el setUp, el padre por nombre se busca en el momento
+	bool setUpDone_ = false;
+
+	Vector3 read(const std::vector<float>& x, const std::vector<float>& y, const std::vector<float>& z) const;
+	void write(std::vector<float>& x, std::vector<float>& y, std::vector<float>& z, const Vector3& v);
+	void markDirty();
+	void updateDepth();
+	//Solo se integra si lo ha pedido y no lo mueve la fisica
+	void updateKinematic();
 public:
 	Transform();
 	Transform(const Vector3& pos, const Vector3& vel, const Vector3& dim, const Vector3& rotation);
@@ -25,10 +49,29 @@ public:
 	virtual void init();
 	virtual void load(const nlohmann::json& params);
 	virtual void update(float deltaTime);
+	virtual void setUp() override;
+	virtual const Reflection::TypeInfo* getTypeInfo() const override;
+
+	// jerarquia
+	//nullptr lo deja en la raiz. Lanza una excepcion si crea un ciclo
+	void setParent(Transform* parent);
+	Transform* getParent() const;
+	//Por nombre de entidad de la escena actual; "" lo deja en la raiz
+	void setParentByName(const std::string& name);
+	const std::vector<Transform*>& getChildren() const;
+	int getDepth() const;
+
+	// estado de mundo (de la ultima pasada del CommonManager)
+	const Matrix4& getWorldMatrix() const;
+	Vector3 getWorldPos() const;
+	Quaternion getWorldRotation() const;
+	Vector3 getWorldScale() const;
+	//Rotacion local en el orden de los nodos de Ogre: yaw con z, pitch con y y roll con x
+	Quaternion getLocalRotation() const;
 
 	// position
 	//const Vector3& getPos();
-	const Vector3& getPos() const;
+	Vector3 getPos() const;
 	void setPos(const Vector3& pos);
 	void setPosX(double x);
 	void setPosY(double y);
@@ -36,7 +79,7 @@ public:
 
 	// rotation
 	//const Vector3& getRot();
-	const Vector3& getRot() const;
+	Vector3 getRot() const;
 	void setRot(Vector3 angle);
 	void setRotX(double x);
 	void setRotY(double y);
@@ -44,7 +87,7 @@ public:
 
 	// velocity
 	//const Vector3& getVel();
-	const Vector3& getVel() const;
+	Vector3 getVel() const;
 	void setVel(const Vector3& vel);
 	void setVelX(double x);
 	void setVelY(double y);
@@ -52,11 +95,20 @@ public:
 
 	//Dimensions
 	//const Vector3& getDimensions();
-	const Vector3& getDimensions() const;
+	Vector3 getDimensions() const;
 	void setDimensions(const Vector3 dim);
 	void setDimX(double x);
 	void setDimY(double y);
 	void setDimZ(double z);
+
+	// La velocidad solo se integra en el fixedUpdate si es cinematico
+	// ("kinematic" en el json); si no, solo se guarda para quien la lea
+	void setKinematic(bool kinematic);
+	bool isKinematic() const;
+
+	// Si lo mueve la fisica no se integra su velocidad ni hereda del padre
+	void setPhysicsDriven(bool driven);
+	bool isPhysicsDriven() const;
 };
 
 #endif
\ No newline at end of file
@@ -4,71 +4,95 @@
 #define _COMMON_VECTOR3_H
 
 #include <vector>
+#include <cmath>
 
+//Todo el vector esta en la cabecera para que el compilador pueda hacer
+//inline de las operaciones en cualquier unidad de traduccion
 class Vector3
 {
 public:
 	 float x; //Guarda el valor en el eje X
-	 float y; //Guarda el valor en el eje X
-	 float z; //Guarda el valor en el eje X
+	 float y; //Guarda el valor en el eje Y
+	 float z; //Guarda el valor en el eje Z
 
 	//Constructor por defecto(todos los valores a cero
-	Vector3();
+	constexpr Vector3() : x(0.0f), y(0.0f), z(0.0f) {}
 	//Constructor
-	Vector3(const float x1, const float y1, const float z1);
-	Vector3(const std::vector<float>& pos);
+	constexpr Vector3(const float x1, const float y1, const float z1) : x(x1), y(y1), z(z1) {}
+	// Se puede tratar la excepcion en el load, si no se trata aqui
+	Vector3(const std::vector<float>& pos) : x(0.0f), y(0.0f), z(0.0f)
+	{
+		if (pos.size() >= 3) {
+			x = pos[0]; y = pos[1]; z = pos[2];
+		}
+	}
 	//Constructor por copia
-	Vector3(const Vector3& other);
+	constexpr Vector3(const Vector3& other) = default;
+	constexpr Vector3& operator=(const Vector3& other) = default;
 
 	//Invertir todos los valores del vector
-	void invert();
+	constexpr void invert() { x = -x; y = -y; z = -z; }
 	// Optener la magnitud del vector
-	float magnitude() const;
-	
+	float magnitude() const { return std::sqrt(squareMagnitude()); }
+
 	//Obtener la magnitud del vector al cuadrado
-	float squareMagnitude() const;
-	
+	constexpr float squareMagnitude() const { return x * x + y * y + z * z; }
+
 	// Multiplicar el vector por un escalar
-	void operator*=(const float k);
+	constexpr void operator*=(const float k) { x *= k; y *= k; z *= k; }
 
 	//Devuelve la copia de un vector multiplicado por un escalar
-	Vector3 operator*(const float k);
+	constexpr Vector3 operator*(const float k) const { return Vector3(x * k, y * k, z * k); }
+
+	//Devuelve la copia de un vector dividido por un escalar
+	constexpr Vector3 operator/(const float k) const { return Vector3(x / k, y / k, z / k); }
 
-	//normalizar el vector
-	float normalize();
+	//normalizar el vector, devuelve la magnitud que tenia
+	float normalize()
+	{
+		float m = magnitude();
+		if (m > 0.0f)
+			*this *= 1.0f / m;
+		return m;
+	}
 
 	//producto escalar de dos vectores
-	float operator*(const Vector3& v) const;
+	constexpr float operator*(const Vector3& v) const { return dot(v); }
 
 	// Funcion para el producto escalar
-	float dot(const Vector3& v) const;
+	constexpr float dot(const Vector3& v) const { return x * v.x + y * v.y + z * v.z; }
 
 	// sumar dos vectores
-	Vector3 operator+(const Vector3& other);
-	
+	constexpr Vector3 operator+(const Vector3& other) const { return Vector3(x + other.x, y + other.y, z + other.z); }
+
 	// Suma a tu vector otro
-	void operator+=(const Vector3& other);
+	constexpr void operator+=(const Vector3& other) { x += other.x; y += other.y; z += other.z; }
 
-   // restar dos vectores
-	Vector3 operator-(const Vector3& other);
+	// restar dos vectores
+	constexpr Vector3 operator-(const Vector3& other) const { return Vector3(x - other.x, y - other.y, z - other.z); }
 
 	//restar a tu vector otro
-	void operator-=(const Vector3& other);
+	constexpr void operator-=(const Vector3& other) { x -= other.x; y -= other.y; z -= other.z; }
+
+	//vector opuesto
+	constexpr Vector3 operator-() const { return Vector3(-x, -y, -z); }
 
 	//comparar dos vectores
-	bool operator==(const Vector3& other);
+	constexpr bool operator==(const Vector3& other) const { return x == other.x && y == other.y && z == other.z; }
+	constexpr bool operator!=(const Vector3& other) const { return !(*this == other); }
 
 	//producto vectorial
-	Vector3 operator%(const Vector3& v);
+	constexpr Vector3 operator%(const Vector3& v) const { return cross(v); }
+	constexpr Vector3 cross(const Vector3& v) const { return Vector3(y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x); }
 
 	//Para saber si el vector es 0
-	bool isZero() const;
+	constexpr bool isZero() const { return x == 0 && y == 0 && z == 0; }
 
-	//setter 
-	void set(Vector3 pos);
-	void setX(float n);
-	void setY(float n);
-	void setZ(float n);
+	//setter
+	constexpr void set(const Vector3& v) { x = v.x; y = v.y; z = v.z; }
+	constexpr void setX(float n) { x = n; }
+	constexpr void setY(float n) { y = n; }
+	constexpr void setZ(float n) { z = n; }
 };
 
-#endif
\ No newline at end of file
+#endif
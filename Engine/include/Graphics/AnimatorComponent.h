@@ -0,0 +1,100 @@
+#pragma once
+
+#ifndef _GRAPHICS_ANIMATOR_H
+#define _GRAPHICS_ANIMATOR_H
+
+#include "Component.h"
+#include "Vector3.h"
+#include <vector>
+#include <string>
+
+class MeshComponent;
+class Transform;
+
+namespace Ogre {
+	class AnimationState;
+	class AnimationStateSet;
+}
+
+/// <summary>
+/// Animaciones de esqueleto de la malla de la entidad (necesita un
+/// MeshComponent). Se mezclan con fundidos entre animaciones. No se
+/// actualizan una a una: el RenderManager avanza todas en una sola pasada y
+/// las que estan lejos o fuera de camara solo cada varios frames, con el
+/// tiempo acumulado (LOD de animacion)
+/// </summary>
+class AnimatorComponent : public Component
+{
+	friend class RenderManager;
+public:
+	// Camara con la que se elige el LOD, la prepara el RenderManager una vez por frame
+	struct View {
+		bool hasCamera = false;
+		Vector3 position;
+		// Planos del frustum (normal hacia dentro) como normal y distancia
+		Vector3 normals[6];
+		float distances[6] = { 0, 0, 0, 0, 0, 0 };
+	};
+private:
+	// Animacion en mezcla, el peso va hacia target a fadeSpeed por segundo
+	struct Layer {
+		Ogre::AnimationState* state = nullptr;
+		float weight = 0.0f;
+		float target = 0.0f;
+		float fadeSpeed = 0.0f;
+	};
+
+	MeshComponent* mesh_ = nullptr;
+	Transform* tr_ = nullptr;
+	Ogre::AnimationStateSet* states_ = nullptr;
+	std::vector<Layer> layers_;
+	float radius_ = 0.0f;		// radio de la malla para saber si se ve
+
+	std::string startAnimation_;
+	bool startLoop_ = true;
+	float speed_ = 1.0f;
+	float fade_ = 0.2f;			// segundos por defecto de los fundidos
+
+	// LOD: pasada cada distancia se actualiza la mitad de veces
+	std::vector<float> lodDistances_;
+	int offscreenInterval_ = 8;	// frames entre actualizaciones fuera de camara
+	int interval_ = 1;
+	int framesToUpdate_ = 0;
+	float pendingTime_ = 0.0f;	// tiempo que aun no se ha aplicado
+
+	Layer* findLayer(const std::string& name);
+	// Cada cuantos frames toca actualizar segun la distancia y si se ve
+	int chooseInterval(const View& view) const;
+	// Lo llama el RenderManager en su pasada, puede ser desde otro hilo
+	void advance(float deltaTime, const View& view);
+public:
+	AnimatorComponent();
+	virtual ~AnimatorComponent();
+
+	virtual void init() override;
+	virtual void load(const nlohmann::json& params) override;
+	virtual void setUp() override;
+	virtual void update(float deltaTime) override;
+	virtual void setActive(bool act) override;
+
+	// Pasa a la animacion con el fundido por defecto
+	void play(const std::string& name, bool loop);
+	// Pasa a la animacion fundiendo en fadeTime segundos (0 = corte)
+	void crossFade(const std::string& name, float fadeTime, bool loop);
+	// Anade una animacion a la mezcla sin quitar las demas
+	void blend(const std::string& name, float weight, float fadeTime, bool loop);
+	// Funde todas a cero
+	void stop(float fadeTime);
+
+	bool hasAnimation(const std::string& name) const;
+	bool isPlaying(const std::string& name) const;
+	// La de mas peso objetivo, vacia si no hay ninguna
+	std::string getCurrentAnimation() const;
+
+	void setSpeed(float speed);
+	float getSpeed() const;
+	// Frames entre actualizaciones que ha elegido el ultimo LOD
+	int getUpdateInterval() const;
+};
+
+#endif
@@ -24,6 +24,12 @@ protected:
 	Ogre::Viewport* vp_ = nullptr;
 	std::string name_ = "";
 	Transform* tr_ = nullptr;
+	bool autoAspectRatio_ = true;
+	int nearClipDistance_ = 1;
+	int farClipDistance_ = 10000;
+
+	//Crea la camara de Ogre con ese nombre, solo la primera vez
+	void createCamera(const std::string& name);
 
 public:
 
@@ -34,6 +40,7 @@ public:
 	virtual void setUp()override;
 	virtual void load(const nlohmann::json& params) override;
 	virtual void init()override;
+	virtual const Reflection::TypeInfo* getTypeInfo() const override;
 
 	//Cambiar posicion del nodo asociado a la camara
 	void setCameraPosition(const Vector3& newPos);
@@ -49,7 +56,7 @@ public:
 	//Metodo para convertir una posicin en coordenadas relativas a la ventana de la camapa
 	Vector3 getScreenCoordinates(const Vector3& iPoint);
 	//Getter posicion de la camara
-	const Vector3& getCameraPosition() const;
+	Vector3 getCameraPosition() const;
 	//Obtener camara
 	inline Ogre::Camera* getCamera() const;
 };
@@ -5,6 +5,7 @@
 
 #include "Component.h"
 #include <string>
+#include "ResourceCache.h"
 
 class SceneManager;
 class Transform;
@@ -21,6 +22,8 @@ private:
 	Ogre::SceneNode* mNode_ = nullptr;		
 	Ogre::Entity* ogreEnt_ = nullptr;
 	Transform* tr_ = nullptr;
+	//Malla, materiales y texturas de la entidad en el cache de recursos
+	ResourceCache::Handles resources_;
 public:
 	//constructora por defecto
 	MeshComponent();
@@ -4,6 +4,10 @@
 #define _GRAPHICS_OGRECONT_H
 
 #include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include "ResourceCache.h"
 class RTShaderTecnhiqueResolveListener;
 class SDL_Window;
 
@@ -14,6 +18,7 @@ namespace Ogre {
 	class ViewPort;
 	class SceneManager;
 	class SceneNode;
+	class Entity;
 
 	class Camera;
 	class FileSystemLayer;
@@ -58,6 +63,14 @@ private:
 	Ogre::FileSystemLayer* mFSLayer_;
 	std::string appName_;
 
+	//Secciones de resources.cfg y cuantas escenas usan cada una
+	std::vector<std::string> resourceGroups_;
+	std::map<std::string, int> groupRefs_;
+	//Sin escenas pero con recursos cargados, a la espera del cache
+	std::set<std::string> releasedGroups_;
+	//Material del cielo y sus texturas
+	ResourceCache::Handles skyResources_;
+
 	bool grab = false;
 	bool showCursor = false;
 	bool exit;
@@ -75,6 +88,9 @@ private:
 	void createSceneManager();
 	void init();
 	void loadFromResourceFile();
+	bool isResourceGroupUsable(const std::string& group) const;
+	//Mallas, materiales y texturas de Ogre en el cache de recursos
+	void registerResourceCache();
 public:
 	static bool setUpInstance(const std::string& appName);
 	static void clean();
@@ -87,6 +103,24 @@ public:
 	//Crear un plano en el eje Z
 	Ogre::Plane createZPlane(float distance);
 
+//------GRUPOS DE RECURSOS--------//
+	//Los grupos de resources.cfg no se inicializan al arrancar (menos General):
+	//se inicializan y cargan cuando una escena los pide. Al soltarlos solo se
+	//quita la referencia: sus recursos quedan en el cache hasta que no caben
+	void acquireResourceGroups(const std::vector<std::string>& groups);
+	void releaseResourceGroups(const std::vector<std::string>& groups);
+	//Descarga los grupos soltados a los que el cache ya les ha quitado todo,
+	//despues de ResourceCache::trim
+	void unloadEvictedGroups();
+	//Inicializa los grupos y deja su lectura de disco en la cola de segundo
+	//plano de Ogre, el acquire posterior termina la carga
+	void prefetchResourceGroups(const std::vector<std::string>& groups);
+	const std::vector<std::string>& getResourceGroups() const;
+
+	//Cuenta en el cache la malla de la entidad, sus materiales y sus texturas
+	void holdResources(Ogre::Entity* ent, ResourceCache::Handles& handles);
+	void holdMaterial(const std::string& materialName, ResourceCache::Handles& handles);
+
 //--------------GET-----------//
 	static OgreContext* getInstance();
 	
@@ -0,0 +1,92 @@
+#pragma once
+
+#ifndef _GRAPHICS_PARTICLESYSTEM_H
+#define _GRAPHICS_PARTICLESYSTEM_H
+
+#include "Component.h"
+#include "Vector3.h"
+#include <vector>
+#include <random>
+#include <string>
+
+class Transform;
+
+namespace Ogre {
+	class SceneNode;
+	class BillboardSet;
+}
+
+/// <summary>
+/// Emisor de particulas. Las particulas no son entidades: se guardan en
+/// arrays SoA, se simulan con SIMD y se pintan con un solo BillboardSet
+/// </summary>
+class ParticleSystemComponent : public Component
+{
+private:
+	Ogre::SceneNode* mNode_ = nullptr;
+	Ogre::BillboardSet* bbSet_ = nullptr;
+	Transform* tr_ = nullptr;
+
+	// Particulas vivas en [0, count_), en espacio del mundo
+	std::vector<float> px_, py_, pz_;
+	std::vector<float> vx_, vy_, vz_;
+	std::vector<float> age_, life_;
+	size_t count_ = 0;
+	size_t maxParticles_ = 100;
+
+	// Emision
+	bool emitting_ = true;
+	bool loop_ = true;
+	float rate_ = 10.0f;		// particulas por segundo
+	float emitAccum_ = 0.0f;
+	int burst_ = 0;				// particulas que salen de golpe al empezar
+	float duration_ = 0.0f;		// 0 = sin limite
+	float elapsed_ = 0.0f;
+
+	float minLife_ = 1.0f, maxLife_ = 1.0f;
+	float minSpeed_ = 1.0f, maxSpeed_ = 1.0f;
+	float spread_ = 0.0f;		// semiangulo del cono en radianes
+	float drag_ = 0.0f;
+	float size_ = 1.0f;
+	bool fade_ = true;
+	Vector3 direction_ = Vector3(0, 1, 0);
+	Vector3 gravity_;
+	float colour_[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+	std::mt19937 rng_;
+
+	float random(float min, float max);
+	Vector3 randomDirection();
+
+	// Arrays y pool de billboards a maxParticles_, sin particulas vivas
+	void allocate();
+	void emit(size_t n);
+	void simulate(float deltaTime);
+	void removeDead();
+	void render();
+public:
+	ParticleSystemComponent();
+	virtual ~ParticleSystemComponent();
+
+	virtual void init() override;
+	virtual void load(const nlohmann::json& params) override;
+	virtual void setUp() override;
+	virtual void update(float deltaTime) override;
+	virtual void setActive(bool act) override;
+
+	// Empieza a emitir desde cero (incluye la rafaga inicial)
+	void play();
+	// Deja de emitir, las particulas vivas terminan su vida
+	void stop();
+	// Emite n particulas de golpe
+	void burst(int n);
+	// Borra todas las particulas vivas
+	void clear();
+
+	bool isEmitting() const;
+	// Si sigue emitiendo o quedan particulas vivas
+	bool isAlive() const;
+	int getParticleCount() const;
+};
+
+#endif
@@ -5,6 +5,7 @@
 
 #include <Component.h>
 #include <string>
+#include "ResourceCache.h"
 
 class Vector3;
 namespace Ogre {
@@ -24,6 +25,8 @@ class PlaneComponent :
 private:
     Ogre::SceneNode* mNode_ = nullptr;
     Ogre::Entity* ent_ = nullptr;
+    //Malla, material y texturas del plano en el cache de recursos
+    ResourceCache::Handles resources_;
 public:
     PlaneComponent();
     virtual ~PlaneComponent();
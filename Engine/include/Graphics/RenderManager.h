@@ -4,26 +4,45 @@
 #define _GRAPHICS_RENDMAN_H
 
 #include "Manager.h"
+#include "ComponentTypes.h"
+#include <vector>
 
 namespace Ogre {
 	class Root;
 	class Camera;
 }
 
+class AnimatorComponent;
+
 class RenderManager : public Manager
 {
 private:
-	static RenderManager* instance_;
 
 	Ogre::Root* ogreRoot_;
+	//Animadores que se avanzan juntos en updateAnimations
+	std::vector<AnimatorComponent*> animators_;
+	bool parallelAnimation_ = true;
+
 	RenderManager();
 	virtual ~RenderManager();
+
+	/// <summary>
+	/// Avanza todas las animaciones en una pasada, en paralelo si hay
+	/// suficientes. Cada animador decide por distancia y visibilidad si le
+	/// toca este frame
+	/// </summary>
+	void updateAnimations(float deltaTime);
 public:
+	//A partir de cuantos animadores se reparten entre hilos
+	static const size_t PARALLEL_ANIMATORS = 64;
+
 	enum class RenderCmpId : int {
 		Mesh = 0,
 		Camera,
 		Light,
 		Plane,
+		ParticleSystem,
+		Animator,
 
 		LastRenderCmpId
 	};
@@ -34,6 +53,24 @@ public:
 	static void destroy();
 	virtual void start();
 	virtual void update(float deltaTime);
+
+	void addAnimator(AnimatorComponent* animator);
+	void removeAnimator(AnimatorComponent* animator);
+	void setParallelAnimation(bool parallel);
 };
 
+
+class MeshComponent;
+class Camera;
+class LightComponent;
+class PlaneComponent;
+class ParticleSystemComponent;
+
+COMPONENT_TYPE(MeshComponent, ManID::Render, RenderManager::RenderCmpId::Mesh)
+COMPONENT_TYPE(Camera, ManID::Render, RenderManager::RenderCmpId::Camera)
+COMPONENT_TYPE(LightComponent, ManID::Render, RenderManager::RenderCmpId::Light)
+COMPONENT_TYPE(PlaneComponent, ManID::Render, RenderManager::RenderCmpId::Plane)
+COMPONENT_TYPE(ParticleSystemComponent, ManID::Render, RenderManager::RenderCmpId::ParticleSystem)
+COMPONENT_TYPE(AnimatorComponent, ManID::Render, RenderManager::RenderCmpId::Animator)
+
 #endif
\ No newline at end of file
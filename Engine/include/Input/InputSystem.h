@@ -37,7 +37,6 @@ public:
 private:
 	InputSystem();
 	virtual ~InputSystem();
-	static InputSystem* instance_;
 	
 	// if in this frame there has been an event
 	int clickEvent_ = 0; // 1 Left, 2 Right
@@ -24,12 +24,22 @@ class MeshComponent;
 class Camera;
 class LightComponent;
 class PlaneComponent;
+class ParticleSystemComponent;
+class AnimatorComponent;
+class TriggerComponent;
 class Transform;
 class OgreContext;
 class Scene;
 class UIButton;
 class UIImage;
 class UILabel;
+class UISlider;
+class AudioEmitter;
+class FramePacer;
+class NavigationManager;
+class CrowdAgent;
+class NetworkManager;
+class AudioSystem;
 class Scene;
 
 class LUAManager : public Manager {
@@ -37,7 +47,6 @@ private:
 	lua_State* L;
 	
 	LUAManager();
-	static LUAManager* instance_;
 
 	const std::string SCRIPTS_FILE_PATH = "LuaScripts/";
 	const std::string FILE_EXTENSION = ".lua";
@@ -62,8 +71,11 @@ public:
 	void changeScene(std::string name);
 	InputSystem* getInputManager();
 	RigidBody* getRigidbody(Entity* ent);
+	TriggerComponent* getTrigger(Entity* ent);
 	MeshComponent* getMeshComponent(Entity* ent);
 	PlaneComponent* getPlaneComponent(Entity* ent);
+	ParticleSystemComponent* getParticleSystem(Entity* ent);
+	AnimatorComponent* getAnimator(Entity* ent);
 	LightComponent* getLightComponent(Entity* ent);
 	Camera* getCamera(Entity* ent);
 	Transform* getTransform(Entity* ent);
@@ -77,6 +89,13 @@ public:
 	UIButton* getUIButton(Entity* ent);
 	UILabel* getUILabel(Entity* ent);
 	UIImage* getUIImage(Entity* ent);
+	UISlider* getUISlider(Entity* ent);
+	AudioEmitter* getAudioEmitter(Entity* ent);
+	AudioSystem* getAudio();
+	FramePacer* getFramePacer();
+	NavigationManager* getNavigation();
+	CrowdAgent* getCrowdAgent(Entity* ent);
+	NetworkManager* getNetwork();
 
 	void closeApp();
 
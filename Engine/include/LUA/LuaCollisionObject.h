@@ -14,6 +14,8 @@ public:
 	void onCollisionEnter(Entity* e);
 	void onCollisionStay(Entity* e);
 	void onCollisionExit(Entity* e);
+	void onTriggerEnter(Entity* e);
+	void onTriggerExit(Entity* e);
 private:
 	LuaComponent* _ptr;
 };
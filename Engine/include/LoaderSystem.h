@@ -16,6 +16,12 @@ private:
 	const std::string SCENES_FILE_PATH = "Scenes/";
 	const std::string FILE_EXTENSION = ".json";
 	 
+	// Escenas leidas por adelantado y prefabs ya leidos
+	std::map<std::string, nlohmann::json> preloaded_;
+	std::map<std::string, nlohmann::json> prefabs_;
+
+	nlohmann::json readScene(const std::string& fileName);
+	const nlohmann::json& getPrefab(const std::string& fileName);
 	void loadComponents(const nlohmann::json& comps, Entity* entity);
 	void readParameters(std::string& dump, std::map<std::string, std::string>& params);
 public:
@@ -23,6 +29,16 @@ public:
 	void loadPrefabByName(std::string fileName, Entity* ent);
 	std::vector<std::string> loadScenes(const std::string& fileName);
 	void loadEntities(const std::string& fileName, Scene* scene);
+
+	// Lee la escena (y sus prefabs) sin crear nada, para hacerlo en otro hilo
+	// mientras arranca el resto. loadEntities usa lo ya leido
+	void preloadScene(const std::string& fileName);
+	void preloadSceneSounds(const std::string& fileName);
+	// Scripts de Lua que usa una escena ya leida
+	std::vector<std::string> getLuaComponents(const std::string& fileName);
+	// Grupos de recursos de Ogre que declara la escena en "ResourceGroups".
+	// Devuelve false si la escena no los declara
+	bool getResourceGroups(const std::string& fileName, std::vector<std::string>& groups);
 };
 
 #endif
\ No newline at end of file
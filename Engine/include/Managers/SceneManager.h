@@ -21,16 +21,27 @@ public:
 	void update();
 	void changeScene(const std::string& sceneName);
 	void createStartScene(const std::string& startScene);
+
+	// Para el arranque en paralelo: lee la lista de escenas y la primera
+	// sin crearla, createStartScene aprovecha lo leido
+	void preloadStartScene(const std::string& startScene);
+	void preloadStartSceneSounds();
+	std::vector<std::string> getStartSceneLuaComponents();
+	// Deja preparandose en segundo plano los recursos de Ogre de la primera escena
+	void prefetchStartSceneResources();
 private:
 	SceneManager();	
 	~SceneManager();
 
 	void loadScene(const std::string& sceneName);
 	void cleanupScene();
+	// Grupos de recursos de Ogre de una escena, todos si no declara ninguno
+	std::vector<std::string> getSceneResourceGroups(const std::string& sceneName);
 
-	static SceneManager* instance_;
-	static Scene* currentScene_;
+	Scene* currentScene_ = nullptr;
 	std::vector<std::string> sceneFiles_;
+	// Grupos que tiene pedidos la escena actual
+	std::vector<std::string> resourceGroups_;
 	LoaderSystem* loader_;
 	bool change_;
 	std::string nextScene_;
@@ -0,0 +1,61 @@
+#pragma once
+
+#ifndef _NAVIGATION_CROWD_H
+#define _NAVIGATION_CROWD_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class CrowdAgent;
+class NavMesh;
+
+/// <summary>
+/// Simulacion de grupos de agentes sobre el plano XZ. Los datos de todos los
+/// agentes estan en arrays SoA; los vecinos se buscan con un hash espacial
+/// uniforme y las fuerzas de separacion y alineacion se calculan con SIMD.
+/// Los CrowdAgent leen su posicion antes y escriben el resultado despues
+/// </summary>
+class Crowd
+{
+public:
+	// Estado por agente, indexado por el hueco del CrowdAgent
+	std::vector<float> px, py, pz;
+	std::vector<float> vx, vz;
+	std::vector<float> desiredX, desiredZ;
+	std::vector<float> radius, maxSpeed, maxForce, neighbourRadius;
+	std::vector<float> separationWeight, alignmentWeight, avoidanceWeight;
+	std::vector<CrowdAgent*> owners;
+
+	size_t addAgent(CrowdAgent* agent);
+	void removeAgent(size_t slot);
+	size_t size() const { return owners.size(); }
+
+	// mesh puede ser nullptr, entonces no se evitan obstaculos
+	void update(float deltaTime, const NavMesh* mesh);
+
+private:
+	// Agentes activos y con setUp; los demas ni se mueven ni cuentan como vecinos
+	std::vector<uint8_t> live_;
+
+	// Fuerzas del frame
+	std::vector<float> sepX_, sepZ_, aliX_, aliZ_, avoidX_, avoidZ_;
+
+	// Hash espacial: los agentes ordenados por celda (counting sort)
+	std::vector<uint32_t> cellStart_, sorted_, agentKey_;
+	uint32_t hashMask_ = 0;
+	float cellSize_ = 1.0f;
+
+	// Vecinos candidatos del agente actual, rellenados a multiplo de 4
+	std::vector<float> candX_, candZ_, candVX_, candVZ_;
+
+	std::vector<std::vector<float>*> arrays();
+	void cellOf(float x, float z, int& cx, int& cz) const;
+	uint32_t hashCell(int cx, int cz) const;
+	void buildHash();
+	void neighbourForces(size_t i);
+	void avoidObstacles(size_t i, const NavMesh* mesh);
+	void integrate(float deltaTime);
+};
+
+#endif
@@ -0,0 +1,62 @@
+#pragma once
+
+#ifndef _NAVIGATION_CROWDAGENT_H
+#define _NAVIGATION_CROWDAGENT_H
+
+#include "Component.h"
+#include "Vector3.h"
+#include <vector>
+
+class Transform;
+class RigidBody;
+class Crowd;
+
+//Agente de un grupo. Sus datos de simulacion estan en el Crowd del
+//NavigationManager, aqui solo se guarda el hueco y el camino que sigue
+class CrowdAgent : public Component
+{
+	friend class Crowd;
+private:
+	size_t slot_;
+	Transform* tr_ = nullptr;
+	RigidBody* rb_ = nullptr;
+
+	// Camino hacia el objetivo de moveTo
+	bool moving_ = false;
+	Vector3 target_;
+	int pathId_ = -1;
+	std::vector<Vector3> path_;
+	size_t waypoint_ = 0;
+	float arriveRadius_ = 0.5f;
+
+	// Velocidad fijada a mano con setDesiredVelocity
+	bool manual_ = false;
+	Vector3 manualVel_;
+
+	void pollPath();
+	Vector3 steerToPath(const Vector3& pos, float speed);
+	// Lee el estado de la entidad y calcula la velocidad deseada
+	void prepare(Crowd& crowd);
+	// Escribe la velocidad resultante en la entidad
+	void apply(Crowd& crowd, float deltaTime);
+public:
+	CrowdAgent();
+	virtual ~CrowdAgent();
+
+	virtual void init() override;
+	virtual void load(const nlohmann::json& params) override;
+	virtual void setUp() override;
+	virtual void update(float deltaTime) override;
+
+	// Va hasta pos siguiendo la malla de navegacion (si la hay)
+	void moveTo(const Vector3& pos);
+	void setDesiredVelocity(const Vector3& vel);
+	void stop();
+	bool isMoving() const;
+
+	Vector3 getVelocity() const;
+	void setMaxSpeed(float speed);
+	float getMaxSpeed() const;
+};
+
+#endif
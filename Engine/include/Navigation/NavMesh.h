@@ -0,0 +1,66 @@
+#pragma once
+
+#ifndef _NAVIGATION_NAVMESH_H
+#define _NAVIGATION_NAVMESH_H
+
+#include "Vector3.h"
+#include <vector>
+#include <cstdint>
+
+//Parametros del horneado
+struct NavMeshConfig {
+	float cellSize = 0.5f;		// lado de cada celda en XZ
+	float agentRadius = 0.5f;	// se erosionan los bordes con este radio
+	float agentHeight = 2.0f;	// hueco minimo sobre el suelo
+	float maxClimb = 0.5f;		// desnivel maximo entre celdas vecinas
+	bool autoBounds = true;		// si no, se usan boundsMin/boundsMax
+	Vector3 boundsMin, boundsMax;
+};
+
+//Geometria de entrada: cajas alineadas a los ejes en coordenadas del mundo
+struct NavBox {
+	Vector3 min, max;
+};
+
+/// <summary>
+/// Malla de navegacion en forma de heightfield 2.5D, al estilo de Recast:
+/// se voxeliza la geometria estatica en columnas, cada celda guarda la altura
+/// del suelo transitable y se erosiona por el radio del agente. Los caminos
+/// se buscan con A* sobre la rejilla y se suavizan por linea de vision.
+/// Una vez construida es de solo lectura y se puede consultar desde varios hilos
+/// </summary>
+class NavMesh
+{
+public:
+	void build(const NavMeshConfig& config, const std::vector<NavBox>& geometry);
+
+	// Devuelve false si no hay camino. out empieza en from y acaba en to
+	bool findPath(const Vector3& from, const Vector3& to, std::vector<Vector3>& out) const;
+	bool isWalkable(const Vector3& pos) const;
+	// Punto transitable mas cercano (busca hasta maxCells celdas alrededor)
+	bool closestWalkable(const Vector3& pos, Vector3& out, int maxCells = 4) const;
+
+	int getWidth() const;
+	int getDepth() const;
+	int getWalkableCount() const;
+	const NavMeshConfig& getConfig() const;
+
+private:
+	NavMeshConfig config_;
+	int width_ = 0, depth_ = 0;
+	Vector3 origin_;
+	std::vector<float> height_;
+	std::vector<uint8_t> walkable_;
+
+	int index(int x, int z) const { return z * width_ + x; }
+	bool inside(int x, int z) const { return x >= 0 && z >= 0 && x < width_ && z < depth_; }
+	bool toCell(const Vector3& pos, int& x, int& z) const;
+	Vector3 toWorld(int x, int z) const;
+	// Si un agente puede pasar de la celda a a la b (vecinas)
+	bool canStep(int a, int b) const;
+	bool snapToCell(const Vector3& pos, int& x, int& z, int maxCells) const;
+	bool lineOfSight(int ax, int az, int bx, int bz) const;
+	void erode();
+};
+
+#endif
@@ -0,0 +1,30 @@
+#pragma once
+
+#ifndef _NAVIGATION_NAVMESHCOMP_H
+#define _NAVIGATION_NAVMESHCOMP_H
+
+#include "Component.h"
+#include "NavMesh.h"
+
+//Configuracion de la malla de navegacion de la escena. Basta con una entidad
+//que lo tenga para que el NavigationManager hornee la malla al empezar
+class NavMeshComponent : public Component
+{
+private:
+	NavMeshConfig config_;
+	bool includeMeshes_ = true;
+	bool forceRebake_ = false;
+
+	friend class NavigationManager;
+public:
+	NavMeshComponent();
+	virtual ~NavMeshComponent();
+
+	virtual void init() override;
+	virtual void load(const nlohmann::json& params) override;
+	virtual void update(float deltaTime) override;
+
+	const NavMeshConfig& getConfig() const;
+};
+
+#endif
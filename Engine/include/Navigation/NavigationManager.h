@@ -0,0 +1,107 @@
+#pragma once
+
+#ifndef _NAVIGATION_NAVMAN_H
+#define _NAVIGATION_NAVMAN_H
+
+#include "Manager.h"
+#include "ComponentTypes.h"
+#include "NavMesh.h"
+#include "Crowd.h"
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+class NavMeshComponent;
+
+/// <summary>
+/// Hornea la malla de navegacion de la escena a partir de la geometria estatica
+/// (rigidbodies estaticos y meshes sin fisica) y resuelve caminos en hilos
+/// trabajadores. Las peticiones devuelven un id que se consulta mas tarde,
+/// asi ni Lua ni el hilo principal esperan al A*
+/// </summary>
+class NavigationManager : public Manager
+{
+public:
+	enum class NavCmpId : int {
+		NavMesh = 0,
+		CrowdAgent,
+		LastNavCmpId
+	};
+
+	enum class PathStatus : int {
+		Invalid = 0,	// id desconocido o ya liberado
+		Pending,
+		Ready,
+		Failed
+	};
+
+	static NavigationManager* getInstance();
+	static bool setUpInstance();
+	static void clean();
+	static void destroy();
+
+	virtual void start() override;
+	virtual void update(float deltaTime) override;
+
+	// Hornea otra vez la malla de la escena actual y la guarda
+	void rebake();
+	bool hasNavMesh() const;
+	bool isWalkable(const Vector3& pos) const;
+
+	// Peticion asincrona, devuelve el id con el que consultarla (-1 si no hay malla)
+	int requestPath(const Vector3& from, const Vector3& to);
+	PathStatus getPathStatus(int id);
+	// Copia el camino si esta listo
+	bool getPath(int id, std::vector<Vector3>& out);
+	// Libera la peticion, si aun no se ha resuelto se descarta
+	void releasePath(int id);
+
+	// Version sincrona para usos puntuales desde C++
+	bool findPath(const Vector3& from, const Vector3& to, std::vector<Vector3>& out) const;
+
+	Crowd& getCrowd();
+
+private:
+
+	struct PathRequest {
+		Vector3 from, to;
+		std::shared_ptr<const NavMesh> mesh;
+		PathStatus status = PathStatus::Pending;
+		std::vector<Vector3> path;
+	};
+
+	// Mallas horneadas por nombre de escena
+	std::map<std::string, std::shared_ptr<const NavMesh>> cache_;
+	std::shared_ptr<const NavMesh> current_;
+	NavMeshComponent* settings_ = nullptr;
+
+	Crowd crowd_;
+
+	// Peticiones y cola de trabajo, protegidas por mtx_
+	std::map<int, PathRequest> requests_;
+	std::deque<int> queue_;
+	int nextId_ = 0;
+	std::mutex mtx_;
+	std::condition_variable cv_;
+	std::vector<std::thread> workers_;
+	bool quit_ = false;
+	// Hilos de busqueda de todos los contextos, se reparten los nucleos
+	static std::atomic<unsigned int> liveWorkers_;
+
+	NavigationManager();
+	virtual ~NavigationManager();
+
+	void workerLoop();
+	std::shared_ptr<const NavMesh> bake(const NavMeshConfig& config, bool includeMeshes);
+	void gatherGeometry(std::vector<NavBox>& geometry, bool includeMeshes);
+};
+
+class CrowdAgent;
+
+COMPONENT_TYPE(NavMeshComponent, ManID::Navigation, NavigationManager::NavCmpId::NavMesh)
+COMPONENT_TYPE(CrowdAgent, ManID::Navigation, NavigationManager::NavCmpId::CrowdAgent)
+
+#endif
@@ -0,0 +1,113 @@
+#pragma once
+
+#ifndef _NETWORK_BITSTREAM_H
+#define _NETWORK_BITSTREAM_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+
+//Escritura y lectura bit a bit para los paquetes de red. Todo es inline,
+//se usa en el bucle de serializacion de cada entidad
+
+// Pasa un float en [min, max] a un entero de bits bits y al reves
+inline uint32_t quantize(float v, float min, float max, int bits)
+{
+	const uint32_t steps = (1u << bits) - 1;
+	float t = (std::min(std::max(v, min), max) - min) / (max - min);
+	return (uint32_t)std::lround(t * steps);
+}
+
+inline float dequantize(uint32_t q, float min, float max, int bits)
+{
+	const uint32_t steps = (1u << bits) - 1;
+	return min + (max - min) * ((float)q / steps);
+}
+
+class BitWriter
+{
+private:
+	std::vector<uint8_t> buffer_;
+	size_t bitPos_ = 0;
+public:
+	void writeBits(uint32_t value, int bits)
+	{
+		for (int i = 0; i < bits; i++) {
+			if ((bitPos_ & 7) == 0) buffer_.push_back(0);
+			if (value & (1u << i)) buffer_.back() |= (uint8_t)(1u << (bitPos_ & 7));
+			bitPos_++;
+		}
+	}
+	void writeBool(bool b) { writeBits(b ? 1 : 0, 1); }
+	// Enteros pequenyos en menos bytes: 7 bits por grupo
+	void writeVarint(uint32_t v)
+	{
+		do {
+			uint32_t group = v & 0x7f;
+			v >>= 7;
+			writeBits(group | (v ? 0x80 : 0), 8);
+		} while (v);
+	}
+	void writeFloat(float f)
+	{
+		uint32_t u;
+		std::memcpy(&u, &f, sizeof(u));
+		writeBits(u, 32);
+	}
+
+	const std::vector<uint8_t>& data() const { return buffer_; }
+	size_t sizeBytes() const { return buffer_.size(); }
+	size_t sizeBits() const { return bitPos_; }
+	void clear() { buffer_.clear(); bitPos_ = 0; }
+};
+
+class BitReader
+{
+private:
+	const uint8_t* data_;
+	size_t sizeBits_;
+	size_t bitPos_ = 0;
+	bool overflow_ = false;
+public:
+	BitReader(const uint8_t* data, size_t sizeBytes) : data_(data), sizeBits_(sizeBytes * 8) {}
+
+	uint32_t readBits(int bits)
+	{
+		if (bitPos_ + bits > sizeBits_) {
+			overflow_ = true;
+			return 0;
+		}
+		uint32_t v = 0;
+		for (int i = 0; i < bits; i++) {
+			if (data_[bitPos_ >> 3] & (1u << (bitPos_ & 7))) v |= 1u << i;
+			bitPos_++;
+		}
+		return v;
+	}
+	bool readBool() { return readBits(1) != 0; }
+	uint32_t readVarint()
+	{
+		uint32_t v = 0;
+		for (int shift = 0; shift < 35; shift += 7) {
+			uint32_t group = readBits(8);
+			v |= (group & 0x7f) << shift;
+			if (!(group & 0x80) || overflow_) break;
+		}
+		return v;
+	}
+	float readFloat()
+	{
+		uint32_t u = readBits(32);
+		float f;
+		std::memcpy(&f, &u, sizeof(f));
+		return f;
+	}
+
+	// Paquete truncado o corrupto
+	bool overflow() const { return overflow_; }
+};
+
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#ifndef _NETWORK_NETREPLICATED_H
+#define _NETWORK_NETREPLICATED_H
+
+#include "Component.h"
+#include "Snapshot.h"
+#include <string>
+#include <vector>
+
+class Transform;
+class RigidBody;
+
+//Marca la entidad para replicarla. El id de red sale del nombre de la
+//entidad, asi servidor y cliente lo conocen sin negociarlo
+class NetReplicated : public Component
+{
+private:
+	uint32_t netId_ = 0;
+	Transform* tr_ = nullptr;
+	RigidBody* rb_ = nullptr;
+
+	bool velocity_ = true;
+	bool alwaysRelevant_ = false;
+	bool focus_ = false;
+	// Campos numericos del self de un componente de Lua
+	std::string luaClass_;
+	std::vector<std::string> luaFields_;
+public:
+	NetReplicated();
+	virtual ~NetReplicated();
+
+	virtual void init() override;
+	virtual void load(const nlohmann::json& params) override;
+	virtual void setUp() override;
+	virtual void update(float deltaTime) override;
+
+	uint32_t getNetId() const;
+	// Se manda a todos los clientes sin mirar la distancia
+	bool isAlwaysRelevant() const;
+	// Entidad del jugador local, su posicion es el foco del cliente
+	bool isFocus() const;
+	Vector3 getPos() const;
+
+	void capture(EntityState& state, const QuantizationConfig& q) const;
+	void restore(const EntityState& state, const QuantizationConfig& q);
+};
+
+#endif
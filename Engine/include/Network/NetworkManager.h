@@ -0,0 +1,93 @@
+#pragma once
+
+#ifndef _NETWORK_NETMAN_H
+#define _NETWORK_NETMAN_H
+
+#include "Manager.h"
+#include "ComponentTypes.h"
+#include "Replication.h"
+#include <memory>
+
+class NetReplicated;
+
+/// <summary>
+/// Replica el estado de la escena entre un servidor y sus clientes. El servidor
+/// recoge las entidades con NetReplicated a la frecuencia de tick y manda a
+/// cada cliente la diferencia con lo ultimo que confirmo. El modo Loopback
+/// monta servidor y cliente en el mismo proceso sobre un enlace simulado
+/// (latencia y perdidas) para medir ancho de banda sin red
+/// </summary>
+class NetworkManager : public Manager
+{
+public:
+	enum class NetCmpId : int {
+		Replicated = 0,
+		LastNetCmpId
+	};
+
+	enum class Mode : int {
+		Offline = 0,
+		Server,
+		Client,
+		Loopback
+	};
+
+	static NetworkManager* getInstance();
+	static bool setUpInstance();
+	static void clean();
+	static void destroy();
+
+	virtual void start() override;
+	virtual void update(float deltaTime) override;
+
+	bool startServer(uint16_t port);
+	bool connect(const std::string& host, uint16_t port);
+	void startLoopback(float latencyMs, float jitterMs, float lossPercent);
+	void stop();
+
+	Mode getMode() const;
+	bool isConnected() const;
+	void setTickRate(float hz);
+	void setInterestRadius(float radius);
+
+	// Estadisticas del servidor (o del cliente si solo se es cliente)
+	const ReplicationStats& getStats() const;
+	// Lado cliente del modo Loopback
+	const ReplicationStats& getLoopbackClientStats() const;
+
+	void registerReplicated(NetReplicated* rep);
+	void unregisterReplicated(NetReplicated* rep);
+
+private:
+
+	Mode mode_ = Mode::Offline;
+	QuantizationConfig q_;
+	float tickRate_ = 20.0f;
+	float tickTimer_ = 0.0f;
+	float interestRadius_ = 100.0f;
+
+	std::unique_ptr<Transport> serverTransport_;
+	std::unique_ptr<Transport> clientTransport_;
+	std::unique_ptr<ReplicationServer> server_;
+	std::unique_ptr<ReplicationClient> client_;
+	ReplicationStats stats_;
+	ReplicationStats emptyStats_;
+
+	// Entidades replicadas por id de red, ordenadas como en los snapshots
+	std::map<uint32_t, NetReplicated*> byId_;
+	uint32_t applied_ = 0;
+
+	// Buffers reutilizados en cada tick
+	Snapshot world_;
+	std::vector<bool> always_;
+
+	NetworkManager();
+	virtual ~NetworkManager();
+
+	void serverTick(float deltaTime);
+	void applySnapshot(const Snapshot& snap);
+};
+
+COMPONENT_TYPE(NetReplicated, ManID::Network, NetworkManager::NetCmpId::Replicated)
+
+#endif
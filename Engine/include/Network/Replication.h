@@ -0,0 +1,108 @@
+#pragma once
+
+#ifndef _NETWORK_REPLICATION_H
+#define _NETWORK_REPLICATION_H
+
+#include "Snapshot.h"
+#include "Transport.h"
+#include <map>
+#include <deque>
+
+enum class PacketType : uint8_t {
+	Hello = 1,		// cliente -> servidor, pide entrar
+	Snapshot,		// servidor -> cliente
+	Ack,			// cliente -> servidor, ultimo snapshot recibido y foco
+	Bye
+};
+
+struct ReplicationStats {
+	float bytesPerSecond = 0.0f;	// media por cliente (servidor) o recibidos (cliente)
+	float avgSnapshotBytes = 0.0f;
+	float serializeMs = 0.0f;		// coste del ultimo tick
+	int clients = 0;
+	int entities = 0;
+	uint32_t snapshots = 0;
+	uint32_t snapshotsLost = 0;		// huecos en la secuencia (cliente)
+};
+
+/// <summary>
+/// Manda a cada cliente las entidades cercanas a su foco como diferencia
+/// respecto al ultimo snapshot que ha confirmado. Si el confirmado ya no
+/// esta en el historial se manda completo
+/// </summary>
+class ReplicationServer
+{
+public:
+	ReplicationServer(Transport* transport, const QuantizationConfig& q);
+
+	void setInterestRadius(float radius);
+	void handlePacket(const Packet& packet);
+	// world ordenado por id; las marcadas en always se mandan a todos
+	void tick(const Snapshot& world, const std::vector<bool>& always, float deltaTime);
+
+	const ReplicationStats& getStats() const;
+	int getClientCount() const;
+
+private:
+	static const size_t HISTORY = 32;
+	static const float TIMEOUT;
+
+	struct Client {
+		uint32_t sequence = 0;
+		uint32_t lastAck = 0;		// 0 = nada confirmado
+		bool hasFocus = false;
+		Vector3 focus;
+		std::deque<Snapshot> history;
+		size_t bytesWindow = 0;
+		float bytesPerSecond = 0.0f;
+		float silence = 0.0f;		// segundos sin saber de el
+	};
+
+	Transport* transport_;
+	QuantizationConfig q_;
+	float interestRadius_ = 100.0f;
+	std::map<int, Client> clients_;
+	float windowTime_ = 0.0f;
+	ReplicationStats stats_;
+
+	const Snapshot* findBaseline(const Client& c) const;
+};
+
+/// <summary>
+/// Reconstruye los snapshots del servidor y los confirma
+/// </summary>
+class ReplicationClient
+{
+public:
+	ReplicationClient(Transport* transport, int serverPeer, const QuantizationConfig& q);
+
+	// Hasta recibir el primer snapshot se repite el Hello
+	void update(float deltaTime);
+	// Devuelve true si el paquete trae un snapshot nuevo
+	bool handlePacket(const Packet& packet);
+	void setFocus(const Vector3& focus);
+	void disconnect();
+
+	const Snapshot* getLatest() const;
+	bool isConnected() const;
+	const ReplicationStats& getStats() const;
+
+private:
+	static const size_t HISTORY = 32;
+
+	Transport* transport_;
+	int serverPeer_;
+	QuantizationConfig q_;
+	std::deque<Snapshot> history_;
+	bool hasFocus_ = false;
+	Vector3 focus_;
+	float helloTimer_ = 0.0f;
+	size_t bytesWindow_ = 0;
+	float windowTime_ = 0.0f;
+	ReplicationStats stats_;
+
+	void sendAck(uint32_t sequence);
+	const Snapshot* find(uint32_t sequence) const;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#pragma once
+
+#ifndef _NETWORK_SNAPSHOT_H
+#define _NETWORK_SNAPSHOT_H
+
+#include "BitStream.h"
+#include "Vector3.h"
+#include <vector>
+#include <utility>
+
+//Rangos y precision de la cuantizacion, iguales en servidor y cliente
+struct QuantizationConfig {
+	float worldMin = -512.0f, worldMax = 512.0f;
+	int posBits = 20;		// ~1mm con el rango por defecto
+	int rotBits = 12;		// grados, ~0.09
+	float velMax = 64.0f;
+	int velBits = 14;
+	int deltaBits = 10;		// cambios pequenyos se mandan como diferencia
+};
+
+//Estado cuantizado de una entidad replicada
+struct EntityState {
+	static const int MAX_LUA_FIELDS = 4;
+
+	uint32_t pos[3] = { 0, 0, 0 };
+	uint32_t rot[3] = { 0, 0, 0 };
+	uint32_t vel[3] = { 0, 0, 0 };
+	float lua[MAX_LUA_FIELDS] = { 0, 0, 0, 0 };
+	uint8_t luaCount = 0;
+	bool hasVel = false;
+
+	void setPos(const Vector3& p, const QuantizationConfig& q);
+	void setRot(const Vector3& r, const QuantizationConfig& q);
+	void setVel(const Vector3& v, const QuantizationConfig& q);
+	Vector3 getPos(const QuantizationConfig& q) const;
+	Vector3 getRot(const QuantizationConfig& q) const;
+	Vector3 getVel(const QuantizationConfig& q) const;
+};
+
+//Estado de las entidades visibles para un cliente en un tick, ordenado por id
+struct Snapshot {
+	uint32_t sequence = 0;
+	std::vector<std::pair<uint32_t, EntityState>> entities;
+
+	const EntityState* find(uint32_t netId) const;
+};
+
+// Codifica snap como diferencia respecto a base (nullptr = completo): solo van
+// las entidades y campos que han cambiado y la lista de las que desaparecen
+void writeSnapshot(BitWriter& w, const Snapshot& snap, const Snapshot* base, const QuantizationConfig& q);
+// Reconstruye el snapshot a partir de base. false si el paquete es invalido
+bool readSnapshot(BitReader& r, Snapshot& out, const Snapshot* base, const QuantizationConfig& q);
+
+#endif
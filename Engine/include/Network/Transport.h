@@ -0,0 +1,89 @@
+#pragma once
+
+#ifndef _NETWORK_TRANSPORT_H
+#define _NETWORK_TRANSPORT_H
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <string>
+#include <memory>
+#include <random>
+#include <chrono>
+#include <cstdint>
+
+struct Packet {
+	int peer = -1;
+	std::vector<uint8_t> data;
+};
+
+//Envio de datagramas a pares identificados por un entero
+class Transport
+{
+public:
+	virtual ~Transport() {}
+	virtual bool send(int peer, const std::vector<uint8_t>& data) = 0;
+	// Devuelve false cuando no quedan paquetes
+	virtual bool receive(Packet& out) = 0;
+};
+
+//UDP no bloqueante. El servidor descubre a los pares al recibir de ellos
+class UdpTransport : public Transport
+{
+private:
+	intptr_t socket_ = -1;
+	// direccion (ip:puerto empaquetado) <-> id de par
+	std::map<uint64_t, int> peerIds_;
+	std::vector<uint64_t> peerAddrs_;
+	std::vector<uint8_t> recvBuffer_;
+
+	int peerFor(uint64_t addr);
+public:
+	UdpTransport();
+	virtual ~UdpTransport();
+
+	// port 0 = cualquiera (clientes)
+	bool open(uint16_t port);
+	void close();
+	// Registra un par remoto, devuelve su id
+	int addPeer(const std::string& host, uint16_t port);
+
+	virtual bool send(int peer, const std::vector<uint8_t>& data) override;
+	virtual bool receive(Packet& out) override;
+};
+
+//Condiciones simuladas del enlace local
+struct LinkConditions {
+	float latencyMs = 0.0f;
+	float jitterMs = 0.0f;
+	float lossPercent = 0.0f;
+};
+
+//Par de extremos en memoria, para probar la replicacion sin red. Cada
+//extremo ve al otro como el par 0
+class LoopbackTransport : public Transport
+{
+private:
+	using Clock = std::chrono::steady_clock;
+	struct InFlight {
+		Clock::time_point deliverAt;
+		std::vector<uint8_t> data;
+	};
+	struct Link {
+		LinkConditions conditions;
+		std::deque<InFlight> queues[2];
+		std::mt19937 rng{ 1234 };
+	};
+
+	std::shared_ptr<Link> link_;
+	int side_;
+
+	LoopbackTransport(std::shared_ptr<Link> link, int side);
+public:
+	static void createPair(const LinkConditions& conditions, std::unique_ptr<LoopbackTransport>& a, std::unique_ptr<LoopbackTransport>& b);
+
+	virtual bool send(int peer, const std::vector<uint8_t>& data) override;
+	virtual bool receive(Packet& out) override;
+};
+
+#endif
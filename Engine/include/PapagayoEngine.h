@@ -6,21 +6,16 @@
 #include <map>
 #include <vector>
 #include <string>
+#include "FramePacer.h"
+#include "EngineContext.h"
 
 #ifdef _DEBUG
 #include "checkML.h"
 #endif
 
 class Manager;
-class InputSystem;
-class UIManager;
-class PhysicsManager;
-class RenderManager;
-class SceneManager;
-class CommonManager;
-class LUAManager;
 class OgreContext;
-class AudioSystem;
+struct SDL_WindowEvent;
 
 class PapagayoEngine {
 public:
@@ -69,32 +64,24 @@ public:
 
 	const std::map<std::string, Manager*>& getManagers();
 	const std::map<std::string, Manager*>& getManagers() const;
+
+	//Control de FPS y estadisticas de frame
+	FramePacer* getFramePacer();
+	//Managers de la instancia con ventana
+	EngineContext* getContext();
 	
 private:
-	uint32_t startTime = 0;
-	uint32_t lag = 0;
-	uint32_t frame_rate = 1000 / 60;
-	float sToCallFixedUpdate = 0.15;
-	
-	InputSystem* input;
-	UIManager* gui;
-	PhysicsManager* phys;
-	RenderManager* render;
-	SceneManager* mSM;
-	CommonManager* common;
-	LUAManager* lua;
+	FramePacer pacer_;
 	OgreContext* ogre;
-	AudioSystem* audio;
 
 	static PapagayoEngine* instance_;
 	std::string appName_;
-	std::map<std::string, Manager*> manRegistry_;
-	bool running_ = true;
+	EngineContext context_;
 
 	PapagayoEngine(const std::string& appName);
 	virtual ~PapagayoEngine();
 	void update(float delta);
-	void fixedUpdate(float delta);
+	void handleWindowEvent(const SDL_WindowEvent& e);
 };
 
 #endif
\ No newline at end of file
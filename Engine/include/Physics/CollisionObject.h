@@ -13,6 +13,9 @@ public:
 	virtual void onCollisionEnter(Entity* other);
 	virtual void onCollisionExit(Entity* other);
 	virtual void onCollisionStay(Entity* other);
+	// Callbacks de TriggerComponent, other entra o sale de la zona
+	virtual void onTriggerEnter(Entity* other);
+	virtual void onTriggerExit(Entity* other);
 
 	void setEntity(Entity* ent);
 	Entity* getEntity();
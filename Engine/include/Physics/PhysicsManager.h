@@ -4,7 +4,10 @@
 #define _PHYSICS_PHYSICSMAN_H
 
 #include <vector>
+#include <json.hpp>
 #include "Manager.h"
+#include "ComponentTypes.h"
+#include "PhysicsMemory.h"
 
 class btDefaultCollisionConfiguration;
 class btCollisionDispatcher;
@@ -16,13 +19,15 @@ class OgreDebugDrawer;
 class Vector3;
 class CollisionObject;
 class btCollisionObject;
+class btCollisionShape;
+class btGhostPairCallback;
+class TriggerComponent;
 
 class PhysicsManager : public Manager
 {
 private:
-	static PhysicsManager* instance_;
 
-	//Configuracion sobre la gestion de colisiones con bullet, nosotros usaremos la configuracion por defecto
+	//Configuracion sobre la gestion de colisiones con bullet, con los pools de PhysicsMemory
 	btDefaultCollisionConfiguration* collConfig = nullptr;
 
 	//Variable de bullet que hace de "pasador" de colisiones
@@ -37,15 +42,28 @@ private:
 	//Variable de bullet a la que se le pasa todas las variables anteriores como configuracion de la fisica
 	btDiscreteDynamicsWorld* dynamicsWorld = nullptr;
 
+	//Mantiene la lista de solapes de los triggers con los pares del broadphase
+	btGhostPairCallback* ghostPairCallback = nullptr;
+
 	//estoy seria para dibujar los colliders en un modo debug, lo queremos?
 	OgreDebugDrawer* mDebugDrawer_ = nullptr;
 
 	std::map<const btCollisionObject*, std::pair<CollisionObject*,  CollisionObject*>> contacts;
 
+	//Triggers en escena, se les pasa el transform y se miran sus solapes en cada paso
+	std::vector<TriggerComponent*> triggers_;
+
+	//Memoria de Bullet usada por este mundo, solo la toca el hilo del contexto
+	PhysicsMemory::Stats memStats_;
+
 	PhysicsManager();
 	virtual ~PhysicsManager();
 
 	void checkCollision();
+	//Avanza el mundo y apunta lo que han usado los pools de colision
+	void stepWorld(float deltaTime);
+	//Entradas y salidas de los triggers en el ultimo paso
+	void checkTriggers();
 
 public:
 
@@ -64,10 +82,19 @@ public:
 
 	btDiscreteDynamicsWorld* getWorld() const;
 
+	PhysicsMemory::Stats& getMemoryStats();
+
 	//Crea el componente Rigidbody a partir de los siguientes parametros:
 	//Posicion, masa e identificador (el cual determina la forma del collider)
 	btRigidBody* createRB(Vector3 pos, float mass, int group = -1, int mask = -1);
 
+	//Forma de colision a partir de { "id": "Box" | "Sphere" | "Cylinder" | "Cone" | "Capsule", ... },
+	//nullptr si no es valida
+	btCollisionShape* createShape(const nlohmann::json& shape);
+
+	void addTrigger(TriggerComponent* trigger);
+	void removeTrigger(TriggerComponent* trigger);
+
 	virtual void addComponent(Entity* ent, int compId);
 	virtual void start();
 	virtual void update(float deltaTime);
@@ -81,8 +108,15 @@ public:
 
 	enum class PhysicsCmpId : int {
 		RigigbodyId = 0,
+		TriggerId,
 		LastPhysicsCmpId
 	};
 };
 
+
+class RigidBody;
+
+COMPONENT_TYPE(RigidBody, ManID::Physics, PhysicsManager::PhysicsCmpId::RigigbodyId)
+COMPONENT_TYPE(TriggerComponent, ManID::Physics, PhysicsManager::PhysicsCmpId::TriggerId)
+
 #endif
\ No newline at end of file
@@ -0,0 +1,141 @@
+#pragma once
+
+#ifndef _PHYSICS_PHYSICSMEMORY_H
+#define _PHYSICS_PHYSICSMEMORY_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstddef>
+#include <json.hpp>
+
+/// <summary>
+/// Memoria de Bullet. Todas sus reservas (btAlignedAlloc) pasan por pools de
+/// bloques por tamanyo, y los pools de manifolds y algoritmos de colision de
+/// btDefaultCollisionConfiguration salen de aqui. Cada hilo coge y devuelve
+/// bloques de su propia cache sin lock; solo al vaciarse o llenarse la cache
+/// se pasa por el pool compartido. Lo usado se apunta por EngineContext y al
+/// cerrar el ultimo mundo se guarda en POOLS_FILE_PATH, asi la siguiente
+/// ejecucion reserva de antemano lo necesario y un paso de la simulacion no
+/// tiene que ir al heap. Es del proceso (Bullet solo tiene un allocator)
+/// </summary>
+class PhysicsMemory
+{
+public:
+	// Tamanyos de bloque; lo que no cabe en el mayor va directo al heap
+	static const int NUM_CLASSES = 8;
+	static const size_t BLOCK_SIZES[NUM_CLASSES];
+
+	// Uso de un contexto. Lo escribe sin lock el hilo que lo tiene enlazado.
+	// Con signo: un contexto puede liberar lo que reservo otro
+	struct Stats {
+		long long bytesInUse = 0;	// pedidos por Bullet
+		long long peakBytes = 0;
+		int blocksInUse[NUM_CLASSES] = {};
+		int peakBlocks[NUM_CLASSES] = {};
+		int largeAllocs = 0;		// mayores que el bloque mas grande
+		int stepHeapHits = 0;		// idas al heap durante un paso
+		int peakManifolds = 0;
+		int peakAlgorithms = 0;
+	};
+
+	// Pool compartido, con el mutex
+	struct PoolStats {
+		size_t reservedBytes = 0;	// de los pools, usados o no
+		int capacity[NUM_CLASSES] = {};
+		int poolGrowths = 0;		// veces que un pool se ha quedado corto
+		int manifoldPool = 0;
+		int algorithmPool = 0;
+		int peakContexts = 0;		// mundos vivos a la vez
+	};
+
+	// { "autoTune": true, "manifoldPool": 4096, "algorithmPool": 4096, "blocks": { "64": 2000, ... } }
+	// Sin autoTune solo se lee, no se reescribe al cerrar
+	static const std::string POOLS_FILE_PATH;
+
+	static PhysicsMemory* getInstance();
+	// Pasa las reservas de Bullet por los pools. Hay que llamarlo antes de
+	// crear nada de Bullet; las siguientes llamadas no hacen nada
+	static void install();
+
+	void loadConfig(const nlohmann::json& config);
+	// Configuracion para la siguiente ejecucion a partir de los picos de los
+	// contextos ya cerrados
+	nlohmann::json tunedConfig() const;
+
+	// Un mundo empieza y termina. Al terminar su uso se junta con el de los
+	// demas y, si era el ultimo vivo, se guarda el fichero una sola vez
+	void beginContext();
+	void endContext(const Stats& stats);
+
+	// Tamanyos para btDefaultCollisionConstructionInfo
+	int getManifoldPoolSize() const;
+	int getAlgorithmPoolSize() const;
+	// Deja al menos count bloques en el pool del tamanyo que cabe size
+	void reserve(size_t size, int count);
+
+	// Lo que pasa entre medias cuenta como paso de la simulacion (por hilo)
+	void beginStep();
+	void endStep();
+	// Uso de los pools de colision del contexto actual tras un paso
+	void recordCollisionPools(int manifolds, int algorithms);
+
+	// Del contexto actual (vacio si no hay), y lo juntado de los cerrados
+	Stats getStats() const;
+	Stats getMergedStats() const;
+	PoolStats getPoolStats() const;
+	void printStats() const;
+
+private:
+	// Cabecera delante de cada bloque, mantiene la alineacion de 16
+	struct alignas(16) Header {
+		int sizeClass;				// -1 si es una reserva grande
+		size_t size;
+	};
+	struct Pool {
+		std::vector<void*> free;
+		std::vector<void*> chunks;
+	};
+	// Bloques libres de un hilo, vuelven al pool al terminar el hilo
+	struct ThreadCache {
+		std::vector<void*> free[NUM_CLASSES];
+		ThreadCache();
+		~ThreadCache();
+	};
+
+	PhysicsMemory();
+	~PhysicsMemory() = default;
+
+	static void* allocate(size_t size);
+	static void deallocate(void* ptr);
+	static int sizeClass(size_t size);
+	// Cache del hilo, nullptr si ya se ha destruido (salida del hilo)
+	static ThreadCache* threadCache();
+	// Uso del contexto enlazado al hilo, nullptr si no hay
+	static Stats* contextStats();
+
+	// Camino lento, con el mutex: pasa bloques entre el pool y una cache
+	void refill(int c, std::vector<void*>& cache, Stats* stats);
+	void drain(int c, std::vector<void*>& cache, size_t keep);
+	// Anade count bloques a la clase, con el mutex cogido
+	void grow(int c, int count);
+	void noteHeapHit(Stats* stats);
+	// Apunta en stats, o sin contexto en orphan_ con el mutex
+	void noteUse(Stats* stats, int c, long long bytes, int blocks);
+
+	Pool pools_[NUM_CLASSES];
+	PoolStats poolStats_;
+	// Juntado de los contextos cerrados, y lo reservado fuera de cualquiera
+	Stats merged_;
+	Stats orphan_;
+	int liveContexts_ = 0;
+	bool autoTune_ = true;
+	// Lo leido del fichero, para no bajar de golpe tras una ejecucion pequenya
+	int loadedBlocks_[NUM_CLASSES] = {};
+	mutable std::mutex mutex_;
+
+	PhysicsMemory(const PhysicsMemory&) = delete;
+	PhysicsMemory& operator=(const PhysicsMemory&) = delete;
+};
+
+#endif
@@ -31,8 +31,14 @@ private:
 	bool trigger = false;
 	bool meshShape = true;
 	CollisionObject* co = nullptr;
+	// Filtro de colision guardado mientras esta fuera del mundo (sin proxy)
+	int group_ = 1;
+	int mask_ = -1;
 
 	bool collidesWithEntity(Entity* other) const;
+	//"Dynamic", "Kinematic", "Trigger" o "Static"
+	void setState(const std::string& state);
+	std::string getState() const;
 public:
 	/// <summary>
 	/// Constructora por defecto Rigibody
@@ -44,10 +50,13 @@ public:
 	virtual void setUp();
 	virtual void init();
 	virtual void update(float deltaTime);
+	// Desactivado sale del mundo de Bullet, no simula ni colisiona
+	virtual void setActive(bool act) override;
 	/// <summary>
 	/// Carga datos a partir de un json
 	/// </summary>
 	virtual void load(const nlohmann::json& params);
+	virtual const Reflection::TypeInfo* getTypeInfo() const override;
 #pragma region Setters
 
 	//metodo que setea la posicion del rb
@@ -88,6 +97,10 @@ public:
 
 	// Permite rotar solo en los ejes que se pasen como parametro
 	void setAngularFactor(const Vector3& axis);
+
+	//Filtro de colision, se guarda aunque el rigidbody este fuera del mundo
+	void setGroup(int group);
+	void setMask(int mask);
 #pragma endregion
 
 #pragma region Getters
@@ -0,0 +1,90 @@
+#pragma once
+
+#ifndef _PHYSICS_TRIGGER_H
+#define _PHYSICS_TRIGGER_H
+
+#include "Component.h"
+#include "Vector3.h"
+#include <vector>
+#include <functional>
+
+class btPairCachingGhostObject;
+class btCollisionObject;
+class btCollisionShape;
+class CollisionObject;
+class Transform;
+class Entity;
+
+/// <summary>
+/// Zona que avisa cuando una entidad con rigidbody entra o sale. Es un ghost
+/// de Bullet que no tiene respuesta ni narrowphase: los solapes salen de la
+/// cache de pares del broadphase (btGhostPairCallback), asi que cada zona
+/// cuesta lo que su caja en el broadphase. Sigue al transform de la entidad,
+/// con un desplazamiento opcional. Los avisos llegan a su CollisionObject
+/// (onTriggerEnter/onTriggerExit, tambien desde Lua) y a los callbacks
+/// </summary>
+class TriggerComponent : public Component
+{
+	friend class PhysicsManager;
+public:
+	typedef std::function<void(Entity*)> TriggerCallback;
+private:
+	btPairCachingGhostObject* ghost_ = nullptr;
+	btCollisionShape* shape_ = nullptr;
+	CollisionObject* co_ = nullptr;
+	Transform* tr_ = nullptr;
+	bool inWorld_ = false;
+
+	Vector3 offset_;
+	int group_;
+	int mask_;
+
+	// Ordenados por puntero para comparar un paso con el anterior
+	std::vector<const btCollisionObject*> inside_;
+	std::vector<const btCollisionObject*> overlaps_;
+	// Avisos pendientes del ultimo paso, se reutilizan para no reservar
+	std::vector<Entity*> entered_;
+	std::vector<Entity*> exited_;
+
+	TriggerCallback onEnter_;
+	TriggerCallback onExit_;
+
+	// Entidad del objeto de Bullet, nullptr si no es de una entidad
+	Entity* entityOf(const btCollisionObject* obj) const;
+	void addToWorld();
+	void removeFromWorld();
+	// Los llama el PhysicsManager antes y despues de cada paso
+	void syncTransform();
+	void refreshOverlaps();
+	void dispatchEvents();
+	// El objeto se destruye: se quita sin avisar
+	void forget(const btCollisionObject* obj);
+public:
+	TriggerComponent();
+	virtual ~TriggerComponent();
+
+	virtual void init() override;
+	virtual void load(const nlohmann::json& params) override;
+	virtual void setUp() override;
+	virtual void update(float deltaTime) override;
+	// Desactivado sale del mundo y avisa de la salida de lo que tenia dentro
+	virtual void setActive(bool act) override;
+	virtual const Reflection::TypeInfo* getTypeInfo() const override;
+
+	// La forma pasa a ser del trigger
+	void setShape(btCollisionShape* shape);
+	void setOffset(const Vector3& offset);
+	const Vector3& getOffset() const;
+	void setGroup(int group);
+	int getGroup() const;
+	void setMask(int mask);
+	int getMask() const;
+
+	void setUserPtr(CollisionObject* co);
+	void setCallbacks(const TriggerCallback& onEnter, const TriggerCallback& onExit);
+
+	bool isInside(Entity* ent) const;
+	int getOverlapCount() const;
+};
+
+#endif
@@ -10,7 +10,6 @@
 class UIButton:public UIComponent
 {
 private:
-	std::string text;
 	std::string scene;
 
 	bool buttonPressed = false;
@@ -25,10 +24,12 @@ public:
 	/// Carga datos a partir de un json
 	/// </summary>
 	virtual void load(const nlohmann::json& params);
+	virtual const Reflection::TypeInfo* getTypeInfo() const override;
 
 	//Evento que se suscribe al pulsar el boton, el cual activa
 	//el booleano que usara lua para su logica
 	void buttonWasPressed();
+	virtual void onClicked() override;
 
 	//Cuando en lua se aplique la logica correspondiente al pulsar el 
 	//boton se desasctivara el booleano para que pueda ser pulsado de nuevo
@@ -36,9 +37,6 @@ public:
 
 	//Devuelve el estado del boton (pulsado o no pulsado)
 	bool getButtonPressed();
-
-	//Aplica un nuevo texto al boton
-	void setText(std::string t);
 };
 
 #endif
@@ -5,6 +5,8 @@
 
 #include "Component.h"
 #include <iostream>
+#include <vector>
+#include <functional>
 class Transform;
 
 namespace CEGUI {
@@ -16,12 +18,50 @@ namespace CEGUI {
 using vector2 = std::pair<float, float>;
 class UIComponent : public Component
 {
+public:
+	//Eventos de interfaz que pueden tener callback
+	enum class UIEvent : int {
+		Click = 0,
+		HoverEnter,
+		HoverExit,
+		ValueChanged,
+		LastUIEvent
+	};
+	//Recibe el valor del evento (el del slider en ValueChanged, 0 en el resto)
+	typedef std::function<void(float)> UICallback;
+
+	//Devuelve el evento con ese nombre ("click", "hoverEnter", "hoverExit",
+	//"valueChanged") o LastUIEvent si no existe
+	static UIEvent getEventByName(const std::string& eventName);
 protected:
 	vector2 pos;
 	vector2 size;
 	std::string name;
 	std::string type;
+	//Texto actual, puede no estar aplicado aun a la ventana
+	std::string text;
+	bool textDirty = false;
 	CEGUI::Window* uiWindow = nullptr;
+	//La ventana pertenece a un layout y no vuelve al pool
+	bool layoutWindow = false;
+	//Layout y ruta de la ventana dentro de el, si la ventana no se crea
+	std::string layoutName;
+	std::string layoutPath;
+	//Propiedades modificadas, se restauran al devolver la ventana al pool
+	std::vector<std::string> changedProps;
+	UICallback callbacks[(int)UIEvent::LastUIEvent];
+
+	//Asigna la ventana del componente, devolviendo la anterior si la habia
+	void setWindow(CEGUI::Window* w, bool fromLayout = false);
+	//Cambia el texto solo si es distinto y encola su aplicacion para el final del frame
+	void changeText(const char* t);
+	//Ventana indicada por los parametros "layout" y "window", o nullptr si no hay
+	CEGUI::Window* findLayoutWindow();
+	//Asigna una ventana del layout y le aplica "position", "size" y "text"
+	//si vienen en params, como se hace al crear las del pool
+	void bindLayoutWindow(CEGUI::Window* w, const nlohmann::json& params);
+	//Lo que se aplica con la ventana ya asignada: "property" y "active"
+	void loadWindowParams(const nlohmann::json& params);
 
 	//Normaliza el vector size del objeto para poder 
 	//usar en el posicionamiento
@@ -35,17 +75,36 @@ public:
 	virtual void init() = 0;
 	virtual void update(float deltaTime) {};
 	virtual void setActive(bool act);
+	//Eventos de la ventana
+	virtual void onClicked() {};
+
+	//Registra la funcion a la que se llama cuando ocurre el evento, una vacia lo quita
+	void setCallback(UIEvent ev, const UICallback& callback);
+	//Lo llama el UIManager al vaciar la cola de eventos, una vez por frame
+	void dispatchEvent(UIEvent ev, float value);
 
 	/// <summary>
 	/// Carga datos a partir de un json
 	/// </summary>
 	virtual void load(const nlohmann::json& params) = 0;
+	//position, size, name, type, text, layout y window, comunes a todos
+	virtual const Reflection::TypeInfo* getTypeInfo() const override;
 
 	// Setters
 	void setPosition(const vector2& p);
 	void setSize(const vector2& s);
 	void setName(const std::string& n);
 	void setProperty(const std::string nameProp, const std::string value);
+
+	// Texto
+	void setText(const std::string& t);
+	//Muestra un numero con los decimales indicados
+	void setNumber(double value, int decimals);
+	//Sustituye el primer "{}" del formato por el numero, p.ej. ("Puntos: {}", 120, 0)
+	void setFormatted(const char* format, double value, int decimals);
+	const std::string& getText() const;
+	//Pasa el texto a la ventana, lo llama el UIManager una vez por frame
+	void applyText();
 };
 
 #endif
@@ -7,8 +7,6 @@
 
 class UILabel : public UIComponent
 {
-private:
-	std::string text;
 public:
 	UILabel();
 	virtual ~UILabel();
@@ -19,9 +17,7 @@ public:
 	/// Carga datos a partir de un json
 	/// </summary>
 	virtual void load(const nlohmann::json& params);
-
-	//Aplica un nuevo texto al label
-	void setText(std::string t);
+	virtual const Reflection::TypeInfo* getTypeInfo() const override;
 };
 
 #endif
@@ -1,7 +1,10 @@
 #pragma once
 #include "Manager.h"
+#include "ComponentTypes.h"
+#include "UIComponent.h"
 #include <Ogre.h>
 #include <SDL_events.h>
+#include <set>
 
 namespace CEGUI {
 	class GUIContext;
@@ -10,14 +13,16 @@ namespace CEGUI {
 	class OgreRenderer;
 	class System;
 	class Scheme;
+	class EventArgs;
 } // namespace CEGUI
 
+class UIComponent;
+
 using vector2 = std::pair<float, float>;
 
 class UIManager : public Ogre::FrameListener, public Manager
 {
 private:
-	static UIManager* instance_;
 
 	//Nombre de la configuracion del GUI
 	std::string schemeName;
@@ -38,13 +43,44 @@ private:
 	//Referencia al scheme actual
 	CEGUI::Scheme* sch = nullptr;
 
-	std::vector<CEGUI::Window*> ceguiWindows;
+	//Ventanas sin usar, por tipo, que se reutilizan entre escenas
+	std::map<std::string, std::vector<CEGUI::Window*>> windowPool;
+	//Layouts cargados, se quedan en memoria aunque se cambie de escena
+	std::map<std::string, CEGUI::Window*> layouts;
+	//Componente que usa cada ventana, para hacerle llegar sus eventos
+	std::map<CEGUI::Window*, UIComponent*> windowOwners;
+	//Ventanas a las que ya se han suscrito los eventos
+	std::set<CEGUI::Window*> eventWindows;
+	//Cambios de propiedades pendientes, se aplican una vez por frame
+	std::map<std::pair<CEGUI::Window*, std::string>, std::string> pendingProps;
+	//Componentes con el texto cambiado este frame
+	std::vector<UIComponent*> pendingTexts;
+
+	//Evento recibido de CEGUI a la espera de despacharse
+	struct QueuedEvent {
+		CEGUI::Window* window;
+		UIComponent::UIEvent type;
+		float value;
+	};
+	std::vector<QueuedEvent> eventQueue;
 
 	UIManager();
 	virtual ~UIManager();
 
 	static void setWidgetDestRect(CEGUI::Window* widget, vector2 position,
 		vector2 size);
+
+	//Saca del pool una ventana del tipo pedido (preferiblemente con el mismo
+	//nombre) o la crea si no hay ninguna libre
+	CEGUI::Window* acquireWindow(const std::string& type, const std::string& name);
+	void applyPendingProperties();
+	//Despacha los eventos del frame a los componentes que siguen usando su ventana
+	void dispatchEvents();
+	void queueEvent(const CEGUI::EventArgs& e, UIComponent::UIEvent type, float value = 0.0f);
+	bool onWindowClicked(const CEGUI::EventArgs& e);
+	bool onWindowHoverEnter(const CEGUI::EventArgs& e);
+	bool onWindowHoverExit(const CEGUI::EventArgs& e);
+	bool onWindowValueChanged(const CEGUI::EventArgs& e);
 public:
 #pragma region Generales
 	//Devuelve el singleton de UIManager
@@ -65,7 +101,10 @@ public:
 
 	void loadFont(const std::string& filename);
 
-	void loadLayout(const std::string& layaoutName);
+	//Carga un layout (o reutiliza el que ya estaba cargado) y lo muestra
+	CEGUI::Window* loadLayout(const std::string& layaoutName);
+	//Devuelve una ventana de un layout a partir de su ruta dentro de el
+	CEGUI::Window* getLayoutWindow(const std::string& layoutFile, const std::string& path);
 
 	//Aplica una nueva fuente
 	void setFont(const std::string& fontFile);
@@ -127,6 +166,21 @@ public:
 		const std::string& name, const std::string& type);
 #pragma endregion
 
+#pragma region Pool
+	//Asocia una ventana al componente que la usa
+	void bindWindow(CEGUI::Window* window, UIComponent* owner);
+	/// <summary>
+	/// Devuelve la ventana al pool (si es propia y no de un layout). Las
+	/// propiedades modificadas vuelven a su valor por defecto
+	/// </summary>
+	void releaseWindow(CEGUI::Window* window, const std::vector<std::string>& changedProps, bool pooled);
+	//Encola el cambio de una propiedad, si se cambia varias veces en un frame solo se aplica la ultima
+	void queueProperty(CEGUI::Window* window, const std::string& prop, const std::string& value);
+	//Encola un componente cuyo texto ha cambiado, se aplica una vez por frame
+	void queueText(UIComponent* comp);
+	void cancelText(UIComponent* comp);
+#pragma endregion
+
 #pragma region INPUT
 	
 	//Captura el input dentro de la UI
@@ -143,4 +197,16 @@ public:
 	CEGUI::WindowManager* getWindowMngr() const;
 #pragma endregion
 
-};
\ No newline at end of file
+};
+
+class UIButton;
+class UISlider;
+class UILabel;
+class UIImage;
+class UIPointer;
+
+COMPONENT_TYPE(UIButton, ManID::UI, UIManager::UICmpId::Button)
+COMPONENT_TYPE(UISlider, ManID::UI, UIManager::UICmpId::Slider)
+COMPONENT_TYPE(UILabel, ManID::UI, UIManager::UICmpId::Label)
+COMPONENT_TYPE(UIImage, ManID::UI, UIManager::UICmpId::Image)
+COMPONENT_TYPE(UIPointer, ManID::UI, UIManager::UICmpId::Pointer)
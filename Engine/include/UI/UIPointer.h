@@ -21,6 +21,7 @@ public:
 	/// Carga datos a partir de un json
 	/// </summary>
 	virtual void load(const nlohmann::json& params);
+	virtual const Reflection::TypeInfo* getTypeInfo() const override;
 };
 
 #endif
@@ -17,6 +17,11 @@ public:
 	/// Carga datos a partir de un json
 	/// </summary>
 	virtual void load(const nlohmann::json& params);
+	virtual const Reflection::TypeInfo* getTypeInfo() const override;
+
+	//Valor actual del slider
+	float getValue() const;
+	void setValue(float value);
 };
 
 #endif
@@ -0,0 +1,89 @@
+#include "AudioEmitter.h"
+#include "AudioSystem.h"
+#include "Entity.h"
+#include "CommonManager.h"
+#include "Transform.h"
+#include <checkML.h>
+#include <stdexcept>
+
+AudioEmitter::AudioEmitter() : Component(AudioSystem::getInstance(), (int)AudioSystem::AudioCmpId::Emitter)
+{
+}
+
+AudioEmitter::~AudioEmitter()
+{
+	stop();
+	AudioSystem::getInstance()->removeEmitter(this);
+}
+
+void AudioEmitter::init()
+{
+}
+
+void AudioEmitter::load(const nlohmann::json& params)
+{
+	auto it = params.find("sound");
+	if (it == params.end())
+		throw std::runtime_error("Cannot create AudioEmitter without sound\n");
+	sound_ = it->get<std::string>();
+
+	volume_ = params.value("volume", volume_);
+	playOnStart_ = params.value("playOnStart", playOnStart_);
+	loop_ = params.value("loop", loop_);
+	bus_ = params.value("bus", bus_);
+
+	AudioSystem::getInstance()->loadSound(sound_, true, loop_);
+}
+
+void AudioEmitter::update(float deltaTime)
+{
+}
+
+void AudioEmitter::setUp()
+{
+	tr_ = _entity->get<Transform>();
+	lastPos_ = tr_->getWorldPos();
+	AudioSystem::getInstance()->addEmitter(this);
+	if (playOnStart_ && _active)
+		play();
+}
+
+void AudioEmitter::setActive(bool status)
+{
+	if (!status)
+		stop();
+	Component::setActive(status);
+}
+
+void AudioEmitter::play()
+{
+	stop();
+	if (tr_ != nullptr)
+		lastPos_ = tr_->getWorldPos();
+	moving_ = false;
+	channelId_ = AudioSystem::getInstance()->playSound(sound_, lastPos_, bus_, volume_);
+}
+
+void AudioEmitter::stop()
+{
+	if (channelId_ != -1)
+		AudioSystem::getInstance()->stopChannel(channelId_);
+	channelId_ = -1;
+}
+
+bool AudioEmitter::isPlaying() const
+{
+	return channelId_ != -1 && AudioSystem::getInstance()->isPlaying(channelId_);
+}
+
+void AudioEmitter::setVolume(float volume)
+{
+	volume_ = volume;
+	if (channelId_ != -1)
+		AudioSystem::getInstance()->setChannelvolume(channelId_, volume_);
+}
+
+float AudioEmitter::getVolume() const
+{
+	return volume_;
+}
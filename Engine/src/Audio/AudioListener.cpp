@@ -0,0 +1,40 @@
+#include "AudioListener.h"
+#include "AudioSystem.h"
+#include "Entity.h"
+#include "CommonManager.h"
+#include "Transform.h"
+#include <checkML.h>
+
+AudioListener::AudioListener() : Component(AudioSystem::getInstance(), (int)AudioSystem::AudioCmpId::Listener)
+{
+}
+
+AudioListener::~AudioListener()
+{
+	AudioSystem::getInstance()->removeListener(this);
+}
+
+void AudioListener::init()
+{
+}
+
+void AudioListener::load(const nlohmann::json& params)
+{
+}
+
+void AudioListener::update(float deltaTime)
+{
+}
+
+void AudioListener::setUp()
+{
+	tr_ = _entity->get<Transform>();
+	AudioSystem::getInstance()->setListener(this);
+}
+
+void AudioListener::setActive(bool status)
+{
+	Component::setActive(status);
+	//Al reactivarse no se calcula velocidad con la posicion antigua
+	firstFrame_ = true;
+}
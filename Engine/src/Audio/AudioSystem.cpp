@@ -1,23 +1,35 @@
 #include "AudioSystem.h"
+#include "EngineContext.h"
 #include <vector>
 #include <iostream>
 #include "Vector3.h"
+#include "Transform.h"
+#include "AudioListener.h"
+#include "AudioEmitter.h"
 #include <math.h>
 #include <chrono>
 #include <thread>
+#include <climits>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
 #include "checkML.h"
-AudioSystem* AudioSystem::instance_ = nullptr;
+
+static_assert((int)AudioSystem::AudioCmpId::LastAudioCmpId == NATIVE_COMPONENTS[(int)ManID::Audio], "Update NATIVE_COMPONENTS in ComponentTypes.h");
+const std::string AudioSystem::BUSES_FILE_PATH = "Audio/buses.json";
+const std::string AudioSystem::MASTER_BUS = "master";
 
 AudioSystem* AudioSystem::getInstance()
 {
-    return instance_;
+    return EngineContext::current()->audio;
 }
 
 bool AudioSystem::setupInstance()
 {
-    if (instance_ == nullptr) {
+    EngineContext* ctx = EngineContext::current();
+    if (!ctx->audio) {
         try {
-            instance_ = new AudioSystem();
+            ctx->audio = new AudioSystem();
         }
         catch (...) {
             return false;
@@ -29,44 +41,159 @@ bool AudioSystem::setupInstance()
 
 void AudioSystem::clean()
 {
+    AudioSystem* audio = getInstance();
+    audio->destroyAllComponents();
+    //Los sonidos siguen cargados, el cache los descarga si hace falta sitio
+    audio->mSceneSounds.releaseAll();
+    audio->mSceneSoundNames.clear();
 }
 
 void AudioSystem::destroy() {
-    instance_->clean();
-    delete instance_;
+    getInstance()->clean();
+    delete getInstance();
+    EngineContext::current()->audio = nullptr;
 }
 
-AudioSystem::AudioSystem()
+AudioSystem::AudioSystem() : Manager(ManID::Audio)
 {
+    registerComponent("AudioListener", (int)AudioCmpId::Listener, []() -> AudioListener* { return new AudioListener(); });
+    registerComponent("AudioEmitter", (int)AudioCmpId::Emitter, []() -> AudioEmitter* { return new AudioEmitter(); });
+
     mpSystem = NULL;
     errorCheck(FMOD::System_Create(&mpSystem));
-    errorCheck(mpSystem->init(512, FMOD_INIT_NORMAL, nullptr));
+    //Solo MAX_REAL_VOICES se mezclan, el resto de voces son virtuales
+    errorCheck(mpSystem->setSoftwareChannels(MAX_REAL_VOICES));
+    //Las voces que dejan de oirse (por ejemplo por distancia) pasan a ser virtuales
+    FMOD_ADVANCEDSETTINGS settings = {};
+    settings.cbSize = sizeof(FMOD_ADVANCEDSETTINGS);
+    settings.vol0virtualvol = 0.001f;
+    errorCheck(mpSystem->setAdvancedSettings(&settings));
+    errorCheck(mpSystem->init(MAX_VOICES, FMOD_INIT_NORMAL | FMOD_INIT_VOL0_BECOMES_VIRTUAL | FMOD_INIT_3D_RIGHTHANDED, nullptr));
     init();
+    registerResourceCache();
 }
 
 AudioSystem::~AudioSystem()
 {
+    //Sin backend el cache olvida los sonidos, se liberan con el sistema
+    ResourceCache::getInstance()->setBackend(ResourceCache::Type::Sound, ResourceCache::Backend());
     errorCheck(mpSystem->close());
     errorCheck(mpSystem->release());
 }
 
-void AudioSystem::update() {
-    std::vector<ChannelMap::iterator> pStoppedChannels;
-    for (auto it = instance_->mChannels.begin(), itEnd = instance_->mChannels.end(); it != itEnd; ++it)
+void AudioSystem::start()
+{
+    for (size_t i = 0; i < _compsList.size(); ++i)
+        _compsList[i]->setUp();
+}
+
+void AudioSystem::update(float deltaTime) {
+    //Primero las posiciones, asi las voces que arrancan ya salen en su sitio
+    updateListener(deltaTime);
+    updateEmitters(deltaTime);
+
+    processLoadedSounds();
+
+    //Las voces que han terminado vuelven a la lista de libres
+    for (int i = 0; i < MAX_VOICES; ++i)
     {
+        Voice& voice = mVoices[i];
+        if (voice.id == -1 || voice.pending)
+            continue;
         bool bIsPlaying = false;
-        it->second->isPlaying(&bIsPlaying);
+        voice.channel->isPlaying(&bIsPlaying);
         if (!bIsPlaying)
         {
-            pStoppedChannels.push_back(it);
+            releaseVoice(i, false);
         }
     }
-    for (auto& it : pStoppedChannels)
+    errorCheck(mpSystem->update());
+}
+
+/// <summary>
+/// Coloca y orienta el listener con el estado de mundo del Transform (con el
+/// de sus padres), el mismo que usa la camara
+/// </summary>
+void AudioSystem::updateListener(float deltaTime)
+{
+    if (mListener == nullptr || !mListener->isActive() || mListener->tr_ == nullptr)
+        return;
+
+    const Vector3& pos = mListener->tr_->getWorldPos();
+    Vector3 vel;
+    if (!mListener->firstFrame_ && deltaTime > 0.0f)
+        vel = Vector3(pos.x - mListener->lastPos_.x, pos.y - mListener->lastPos_.y, pos.z - mListener->lastPos_.z) * (1.0f / deltaTime);
+    mListener->lastPos_ = pos;
+    mListener->firstFrame_ = false;
+
+    //Ogre mira hacia -Z y tiene Y hacia arriba; la rotacion es la de mundo,
+    //compuesta con la de los padres igual que la posicion
+    Quaternion rot = mListener->tr_->getWorldRotation();
+    Vector3 forward = rot.rotate(Vector3(0.0f, 0.0f, -1.0f));
+    Vector3 up = rot.rotate(Vector3(0.0f, 1.0f, 0.0f));
+
+    set3dListenerAndOrientation(pos, forward, up, vel);
+}
+
+/// <summary>
+/// Pasa de una vez las posiciones de los emisores al mezclador. Los que no se
+/// han movido desde el frame anterior no generan llamadas a FMOD
+/// </summary>
+void AudioSystem::updateEmitters(float deltaTime)
+{
+    float invDelta = deltaTime > 0.0f ? 1.0f / deltaTime : 0.0f;
+    for (AudioEmitter* emitter : mEmitters)
     {
+        if (emitter->channelId_ == -1 || emitter->tr_ == nullptr)
+            continue;
+        if (getVoice(emitter->channelId_) == nullptr)
+        {
+            //El canal termino o se lo robo otra voz
+            emitter->channelId_ = -1;
+            continue;
+        }
 
-        instance_->mChannels.erase(it);
+        const Vector3& pos = emitter->tr_->getWorldPos();
+        const Vector3& last = emitter->lastPos_;
+        bool moved = pos.x != last.x || pos.y != last.y || pos.z != last.z;
+        if (!moved && !emitter->moving_)
+            continue;
+
+        Vector3 vel(pos.x - last.x, pos.y - last.y, pos.z - last.z);
+        setChannel3dAttributes(emitter->channelId_, pos, vel * invDelta);
+        emitter->lastPos_ = pos;
+        emitter->moving_ = moved;
+    }
+}
+
+void AudioSystem::setListener(AudioListener* listener)
+{
+    if (mListener != nullptr && mListener != listener)
+        std::cout << "WARNING: hay mas de un AudioListener en la escena, se usa el ultimo\n";
+    mListener = listener;
+    mListener->firstFrame_ = true;
+}
+
+void AudioSystem::removeListener(AudioListener* listener)
+{
+    if (mListener == listener)
+        mListener = nullptr;
+}
+
+void AudioSystem::addEmitter(AudioEmitter* emitter)
+{
+    if (std::find(mEmitters.begin(), mEmitters.end(), emitter) == mEmitters.end())
+        mEmitters.push_back(emitter);
+}
+
+void AudioSystem::removeEmitter(AudioEmitter* emitter)
+{
+    auto it = std::find(mEmitters.begin(), mEmitters.end(), emitter);
+    if (it != mEmitters.end())
+    {
+        *it = mEmitters.back();
+        mEmitters.pop_back();
     }
-    errorCheck(instance_->mpSystem->update());
 }
 
 AudioSystem::SoundMap& AudioSystem::getSoundMap()
@@ -79,24 +206,24 @@ const AudioSystem::SoundMap& AudioSystem::getSoundMap() const
     return mSounds;
 }
 
-AudioSystem::ChannelMap& AudioSystem::getSoundChannels()
+AudioSystem::VoicePool& AudioSystem::getSoundChannels()
 {
-    return mChannels;
+    return mVoices;
 }
 
-const AudioSystem::ChannelMap& AudioSystem::getSoundChannels() const
+const AudioSystem::VoicePool& AudioSystem::getSoundChannels() const
 {
-    return mChannels;
+    return mVoices;
 }
 
-AudioSystem::ChannelGroupMap& AudioSystem::getChanGroupMap()
+AudioSystem::BusMap& AudioSystem::getBusMap()
 {
-    return mGroup;
+    return mBuses;
 }
 
-const AudioSystem::ChannelGroupMap& AudioSystem::getChanGroupMap() const
+const AudioSystem::BusMap& AudioSystem::getBusMap() const
 {
-    return mGroup;
+    return mBuses;
 }
 
 FMOD::System* AudioSystem::getSystem()
@@ -120,6 +247,193 @@ const int& AudioSystem::getNextChannelId() const
 }
 
 void AudioSystem::init() {
+    mVoices.resize(MAX_VOICES);
+    mFreeVoices.reserve(MAX_VOICES);
+    for (int i = MAX_VOICES - 1; i >= 0; --i)
+        mFreeVoices.push_back(i);
+    createDefaultBuses();
+}
+
+AudioSystem::Voice* AudioSystem::getVoice(int nChannelId)
+{
+    if (nChannelId < 0)
+        return nullptr;
+    Voice& voice = mVoices[nChannelId % MAX_VOICES];
+    return voice.id == nChannelId ? &voice : nullptr;
+}
+
+const AudioSystem::Voice* AudioSystem::getVoice(int nChannelId) const
+{
+    if (nChannelId < 0)
+        return nullptr;
+    const Voice& voice = mVoices[nChannelId % MAX_VOICES];
+    return voice.id == nChannelId ? &voice : nullptr;
+}
+
+/// <summary>
+/// Reserva una voz del pool para un sonido. Si el sonido ya tiene el maximo
+/// de instancias se roba una segun su politica; si el pool esta lleno se roba
+/// la voz menos prioritaria (y mas antigua) siempre que no sea mas importante
+/// </summary>
+/// <returns>indice de la voz o -1 si no se puede reproducir</returns>
+int AudioSystem::acquireVoice(FMOD::Sound* pSound, const SoundProps& props)
+{
+    int nInstances = 0;
+    int nVictim = -1;
+    float fVictimValue = 0.0f;
+    int nGlobalVictim = -1;
+    for (int i = 0; i < MAX_VOICES; ++i)
+    {
+        const Voice& voice = mVoices[i];
+        if (voice.id == -1)
+            continue;
+        if (voice.sound == pSound)
+        {
+            nInstances++;
+            float fValue = (float)voice.order;
+            if (props.steal == StealPolicy::Quietest)
+            {
+                // Una voz pendiente aun no suena, cuenta como inaudible
+                fValue = 0.0f;
+                if (!voice.pending)
+                    voice.channel->getAudibility(&fValue);
+            }
+            // A igual valor se queda la mas antigua
+            if (nVictim == -1 || fValue < fVictimValue ||
+                (fValue == fVictimValue && voice.order < mVoices[nVictim].order))
+            {
+                nVictim = i;
+                fVictimValue = fValue;
+            }
+        }
+        if (nGlobalVictim == -1 || voice.props.priority > mVoices[nGlobalVictim].props.priority ||
+            (voice.props.priority == mVoices[nGlobalVictim].props.priority && voice.order < mVoices[nGlobalVictim].order))
+        {
+            nGlobalVictim = i;
+        }
+    }
+
+    if (nInstances >= props.maxInstances)
+    {
+        if (props.steal == StealPolicy::None || nVictim == -1)
+            return -1;
+        releaseVoice(nVictim, true);
+    }
+    else if (mFreeVoices.empty())
+    {
+        if (nGlobalVictim == -1 || mVoices[nGlobalVictim].props.priority < props.priority)
+            return -1;
+        releaseVoice(nGlobalVictim, true);
+    }
+
+    int nSlot = mFreeVoices.back();
+    mFreeVoices.pop_back();
+    return nSlot;
+}
+
+void AudioSystem::releaseVoice(int nSlot, bool bStop)
+{
+    Voice& voice = mVoices[nSlot];
+    if (bStop && voice.channel)
+        voice.channel->stop();
+    voice = Voice();
+    mFreeVoices.push_back(nSlot);
+}
+
+void AudioSystem::startVoice(int nSlot)
+{
+    Voice& voice = mVoices[nSlot];
+    FMOD::Channel* pChannel = nullptr;
+    errorCheck(mpSystem->playSound(voice.sound, voice.group, true, &pChannel));
+    if (!pChannel)
+    {
+        releaseVoice(nSlot, false);
+        return;
+    }
+
+    FMOD_MODE currMode;
+    voice.sound->getMode(&currMode);
+    if (currMode & FMOD_3D) {
+        errorCheck(pChannel->set3DAttributes(&voice.position, nullptr));
+        errorCheck(pChannel->set3DMinMaxDistance(voice.props.minDistance, voice.props.maxDistance));
+    }
+    errorCheck(pChannel->setPriority(voice.props.priority));
+    errorCheck(pChannel->setVolume(voice.volume));
+    errorCheck(pChannel->setPaused(false));
+
+    voice.channel = pChannel;
+    voice.pending = false;
+}
+
+bool AudioSystem::isLoading(FMOD::Sound* pSound) const
+{
+    return std::find(mLoadingSounds.begin(), mLoadingSounds.end(), pSound) != mLoadingSounds.end();
+}
+
+/// <summary>
+/// Cola de sonidos en carga: los que ya estan listos arrancan las voces
+/// que esperaban por ellos y los que han fallado se descartan
+/// </summary>
+void AudioSystem::processLoadedSounds()
+{
+    for (size_t i = 0; i < mLoadingSounds.size();)
+    {
+        FMOD::Sound* pSound = mLoadingSounds[i];
+        FMOD_OPENSTATE state = FMOD_OPENSTATE_LOADING;
+        pSound->getOpenState(&state, nullptr, nullptr, nullptr);
+        if (state != FMOD_OPENSTATE_READY && state != FMOD_OPENSTATE_ERROR)
+        {
+            ++i;
+            continue;
+        }
+
+        mLoadingSounds[i] = mLoadingSounds.back();
+        mLoadingSounds.pop_back();
+
+        for (int v = 0; v < MAX_VOICES; ++v)
+        {
+            if (mVoices[v].id == -1 || !mVoices[v].pending || mVoices[v].sound != pSound)
+                continue;
+            if (state == FMOD_OPENSTATE_READY)
+                startVoice(v);
+            else
+                releaseVoice(v, false);
+        }
+
+        if (state == FMOD_OPENSTATE_ERROR)
+        {
+            auto it = std::find_if(mSounds.begin(), mSounds.end(),
+                [pSound](const SoundMap::value_type& s) { return s.second == pSound; });
+            if (it != mSounds.end())
+            {
+                std::cout << "FMOD ERROR: no se ha podido cargar " << it->first << std::endl;
+                // El cache tampoco debe seguir contandolo
+                ResourceCache::getInstance()->forget(ResourceCache::Type::Sound, it->first);
+                mMusicStreams.erase(it->first);
+                mSounds.erase(it);
+            }
+            pSound->release();
+        }
+    }
+}
+
+void AudioSystem::setSoundProperties(const std::string& strSoundName, const SoundProps& props)
+{
+    mSoundProps[strSoundName] = props;
+}
+
+const AudioSystem::SoundProps& AudioSystem::getSoundProperties(const std::string& strSoundName) const
+{
+    static const SoundProps defaultProps;
+    auto encontrado = mSoundProps.find(strSoundName);
+    if (encontrado == mSoundProps.end())
+        return defaultProps;
+    return encontrado->second;
+}
+
+int AudioSystem::getActiveVoices() const
+{
+    return MAX_VOICES - (int)mFreeVoices.size();
 }
 
 //Comprueba si hay un error en la ejecucion de comando fmod
@@ -132,28 +446,41 @@ int AudioSystem::errorCheck(FMOD_RESULT result)
     return 0;
 }
 /// <summary>
-/// Carga un sonido en el sistema 
+/// Carga un sonido en el sistema sin bloquear (FMOD_NONBLOCKING).
+/// El sonido queda en la cola de carga hasta que FMOD lo tiene listo
 /// </summary>
 /// <param name="strSoundName"> string del archivo </param>
 /// <param name="b3d"> bool 3d /2d</param>
 /// <param name="bLooping">bool bool on /off</param>
-/// <param name="bStream">bool stream /compresses sample</param>
-void AudioSystem::loadSound(const std::string& strSoundName, bool b3d, bool bLooping, bool bStream)
+/// <param name="mode">stream / compressed sample / automatico segun tamanyo</param>
+void AudioSystem::loadSound(const std::string& strSoundName, bool b3d, bool bLooping, LoadMode mode)
 {
-    auto encontrado = instance_->getSoundMap().find(strSoundName);
-    if (encontrado != instance_->getSoundMap().end())
+    AudioSystem* audio = getInstance();
+    auto encontrado = audio->getSoundMap().find(strSoundName);
+    if (encontrado != audio->getSoundMap().end())
         return;
 
+    bool bStream = mode == LoadMode::Stream;
+    if (mode == LoadMode::Auto) {
+        std::error_code error;
+        auto size = std::filesystem::file_size(strSoundName, error);
+        bStream = !error && size > (std::uintmax_t)STREAM_THRESHOLD;
+    }
+
 
     FMOD_MODE eMode = FMOD_DEFAULT;
-    eMode |= b3d ? FMOD_3D : FMOD_2D;
+    //Con atenuacion lineal el volumen llega a 0 en la distancia maxima y la voz pasa a ser virtual
+    eMode |= b3d ? (FMOD_3D | FMOD_3D_LINEARSQUAREROLLOFF) : FMOD_2D;
     eMode |= bLooping ? FMOD_LOOP_NORMAL : FMOD_LOOP_OFF;
     eMode |= bStream ? FMOD_CREATESTREAM : FMOD_CREATECOMPRESSEDSAMPLE;
+    eMode |= FMOD_NONBLOCKING;
 
     FMOD::Sound* pSound = nullptr;
-    errorCheck(instance_->getSystem()->createSound(strSoundName.c_str(), eMode, nullptr, &pSound));
+    errorCheck(audio->getSystem()->createSound(strSoundName.c_str(), eMode, nullptr, &pSound));
     if (pSound) {
-        instance_->getSoundMap()[strSoundName] = pSound;
+        audio->getSoundMap()[strSoundName] = pSound;
+        audio->mLoadingSounds.push_back(pSound);
+        ResourceCache::getInstance()->touch(ResourceCache::Type::Sound, strSoundName);
     }
 
 }
@@ -163,113 +490,283 @@ void AudioSystem::loadSound(const std::string& strSoundName, bool b3d, bool bLoo
 /// <param name="strSoundName"></param>
 void AudioSystem::unloadSound(const std::string& strSoundName)
 {
-    auto encontrado = instance_->getSoundMap().find(strSoundName);
-    if (encontrado == instance_->getSoundMap().end())
+    AudioSystem* audio = getInstance();
+    auto encontrado = audio->getSoundMap().find(strSoundName);
+    if (encontrado == audio->getSoundMap().end())
         return;
-    errorCheck(encontrado->second->release());
-    instance_->getSoundMap().erase(encontrado);
+    audio->releaseSound(encontrado);
+    ResourceCache::getInstance()->forget(ResourceCache::Type::Sound, strSoundName);
+}
+
+void AudioSystem::releaseSound(SoundMap::iterator itSound)
+{
+    //Las voces que usan el sonido se liberan antes que el propio sonido
+    for (int i = 0; i < MAX_VOICES; ++i)
+    {
+        if (mVoices[i].id != -1 && mVoices[i].sound == itSound->second)
+            releaseVoice(i, true);
+    }
+    auto loading = std::find(mLoadingSounds.begin(), mLoadingSounds.end(), itSound->second);
+    if (loading != mLoadingSounds.end())
+        mLoadingSounds.erase(loading);
+    errorCheck(itSound->second->release());
+    mMusicStreams.erase(itSound->first);
+    mSounds.erase(itSound);
+}
+
+void AudioSystem::holdSceneSound(const std::string& strSoundName)
+{
+    if (mSceneSoundNames.insert(strSoundName).second)
+        mSceneSounds.acquire(ResourceCache::Type::Sound, strSoundName);
+}
+
+/// <summary>
+/// El cache mide lo que ocupan los samples (los streams se leen del disco) y
+/// no descarga sonidos que se esten cargando o que tenga alguna voz
+/// </summary>
+void AudioSystem::registerResourceCache()
+{
+    //El cache puede llamar desde otro hilo, se usa el contexto de este sistema
+    EngineContext* ctx = EngineContext::current();
+    ResourceCache::Backend backend;
+    backend.size = [this](const std::string& strSoundName) -> size_t {
+        auto encontrado = mSounds.find(strSoundName);
+        if (encontrado == mSounds.end() || isLoading(encontrado->second))
+            return 0;
+        FMOD_MODE eMode = 0;
+        unsigned int nBytes = 0;
+        encontrado->second->getMode(&eMode);
+        if (eMode & FMOD_CREATESTREAM)
+            return 0;
+        encontrado->second->getLength(&nBytes, FMOD_TIMEUNIT_RAWBYTES);
+        return nBytes;
+    };
+    backend.inUse = [this](const std::string& strSoundName) {
+        auto encontrado = mSounds.find(strSoundName);
+        if (encontrado == mSounds.end())
+            return false;
+        if (isLoading(encontrado->second))
+            return true;
+        for (const Voice& voice : mVoices)
+            if (voice.id != -1 && voice.sound == encontrado->second)
+                return true;
+        return false;
+    };
+    backend.unload = [ctx](const std::string& strSoundName) {
+        EngineContext::Scope scope(ctx);
+        getInstance()->unloadSound(strSoundName);
+    };
+    ResourceCache::getInstance()->setBackend(ResourceCache::Type::Sound, backend);
 }
 /// <summary>
-/// NO IMPLEMENTADO
+/// Precarga los sonidos de un manifiesto. Cada entrada puede ser el nombre del
+/// archivo o un objeto con "file" y opcionalmente "3d", "loop", "mode"
+/// ("Auto", "Sample", "Stream"), "maxInstances", "priority", "steal"
+/// ("Oldest", "Quietest", "None"), "minDistance" y "maxDistance"
 /// </summary>
-/// <param name="vPos"></param>
-/// <param name="fVolumedB"></param>
-void AudioSystem::set3dListenerAndOrientation(const Vector3& vPos = Vector3{ 0, 0, 0 }, float fVolumedB)
-{   
+/// <param name="manifest">array json con los sonidos de la escena</param>
+void AudioSystem::preloadSounds(const nlohmann::json& manifest)
+{
+    if (!manifest.is_array())
+        return;
+
+    for (const auto& entry : manifest) {
+        if (entry.is_string()) {
+            loadSound(entry.get<std::string>());
+            holdSceneSound(entry.get<std::string>());
+            continue;
+        }
+        auto it = entry.find("file");
+        if (!entry.is_object() || it == entry.end() || !it->is_string()) {
+            std::cout << "WARNING: entrada de sonido sin \"file\" en el manifiesto\n";
+            continue;
+        }
+        std::string file = it->get<std::string>();
+
+        SoundProps props = getSoundProperties(file);
+        props.maxInstances = entry.value("maxInstances", props.maxInstances);
+        props.priority = entry.value("priority", props.priority);
+        props.minDistance = entry.value("minDistance", props.minDistance);
+        props.maxDistance = entry.value("maxDistance", props.maxDistance);
+        std::string steal = entry.value("steal", std::string());
+        if (steal == "Oldest") props.steal = StealPolicy::Oldest;
+        else if (steal == "Quietest") props.steal = StealPolicy::Quietest;
+        else if (steal == "None") props.steal = StealPolicy::None;
+        setSoundProperties(file, props);
+
+        LoadMode mode = LoadMode::Auto;
+        std::string strMode = entry.value("mode", std::string());
+        if (strMode == "Sample") mode = LoadMode::Sample;
+        else if (strMode == "Stream") mode = LoadMode::Stream;
+
+        loadSound(file, entry.value("3d", true), entry.value("loop", false), mode);
+        holdSceneSound(file);
+    }
 }
+
+int AudioSystem::playMusic(const std::string& strSoundName, float fVolumedB)
+{
+    //Si ya estaba cargado de otra forma (precargado como sample, sin bucle...)
+    //se vuelve a cargar; la entrada del cache y sus referencias se mantienen
+    auto encontrado = mSounds.find(strSoundName);
+    if (encontrado != mSounds.end() && mMusicStreams.count(strSoundName) == 0)
+        releaseSound(encontrado);
+    if (mSounds.find(strSoundName) == mSounds.end())
+    {
+        loadSound(strSoundName, false, true, LoadMode::Stream);
+        if (mSounds.find(strSoundName) != mSounds.end())
+            mMusicStreams.insert(strSoundName);
+    }
+    return playSound(strSoundName, Vector3(0, 0, 0), "music", fVolumedB);
+}
+
+bool AudioSystem::isSoundReady(const std::string& strSoundName) const
+{
+    auto encontrado = mSounds.find(strSoundName);
+    return encontrado != mSounds.end() && !isLoading(encontrado->second);
+}
+
 /// <summary>
-/// Reproduce un sonido , si no existe lo carga 
+/// Coloca y orienta el listener de FMOD
+/// </summary>
+/// <param name="vPos">posicion</param>
+/// <param name="vForward">direccion a la que mira (unitaria)</param>
+/// <param name="vUp">vector arriba (unitario y perpendicular a vForward)</param>
+/// <param name="vVel">velocidad en unidades por segundo, para el efecto doppler</param>
+void AudioSystem::set3dListenerAndOrientation(const Vector3& vPos, const Vector3& vForward, const Vector3& vUp, const Vector3& vVel)
+{
+    FMOD_VECTOR pos = vectorToFmod(vPos);
+    FMOD_VECTOR vel = vectorToFmod(vVel);
+    FMOD_VECTOR forward = vectorToFmod(vForward);
+    FMOD_VECTOR up = vectorToFmod(vUp);
+    errorCheck(getInstance()->mpSystem->set3DListenerAttributes(0, &pos, &vel, &forward, &up));
+}
+/// <summary>
+/// Reproduce un sonido , si no existe lo carga. Respeta el limite de instancias
+/// y la prioridad configurados con setSoundProperties. Si el sonido aun se esta
+/// cargando la voz queda pendiente y empieza a sonar en cuanto este listo
 /// </summary>
 /// <param name="strSoundName">nombre del archivo </param>
 /// <param name="vPos">posicion</param>
-/// <param name="groupName">nombre del grupo perteneciente si es null lo crea al general </param>
+/// <param name="strBus">bus por el que sale el sonido, si no existe sale por el master</param>
 /// <param name="fVolumedB"> volumen </param>
-/// <returns></returns>
-int AudioSystem::playSound(const std::string& strSoundName, const Vector3& vPos = Vector3{ 0, 0, 0 }, const char* groupName,  float fVolumedB)
+/// <returns>id del canal o -1 si no se ha podido reproducir</returns>
+int AudioSystem::playSound(const std::string& strSoundName, const Vector3& vPos = Vector3{ 0, 0, 0 }, const std::string& strBus, float fVolumedB)
 {
-    int nChannelId = instance_->getNextChannelId()++;
-    auto encontrado = instance_->getSoundMap().find(strSoundName);
-    if (encontrado == instance_->getSoundMap().end())
+    AudioSystem* audio = getInstance();
+    auto encontrado = audio->getSoundMap().find(strSoundName);
+    if (encontrado == audio->getSoundMap().end())
     {
         loadSound(strSoundName);
-        encontrado = instance_->getSoundMap().find(strSoundName);
-        if (encontrado == instance_->getSoundMap().end())
+        encontrado = audio->getSoundMap().find(strSoundName);
+        if (encontrado == audio->getSoundMap().end())
         {
-            return nChannelId;
+            return -1;
         }
     }
-    FMOD::Channel* pChannel = nullptr;
-    FMOD::ChannelGroup* pGruoup = nullptr;
-    if (instance_->getChanGroupMap().count(groupName) == 0 && groupName != nullptr)
+    ResourceCache::getInstance()->touch(ResourceCache::Type::Sound, strSoundName);
+    const SoundProps& props = audio->getSoundProperties(strSoundName);
+    int nSlot = audio->acquireVoice(encontrado->second, props);
+    if (nSlot == -1)
+        return -1;
+
+    Bus* bus = audio->getBus(strBus);
+    if (bus == nullptr)
     {
-        pGruoup = createChannelGroup(groupName);
+        std::cout << "WARNING: el bus de audio " << strBus << " no existe, se usa " << MASTER_BUS << "\n";
+        bus = audio->getBus(MASTER_BUS);
     }
-    errorCheck(instance_->getSystem()->playSound(encontrado->second
-        , pGruoup, true, &pChannel));
-    if (pChannel)
-    {
-        FMOD_MODE currMode;
-        encontrado->second->getMode(&currMode);
-        if (currMode & FMOD_3D) {
-            FMOD_VECTOR position = vectorToFmod(vPos);
-            errorCheck(pChannel->set3DAttributes(&position, nullptr));
-        }
-        errorCheck(pChannel->setVolume(dbToVolume(fVolumedB)));
-        errorCheck(pChannel->setPaused(false));
-        instance_->getSoundChannels()[nChannelId] = pChannel;
-    }
-    return nChannelId;
+
+    //El id codifica la posicion en el pool, asi se busca sin recorrerlo
+    int nChannelId = nSlot + MAX_VOICES * (audio->getNextChannelId()++ % (INT_MAX / MAX_VOICES));
+    Voice& voice = audio->mVoices[nSlot];
+    voice.sound = encontrado->second;
+    voice.id = nChannelId;
+    voice.order = audio->mnPlayOrder++;
+    voice.props = props;
+    voice.pending = true;
+    voice.group = bus->group;
+    voice.position = vectorToFmod(vPos);
+    voice.volume = dbToVolume(fVolumedB);
+
+    if (!audio->isLoading(voice.sound))
+        audio->startVoice(nSlot);
+    return audio->getVoice(nChannelId) != nullptr ? nChannelId : -1;
 
 }
 //Para un canal
 void AudioSystem::stopChannel(int nChannelId)
 {
-
-    auto encontrado = instance_->getSoundChannels().find(nChannelId);
-    if (encontrado == instance_->getSoundChannels().end())
+    AudioSystem* audio = getInstance();
+    Voice* voice = audio->getVoice(nChannelId);
+    if (voice == nullptr)
         return;
-    errorCheck(encontrado->second->stop());
+    audio->releaseVoice(nChannelId % MAX_VOICES, true);
 }
 //Para todos los canales
 void AudioSystem::stopAllChannels()
 {
-
-    for (auto x : instance_->getSoundChannels())
-        errorCheck(x.second->stop());
+    AudioSystem* audio = getInstance();
+    for (int i = 0; i < MAX_VOICES; ++i)
+    {
+        if (audio->mVoices[i].id != -1)
+            audio->releaseVoice(i, true);
+    }
 }
 //Coloca un canal en una posicion 3d 
 void AudioSystem::setChannel3dPosition(int nChannelId, const Vector3& vPosition)
 {
-    auto encontrado = instance_->getSoundChannels().find(nChannelId);
-    if (encontrado == instance_->getSoundChannels().end())
+    Voice* voice = getInstance()->getVoice(nChannelId);
+    if (voice == nullptr)
+        return;
+
+    if (voice->pending) {
+        voice->position = vectorToFmod(vPosition);
+        return;
+    }
+    FMOD_VECTOR position = vectorToFmod(vPosition);
+    errorCheck(voice->channel->set3DAttributes(&position, NULL));
+}
+//Coloca un canal en una posicion 3d con velocidad (doppler)
+void AudioSystem::setChannel3dAttributes(int nChannelId, const Vector3& vPosition, const Vector3& vVelocity)
+{
+    Voice* voice = getInstance()->getVoice(nChannelId);
+    if (voice == nullptr)
         return;
 
+    if (voice->pending) {
+        voice->position = vectorToFmod(vPosition);
+        return;
+    }
     FMOD_VECTOR position = vectorToFmod(vPosition);
-    errorCheck(encontrado->second->set3DAttributes(&position, NULL));
+    FMOD_VECTOR velocity = vectorToFmod(vVelocity);
+    errorCheck(voice->channel->set3DAttributes(&position, &velocity));
 }
 //Devuelve true si un canal esta reproduciendose
 bool AudioSystem::isPlaying(int nChannelId) const
 {
-    auto encontrado = instance_->getSoundChannels().find(nChannelId);
-    if (encontrado == instance_->getSoundChannels().end())
+    const Voice* voice = getInstance()->getVoice(nChannelId);
+    if (voice == nullptr)
         return false;
+    if (voice->pending)
+        return true;
     bool isplay = false;
-    errorCheck(instance_->getSoundChannels().at(nChannelId)->isPlaying(&isplay));
+    errorCheck(voice->channel->isPlaying(&isplay));
     return isplay;
 }
 //Si esta pausado el canal lo resume y si esta sonando lo pausa
 void AudioSystem::pause_Resume_Channel(int nChannelId)
 {
-    auto encontrado = instance_->getSoundChannels().find(nChannelId);
-    if (encontrado == instance_->getSoundChannels().end())
+    Voice* voice = getInstance()->getVoice(nChannelId);
+    if (voice == nullptr || voice->pending)
         return;
     bool ch = false;
-    errorCheck(instance_->getSoundChannels().at(nChannelId)->getPaused(&ch));
-    errorCheck(instance_->getSoundChannels().at(nChannelId)->setPaused(!ch));
+    errorCheck(voice->channel->getPaused(&ch));
+    errorCheck(voice->channel->setPaused(!ch));
 
 }
 //Convierte un vector fmod
-FMOD_VECTOR& AudioSystem::vectorToFmod(const Vector3& vPosition)
+FMOD_VECTOR AudioSystem::vectorToFmod(const Vector3& vPosition)
 {
     FMOD_VECTOR fVec;
     fVec.x = vPosition.x;
@@ -277,22 +774,6 @@ FMOD_VECTOR& AudioSystem::vectorToFmod(const Vector3& vPosition)
     fVec.z = vPosition.z;
     return fVec;
 }
-//Crea un grupo de canales
-FMOD::ChannelGroup* AudioSystem::createChannelGroup(const char* name)
-{
-    FMOD::ChannelGroup* channelGroup = nullptr;
-    errorCheck(instance_->getSystem()->createChannelGroup(name, &channelGroup));
-    instance_->getChanGroupMap()[name] = channelGroup;
-    return channelGroup;
-}
-//Mutea un grupo de canales especifico  
-void AudioSystem::muteChannelGroup(const char* name)
-{
-    bool mute = false;
-    errorCheck(instance_->getChanGroupMap()[name]->getMute(&mute));
-    errorCheck(instance_->getChanGroupMap()[name]->setMute(!mute));
-
-}
 
 float  AudioSystem::dbToVolume(float dB)
 {
@@ -307,9 +788,288 @@ float  AudioSystem::volumeTodb(float volume)
 //Cambia el volumen del canal 
 void AudioSystem::setChannelvolume(int nChannelId, float fVolumedB)
 {
-    auto encontrado = instance_->getSoundChannels().find(nChannelId);
-    if (encontrado == instance_->getSoundChannels().end())
+    Voice* voice = getInstance()->getVoice(nChannelId);
+    if (voice == nullptr)
+        return;
+    if (voice->pending) {
+        voice->volume = dbToVolume(fVolumedB);
+        return;
+    }
+
+    errorCheck(voice->channel->setVolume(dbToVolume(fVolumedB)));
+}
+void AudioSystem::createDefaultBuses()
+{
+    Bus& master = mBuses[MASTER_BUS];
+    errorCheck(mpSystem->getMasterChannelGroup(&master.group));
+
+    createBus("music");
+    createBus("sfx");
+    createBus("ui");
+    createBus("voice");
+    setBusDucking("music", "voice");
+}
+
+AudioSystem::Bus* AudioSystem::getBus(const std::string& strBus)
+{
+    auto encontrado = mBuses.find(strBus);
+    return encontrado != mBuses.end() ? &encontrado->second : nullptr;
+}
+
+const AudioSystem::Bus* AudioSystem::getBus(const std::string& strBus) const
+{
+    auto encontrado = mBuses.find(strBus);
+    return encontrado != mBuses.end() ? &encontrado->second : nullptr;
+}
+
+FMOD::DSP* AudioSystem::getBusDSP(Bus& bus, FMOD::DSP*& pDSP, FMOD_DSP_TYPE eType)
+{
+    if (pDSP == nullptr)
+    {
+        errorCheck(mpSystem->createDSPByType(eType, &pDSP));
+        if (pDSP != nullptr)
+            errorCheck(bus.group->addDSP(FMOD_CHANNELCONTROL_DSP_TAIL, pDSP));
+    }
+    return pDSP;
+}
+
+/// <summary>
+/// Carga la configuracion del mezclador. Si el archivo no existe se mantiene
+/// el grafo por defecto
+/// </summary>
+/// <param name="strFile">ruta del json</param>
+void AudioSystem::loadBuses(const std::string& strFile)
+{
+    std::fstream i(strFile);
+    if (!i.is_open())
+        return;
+
+    nlohmann::json config;
+    try {
+        i >> config;
+    }
+    catch (const std::exception& e) {
+        std::cout << "WARNING: no se ha podido leer " << strFile << "\n" << e.what() << "\n";
+        return;
+    }
+    loadBuses(config);
+}
+
+/// <summary>
+/// Lee "Buses", un array de objetos con "name" y opcionalmente "parent"
+/// (por defecto master, debe aparecer antes que sus hijos), "volume" (dB),
+/// "mute", "lowpass" (Hz) y "reverb" { "decay" (ms), "wet" (dB) }; y "Ducking",
+/// un array con "target", "trigger" y opcionalmente "threshold" (dB), "ratio",
+/// "attack" y "release" (ms)
+/// </summary>
+/// <param name="config">objeto json con la configuracion</param>
+void AudioSystem::loadBuses(const nlohmann::json& config)
+{
+    auto buses = config.find("Buses");
+    if (buses != config.end() && buses->is_array())
+    {
+        for (const auto& entry : *buses)
+        {
+            std::string name = entry.value("name", std::string());
+            if (name.empty()) {
+                std::cout << "WARNING: bus de audio sin \"name\"\n";
+                continue;
+            }
+            if (name != MASTER_BUS && createBus(name, entry.value("parent", MASTER_BUS)) == nullptr)
+                continue;
+
+            if (entry.contains("volume"))
+                setBusVolume(name, entry["volume"].get<float>());
+            if (entry.contains("mute"))
+                setBusMute(name, entry["mute"].get<bool>());
+            if (entry.contains("lowpass"))
+                setBusLowpass(name, entry["lowpass"].get<float>());
+            auto reverb = entry.find("reverb");
+            if (reverb != entry.end())
+                setBusReverb(name, reverb->value("decay", 1500.0f), reverb->value("wet", -6.0f));
+        }
+    }
+
+    auto ducking = config.find("Ducking");
+    if (ducking != config.end() && ducking->is_array())
+    {
+        for (const auto& entry : *ducking)
+        {
+            std::string target = entry.value("target", std::string());
+            std::string trigger = entry.value("trigger", std::string());
+            if (target.empty() || trigger.empty()) {
+                std::cout << "WARNING: ducking de audio sin \"target\" o \"trigger\"\n";
+                continue;
+            }
+            setBusDucking(target, trigger, entry.value("threshold", -30.0f), entry.value("ratio", 4.0f),
+                entry.value("attack", 50.0f), entry.value("release", 500.0f));
+        }
+    }
+}
+
+/// <summary>
+/// Crea un bus colgando de otro. Si ya existe se devuelve el que hay
+/// </summary>
+/// <returns>ChannelGroup del bus o nullptr si el padre no existe</returns>
+FMOD::ChannelGroup* AudioSystem::createBus(const std::string& strBus, const std::string& strParent)
+{
+    Bus* bus = getBus(strBus);
+    if (bus != nullptr)
+    {
+        if (bus->parent != strParent && strBus != MASTER_BUS)
+            std::cout << "WARNING: el bus de audio " << strBus << " ya cuelga de " << bus->parent << "\n";
+        return bus->group;
+    }
+
+    Bus* parent = getBus(strParent);
+    if (parent == nullptr)
+    {
+        std::cout << "WARNING: el bus padre " << strParent << " de " << strBus << " no existe\n";
+        return nullptr;
+    }
+
+    FMOD::ChannelGroup* group = nullptr;
+    errorCheck(mpSystem->createChannelGroup(strBus.c_str(), &group));
+    if (group == nullptr)
+        return nullptr;
+    errorCheck(parent->group->addGroup(group));
+
+    Bus& newBus = mBuses[strBus];
+    newBus.group = group;
+    newBus.parent = strParent;
+    return group;
+}
+
+bool AudioSystem::hasBus(const std::string& strBus) const
+{
+    return getBus(strBus) != nullptr;
+}
+
+void AudioSystem::setBusVolume(const std::string& strBus, float fVolumedB)
+{
+    Bus* bus = getBus(strBus);
+    if (bus == nullptr)
+        return;
+    bus->volume = fVolumedB;
+    errorCheck(bus->group->setVolume(dbToVolume(fVolumedB)));
+}
+
+float AudioSystem::getBusVolume(const std::string& strBus) const
+{
+    const Bus* bus = getBus(strBus);
+    return bus != nullptr ? bus->volume : 0.0f;
+}
+
+void AudioSystem::setBusMute(const std::string& strBus, bool bMute)
+{
+    Bus* bus = getBus(strBus);
+    if (bus == nullptr)
+        return;
+    errorCheck(bus->group->setMute(bMute));
+}
+
+bool AudioSystem::isBusMuted(const std::string& strBus) const
+{
+    const Bus* bus = getBus(strBus);
+    bool mute = false;
+    if (bus != nullptr)
+        errorCheck(bus->group->getMute(&mute));
+    return mute;
+}
+
+void AudioSystem::setBusPaused(const std::string& strBus, bool bPaused)
+{
+    Bus* bus = getBus(strBus);
+    if (bus == nullptr)
+        return;
+    errorCheck(bus->group->setPaused(bPaused));
+}
+
+void AudioSystem::setBusLowpass(const std::string& strBus, float fCutoffHz)
+{
+    Bus* bus = getBus(strBus);
+    if (bus == nullptr)
+        return;
+    FMOD::DSP* lowpass = getBusDSP(*bus, bus->lowpass, FMOD_DSP_TYPE_LOWPASS);
+    if (lowpass == nullptr)
+        return;
+    fCutoffHz = std::max(10.0f, std::min(fCutoffHz, 22000.0f));
+    errorCheck(lowpass->setParameterFloat(FMOD_DSP_LOWPASS_CUTOFF, fCutoffHz));
+    //Sin corte el filtro no gasta CPU
+    errorCheck(lowpass->setBypass(fCutoffHz >= 22000.0f));
+}
+
+void AudioSystem::setBusReverb(const std::string& strBus, float fDecayMs, float fWetdB)
+{
+    Bus* bus = getBus(strBus);
+    if (bus == nullptr)
+        return;
+    FMOD::DSP* reverb = getBusDSP(*bus, bus->reverb, FMOD_DSP_TYPE_SFXREVERB);
+    if (reverb == nullptr)
+        return;
+    fDecayMs = std::max(100.0f, std::min(fDecayMs, 20000.0f));
+    fWetdB = std::max(-80.0f, std::min(fWetdB, 20.0f));
+    errorCheck(reverb->setParameterFloat(FMOD_DSP_SFXREVERB_DECAYTIME, fDecayMs));
+    errorCheck(reverb->setParameterFloat(FMOD_DSP_SFXREVERB_WETLEVEL, fWetdB));
+    errorCheck(reverb->setBypass(fWetdB <= -80.0f));
+}
+
+/// <summary>
+/// Pone un compresor en el bus destino cuya entrada de sidechain es la salida
+/// del bus que dispara el ducking. FMOD lo resuelve en el mezclador, sin
+/// trabajo por frame en el motor
+/// </summary>
+/// <param name="strTarget">bus que se atenua (por ejemplo music)</param>
+/// <param name="strTrigger">bus que provoca la atenuacion (por ejemplo voice)</param>
+/// <param name="fThresholddB">nivel del trigger a partir del que se atenua</param>
+/// <param name="fRatio">intensidad de la atenuacion</param>
+/// <param name="fAttackMs">tiempo en atenuar</param>
+/// <param name="fReleaseMs">tiempo en recuperar el volumen</param>
+void AudioSystem::setBusDucking(const std::string& strTarget, const std::string& strTrigger, float fThresholddB,
+    float fRatio, float fAttackMs, float fReleaseMs)
+{
+    Bus* target = getBus(strTarget);
+    Bus* trigger = getBus(strTrigger);
+    if (target == nullptr || trigger == nullptr || target == trigger)
+    {
+        std::cout << "WARNING: no se puede atenuar " << strTarget << " con " << strTrigger << "\n";
+        return;
+    }
+
+    if (target->duckTrigger != strTrigger)
+        removeBusDucking(strTarget);
+
+    bool bNew = target->ducker == nullptr;
+    FMOD::DSP* ducker = getBusDSP(*target, target->ducker, FMOD_DSP_TYPE_COMPRESSOR);
+    if (ducker == nullptr)
         return;
+    errorCheck(ducker->setParameterFloat(FMOD_DSP_COMPRESSOR_THRESHOLD, std::max(-60.0f, std::min(fThresholddB, 0.0f))));
+    errorCheck(ducker->setParameterFloat(FMOD_DSP_COMPRESSOR_RATIO, std::max(1.0f, std::min(fRatio, 50.0f))));
+    errorCheck(ducker->setParameterFloat(FMOD_DSP_COMPRESSOR_ATTACK, std::max(0.1f, std::min(fAttackMs, 500.0f))));
+    errorCheck(ducker->setParameterFloat(FMOD_DSP_COMPRESSOR_RELEASE, std::max(10.0f, std::min(fReleaseMs, 5000.0f))));
 
-    errorCheck(encontrado->second->setVolume(dbToVolume(fVolumedB)));
-}
\ No newline at end of file
+    if (bNew)
+    {
+        FMOD_DSP_PARAMETER_SIDECHAIN sidechain = {};
+        sidechain.sidechainenable = true;
+        errorCheck(ducker->setParameterData(FMOD_DSP_COMPRESSOR_USESIDECHAIN, &sidechain, sizeof(sidechain)));
+
+        FMOD::DSP* triggerHead = nullptr;
+        errorCheck(trigger->group->getDSP(FMOD_CHANNELCONTROL_DSP_HEAD, &triggerHead));
+        if (triggerHead != nullptr)
+            errorCheck(ducker->addInput(triggerHead, nullptr, FMOD_DSPCONNECTION_TYPE_SIDECHAIN));
+        target->duckTrigger = strTrigger;
+    }
+}
+
+void AudioSystem::removeBusDucking(const std::string& strTarget)
+{
+    Bus* target = getBus(strTarget);
+    if (target == nullptr || target->ducker == nullptr)
+        return;
+    errorCheck(target->group->removeDSP(target->ducker));
+    errorCheck(target->ducker->disconnectAll(true, true));
+    errorCheck(target->ducker->release());
+    target->ducker = nullptr;
+    target->duckTrigger.clear();
+}
@@ -1,11 +1,14 @@
 #include "..\..\include\Common\CommonManager.h"
+#include "EngineContext.h"
 #include "..\..\include\Common\CommonManager.h"
 #include "..\..\include\Common\CommonManager.h"
 #include "Entity.h"
 #include "Transform.h"
 #include "CommonManager.h"
+#include "SimdMath.h"
+#include <algorithm>
 
-CommonManager* CommonManager::_instance = nullptr;
+static_assert((int)CommonManager::CommonCmpId::LastCommonCmpId == NATIVE_COMPONENTS[(int)ManID::Common], "Update NATIVE_COMPONENTS in ComponentTypes.h");
 
 CommonManager::CommonManager() : Manager(ManID::Common) {
 	registerComponent("Transform", (int)CommonCmpId::TransId, []() -> Transform* { return new Transform(); });
@@ -17,14 +20,15 @@ CommonManager::~CommonManager() {
 
 CommonManager* CommonManager::getInstance() {
 
-	return _instance;
+	return EngineContext::current()->common;
 }
 
 bool CommonManager::setUpInstance()
 {
-	if (!_instance) {
+	EngineContext* ctx = EngineContext::current();
+	if (!ctx->common) {
 		try {
-			_instance = new CommonManager();
+			ctx->common = new CommonManager();
 		}
 		catch (...) {
 			return false;
@@ -35,21 +39,164 @@ bool CommonManager::setUpInstance()
 
 void CommonManager::clean()
 {
-	_instance->destroyAllComponents();
+	getInstance()->destroyAllComponents();
 }
 
 void CommonManager::destroy()
 {
-	_instance->clean();
-	delete _instance;
+	getInstance()->clean();
+	delete getInstance();
+	EngineContext::current()->common = nullptr;
 }
 
+// Primero todos buscan su padre y luego se calcula el estado de mundo, asi
+// los demas managers lo tienen listo en su start
 void CommonManager::start() {
-
+	for (size_t i = 0; i < _compsList.size(); ++i)
+		_compsList[i]->setUp();
+	updateWorldTransforms();
 }
 
 void CommonManager::update(float deltaTime) {
+	updateWorldTransforms();
+}
+
+void CommonManager::composeWorld(size_t slot)
+{
+	TransformArrays& t = transforms_;
+	const Transform* tr = t.owners[slot];
+
+	Vector3 pos(t.posX[slot], t.posY[slot], t.posZ[slot]);
+	Vector3 scale(t.scaleX[slot], t.scaleY[slot], t.scaleZ[slot]);
+	Quaternion rot = tr->getLocalRotation();
+
+	// Lo que mueve la fisica ya esta en coordenadas de mundo
+	const Transform* parent = tr->physicsDriven_ ? nullptr : tr->parent_;
+	if (parent != nullptr) {
+		size_t p = parent->slot_;
+		pos = t.world[p].transformPoint(pos);
+		rot = t.worldRot[p] * rot;
+		const Vector3& ps = t.worldScale[p];
+		scale = Vector3(ps.x * scale.x, ps.y * scale.y, ps.z * scale.z);
+	}
+
+	t.worldRot[slot] = rot;
+	t.worldScale[slot] = scale;
+	t.world[slot] = Matrix4::fromTRS(pos, rot, scale);
+}
+
+void CommonManager::updateWorldTransforms()
+{
+	TransformArrays& t = transforms_;
+	if (orderDirty_) {
+		order_ = t.owners;
+		std::stable_sort(order_.begin(), order_.end(),
+			[](const Transform* a, const Transform* b) { return a->depth_ < b->depth_; });
+		orderDirty_ = false;
+	}
+
+	// Un hueco se recalcula si ha cambiado el o su padre en esta pasada
+	changed_.assign(t.size(), 0);
+	for (Transform* tr : order_) {
+		size_t s = tr->slot_;
+		const Transform* parent = tr->physicsDriven_ ? nullptr : tr->parent_;
+		if (!t.dirty[s] && !(parent && changed_[parent->slot_]))
+			continue;
+		composeWorld(s);
+		changed_[s] = 1;
+		t.dirty[s] = 0;
+	}
+}
+
+void CommonManager::updateWorldTransform(Transform* tr)
+{
+	if (tr->parent_ != nullptr && !tr->physicsDriven_)
+		updateWorldTransform(tr->parent_);
+	composeWorld(tr->slot_);
+}
+
+void CommonManager::fixedUpdate(float deltaTime)
+{
+	TransformArrays& t = transforms_;
+	if (t.kinematicCount == 0) return;
+	simd::integrate(t.posX.data(), t.posY.data(), t.posZ.data(),
+		t.velX.data(), t.velY.data(), t.velZ.data(), deltaTime, t.kinematicCount);
+
+	// Los que se han movido se recalculan en la siguiente pasada
+	for (size_t i = 0; i < t.kinematicCount; i++)
+		if (t.velX[i] != 0.0f || t.velY[i] != 0.0f || t.velZ[i] != 0.0f)
+			t.dirty[i] = 1;
+}
+
+size_t CommonManager::addTransform(Transform* tr)
+{
+	TransformArrays& t = transforms_;
+	for (auto* arr : { &t.posX, &t.posY, &t.posZ, &t.velX, &t.velY, &t.velZ, &t.rotX, &t.rotY, &t.rotZ })
+		arr->push_back(0.0f);
+	t.scaleX.push_back(1.0f); t.scaleY.push_back(1.0f); t.scaleZ.push_back(1.0f);
+	t.world.push_back(Matrix4());
+	t.worldRot.push_back(Quaternion());
+	t.worldScale.push_back(Vector3(1.0f, 1.0f, 1.0f));
+	t.dirty.push_back(1);
+	t.owners.push_back(tr);
+	orderDirty_ = true;
 
+	// Los nuevos no son cinematicos hasta que lo pidan, van al final
+	return t.size() - 1;
+}
+
+void CommonManager::removeTransform(size_t slot)
+{
+	TransformArrays& t = transforms_;
+	// Primero se lleva al final de su particion y luego al final de todo
+	if (slot < t.kinematicCount) {
+		swapSlots(slot, t.kinematicCount - 1);
+		slot = --t.kinematicCount;
+	}
+	swapSlots(slot, t.size() - 1);
+	popSlot();
+	orderDirty_ = true;
+}
+
+void CommonManager::setKinematic(size_t slot, bool kinematic)
+{
+	TransformArrays& t = transforms_;
+	bool isKinematic = slot < t.kinematicCount;
+	if (isKinematic == kinematic) return;
+
+	if (kinematic)
+		swapSlots(slot, t.kinematicCount++);
+	else
+		swapSlots(slot, --t.kinematicCount);
+}
+
+void CommonManager::swapSlots(size_t a, size_t b)
+{
+	if (a == b) return;
+	TransformArrays& t = transforms_;
+	for (auto* arr : { &t.posX, &t.posY, &t.posZ, &t.velX, &t.velY, &t.velZ,
+		&t.rotX, &t.rotY, &t.rotZ, &t.scaleX, &t.scaleY, &t.scaleZ })
+		std::swap((*arr)[a], (*arr)[b]);
+	std::swap(t.world[a], t.world[b]);
+	std::swap(t.worldRot[a], t.worldRot[b]);
+	std::swap(t.worldScale[a], t.worldScale[b]);
+	std::swap(t.dirty[a], t.dirty[b]);
+	std::swap(t.owners[a], t.owners[b]);
+	t.owners[a]->slot_ = a;
+	t.owners[b]->slot_ = b;
+}
+
+void CommonManager::popSlot()
+{
+	TransformArrays& t = transforms_;
+	for (auto* arr : { &t.posX, &t.posY, &t.posZ, &t.velX, &t.velY, &t.velZ,
+		&t.rotX, &t.rotY, &t.rotZ, &t.scaleX, &t.scaleY, &t.scaleZ })
+		arr->pop_back();
+	t.world.pop_back();
+	t.worldRot.pop_back();
+	t.worldScale.pop_back();
+	t.dirty.pop_back();
+	t.owners.pop_back();
 }
 
 void CommonManager::addComponent(Entity* ent, int compId) {
@@ -65,7 +212,7 @@ void CommonManager::addComponent(Entity* ent, int compId) {
 	}
 	if (!comp)
 		throw ("ERROR: Common Manager couldn't create a component with an Id: ", compId, "\n");
-	_compsList.push_back(comp);
+	addToList(comp);
 	comp->setEntity(ent);
 	ent->addComponent(comp);
 }
\ No newline at end of file
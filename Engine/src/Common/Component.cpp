@@ -1,6 +1,7 @@
 #include "Component.h"
 #include "Entity.h"
 #include "Manager.h"
+#include "Reflection.h"
 
 Component::Component(Manager* man, int id) : _manager(man), _id(id) {
 
@@ -24,7 +25,10 @@ bool Component::isActive() const {
 }
 
 void Component::setActive(bool act) {
+	if (_active == act) return;
 	_active = act;
+	if (_manager)
+		_manager->setComponentActive(this);
 }
 
 Entity* Component::getEntity() const {
@@ -41,4 +45,14 @@ Manager* Component::getManager() const {
 
 void Component::setUp() {
 
+}
+
+const Reflection::TypeInfo* Component::getTypeInfo() const {
+	return nullptr;
+}
+
+void Component::loadFields(const nlohmann::json& params) {
+	const Reflection::TypeInfo* type = getTypeInfo();
+	if (type != nullptr)
+		Reflection::loadJson(*type, this, params);
 }
\ No newline at end of file
@@ -0,0 +1,274 @@
+#include "EngineContext.h"
+#include "StartupGraph.h"
+
+#include <stdexcept>
+
+#include "Managers/SceneManager.h"
+#include "Graphics/OgreContext.h"
+#include "Input/InputSystem.h"
+#include "CommonManager.h"
+#include "Graphics/RenderManager.h"
+#include "Physics/PhysicsManager.h"
+#include "UIManager.h"
+#include "LUA/LUAManager.h"
+#include "AudioSystem.h"
+#include "Navigation/NavigationManager.h"
+#include "Network/NetworkManager.h"
+
+thread_local EngineContext* EngineContext::current_ = nullptr;
+
+EngineContext::Scope::Scope(EngineContext* ctx) : prev_(current_)
+{
+	current_ = ctx;
+}
+
+EngineContext::Scope::~Scope()
+{
+	current_ = prev_;
+}
+
+EngineContext::EngineContext(bool headless) : headless_(headless)
+{
+}
+
+EngineContext::~EngineContext()
+{
+	destroy();
+}
+
+EngineContext* EngineContext::current()
+{
+	return current_;
+}
+
+void EngineContext::bind(EngineContext* ctx)
+{
+	current_ = ctx;
+}
+
+void EngineContext::setUp(const std::string& appName)
+{
+	StartupGraph graph;
+	addSetUpSteps(graph, appName);
+	graph.run(this);
+}
+
+void EngineContext::addSetUpSteps(StartupGraph& graph, const std::string& appName)
+{
+	if (current_ != this)
+		throw std::runtime_error("ERROR: EngineContext must be bound to the thread before setUp\n");
+
+	std::vector<std::string> managers;
+	auto addManager = [&graph, &managers](const std::string& name, bool (*setUpInstance)(),
+		const std::vector<std::string>& deps, bool mainThread) {
+		graph.addStep(name, [name, setUpInstance]() {
+			if (!setUpInstance())
+				throw std::runtime_error("ERROR: Couldn't load " + name + "\n");
+		}, deps, mainThread);
+		managers.push_back(name);
+	};
+
+	// Ogre y CEGUI tienen que ir en el hilo de la ventana
+	bool physicsOnMain = false;
+	std::vector<std::string> physicsDeps;
+	if (!headless_) {
+		graph.addStep("OgreContext", [appName]() {
+			if (!OgreContext::setUpInstance(appName))
+				throw std::exception("ERROR: Couldn't load OgreContext\n");
+		}, {}, true);
+		managers.push_back("OgreContext");
+		addManager("InputSystem", &InputSystem::setUpInstance, {}, false);
+		addManager("UIManager", &UIManager::setUpInstance, { "OgreContext" }, true);
+		addManager("RenderManager", &RenderManager::setUpInstance, { "OgreContext" }, false);
+		// FMOD arranca su propio hilo de mezcla, no depende de nadie
+		addManager("AudioSystem", &AudioSystem::setupInstance, {}, false);
+#ifdef _DEBUG
+		// El dibujado de depuracion de Bullet crea objetos de Ogre
+		physicsOnMain = true;
+		physicsDeps.push_back("OgreContext");
+#endif
+	}
+
+	addManager("PhysicsManager", &PhysicsManager::setUpInstance, physicsDeps, physicsOnMain);
+	addManager("SceneManager", &SceneManager::setupInstance, {}, false);
+	addManager("CommonManager", &CommonManager::setUpInstance, {}, false);
+	addManager("LUAManager", &LUAManager::setUpInstance, {}, false);
+	addManager("NavigationManager", &NavigationManager::setUpInstance, {}, false);
+	addManager("NetworkManager", &NetworkManager::setUpInstance, {}, false);
+
+	// Sin ventana los componentes de render, interfaz y audio no se cargan
+	graph.addStep("managers", [this]() {
+		registerManager("Physics", phys);
+		registerManager("Common", common);
+		registerManager("LUA", lua);
+		registerManager("Navigation", nav);
+		registerManager("Network", net);
+		if (!headless_) {
+			registerManager("Render", render);
+			registerManager("UI", gui);
+			registerManager("Audio", audio);
+		}
+	}, managers);
+}
+
+void EngineContext::loadScenes(const std::string& scenesFile)
+{
+	scenes->createStartScene(scenesFile);
+}
+
+void EngineContext::start()
+{
+	//Jerarquia y estado de mundo antes que los que lo leen
+	common->start();
+	if (render) render->start();
+	phys->start();
+	//Despues de render y fisica: hornea con sus transforms ya colocados
+	nav->start();
+	lua->start();
+	net->start();
+	if (audio) audio->start();
+}
+
+void EngineContext::update(float deltaTime)
+{
+	lua->update(deltaTime);
+	//Los agentes dan su velocidad a los rigidbodies antes de la fisica
+	nav->update(deltaTime);
+	phys->update(deltaTime);
+	//El servidor manda el estado ya simulado y el cliente lo pisa
+	net->update(deltaTime);
+	//Con las posiciones ya finales se recalcula el estado de mundo
+	common->update(deltaTime);
+	//Los cambios de la interfaz se aplican antes de renderizar
+	if (gui) gui->update(deltaTime);
+	if (render) render->update(deltaTime);
+	if (audio) audio->update(deltaTime);
+	scenes->update();
+}
+
+void EngineContext::fixedUpdate(float deltaTime)
+{
+	lua->fixedUpdate(deltaTime);
+	common->fixedUpdate(deltaTime);
+	phys->fixedUpdate(deltaTime);
+}
+
+void EngineContext::step(float deltaTime)
+{
+	update(deltaTime);
+	fixedTimer_ += deltaTime;
+	if (fixedTimer_ > fixedStep_) {
+		fixedUpdate(deltaTime);
+		fixedTimer_ = 0.0f;
+	}
+}
+
+void EngineContext::clean()
+{
+	if (input) input->clean();
+	if (audio) audio->clean();
+
+	// render
+	if (render) render->clean();
+	if (gui) gui->clean();
+	if (!headless_) OgreContext::getInstance()->clean();
+
+	// red
+	net->clean();
+
+	// navegacion
+	nav->clean();
+
+	// fisicas
+	phys->clean();
+
+	// common
+	common->clean();
+
+	// logica
+	lua->clean();
+
+	// escena
+	scenes->clean();
+}
+
+// Cada destroy deja su hueco a nullptr, asi se puede llamar mas de una vez
+void EngineContext::destroy()
+{
+	Scope scope(this);
+
+	// sistemas
+	if (input) input->destroy();
+	if (audio) audio->destroy();
+
+	// red (cierra la conexion)
+	if (net) net->destroy();
+
+	// navegacion (antes que la fisica, hornea con sus rigidbodies)
+	if (nav) nav->destroy();
+
+	// fisicas
+	if (phys) phys->destroy();
+
+	// render
+	if (render) render->destroy();
+	if (gui) gui->destroy();
+	if (!headless_ && OgreContext::getInstance()) OgreContext::getInstance()->destroy();
+
+	// common
+	if (common) common->destroy();
+
+	// logica
+	if (lua) lua->destroy();
+
+	// escena
+	if (scenes) scenes->destroy();
+
+	manRegistry_.clear();
+	manNames_.clear();
+	for (Manager*& man : managers_)
+		man = nullptr;
+}
+
+bool EngineContext::isHeadless() const
+{
+	return headless_;
+}
+
+bool EngineContext::isRunning() const
+{
+	return running_;
+}
+
+void EngineContext::close()
+{
+	running_ = false;
+}
+
+void EngineContext::setFixedStep(float seconds)
+{
+	fixedStep_ = seconds;
+}
+
+const std::map<std::string, Manager*>& EngineContext::getManagers() const
+{
+	return manRegistry_;
+}
+
+void EngineContext::registerManager(const std::string& type, Manager* man)
+{
+	manRegistry_[type] = man;
+	manNames_.insert(type, man->getId());
+	managers_[man->getId()] = man;
+}
+
+Manager* EngineContext::getManager(const std::string& type) const
+{
+	int id = manNames_.find(type);
+	return id >= 0 ? managers_[id] : nullptr;
+}
+
+Manager* EngineContext::getManager(ManID id) const
+{
+	return managers_[(int)id];
+}
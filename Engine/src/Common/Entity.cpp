@@ -7,41 +7,54 @@ Entity::Entity() {
 }
 
 Entity::~Entity() {
-	for (auto it = _componentMap.begin(); it != _componentMap.end(); ++it)
-	{
-		for (auto it2 = it->second.begin(); it2 != it->second.end(); it2 = it->second.begin()) {
-			int id = it2->second->getId();
-			//removeComponent(it->first, id);
-			if (!removeComponent(it2->second->getManager()->getId(), id))
-				throw std::runtime_error("ERROR: Tried to destroy a non existant component while destroying the entity\n");
-		}
-	}
+	// Los componentes los destruye su manager, aqui solo se sueltan
+	for (Component*& c : _native)
+		c = nullptr;
+	_componentMap.clear();
 }
 
 void Entity::start()
 {
-	for (auto it = _componentMap.begin(); it != _componentMap.end(); ++it)
-	{
-		for (auto it2 = it->second.begin(); it2 != it->second.end(); ++it2) {
-			it2->second->setUp();
+	for (int man = 0; man < (int)ManID::LastManId; ++man) {
+		for (int id = 0; id < NATIVE_COMPONENTS[man]; ++id) {
+			Component* c = _native[nativeComponentOffset(man) + id];
+			if (c) c->setUp();
 		}
+		auto it = _componentMap.find(man);
+		if (it == _componentMap.end()) continue;
+		for (auto it2 = it->second.begin(); it2 != it->second.end(); ++it2)
+			it2->second->setUp();
 	}
 }
 
 void Entity::destroy()
 {
-	for (auto it = _componentMap.begin(); it != _componentMap.end(); ++it)
-	{
-		for (auto it2 = it->second.begin(); it2 != it->second.end(); it2 = it->second.begin()) {	
-			int id = it2->second->getId();
-			it2->second->getManager()->destroyComponent(this, id);
+	// Cada componente se quita de la entidad en su destructora
+	for (int man = 0; man < (int)ManID::LastManId; ++man) {
+		for (int id = 0; id < NATIVE_COMPONENTS[man]; ++id) {
+			Component* c = _native[nativeComponentOffset(man) + id];
+			if (c && !c->getManager()->destroyComponent(this, id))
+				removeComponent(man, id);
+		}
+		auto it = _componentMap.find(man);
+		if (it == _componentMap.end()) continue;
+		while (!it->second.empty()) {
+			Component* c = it->second.begin()->second;
+			int id = c->getId();
+			if (!c->getManager()->destroyComponent(this, id))
+				removeComponent(man, id);
 		}
 	}
 }
 
 void Entity::addComponent(Component* comp)
 {
-	_componentMap[comp->getManager()->getId()][comp->getId()] = comp;
+	int man = comp->getManager()->getId();
+	int index = nativeComponentIndex(man, comp->getId());
+	if (index >= 0)
+		_native[index] = comp;
+	else
+		_componentMap[man][comp->getId()] = comp;
 }
 
 const std::string& Entity::getName() const
@@ -56,11 +69,22 @@ void Entity::setName(const std::string& name)
 
 Component* Entity::getComponent(int managerId, int compId)
 {
-	return _componentMap[managerId][compId];
+	int index = nativeComponentIndex(managerId, compId);
+	if (index >= 0)
+		return _native[index];
+
+	auto man = _componentMap.find(managerId);
+	if (man == _componentMap.end()) return nullptr;
+	auto it = man->second.find(compId);
+	return it != man->second.end() ? it->second : nullptr;
 }
 
 bool Entity::hasComponent(int managerId, int compId) const
 {
+	int index = nativeComponentIndex(managerId, compId);
+	if (index >= 0)
+		return _native[index] != nullptr;
+
 	auto man = _componentMap.find(managerId);
 	if (man != _componentMap.end()) {
 		return man->second.find(compId) != man->second.end();
@@ -69,6 +93,13 @@ bool Entity::hasComponent(int managerId, int compId) const
 }
 
 bool Entity::removeComponent(int managerId, int compId) {
+	int index = nativeComponentIndex(managerId, compId);
+	if (index >= 0) {
+		if (_native[index] == nullptr) return false;
+		_native[index] = nullptr;
+		return true;
+	}
+
 	auto itMaps = _componentMap.find(managerId);
 	if (itMaps != _componentMap.end()) {
 		auto it = itMaps->second.find(compId);
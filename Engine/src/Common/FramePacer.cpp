@@ -0,0 +1,151 @@
+#include "FramePacer.h"
+#include <thread>
+#include <algorithm>
+#include <cmath>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+FramePacer::FramePacer()
+{
+#ifdef _WIN32
+	// Por defecto Windows duerme con una granularidad de ~15ms
+	timeBeginPeriod(1);
+#endif
+}
+
+FramePacer::~FramePacer()
+{
+#ifdef _WIN32
+	timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::setTargetFps(int fps)
+{
+	targetFps_ = std::max(0, fps);
+}
+
+int FramePacer::getTargetFps() const
+{
+	return targetFps_;
+}
+
+void FramePacer::setBackgroundFps(int fps)
+{
+	backgroundFps_ = std::max(0, fps);
+}
+
+void FramePacer::setMinimizedFps(int fps)
+{
+	minimizedFps_ = std::max(0, fps);
+}
+
+void FramePacer::setVSync(bool vsync)
+{
+	vsync_ = vsync;
+}
+
+void FramePacer::setFocused(bool focused)
+{
+	focused_ = focused;
+}
+
+void FramePacer::setMinimized(bool minimized)
+{
+	minimized_ = minimized;
+}
+
+int FramePacer::currentFps() const
+{
+	if (minimized_) return minimizedFps_;
+	if (!focused_) return backgroundFps_;
+	if (vsync_) return 0;
+	return targetFps_;
+}
+
+float FramePacer::beginFrame()
+{
+	Clock::time_point now = Clock::now();
+	float delta = 0.0f;
+	if (!firstFrame_) {
+		delta = std::chrono::duration<float>(now - frameStart_).count();
+		pushStats(delta * 1000.0f);
+	}
+	firstFrame_ = false;
+	frameStart_ = now;
+	return delta;
+}
+
+void FramePacer::endFrame()
+{
+	stats_.workMs = std::chrono::duration<float, std::milli>(Clock::now() - frameStart_).count();
+
+	int fps = currentFps();
+	if (fps <= 0) return;
+
+	auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps));
+	waitUntil(frameStart_ + period);
+}
+
+void FramePacer::reset()
+{
+	firstFrame_ = true;
+}
+
+// Duerme en tramos de 1ms mientras quede mas tiempo que el error estimado del
+// sleep y el resto lo espera activamente, asi no se pasa del objetivo
+void FramePacer::waitUntil(Clock::time_point target)
+{
+	using namespace std::chrono;
+
+	double remaining = duration<double>(target - Clock::now()).count();
+	while (remaining > sleepEstimate_) {
+		Clock::time_point start = Clock::now();
+		std::this_thread::sleep_for(milliseconds(1));
+		double observed = duration<double>(Clock::now() - start).count();
+
+		sleepCount_++;
+		double d = observed - sleepMean_;
+		sleepMean_ += d / sleepCount_;
+		sleepM2_ += d * (observed - sleepMean_);
+		double stddev = std::sqrt(sleepM2_ / (sleepCount_ - 1));
+		sleepEstimate_ = sleepMean_ + stddev;
+
+		remaining -= observed;
+	}
+
+	while (Clock::now() < target)
+		std::this_thread::yield();
+}
+
+void FramePacer::pushStats(float frameMs)
+{
+	history_[historyIdx_] = frameMs;
+	historyIdx_ = (historyIdx_ + 1) % STATS_WINDOW;
+	historySize_ = std::min(historySize_ + 1, STATS_WINDOW);
+
+	float sum = 0.0f;
+	float mn = history_[0], mx = history_[0];
+	for (int i = 0; i < historySize_; i++) {
+		sum += history_[i];
+		mn = std::min(mn, history_[i]);
+		mx = std::max(mx, history_[i]);
+	}
+
+	stats_.lastMs = frameMs;
+	stats_.avgMs = sum / historySize_;
+	stats_.minMs = mn;
+	stats_.maxMs = mx;
+	stats_.fps = stats_.avgMs > 0.0f ? 1000.0f / stats_.avgMs : 0.0f;
+	stats_.frames++;
+}
+
+const FramePacer::FrameStats& FramePacer::getStats() const
+{
+	return stats_;
+}
@@ -1,6 +1,7 @@
 #include "Manager.h"
 #include "Component.h"
 #include "Entity.h"
+#include <algorithm>
 
 Manager::Manager(ManID id) : _manId(id) {
 
@@ -10,43 +11,94 @@ Manager::~Manager() {
 	destroyAllComponents();
 }
 
-int Manager::getCompID(const std::string& s)
+int Manager::getCompID(const std::string& s) const
 {
-	auto e = enum_map_.find(s);
-	if (e != enum_map_.end())
-		return e->second;
-	return -1;
+	return enum_map_.find(s);
 }
 
-const std::list<Component*>& Manager::getComponents() {
+const std::vector<Component*>& Manager::getComponents() {
 	return _compsList;
 }
 
-const std::list<Component*>& Manager::getComponents() const {
+const std::vector<Component*>& Manager::getComponents() const {
 	return _compsList;
 }
 
+size_t Manager::getActiveCount() const {
+	return _activeCount;
+}
+
 void Manager::destroyAllComponents() {
-	for (auto it = _compsList.begin(); it != _compsList.end(); it = _compsList.begin())
-	{
-		delete* it;
-		(*it) = nullptr;
-		_compsList.erase(it);
+	// Se vacia antes por si algun destructor vuelve a llamar al manager
+	std::vector<Component*> comps;
+	comps.swap(_compsList);
+	_activeCount = 0;
+	_pendingToggles.clear();
+	for (Component* c : comps) {
+		c->_slot = -1;
+		delete c;
 	}
 }
 
 bool Manager::destroyComponent(Entity* ent, int compId) {
-	auto it = _compsList.begin();
-	for (; it != _compsList.end(); it++) {
-		if ((*it)->getEntity() == ent) {
-			delete *it;
-			_compsList.erase(it);
+	for (Component* c : _compsList) {
+		if (c->getEntity() == ent && c->getId() == compId) {
+			removeFromList(c);
+			delete c;
 			return true;
 		}
 	}
 	return false;
 }
 
+void Manager::addToList(Component* comp) {
+	comp->_slot = (int)_compsList.size();
+	_compsList.push_back(comp);
+	movePartition(comp);
+}
+
+void Manager::removeFromList(Component* comp) {
+	size_t i = comp->_slot;
+	// Primero sale de los activos y luego se tapa el hueco con el ultimo
+	if (i < _activeCount) {
+		size_t last = --_activeCount;
+		std::swap(_compsList[i], _compsList[last]);
+		_compsList[i]->_slot = (int)i;
+		i = last;
+	}
+	_compsList[i] = _compsList.back();
+	_compsList[i]->_slot = (int)i;
+	_compsList.pop_back();
+	comp->_slot = -1;
+
+	auto it = std::find(_pendingToggles.begin(), _pendingToggles.end(), comp);
+	if (it != _pendingToggles.end())
+		_pendingToggles.erase(it);
+}
+
+void Manager::movePartition(Component* comp) {
+	if (comp->_slot < 0) return;
+	size_t i = comp->_slot;
+	size_t to;
+	if (comp->isActive() && i >= _activeCount)
+		to = _activeCount++;
+	else if (!comp->isActive() && i < _activeCount)
+		to = --_activeCount;
+	else
+		return;
+	std::swap(_compsList[i], _compsList[to]);
+	_compsList[i]->_slot = (int)i;
+	_compsList[to]->_slot = (int)to;
+}
+
+void Manager::setComponentActive(Component* comp) {
+	if (comp->_slot < 0 || comp->getManager() != this) return;
+	if (_iterating > 0)
+		_pendingToggles.push_back(comp);
+	else
+		movePartition(comp);
+}
+
 int Manager::getId() {
 	return (int)_manId;
 }
@@ -57,18 +109,24 @@ int Manager::getId() const {
 
 void Manager::registerComponent(const std::string& name, int id, std::function<Component * ()> compConst)
 {
-	enum_map_[name] = id;
+	enum_map_.insert(name, id);
+	if ((int)compsRegistry_.size() <= id)
+		compsRegistry_.resize(id + 1);
 	compsRegistry_[id] = compConst;
 }
 
 Component* Manager::create(const std::string& name, Entity* ent)
+{
+	return create(getCompID(name), ent);
+}
+
+Component* Manager::create(int compId, Entity* ent)
 {
 	Component* comp = nullptr;
-	auto it = compsRegistry_.find(enum_map_[name]);
-	if (it != compsRegistry_.end())
-		comp = it->second();
+	if (compId >= 0 && compId < (int)compsRegistry_.size() && compsRegistry_[compId])
+		comp = compsRegistry_[compId]();
 	if (comp != nullptr) {
-		_compsList.push_back(comp);
+		addToList(comp);
 		comp->setEntity(ent);
 		return comp;
 	}
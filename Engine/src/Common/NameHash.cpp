@@ -0,0 +1,68 @@
+#include "NameHash.h"
+
+// FNV-1a con la semilla mezclada en la base
+uint32_t NameHash::hash(const std::string& name, uint32_t seed)
+{
+	uint32_t h = 2166136261u ^ (seed * 16777619u);
+	for (unsigned char c : name) {
+		h ^= c;
+		h *= 16777619u;
+	}
+	return h ^ (h >> 15);
+}
+
+void NameHash::insert(const std::string& name, int value)
+{
+	for (auto& e : entries_) {
+		if (e.first == name) {
+			e.second = value;
+			return;
+		}
+	}
+	entries_.push_back({ name, value });
+	rebuild();
+}
+
+void NameHash::rebuild()
+{
+	// Con el doble de casillas que nombres suele bastar con pocas semillas;
+	// si no aparece ninguna se agranda la tabla
+	size_t size = 1;
+	while (size < entries_.size() * 2) size <<= 1;
+
+	for (;; size <<= 1) {
+		for (uint32_t seed = 0; seed < 256; ++seed) {
+			slots_.assign(size, -1);
+			bool ok = true;
+			for (size_t i = 0; i < entries_.size() && ok; ++i) {
+				int& slot = slots_[hash(entries_[i].first, seed) & (size - 1)];
+				if (slot != -1) ok = false;
+				else slot = (int)i;
+			}
+			if (ok) {
+				seed_ = seed;
+				return;
+			}
+		}
+	}
+}
+
+int NameHash::find(const std::string& name) const
+{
+	if (slots_.empty()) return -1;
+	int i = slots_[hash(name, seed_) & (slots_.size() - 1)];
+	if (i == -1 || entries_[i].first != name) return -1;
+	return entries_[i].second;
+}
+
+size_t NameHash::size() const
+{
+	return entries_.size();
+}
+
+void NameHash::clear()
+{
+	entries_.clear();
+	slots_.clear();
+	seed_ = 0;
+}
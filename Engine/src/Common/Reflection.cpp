@@ -0,0 +1,187 @@
+#include "Reflection.h"
+
+namespace Reflection {
+
+	namespace {
+		std::string fieldPath(const TypeInfo& type, const Field& f)
+		{
+			return type.getName() + "." + f.name;
+		}
+
+		std::string indexPath(const std::string& path, size_t i)
+		{
+			return path + "[" + std::to_string(i) + "]";
+		}
+
+		float readNumber(const nlohmann::json& value, const std::string& path)
+		{
+			if (!value.is_number())
+				throw Error(path, "expected a number");
+			return value.get<float>();
+		}
+
+		// Los n primeros de un array, sin crear un std::vector por medio
+		void readFloats(const nlohmann::json& value, float* out, size_t n, const std::string& path)
+		{
+			if (!value.is_array() || value.size() < n)
+				throw Error(path, "expected an array of " + std::to_string(n) + " numbers");
+			for (size_t i = 0; i < n; i++) {
+				const nlohmann::json& v = value[i];
+				if (!v.is_number())
+					throw Error(indexPath(path, i), "expected a number");
+				out[i] = v.get<float>();
+			}
+		}
+
+		// Lee el valor del tipo del campo y se lo pasa al setter
+		void applyJson(const Field& f, Component* c, const nlohmann::json& value, const std::string& path)
+		{
+			switch (f.type) {
+			case FieldType::Bool: {
+				if (!value.is_boolean())
+					throw Error(path, "expected a boolean");
+				bool b = value.get<bool>();
+				f.set(c, &b);
+				break;
+			}
+			case FieldType::Int: {
+				if (!value.is_number())
+					throw Error(path, "expected an integer");
+				int i = value.get<int>();
+				f.set(c, &i);
+				break;
+			}
+			case FieldType::Float: {
+				float x = readNumber(value, path);
+				f.set(c, &x);
+				break;
+			}
+			case FieldType::String: {
+				if (!value.is_string())
+					throw Error(path, "expected a string");
+				f.set(c, &value.get_ref<const std::string&>());
+				break;
+			}
+			case FieldType::Vector2: {
+				float v[2];
+				readFloats(value, v, 2, path);
+				std::pair<float, float> p(v[0], v[1]);
+				f.set(c, &p);
+				break;
+			}
+			case FieldType::Vector3: {
+				float v[3];
+				readFloats(value, v, 3, path);
+				Vector3 p(v[0], v[1], v[2]);
+				f.set(c, &p);
+				break;
+			}
+			case FieldType::FloatList: {
+				if (!value.is_array())
+					throw Error(path, "expected an array of numbers");
+				std::vector<float> list(value.size());
+				for (size_t i = 0; i < list.size(); i++)
+					list[i] = readNumber(value[i], indexPath(path, i));
+				f.set(c, &list);
+				break;
+			}
+			}
+		}
+	}
+
+#pragma region Tipos
+
+	Error::Error(const std::string& path, const std::string& problem) :
+		std::runtime_error("ERROR: " + path + ": " + problem + "\n"), path_(path)
+	{
+	}
+
+	const std::string& Error::getPath() const
+	{
+		return path_;
+	}
+
+	Field::Field(const char* name_, FieldType type_, Getter get_, Setter set_) :
+		name(name_), type(type_), get(get_), set(set_)
+	{
+	}
+
+	Field Field::required() const
+	{
+		Field f = *this;
+		f.isRequired = true;
+		return f;
+	}
+
+	Field Field::loadOnly() const
+	{
+		Field f = *this;
+		f.isLoadOnly = true;
+		return f;
+	}
+
+	TypeInfo::TypeInfo(const std::string& name, std::initializer_list<Field> fields, const TypeInfo* base) :
+		name_(name)
+	{
+		if (base != nullptr)
+			fields_ = base->fields_;
+		fields_.insert(fields_.end(), fields.begin(), fields.end());
+		if (fields_.size() > MAX_FIELDS)
+			throw std::runtime_error("ERROR: " + name_ + " declares too many fields\n");
+
+		for (size_t i = 0; i < fields_.size(); i++)
+			index_.insert(fields_[i].name, (int)i);
+	}
+
+	const std::string& TypeInfo::getName() const
+	{
+		return name_;
+	}
+
+	const std::vector<Field>& TypeInfo::getFields() const
+	{
+		return fields_;
+	}
+
+	int TypeInfo::findField(const std::string& name) const
+	{
+		return index_.find(name);
+	}
+
+	void checkRequired(const TypeInfo& type, const bool* found)
+	{
+		const std::vector<Field>& fields = type.getFields();
+		for (size_t i = 0; i < fields.size(); i++)
+			if (fields[i].isRequired && !found[i])
+				throw Error(fieldPath(type, fields[i]), "required field missing");
+	}
+
+#pragma endregion
+
+#pragma region Json
+
+	void loadJson(const TypeInfo& type, Component* c, const nlohmann::json& params)
+	{
+		if (!params.is_object())
+			throw Error(type.getName(), "parameters must be an object");
+
+		// Una pasada por las claves; cada una es un hash y una comparacion
+		const nlohmann::json* values[TypeInfo::MAX_FIELDS] = {};
+		bool found[TypeInfo::MAX_FIELDS] = {};
+		for (auto it = params.begin(); it != params.end(); ++it) {
+			int i = type.findField(it.key());
+			if (i >= 0) {
+				values[i] = &it.value();
+				found[i] = true;
+			}
+		}
+		checkRequired(type, found);
+
+		const std::vector<Field>& fields = type.getFields();
+		for (size_t i = 0; i < fields.size(); i++)
+			if (values[i] != nullptr)
+				applyJson(fields[i], c, *values[i], fieldPath(type, fields[i]));
+	}
+
+#pragma endregion
+}
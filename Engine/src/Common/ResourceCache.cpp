@@ -0,0 +1,235 @@
+#include "ResourceCache.h"
+
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+const std::string ResourceCache::BUDGETS_FILE_PATH = "Resources/budgets.json";
+
+namespace {
+	const size_t MB = 1024 * 1024;
+}
+
+#pragma region Handles
+
+ResourceCache::Handles::~Handles()
+{
+	releaseAll();
+}
+
+void ResourceCache::Handles::acquire(Type type, const std::string& name)
+{
+	if (name.empty()) return;
+	ResourceCache::getInstance()->acquire(type, name);
+	held_.push_back({ type, name });
+}
+
+void ResourceCache::Handles::releaseAll()
+{
+	ResourceCache* cache = ResourceCache::getInstance();
+	for (const auto& h : held_)
+		cache->release(h.first, h.second);
+	held_.clear();
+}
+
+#pragma endregion
+
+ResourceCache::ResourceCache()
+{
+	// Por defecto se limita lo que mas ocupa, los materiales apenas gastan
+	pools_[(int)Type::Mesh].budget = 256 * MB;
+	pools_[(int)Type::Texture].budget = 512 * MB;
+	pools_[(int)Type::Sound].budget = 128 * MB;
+
+	std::fstream i(BUDGETS_FILE_PATH);
+	if (!i.is_open())
+		return;
+
+	nlohmann::json config;
+	try {
+		i >> config;
+	}
+	catch (const std::exception& e) {
+		std::cout << "WARNING: couldn't read " << BUDGETS_FILE_PATH << "\n" << e.what() << "\n";
+		return;
+	}
+	loadBudgets(config);
+}
+
+ResourceCache* ResourceCache::getInstance()
+{
+	static ResourceCache instance;
+	return &instance;
+}
+
+const char* ResourceCache::typeName(Type type)
+{
+	switch (type) {
+	case Type::Mesh: return "Mesh";
+	case Type::Material: return "Material";
+	case Type::Texture: return "Texture";
+	case Type::Sound: return "Sound";
+	default: return "Unknown";
+	}
+}
+
+void ResourceCache::setBackend(Type type, const Backend& backend)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex_);
+	Pool& pool = pools_[(int)type];
+	pool.backend = backend;
+	if (!backend.unload) {
+		pool.entries.clear();
+		pool.lru.clear();
+	}
+}
+
+void ResourceCache::setBudget(Type type, size_t bytes)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex_);
+	pools_[(int)type].budget = bytes;
+}
+
+void ResourceCache::loadBudgets(const nlohmann::json& config)
+{
+	if (!config.is_object())
+		throw std::exception("ERROR: Resource budgets must be an object\n");
+
+	for (int t = 0; t < (int)Type::LastType; ++t) {
+		auto it = config.find(typeName((Type)t));
+		if (it == config.end()) continue;
+		if (!it->is_number() || it->get<double>() < 0)
+			throw std::runtime_error("ERROR: Resource budget for " + std::string(typeName((Type)t)) + " must be a positive number of MB\n");
+		setBudget((Type)t, (size_t)(it->get<double>() * MB));
+	}
+}
+
+ResourceCache::Entry& ResourceCache::getEntry(Pool& pool, const std::string& name)
+{
+	auto it = pool.entries.find(name);
+	if (it != pool.entries.end())
+		return it->second;
+
+	// Los nuevos entran sin referencias, como los mas recientes
+	Entry& e = pool.entries[name];
+	e.lru = pool.lru.insert(pool.lru.end(), name);
+	return e;
+}
+
+void ResourceCache::acquire(Type type, const std::string& name)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex_);
+	Pool& pool = pools_[(int)type];
+	Entry& e = getEntry(pool, name);
+	if (e.refs++ == 0)
+		pool.lru.erase(e.lru);
+	e.lastUse = ++useClock_;
+}
+
+void ResourceCache::release(Type type, const std::string& name)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex_);
+	Pool& pool = pools_[(int)type];
+	auto it = pool.entries.find(name);
+	if (it == pool.entries.end() || it->second.refs <= 0) return;
+
+	Entry& e = it->second;
+	e.lastUse = ++useClock_;
+	if (--e.refs == 0)
+		e.lru = pool.lru.insert(pool.lru.end(), name);
+}
+
+void ResourceCache::touch(Type type, const std::string& name)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex_);
+	Pool& pool = pools_[(int)type];
+	Entry& e = getEntry(pool, name);
+	e.lastUse = ++useClock_;
+	if (e.refs == 0)
+		pool.lru.splice(pool.lru.end(), pool.lru, e.lru);
+}
+
+void ResourceCache::forget(Type type, const std::string& name)
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex_);
+	Pool& pool = pools_[(int)type];
+	auto it = pool.entries.find(name);
+	if (it == pool.entries.end()) return;
+	if (it->second.refs == 0)
+		pool.lru.erase(it->second.lru);
+	pool.entries.erase(it);
+}
+
+size_t ResourceCache::poolBytes(const Pool& pool) const
+{
+	if (!pool.backend.size) return 0;
+	size_t bytes = 0;
+	for (const auto& e : pool.entries)
+		bytes += pool.backend.size(e.first);
+	return bytes;
+}
+
+// all = true descarga todos los candidatos aunque quepan
+void ResourceCache::evict(Pool& pool, bool all)
+{
+	if (!pool.backend.unload || (!all && pool.budget == 0)) return;
+
+	size_t bytes = all ? 0 : poolBytes(pool);
+	auto it = pool.lru.begin();
+	while (it != pool.lru.end() && (all || bytes > pool.budget)) {
+		std::string name = *it;
+		// Si algo fuera del cache lo sigue usando se salta
+		if (pool.backend.inUse && pool.backend.inUse(name)) {
+			++it;
+			continue;
+		}
+		size_t size = pool.backend.size ? pool.backend.size(name) : 0;
+		it = pool.lru.erase(it);
+		pool.entries.erase(name);
+		// Se quita antes de descargar por si el backend llama a forget
+		pool.backend.unload(name);
+		bytes -= std::min(size, bytes);
+		pool.evictions++;
+	}
+}
+
+void ResourceCache::trim()
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex_);
+	// En orden: al descargar los materiales se sueltan sus texturas
+	for (Pool& pool : pools_)
+		evict(pool, false);
+}
+
+void ResourceCache::purge()
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex_);
+	for (Pool& pool : pools_)
+		evict(pool, true);
+}
+
+ResourceCache::Stats ResourceCache::getStats(Type type) const
+{
+	std::lock_guard<std::recursive_mutex> lock(mutex_);
+	const Pool& pool = pools_[(int)type];
+	Stats stats;
+	stats.bytes = poolBytes(pool);
+	stats.budget = pool.budget;
+	stats.resident = (int)pool.entries.size();
+	stats.referenced = stats.resident - (int)pool.lru.size();
+	stats.evictions = pool.evictions;
+	return stats;
+}
+
+void ResourceCache::printStats() const
+{
+	std::cout << "---- Resource cache ----\n";
+	for (int t = 0; t < (int)Type::LastType; ++t) {
+		Stats s = getStats((Type)t);
+		std::cout << typeName((Type)t) << ": " << s.bytes / MB << "/";
+		if (s.budget) std::cout << s.budget / MB << " MB";
+		else std::cout << "- MB";
+		std::cout << ", " << s.resident << " resident, " << s.referenced << " referenced, "
+			<< s.evictions << " evicted\n";
+	}
+}
@@ -0,0 +1,188 @@
+#include "StartupGraph.h"
+#include "EngineContext.h"
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+
+void StartupGraph::addStep(const std::string& name, std::function<void()> step,
+	const std::vector<std::string>& deps, bool mainThread)
+{
+	if (byName_.count(name))
+		throw std::runtime_error("ERROR: Startup step " + name + " added twice\n");
+	byName_[name] = steps_.size();
+	Step s;
+	s.name = name;
+	s.fn = std::move(step);
+	s.deps = deps;
+	s.mainThread = mainThread;
+	steps_.push_back(std::move(s));
+}
+
+bool StartupGraph::hasStep(const std::string& name) const
+{
+	return byName_.count(name) > 0;
+}
+
+// Pasa las dependencias a indices y comprueba que no haya ciclos
+void StartupGraph::resolve()
+{
+	for (Step& s : steps_) {
+		s.next.clear();
+		s.pending = 0;
+	}
+	for (size_t i = 0; i < steps_.size(); i++) {
+		for (const std::string& d : steps_[i].deps) {
+			auto it = byName_.find(d);
+			if (it == byName_.end())
+				throw std::runtime_error("ERROR: Startup step " + steps_[i].name + " depends on unknown step " + d + "\n");
+			steps_[it->second].next.push_back(i);
+			steps_[i].pending++;
+		}
+	}
+
+	std::vector<int> pending(steps_.size());
+	std::vector<size_t> ready;
+	for (size_t i = 0; i < steps_.size(); i++) {
+		pending[i] = steps_[i].pending;
+		if (pending[i] == 0) ready.push_back(i);
+	}
+	size_t visited = 0;
+	while (!ready.empty()) {
+		size_t i = ready.back();
+		ready.pop_back();
+		visited++;
+		for (size_t n : steps_[i].next)
+			if (--pending[n] == 0) ready.push_back(n);
+	}
+	if (visited != steps_.size())
+		throw std::runtime_error("ERROR: Startup steps have a dependency cycle\n");
+}
+
+void StartupGraph::run(EngineContext* ctx, unsigned int threads)
+{
+	using Clock = std::chrono::steady_clock;
+	resolve();
+
+	if (threads == 0) {
+		unsigned int hw = std::thread::hardware_concurrency();
+		threads = std::max(1u, std::min(4u, hw > 1 ? hw - 1 : 1u));
+	}
+
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::deque<size_t> workerQueue, mainQueue;
+	size_t remaining = steps_.size();
+	int running = 0;
+	std::exception_ptr error;
+
+	timings_.assign(steps_.size(), StepTiming());
+	const Clock::time_point start = Clock::now();
+
+	for (size_t i = 0; i < steps_.size(); i++) {
+		if (steps_[i].pending == 0)
+			(steps_[i].mainThread ? mainQueue : workerQueue).push_back(i);
+	}
+
+	// Se llama con el cerrojo cogido
+	auto finished = [&]() { return remaining == 0 || (error && running == 0); };
+
+	// Saca un paso de la cola, lo ejecuta y libera a los que esperaban por el
+	auto execute = [&](std::unique_lock<std::mutex>& lock, std::deque<size_t>& queue) {
+		size_t i = queue.front();
+		queue.pop_front();
+		running++;
+		lock.unlock();
+
+		Clock::time_point t0 = Clock::now();
+		std::exception_ptr failed;
+		try {
+			steps_[i].fn();
+		}
+		catch (...) {
+			failed = std::current_exception();
+		}
+		Clock::time_point t1 = Clock::now();
+
+		lock.lock();
+		StepTiming& t = timings_[i];
+		t.name = steps_[i].name;
+		t.startMs = std::chrono::duration<float, std::milli>(t0 - start).count();
+		t.durationMs = std::chrono::duration<float, std::milli>(t1 - t0).count();
+		t.mainThread = steps_[i].mainThread;
+		running--;
+		remaining--;
+		if (failed && !error) error = failed;
+		if (!failed) {
+			for (size_t n : steps_[i].next)
+				if (--steps_[n].pending == 0)
+					(steps_[n].mainThread ? mainQueue : workerQueue).push_back(n);
+		}
+		cv.notify_all();
+	};
+
+	auto worker = [&]() {
+		EngineContext::Scope scope(ctx);
+		std::unique_lock<std::mutex> lock(mtx);
+		while (true) {
+			cv.wait(lock, [&]() { return finished() || error || !workerQueue.empty(); });
+			if (finished() || error) return;
+			execute(lock, workerQueue);
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (unsigned int i = 0; i < threads; i++)
+		pool.emplace_back(worker);
+
+	{
+		EngineContext::Scope scope(ctx);
+		std::unique_lock<std::mutex> lock(mtx);
+		while (true) {
+			cv.wait(lock, [&]() { return finished() || (!error && !mainQueue.empty()); });
+			if (finished()) break;
+			execute(lock, mainQueue);
+		}
+	}
+	cv.notify_all();
+	for (std::thread& t : pool)
+		t.join();
+
+	totalMs_ = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+	if (error)
+		std::rethrow_exception(error);
+}
+
+const std::vector<StartupGraph::StepTiming>& StartupGraph::getTimings() const
+{
+	return timings_;
+}
+
+float StartupGraph::getTotalMs() const
+{
+	return totalMs_;
+}
+
+void StartupGraph::printReport() const
+{
+	std::vector<StepTiming> sorted = timings_;
+	std::sort(sorted.begin(), sorted.end(), [](const StepTiming& a, const StepTiming& b) { return a.startMs < b.startMs; });
+
+	float sum = 0.0f;
+	for (const StepTiming& t : sorted) sum += t.durationMs;
+
+	std::cout << std::fixed << std::setprecision(1)
+		<< "Arranque: " << totalMs_ << " ms (" << sum << " ms en serie)\n";
+	for (const StepTiming& t : sorted) {
+		std::cout << "  " << std::left << std::setw(20) << t.name << std::right
+			<< std::setw(8) << t.startMs << " +" << std::setw(8) << t.durationMs << " ms"
+			<< (t.mainThread ? "  [principal]" : "") << "\n";
+	}
+	std::cout.unsetf(std::ios::floatfield);
+}
@@ -1,157 +1,341 @@
 #include "Vector3.h"
 #include "CommonManager.h"
 #include "Transform.h"
+#include "Entity.h"
+#include "Scene/Scene.h"
+#include "Managers/SceneManager.h"
+#include "Reflection.h"
+#include <algorithm>
+#include <iostream>
 
 Transform::Transform() : 
 	Component(CommonManager::getInstance(), (int)CommonManager::CommonCmpId::TransId),
-	_position(),
-	_velocity(),
-	_dimensions(),
-	_rotation() 
+	slot_(CommonManager::getInstance()->addTransform(this)),
+	physicsDriven_(false)
 {
+	setDimensions(Vector3());
 }
 
 Transform::Transform(const Vector3& pos, const Vector3& vel, const Vector3& dim, const Vector3& rotation) :
 	Component(CommonManager::getInstance(), (int)CommonManager::CommonCmpId::TransId),
-	_position(pos), //
-	_velocity(vel), //
-	_dimensions(dim),
-	_rotation(rotation) //
+	slot_(CommonManager::getInstance()->addTransform(this)),
+	physicsDriven_(false)
 {
+	setPos(pos);
+	setVel(vel);
+	setDimensions(dim);
+	setRot(rotation);
 }
 
 // Si algun parametro no se especifica, se mantendra por defecto
 void Transform::load(const nlohmann::json& params)
 {
-	auto it = params.find("position");
-	if (it != params.end()) {
-		std::vector<float> pos = it->get<std::vector<float>>();
-		_position = Vector3(pos[0], pos[1], pos[2]);
+	loadFields(params);
+}
+
+const Reflection::TypeInfo* Transform::getTypeInfo() const
+{
+	static const Reflection::TypeInfo info("Transform", {
+		REFLECT_PROPERTY(Transform, Vector3, "position", getPos, setPos),
+		REFLECT_PROPERTY(Transform, Vector3, "velocity", getVel, setVel),
+		REFLECT_PROPERTY(Transform, Vector3, "dimensions", getDimensions, setDimensions),
+		REFLECT_PROPERTY(Transform, Vector3, "rotation", getRot, setRot),
+		REFLECT_PROPERTY(Transform, bool, "kinematic", isKinematic, setKinematic),
+		// Nombre de la entidad padre, puede estar despues en la escena
+		REFLECT_FIELD(Transform, std::string, "parent",
+			self.parent_ ? self.parent_->getEntity()->getName() : self.parentName_, self.setParentByName(v))
+	});
+	return &info;
+}
+
+Transform::~Transform() {
+	// Los hijos se quedan en la raiz con sus valores locales
+	setParent(nullptr);
+	for (Transform* child : children_) {
+		child->parent_ = nullptr;
+		child->updateDepth();
+		child->markDirty();
 	}
-	it = params.find("velocity");
-	if (it != params.end()) {
-		std::vector<float> pos = it->get<std::vector<float>>();
-		_velocity= Vector3(pos[0], pos[1], pos[2]);
+	children_.clear();
+	CommonManager::getInstance()->removeTransform(slot_);
+}
+
+void Transform::init() {
+	setPos(Vector3());
+	setVel(Vector3());
+	setRot(Vector3());
+	setDimensions(Vector3(1.0f, 1.0f, 1.0f));
+	setKinematic(false);
+}
+
+// La velocidad se integra en bloque en CommonManager::fixedUpdate
+void Transform::update(float deltaTime) {
+
+}
+
+void Transform::setUp()
+{
+	setUpDone_ = true;
+	if (!parentName_.empty()) {
+		std::string name;
+		name.swap(parentName_);
+		setParentByName(name);
 	}
-	it = params.find("dimensions");
-	if (it != params.end()) {
-		std::vector<float> pos = it->get<std::vector<float>>();
-		_dimensions = Vector3(pos[0], pos[1], pos[2]);
+	// Los que se crean a mitad de frame tienen ya su estado de mundo
+	CommonManager::getInstance()->updateWorldTransform(this);
+}
+
+void Transform::markDirty()
+{
+	CommonManager::getInstance()->markDirty(slot_);
+}
+
+void Transform::updateDepth()
+{
+	depth_ = parent_ ? parent_->depth_ + 1 : 0;
+	for (Transform* child : children_)
+		child->updateDepth();
+}
+
+void Transform::setParent(Transform* parent)
+{
+	if (parent == parent_) return;
+	for (Transform* p = parent; p != nullptr; p = p->parent_)
+		if (p == this)
+			throw std::runtime_error("ERROR: Transform parent would create a cycle\n");
+
+	if (parent_ != nullptr) {
+		auto& siblings = parent_->children_;
+		siblings.erase(std::remove(siblings.begin(), siblings.end(), this), siblings.end());
+	}
+	parent_ = parent;
+	if (parent_ != nullptr)
+		parent_->children_.push_back(this);
+
+	updateDepth();
+	markDirty();
+	CommonManager::getInstance()->markHierarchyChanged();
+}
+
+Transform* Transform::getParent() const
+{
+	return parent_;
+}
+
+void Transform::setParentByName(const std::string& name)
+{
+	// En la carga la entidad puede estar despues en la escena
+	if (!setUpDone_) {
+		parentName_ = name;
+		return;
 	}
-	it = params.find("rotation");
-	if (it != params.end()) {
-		std::vector<float> pos = it->get<std::vector<float>>();
-		_rotation = Vector3(pos[0], pos[1], pos[2]);
+	if (name.empty()) {
+		setParent(nullptr);
+		return;
 	}
+	Scene* scene = SceneManager::getCurrentScene();
+	Entity* ent = scene ? scene->getEntity(name) : nullptr;
+	Transform* parent = ent ? ent->get<Transform>() : nullptr;
+	if (parent == nullptr)
+		std::cout << "WARNING: Transform parent " << name << " not found\n";
+	else
+		setParent(parent);
 }
-Transform::~Transform() {
+
+const std::vector<Transform*>& Transform::getChildren() const
+{
+	return children_;
 }
 
-void Transform::init() {
-	_position = _velocity = _rotation = Vector3();
-	_dimensions = Vector3(1.0f, 1.0f, 1.0f);
+int Transform::getDepth() const
+{
+	return depth_;
 }
 
-void Transform::update(float deltaTime) {
+const Matrix4& Transform::getWorldMatrix() const
+{
+	return CommonManager::getInstance()->getTransforms().world[slot_];
+}
+
+Vector3 Transform::getWorldPos() const
+{
+	return getWorldMatrix().c[3].xyz();
+}
+
+Quaternion Transform::getWorldRotation() const
+{
+	return CommonManager::getInstance()->getTransforms().worldRot[slot_];
+}
+
+Vector3 Transform::getWorldScale() const
+{
+	return CommonManager::getInstance()->getTransforms().worldScale[slot_];
+}
+
+Quaternion Transform::getLocalRotation() const
+{
+	const TransformArrays& t = CommonManager::getInstance()->getTransforms();
+	return Quaternion::fromYawPitchRoll(t.rotZ[slot_], t.rotY[slot_], t.rotX[slot_]);
+}
+
+Vector3 Transform::read(const std::vector<float>& x, const std::vector<float>& y, const std::vector<float>& z) const
+{
+	return Vector3(x[slot_], y[slot_], z[slot_]);
+}
 
+void Transform::write(std::vector<float>& x, std::vector<float>& y, std::vector<float>& z, const Vector3& v)
+{
+	x[slot_] = v.x;
+	y[slot_] = v.y;
+	z[slot_] = v.z;
 }
 
-const Vector3& Transform::getPos() const
+Vector3 Transform::getPos() const
 {
-	 return _position;
+	const TransformArrays& t = CommonManager::getInstance()->getTransforms();
+	return read(t.posX, t.posY, t.posZ);
 }
 
 void Transform::setPos(const Vector3& pos)
 {
-	_position.set(pos);
+	TransformArrays& t = CommonManager::getInstance()->getTransforms();
+	write(t.posX, t.posY, t.posZ, pos);
+	markDirty();
 }
 
 void Transform::setPosX(double x)
 {
-	_position.setX(x);
+	CommonManager::getInstance()->getTransforms().posX[slot_] = x;
+	markDirty();
 }
 
 void Transform::setPosY(double y)
 {
-	_position.setY(y);
+	CommonManager::getInstance()->getTransforms().posY[slot_] = y;
+	markDirty();
 }
 
 void Transform::setPosZ(double z)
 {
-	_position.setZ(z);
+	CommonManager::getInstance()->getTransforms().posZ[slot_] = z;
+	markDirty();
 }
 
-const Vector3& Transform::getRot() const
+Vector3 Transform::getRot() const
 {
-	return _rotation;
+	const TransformArrays& t = CommonManager::getInstance()->getTransforms();
+	return read(t.rotX, t.rotY, t.rotZ);
 }
 
 void Transform::setRot(Vector3 angle)
 {
-	_rotation = angle;
+	TransformArrays& t = CommonManager::getInstance()->getTransforms();
+	write(t.rotX, t.rotY, t.rotZ, angle);
+	markDirty();
 }
 
 void Transform::setRotX(double x)
 {
-	_rotation.setX(x);
+	CommonManager::getInstance()->getTransforms().rotX[slot_] = x;
+	markDirty();
 }
 
 void Transform::setRotY(double y)
 {
-	_rotation.setY(y);
+	CommonManager::getInstance()->getTransforms().rotY[slot_] = y;
+	markDirty();
 }
 
 void Transform::setRotZ(double z)
 {
-	_rotation.setZ(z);
+	CommonManager::getInstance()->getTransforms().rotZ[slot_] = z;
+	markDirty();
 }
 
-const Vector3& Transform::getVel() const
+Vector3 Transform::getVel() const
 {
-	return _velocity;
+	const TransformArrays& t = CommonManager::getInstance()->getTransforms();
+	return read(t.velX, t.velY, t.velZ);
 }
 
 void Transform::setVel(const Vector3& vel)
 {
-	_velocity.set(vel);
+	TransformArrays& t = CommonManager::getInstance()->getTransforms();
+	write(t.velX, t.velY, t.velZ, vel);
 }
 
 void Transform::setVelX(double x)
 {
-	_velocity.setX(x);
+	CommonManager::getInstance()->getTransforms().velX[slot_] = x;
 }
 
 void Transform::setVelY(double y)
 {
-	_velocity.setY(y);
+	CommonManager::getInstance()->getTransforms().velY[slot_] = y;
 }
 
 void Transform::setVelZ(double z)
 {
-	_velocity.setZ(z);
+	CommonManager::getInstance()->getTransforms().velZ[slot_] = z;
 }
 
-const Vector3& Transform::getDimensions() const
+Vector3 Transform::getDimensions() const
 {
-	return _dimensions;
+	const TransformArrays& t = CommonManager::getInstance()->getTransforms();
+	return read(t.scaleX, t.scaleY, t.scaleZ);
 }
 
 void Transform::setDimensions(const Vector3 dim)
 {
-	_dimensions.set(dim);
+	TransformArrays& t = CommonManager::getInstance()->getTransforms();
+	write(t.scaleX, t.scaleY, t.scaleZ, dim);
+	markDirty();
 }
 
 void Transform::setDimX(double x)
 {
-	_dimensions.setX(x);
+	CommonManager::getInstance()->getTransforms().scaleX[slot_] = x;
+	markDirty();
 }
 
 void Transform::setDimY(double y)
 {
-	_dimensions.setY(y);
+	CommonManager::getInstance()->getTransforms().scaleY[slot_] = y;
+	markDirty();
 }
 
 void Transform::setDimZ(double z)
 {
-	_dimensions.setZ(z);
+	CommonManager::getInstance()->getTransforms().scaleZ[slot_] = z;
+	markDirty();
+}
+
+void Transform::setKinematic(bool kinematic)
+{
+	kinematic_ = kinematic;
+	updateKinematic();
+}
+
+bool Transform::isKinematic() const
+{
+	return kinematic_;
+}
+
+void Transform::setPhysicsDriven(bool driven)
+{
+	if (physicsDriven_ == driven) return;
+	physicsDriven_ = driven;
+	updateKinematic();
+	// Con o sin padre cambia su estado de mundo
+	markDirty();
+}
+
+void Transform::updateKinematic()
+{
+	CommonManager::getInstance()->setKinematic(slot_, kinematic_ && !physicsDriven_);
+}
+
+bool Transform::isPhysicsDriven() const
+{
+	return physicsDriven_;
 }
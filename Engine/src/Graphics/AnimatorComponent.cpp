@@ -0,0 +1,238 @@
+#include "AnimatorComponent.h"
+#include "RenderManager.h"
+#include "MeshComponent.h"
+#include "Entity.h"
+#include "CommonManager.h"
+#include "Transform.h"
+#include <OgreEntity.h>
+#include <OgreMesh.h>
+#include <OgreAnimationState.h>
+#include <checkML.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+AnimatorComponent::AnimatorComponent() :
+	Component(RenderManager::getInstance(), (int)RenderManager::RenderCmpId::Animator)
+{
+}
+
+AnimatorComponent::~AnimatorComponent()
+{
+	if (RenderManager::getInstance() != nullptr)
+		RenderManager::getInstance()->removeAnimator(this);
+}
+
+void AnimatorComponent::init()
+{
+	startAnimation_.clear();
+	startLoop_ = true;
+	speed_ = 1.0f;
+	fade_ = 0.2f;
+	lodDistances_.clear();
+	offscreenInterval_ = 8;
+}
+
+void AnimatorComponent::load(const nlohmann::json& params)
+{
+	auto it = params.find("animation");
+	if (it != params.end()) startAnimation_ = it->get<std::string>();
+
+	it = params.find("loop");
+	if (it != params.end()) startLoop_ = it->get<bool>();
+
+	it = params.find("speed");
+	if (it != params.end()) speed_ = it->get<float>();
+
+	it = params.find("fade");
+	if (it != params.end()) fade_ = std::max(0.0f, it->get<float>());
+
+	// Distancias crecientes: pasada cada una se actualiza la mitad de veces
+	it = params.find("lodDistances");
+	if (it != params.end()) {
+		lodDistances_ = it->get<std::vector<float>>();
+		std::sort(lodDistances_.begin(), lodDistances_.end());
+	}
+
+	it = params.find("offscreenInterval");
+	if (it != params.end()) offscreenInterval_ = std::max(1, it->get<int>());
+}
+
+void AnimatorComponent::setUp()
+{
+	tr_ = _entity->get<Transform>();
+	mesh_ = _entity->get<MeshComponent>();
+
+	Ogre::Entity* ent = mesh_ ? mesh_->getOgreEntity() : nullptr;
+	if (ent == nullptr) {
+		std::cout << "WARNING: AnimatorComponent needs a MeshComponent\n";
+		return;
+	}
+	states_ = ent->getAllAnimationStates();
+	if (states_ == nullptr) {
+		std::cout << "WARNING: Mesh " << ent->getMesh()->getName() << " has no skeletal animations\n";
+		return;
+	}
+	radius_ = ent->getMesh()->getBoundingSphereRadius();
+
+	RenderManager::getInstance()->addAnimator(this);
+	if (!startAnimation_.empty() && layers_.empty())
+		crossFade(startAnimation_, 0.0f, startLoop_);
+}
+
+// Se avanzan todas juntas en RenderManager::updateAnimations
+void AnimatorComponent::update(float deltaTime)
+{
+}
+
+void AnimatorComponent::setActive(bool act)
+{
+	Component::setActive(act);
+	// El siguiente frame activo se actualiza ya, sin el tiempo que ha estado parado
+	pendingTime_ = 0.0f;
+	framesToUpdate_ = 0;
+}
+
+AnimatorComponent::Layer* AnimatorComponent::findLayer(const std::string& name)
+{
+	for (Layer& l : layers_)
+		if (l.state->getAnimationName() == name)
+			return &l;
+	return nullptr;
+}
+
+void AnimatorComponent::blend(const std::string& name, float weight, float fadeTime, bool loop)
+{
+	if (!hasAnimation(name)) {
+		std::cout << "WARNING: Animation " << name << " not found\n";
+		return;
+	}
+	Layer* l = findLayer(name);
+	if (l == nullptr) {
+		layers_.push_back(Layer());
+		l = &layers_.back();
+		l->state = states_->getAnimationState(name);
+		l->state->setTimePosition(0.0f);
+		l->state->setWeight(0.0f);
+		l->state->setEnabled(true);
+	}
+	// Una que ya habia terminado vuelve a empezar
+	else if (l->state->hasEnded())
+		l->state->setTimePosition(0.0f);
+
+	l->state->setLoop(loop);
+	l->target = std::max(0.0f, weight);
+	l->fadeSpeed = fadeTime > 0.0f ? 1.0f / fadeTime : 0.0f;
+}
+
+void AnimatorComponent::crossFade(const std::string& name, float fadeTime, bool loop)
+{
+	if (!hasAnimation(name)) {
+		std::cout << "WARNING: Animation " << name << " not found\n";
+		return;
+	}
+	stop(fadeTime);
+	blend(name, 1.0f, fadeTime, loop);
+}
+
+void AnimatorComponent::play(const std::string& name, bool loop)
+{
+	crossFade(name, fade_, loop);
+}
+
+void AnimatorComponent::stop(float fadeTime)
+{
+	for (Layer& l : layers_) {
+		l.target = 0.0f;
+		l.fadeSpeed = fadeTime > 0.0f ? 1.0f / fadeTime : 0.0f;
+	}
+}
+
+int AnimatorComponent::chooseInterval(const View& view) const
+{
+	if (!view.hasCamera || tr_ == nullptr)
+		return 1;
+
+	// Esfera de la malla contra el frustum, sin tocar los nodos de Ogre
+	Vector3 pos = tr_->getWorldPos();
+	Vector3 scale = tr_->getWorldScale();
+	float r = radius_ * std::max(std::fabs(scale.x), std::max(std::fabs(scale.y), std::fabs(scale.z)));
+	for (int i = 0; i < 6; i++)
+		if (view.normals[i].dot(pos) + view.distances[i] < -r)
+			return offscreenInterval_;
+
+	float dist = (pos - view.position).magnitude();
+	int interval = 1;
+	for (float d : lodDistances_)
+		if (dist > d) interval *= 2;
+	return interval;
+}
+
+void AnimatorComponent::advance(float deltaTime, const View& view)
+{
+	pendingTime_ += deltaTime;
+	if (--framesToUpdate_ > 0)
+		return;
+
+	interval_ = chooseInterval(view);
+	framesToUpdate_ = interval_;
+	float t = pendingTime_;
+	pendingTime_ = 0.0f;
+
+	for (size_t i = 0; i < layers_.size();) {
+		Layer& l = layers_[i];
+		if (l.fadeSpeed <= 0.0f)
+			l.weight = l.target;
+		else if (l.weight < l.target)
+			l.weight = std::min(l.weight + l.fadeSpeed * t, l.target);
+		else
+			l.weight = std::max(l.weight - l.fadeSpeed * t, l.target);
+
+		// Las que ya no pesan salen de la mezcla
+		if (l.weight <= 0.0f && l.target <= 0.0f) {
+			l.state->setEnabled(false);
+			layers_.erase(layers_.begin() + i);
+			continue;
+		}
+		l.state->setWeight(l.weight);
+		l.state->addTime(t * speed_);
+		i++;
+	}
+}
+
+bool AnimatorComponent::hasAnimation(const std::string& name) const
+{
+	return states_ != nullptr && states_->hasAnimationState(name);
+}
+
+bool AnimatorComponent::isPlaying(const std::string& name) const
+{
+	for (const Layer& l : layers_)
+		if (l.state->getAnimationName() == name)
+			return l.target > 0.0f && !l.state->hasEnded();
+	return false;
+}
+
+std::string AnimatorComponent::getCurrentAnimation() const
+{
+	const Layer* best = nullptr;
+	for (const Layer& l : layers_)
+		if (l.target > 0.0f && (best == nullptr || l.target > best->target))
+			best = &l;
+	return best ? best->state->getAnimationName() : std::string();
+}
+
+void AnimatorComponent::setSpeed(float speed)
+{
+	speed_ = speed;
+}
+
+float AnimatorComponent::getSpeed() const
+{
+	return speed_;
+}
+
+int AnimatorComponent::getUpdateInterval() const
+{
+	return interval_;
+}
@@ -9,7 +9,9 @@
 #include "CommonManager.h"
 #include "Entity.h"
 #include "Transform.h"
+#include "Reflection.h"
 #include <algorithm>
+#include <iostream>
 
 void Camera::init()
 {
@@ -32,7 +34,7 @@ Camera::~Camera()
 void Camera::update(float deltaTime)
 {
 	//posicion
-	Vector3 pos = tr_->getPos();
+	Vector3 pos = tr_->getWorldPos();
 	camNode_->setPosition(Ogre::Vector3(pos.x, pos.y, pos.z));
 	Vector3 rot = tr_->getRot();
 	//rotaciones
@@ -40,6 +42,11 @@ void Camera::update(float deltaTime)
 	camNode_->yaw(Ogre::Degree(rot.y), Ogre::Node::TS_WORLD);//ejeY
 	camNode_->pitch(Ogre::Degree(rot.x), Ogre::Node::TS_WORLD);//ejex
 	camNode_->roll(Ogre::Degree(rot.z), Ogre::Node::TS_WORLD);//ejez
+	//si cuelga de otro transform gira con el
+	if (tr_->getParent() != nullptr) {
+		Quaternion parentRot = tr_->getParent()->getWorldRotation();
+		camNode_->setOrientation(Ogre::Quaternion(parentRot.w, parentRot.x, parentRot.y, parentRot.z) * camNode_->getOrientation());
+	}
 	//escala
 	Vector3 scale = tr_->getDimensions();
 	camNode_->scale(Ogre::Vector3(scale.x, scale.y, scale.z));
@@ -47,39 +54,16 @@ void Camera::update(float deltaTime)
 
 void Camera::setUp()
 {
-	tr_ = static_cast<Transform*>(_entity->getComponent((int)ManID::Common, (int)CommonManager::CommonCmpId::TransId));
+	tr_ = _entity->get<Transform>();
 }
 
 void Camera::load(const nlohmann::json& params)
 {
-	//PARAMETRO NOMBRE OBLIGATORIO
-	auto it = params.find("camName");
-	if (it != params.end()) {
-		name_ = it->get<std::string>();
-		mCamera_ = OgreContext::getInstance()->getSceneManager()->createCamera(name_);
-		camNode_->attachObject(mCamera_);
-	}
-	else {
-		throw std::runtime_error("Cannot create camera without specified name\n");
-	}
-
-	//Posicin de la cmara
-	it = params.find("camPosition");
-	if (it != params.end()) {
-		std::vector<float> pos = it->get<std::vector<float>>();
-		camNode_->setPosition(pos[0], pos[1], pos[2]);
-	}
-
-	//Posicin hacia la que est mirando la cmara
-	it = params.find("lookAt");
-	if (it != params.end()) {
-		std::vector<float> pos = it->get<std::vector<float>>();
-		camNode_->lookAt(Ogre::Vector3(pos[0], pos[1], pos[2]), Ogre::Node::TS_WORLD);
-	}
-
+	//Nombre (obligatorio), posicion, hacia donde mira y planos de corte
+	loadFields(params);
 
 	//Configurar el viewport para que no ocupe toda la ventana
-	it = params.find("viewport");
+	auto it = params.find("viewport");
 	if (it != params.end() && it->is_object()) {
 
 		int zOrder = 0;
@@ -132,31 +116,39 @@ void Camera::load(const nlohmann::json& params)
 		vp_->setBackgroundColour(Ogre::ColourValue(color[0], color[1], color[2], color[3]));
 	}
 
-	//AspectRatio automatico
-	it = params.find("autoAspectRatio");
-	if (it != params.end()) {
-		bool autoAspectRatio = it->get<bool>();
-		mCamera_->setAutoAspectRatio(autoAspectRatio);
-	}
-	//Por defecto si no, siempre se ajusta
-	else mCamera_->setAutoAspectRatio(true);
+	mCamera_->setAutoAspectRatio(autoAspectRatio_);
+	mCamera_->setNearClipDistance(nearClipDistance_);
+	mCamera_->setFarClipDistance(farClipDistance_);
+}
 
-	//NearClipDistance
-	it = params.find("nearClipDistance");
-	if (it != params.end()) {
-		int near = it->get<int>();
-		mCamera_->setNearClipDistance(near);
-	}
-	else mCamera_->setNearClipDistance(1);
+const Reflection::TypeInfo* Camera::getTypeInfo() const
+{
+	static const Reflection::TypeInfo info("Camera", {
+		REFLECT_FIELD(Camera, std::string, "camName", self.name_, self.createCamera(v)).required().loadOnly(),
+		REFLECT_PROPERTY(Camera, Vector3, "camPosition", getCameraPosition, setCameraPosition),
+		//Posicion hacia la que mira la camara
+		REFLECT_SETTER(Camera, Vector3, "lookAt",
+			self.camNode_->lookAt(Ogre::Vector3(v.x, v.y, v.z), Ogre::Node::TS_WORLD)),
+		//Por defecto siempre se ajusta
+		REFLECT_FIELD(Camera, bool, "autoAspectRatio", self.autoAspectRatio_,
+			{ self.autoAspectRatio_ = v; if (self.mCamera_) self.mCamera_->setAutoAspectRatio(v); }),
+		REFLECT_FIELD(Camera, int, "nearClipDistance", self.nearClipDistance_,
+			{ self.nearClipDistance_ = v; if (self.mCamera_) self.mCamera_->setNearClipDistance(v); }),
+		REFLECT_FIELD(Camera, int, "farClipDistance", self.farClipDistance_,
+			{ self.farClipDistance_ = v; if (self.mCamera_) self.mCamera_->setFarClipDistance(v); })
+	});
+	return &info;
+}
 
-	//FarClipDistance
-	it = params.find("farClipDistance");
-	if (it != params.end()) {
-		int far = it->get<int>();
-		mCamera_->setFarClipDistance(far);
+void Camera::createCamera(const std::string& name)
+{
+	if (mCamera_ != nullptr) {
+		std::cout << "WARNING: Camera " << name_ << " already created, name " << name << " ignored\n";
+		return;
 	}
-	else mCamera_->setFarClipDistance(10000);
-
+	name_ = name;
+	mCamera_ = OgreContext::getInstance()->getSceneManager()->createCamera(name_);
+	camNode_->attachObject(mCamera_);
 }
 
 void Camera::setCameraPosition(const Vector3& newPos)
@@ -177,11 +169,13 @@ void Camera::setBackgroundColor(const Vector3& newColor, float alpha)
 
 void Camera::setNearClipDistance(int distance)
 {
+	nearClipDistance_ = distance;
 	mCamera_->setNearClipDistance(distance);
 }
 
 void Camera::setFarClipDistance(int distance)
 {
+	farClipDistance_ = distance;
 	mCamera_->setFarClipDistance(distance);
 }
 
@@ -193,7 +187,7 @@ Vector3 Camera::getScreenCoordinates(const Vector3& iPoint)
 	return Vector3(((ogrePoint.x / 2.f) + 0.5f)*vp_->getActualWidth(), ((ogrePoint.y / 2.f) + 0.5f)*vp_->getActualHeight(), 0);
 }
 
-const Vector3& Camera::getCameraPosition() const
+Vector3 Camera::getCameraPosition() const
 {
 	Ogre::Vector3 aux = camNode_->getPosition();
 	return Vector3(aux.x, aux.y, aux.z);
@@ -20,7 +20,7 @@ MeshComponent::MeshComponent() :Component(RenderManager::getInstance(), (int)Ren
 
 void MeshComponent::setActive(bool act)
 {
-	_active = act;
+	Component::setActive(act);
 	mNode_->setVisible(_active);
 }
 
@@ -32,25 +32,23 @@ MeshComponent::~MeshComponent()
 
 void MeshComponent::update(float deltaTime)
 {
+	//El CommonManager ya ha calculado el estado de mundo con el del padre
 	//posicion
-	Vector3 pos = tr_->getPos();
+	Vector3 pos = tr_->getWorldPos();
 	mNode_->setPosition(Ogre::Vector3(pos.x, pos.y, pos.z));
-	Vector3 rot = tr_->getRot();
-	//rotaciones 
-	mNode_->resetOrientation();
-	mNode_->yaw(Ogre::Radian(rot.z), Ogre::Node::TS_WORLD);//ejeY
-	mNode_->pitch(Ogre::Radian(rot.y), Ogre::Node::TS_WORLD);//ejex
-	mNode_->roll(Ogre::Radian(rot.x), Ogre::Node::TS_WORLD);//ejez
+	//rotacion (yaw con z, pitch con y y roll con x, como antes)
+	Quaternion rot = tr_->getWorldRotation();
+	mNode_->setOrientation(Ogre::Quaternion(rot.w, rot.x, rot.y, rot.z));
 
 	//escala
-	Vector3 scale = tr_->getDimensions();
+	Vector3 scale = tr_->getWorldScale();
 	mNode_->setScale(Ogre::Vector3(scale.x, scale.y, scale.z));
 
 }
 
 void MeshComponent::setUp()
 {
-	tr_ = static_cast<Transform*>(_entity->getComponent((int)ManID::Common, (int)CommonManager::CommonCmpId::TransId));
+	tr_ = _entity->get<Transform>();
 }
 
 void MeshComponent::load(const nlohmann::json& params)
@@ -74,6 +72,7 @@ void MeshComponent::load(const nlohmann::json& params)
 		throw std::runtime_error("Error creating MeshComponent. Can't find mesh with mesh name: " + meshName + " " + e.what());
 	}
 	mNode_->attachObject(ogreEnt_);
+	OgreContext::getInstance()->holdResources(ogreEnt_, resources_);
 
 	it = params.find("meshMaterial");
 	if (it != params.end()) {
@@ -95,4 +94,7 @@ Ogre::Entity* MeshComponent::getOgreEntity()
 void MeshComponent::setMaterial(const std::string& matName)
 {
 	ogreEnt_->setMaterialName(matName);
+	//Se vuelven a contar las referencias con el material nuevo
+	resources_.releaseAll();
+	OgreContext::getInstance()->holdResources(ogreEnt_, resources_);
 }
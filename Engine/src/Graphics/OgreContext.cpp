@@ -7,10 +7,12 @@
 #include <SDL_syswm.h>
 #include <SDL_events.h>
 #include <iostream>
+#include <algorithm>
 
 #include <OgreSTBICodec.h>
 #include <checkML.h>
 #include <OgreShaderGenerator.h>
+#include <OgreResourceBackgroundQueue.h>
 
 /*#include <OgreFileSystemLayer.h>
 #include "WindowGenerator.h"
@@ -68,6 +70,9 @@ void OgreContext::init()
 	//ogreRoot_->addFrameListener(render);
 	//----RT-SHADER-SYSTEM-----//
 	setupRTShaderGenerator();
+
+	//----RESOURCE-CACHE-------//
+	registerResourceCache();
 }
 
 void OgreContext::createRoot()
@@ -152,6 +157,8 @@ void OgreContext::loadFromResourceFile()
 	// iterate through all of the results.
 	for (auto it : secIt) {
 		Ogre::String secName = it.first;
+		if (!secName.empty() && std::find(resourceGroups_.begin(), resourceGroups_.end(), secName) == resourceGroups_.end())
+			resourceGroups_.push_back(secName);
 		// ask for another iterator that will let us iterate through the items
 		// in each section
 		Ogre::ConfigFile::SettingsMultiMap* settings = &it.second;
@@ -168,7 +175,12 @@ void OgreContext::loadFromResourceFile()
 				name, locType, secName);
 		}
 	}
-	Ogre::ResourceGroupManager::getSingleton().initialiseAllResourceGroups();
+	//Solo se inicializa lo comun, el resto de grupos los pide cada escena
+	Ogre::ResourceGroupManager& rgm = Ogre::ResourceGroupManager::getSingleton();
+	if (!rgm.isResourceGroupInitialised(Ogre::RGN_INTERNAL))
+		rgm.initialiseResourceGroup(Ogre::RGN_INTERNAL);
+	if (!rgm.isResourceGroupInitialised(Ogre::RGN_DEFAULT))
+		rgm.initialiseResourceGroup(Ogre::RGN_DEFAULT);
 }
 
 void OgreContext::setupRTShaderGenerator()
@@ -213,6 +225,178 @@ Ogre::Plane OgreContext::createZPlane(float distance)
 
 #pragma endregion
 
+#pragma region RESOURCE_GROUPS
+
+//General, Internal y Autodetect estan siempre inicializados
+bool OgreContext::isResourceGroupUsable(const std::string& group) const
+{
+	if (group == Ogre::RGN_DEFAULT || group == Ogre::RGN_INTERNAL || group == Ogre::RGN_AUTODETECT)
+		return false;
+	if (!Ogre::ResourceGroupManager::getSingleton().resourceGroupExists(group)) {
+		std::cout << "WARNING: Resource group " << group << " not found\n";
+		return false;
+	}
+	return true;
+}
+
+namespace {
+	//Mallas, materiales y texturas de un grupo, con su tipo en el cache
+	template<typename F>
+	void forEachCachedResource(const std::string& group, F f)
+	{
+		const std::pair<ResourceCache::Type, Ogre::ResourceManager*> managers[] = {
+			{ ResourceCache::Type::Mesh, Ogre::MeshManager::getSingletonPtr() },
+			{ ResourceCache::Type::Material, Ogre::MaterialManager::getSingletonPtr() },
+			{ ResourceCache::Type::Texture, Ogre::TextureManager::getSingletonPtr() }
+		};
+		for (const auto& m : managers) {
+			Ogre::ResourceManager::ResourceMapIterator it = m.second->getResourceIterator();
+			while (it.hasMoreElements()) {
+				Ogre::ResourcePtr res = it.getNext();
+				if (res->getGroup() == group)
+					f(m.first, res);
+			}
+		}
+	}
+}
+
+void OgreContext::acquireResourceGroups(const std::vector<std::string>& groups)
+{
+	Ogre::ResourceGroupManager& rgm = Ogre::ResourceGroupManager::getSingleton();
+	for (const std::string& group : groups) {
+		if (!isResourceGroupUsable(group)) continue;
+		if (groupRefs_[group]++ > 0) continue;
+		releasedGroups_.erase(group);
+
+		// Primera escena que lo usa: se parsean sus scripts y se carga
+		if (!rgm.isResourceGroupInitialised(group))
+			rgm.initialiseResourceGroup(group);
+		if (!rgm.isResourceGroupLoaded(group))
+			rgm.loadResourceGroup(group);
+	}
+}
+
+void OgreContext::releaseResourceGroups(const std::vector<std::string>& groups)
+{
+	for (const std::string& group : groups) {
+		auto it = groupRefs_.find(group);
+		if (it == groupRefs_.end() || it->second <= 0) continue;
+		if (--it->second > 0) continue;
+
+		// No se descarga aqui: lo que tiene el grupo pasa a ser candidato
+		// del cache, que lo descarga si no cabe, y el grupo se da por
+		// descargado cuando ya no le queda nada (unloadEvictedGroups)
+		groupRefs_.erase(it);
+		releasedGroups_.insert(group);
+		ResourceCache* cache = ResourceCache::getInstance();
+		forEachCachedResource(group, [cache](ResourceCache::Type type, const Ogre::ResourcePtr& res) {
+			if (res->isLoaded())
+				cache->touch(type, res->getName());
+		});
+	}
+}
+
+void OgreContext::unloadEvictedGroups()
+{
+	Ogre::ResourceGroupManager& rgm = Ogre::ResourceGroupManager::getSingleton();
+	for (auto it = releasedGroups_.begin(); it != releasedGroups_.end();) {
+		bool loaded = false;
+		forEachCachedResource(*it, [&loaded](ResourceCache::Type, const Ogre::ResourcePtr& res) {
+			loaded = loaded || res->isLoaded();
+		});
+		if (loaded) {
+			++it;
+			continue;
+		}
+		// Se descarga el resto (programas, esqueletos...) pero se mantienen
+		// declarados (los materiales siguen existiendo para el RTShader),
+		// asi volver a pedirlo es solo cargar
+		rgm.unloadResourceGroup(*it);
+		it = releasedGroups_.erase(it);
+	}
+}
+
+void OgreContext::prefetchResourceGroups(const std::vector<std::string>& groups)
+{
+	Ogre::ResourceGroupManager& rgm = Ogre::ResourceGroupManager::getSingleton();
+	for (const std::string& group : groups) {
+		if (!isResourceGroupUsable(group)) continue;
+		auto it = groupRefs_.find(group);
+		if (it != groupRefs_.end() && it->second > 0) continue;
+
+		// Los scripts declaran los recursos, tiene que ser en este hilo
+		if (!rgm.isResourceGroupInitialised(group))
+			rgm.initialiseResourceGroup(group);
+		if (!rgm.isResourceGroupLoaded(group))
+			Ogre::ResourceBackgroundQueue::getSingleton().prepareResourceGroup(group);
+	}
+}
+
+const std::vector<std::string>& OgreContext::getResourceGroups() const
+{
+	return resourceGroups_;
+}
+
+namespace {
+	//Los recursos se buscan en todos los grupos
+	Ogre::ResourcePtr findResource(Ogre::ResourceManager* manager, const std::string& name)
+	{
+		return manager->getResourceByName(name, Ogre::RGN_AUTODETECT);
+	}
+
+	ResourceCache::Backend ogreBackend(Ogre::ResourceManager* manager)
+	{
+		ResourceCache::Backend backend;
+		backend.size = [manager](const std::string& name) -> size_t {
+			Ogre::ResourcePtr res = findResource(manager, name);
+			return res && res->isLoaded() ? res->getSize() : 0;
+		};
+		//El gestor y el grupo guardan sus referencias, mas la de findResource
+		backend.inUse = [manager](const std::string& name) {
+			Ogre::ResourcePtr res = findResource(manager, name);
+			return res && res.use_count() > Ogre::ResourceGroupManager::RESOURCE_SYSTEM_NUM_REFERENCE_COUNTS + 1;
+		};
+		//Se descarga pero sigue declarado, Ogre lo recarga si se vuelve a usar
+		backend.unload = [manager](const std::string& name) {
+			Ogre::ResourcePtr res = findResource(manager, name);
+			if (res && res->isReloadable())
+				res->unload();
+		};
+		return backend;
+	}
+}
+
+void OgreContext::registerResourceCache()
+{
+	ResourceCache* cache = ResourceCache::getInstance();
+	cache->setBackend(ResourceCache::Type::Mesh, ogreBackend(Ogre::MeshManager::getSingletonPtr()));
+	cache->setBackend(ResourceCache::Type::Material, ogreBackend(Ogre::MaterialManager::getSingletonPtr()));
+	cache->setBackend(ResourceCache::Type::Texture, ogreBackend(Ogre::TextureManager::getSingletonPtr()));
+}
+
+void OgreContext::holdResources(Ogre::Entity* ent, ResourceCache::Handles& handles)
+{
+	if (ent == nullptr) return;
+	handles.acquire(ResourceCache::Type::Mesh, ent->getMesh()->getName());
+	for (unsigned int i = 0; i < ent->getNumSubEntities(); ++i)
+		holdMaterial(ent->getSubEntity(i)->getMaterialName(), handles);
+}
+
+void OgreContext::holdMaterial(const std::string& materialName, ResourceCache::Handles& handles)
+{
+	Ogre::MaterialPtr mat = Ogre::MaterialManager::getSingleton().getByName(materialName, Ogre::RGN_AUTODETECT);
+	if (!mat) return;
+
+	handles.acquire(ResourceCache::Type::Material, mat->getName());
+	for (Ogre::Technique* tech : mat->getTechniques())
+		for (Ogre::Pass* pass : tech->getPasses())
+			for (Ogre::TextureUnitState* tus : pass->getTextureUnitStates())
+				for (unsigned int f = 0; f < tus->getNumFrames(); ++f)
+					handles.acquire(ResourceCache::Type::Texture, tus->getFrameTextureName(f));
+}
+
+#pragma endregion
+
 void OgreContext::clean()
 {
 	OgreContext::getInstance()->getRenderWindow()->removeAllViewports();
@@ -224,16 +408,26 @@ void OgreContext::destroy()
 	instance_->mShaderGenerator_->removeSceneManager(instance_->mSM);
 	instance_->ogreRoot_->destroySceneManager(instance_->mSM);
 	delete instance_;
+	instance_ = nullptr;
 }
 
 void OgreContext::setSkyPlane(const std::string& materialName, float planeDist, int width, int height, float bow)
 {
 	mSM->setSkyPlane(true, Ogre::Plane(Ogre::Vector3::UNIT_Z, planeDist), materialName, 1, 1, true, bow, width, height);
+	skyResources_.releaseAll();
+	holdMaterial(materialName, skyResources_);
 
 }
 
 OgreContext::~OgreContext()
 {
+	//El cache deja de conocer los recursos de Ogre, se liberan con Root
+	skyResources_.releaseAll();
+	ResourceCache* cache = ResourceCache::getInstance();
+	cache->setBackend(ResourceCache::Type::Mesh, ResourceCache::Backend());
+	cache->setBackend(ResourceCache::Type::Material, ResourceCache::Backend());
+	cache->setBackend(ResourceCache::Type::Texture, ResourceCache::Backend());
+
 	if (ogreRoot_ != nullptr)
 		ogreRoot_->saveConfig();
 
@@ -0,0 +1,288 @@
+#include "ParticleSystemComponent.h"
+#include "RenderManager.h"
+#include "OgreContext.h"
+#include "Entity.h"
+#include "CommonManager.h"
+#include "Transform.h"
+#include "SimdMath.h"
+#include <OgreSceneManager.h>
+#include <OgreSceneNode.h>
+#include <OgreBillboardSet.h>
+#include <OgreBillboard.h>
+#include <checkML.h>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	const float PI = 3.14159265f;
+
+	// Lee un rango [min, max] o un unico valor
+	void readRange(const nlohmann::json& params, const char* key, float& min, float& max)
+	{
+		auto it = params.find(key);
+		if (it == params.end()) return;
+		if (it->is_array()) {
+			std::vector<float> r = it->get<std::vector<float>>();
+			if (r.size() < 2) throw std::runtime_error(std::string("ParticleSystem: ") + key + " needs [min, max]\n");
+			min = r[0];
+			max = r[1];
+		}
+		else
+			min = max = it->get<float>();
+	}
+}
+
+ParticleSystemComponent::ParticleSystemComponent() :
+	Component(RenderManager::getInstance(), (int)RenderManager::RenderCmpId::ParticleSystem),
+	rng_(std::random_device()())
+{
+	Ogre::SceneManager* sm = OgreContext::getInstance()->getSceneManager();
+	// Las particulas estan en coordenadas del mundo, el nodo se queda en el origen
+	mNode_ = sm->getRootSceneNode()->createChildSceneNode();
+	bbSet_ = sm->createBillboardSet(maxParticles_);
+	bbSet_->setAutoextend(false);
+	bbSet_->setCullIndividually(false);
+	mNode_->attachObject(bbSet_);
+	init();
+}
+
+ParticleSystemComponent::~ParticleSystemComponent()
+{
+	Ogre::SceneManager* sm = OgreContext::getInstance()->getSceneManager();
+	if (bbSet_ != nullptr) sm->destroyBillboardSet(bbSet_);
+	if (mNode_ != nullptr) sm->destroySceneNode(mNode_);
+}
+
+void ParticleSystemComponent::init()
+{
+	maxParticles_ = 100;
+	allocate();
+}
+
+void ParticleSystemComponent::allocate()
+{
+	for (auto* arr : { &px_, &py_, &pz_, &vx_, &vy_, &vz_, &age_, &life_ })
+		arr->assign(maxParticles_, 0.0f);
+	count_ = 0;
+	bbSet_->setPoolSize(maxParticles_);
+}
+
+void ParticleSystemComponent::load(const nlohmann::json& params)
+{
+	auto it = params.find("maxParticles");
+	if (it != params.end()) maxParticles_ = it->get<size_t>();
+	allocate();
+
+	it = params.find("material");
+	if (it != params.end()) bbSet_->setMaterialName(it->get<std::string>());
+
+	it = params.find("rate");
+	if (it != params.end()) rate_ = it->get<float>();
+
+	it = params.find("burst");
+	if (it != params.end()) burst_ = it->get<int>();
+
+	it = params.find("duration");
+	if (it != params.end()) duration_ = it->get<float>();
+
+	it = params.find("loop");
+	if (it != params.end()) loop_ = it->get<bool>();
+
+	it = params.find("playOnStart");
+	if (it != params.end()) emitting_ = it->get<bool>();
+
+	readRange(params, "lifetime", minLife_, maxLife_);
+	readRange(params, "speed", minSpeed_, maxSpeed_);
+
+	it = params.find("direction");
+	if (it != params.end()) {
+		direction_ = Vector3(it->get<std::vector<float>>());
+		if (direction_.normalize() == 0.0f) direction_ = Vector3(0, 1, 0);
+	}
+
+	// En grados, como el resto de rotaciones del json
+	it = params.find("spread");
+	if (it != params.end()) spread_ = it->get<float>() * PI / 180.0f;
+
+	it = params.find("gravity");
+	if (it != params.end()) gravity_ = Vector3(it->get<std::vector<float>>());
+
+	it = params.find("drag");
+	if (it != params.end()) drag_ = it->get<float>();
+
+	it = params.find("size");
+	if (it != params.end()) size_ = it->get<float>();
+	bbSet_->setDefaultDimensions(size_, size_);
+
+	it = params.find("colour");
+	if (it != params.end()) {
+		std::vector<float> c = it->get<std::vector<float>>();
+		for (size_t i = 0; i < 4 && i < c.size(); i++) colour_[i] = c[i];
+	}
+
+	it = params.find("fade");
+	if (it != params.end()) fade_ = it->get<bool>();
+}
+
+void ParticleSystemComponent::setUp()
+{
+	tr_ = _entity->get<Transform>();
+	if (emitting_) play();
+}
+
+void ParticleSystemComponent::update(float deltaTime)
+{
+	if (!_active) return;
+
+	if (emitting_) {
+		elapsed_ += deltaTime;
+		emitAccum_ += rate_ * deltaTime;
+		size_t n = (size_t)emitAccum_;
+		emitAccum_ -= n;
+		emit(n);
+
+		if (duration_ > 0.0f && elapsed_ >= duration_) {
+			if (loop_) {
+				elapsed_ = 0.0f;
+				emit(burst_);
+			}
+			else emitting_ = false;
+		}
+	}
+
+	simulate(deltaTime);
+	removeDead();
+	render();
+}
+
+void ParticleSystemComponent::setActive(bool act)
+{
+	Component::setActive(act);
+	mNode_->setVisible(_active);
+}
+
+float ParticleSystemComponent::random(float min, float max)
+{
+	if (min >= max) return min;
+	return std::uniform_real_distribution<float>(min, max)(rng_);
+}
+
+// Direccion aleatoria dentro del cono de semiangulo spread_ alrededor de direction_
+Vector3 ParticleSystemComponent::randomDirection()
+{
+	if (spread_ <= 0.0f) return direction_;
+
+	float cosT = random(std::cos(spread_), 1.0f);
+	float sinT = std::sqrt(std::max(0.0f, 1.0f - cosT * cosT));
+	float phi = random(0.0f, 2.0f * PI);
+
+	Vector3 axis = std::abs(direction_.x) < 0.9f ? Vector3(1, 0, 0) : Vector3(0, 1, 0);
+	Vector3 u = direction_.cross(axis);
+	u.normalize();
+	Vector3 v = direction_.cross(u);
+	return direction_ * cosT + (u * std::cos(phi) + v * std::sin(phi)) * sinT;
+}
+
+void ParticleSystemComponent::emit(size_t n)
+{
+	if (tr_ == nullptr) return;
+	n = std::min(n, maxParticles_ - count_);
+	Vector3 origin = tr_->getWorldPos();
+
+	for (size_t i = count_; i < count_ + n; i++) {
+		Vector3 vel = randomDirection() * random(minSpeed_, maxSpeed_);
+		px_[i] = origin.x; py_[i] = origin.y; pz_[i] = origin.z;
+		vx_[i] = vel.x; vy_[i] = vel.y; vz_[i] = vel.z;
+		age_[i] = 0.0f;
+		life_[i] = random(minLife_, maxLife_);
+	}
+	count_ += n;
+}
+
+void ParticleSystemComponent::simulate(float deltaTime)
+{
+	if (count_ == 0) return;
+
+	simd::addScalar(age_.data(), deltaTime, count_);
+
+	if (!gravity_.isZero()) {
+		simd::addScalar(vx_.data(), gravity_.x * deltaTime, count_);
+		simd::addScalar(vy_.data(), gravity_.y * deltaTime, count_);
+		simd::addScalar(vz_.data(), gravity_.z * deltaTime, count_);
+	}
+	if (drag_ > 0.0f) {
+		float k = std::max(0.0f, 1.0f - drag_ * deltaTime);
+		simd::mulScalar(vx_.data(), k, count_);
+		simd::mulScalar(vy_.data(), k, count_);
+		simd::mulScalar(vz_.data(), k, count_);
+	}
+
+	simd::integrate(px_.data(), py_.data(), pz_.data(), vx_.data(), vy_.data(), vz_.data(), deltaTime, count_);
+}
+
+// Las muertas se sustituyen por la ultima viva para no dejar huecos
+void ParticleSystemComponent::removeDead()
+{
+	size_t i = 0;
+	while (i < count_) {
+		if (age_[i] >= life_[i]) {
+			size_t last = --count_;
+			px_[i] = px_[last]; py_[i] = py_[last]; pz_[i] = pz_[last];
+			vx_[i] = vx_[last]; vy_[i] = vy_[last]; vz_[i] = vz_[last];
+			age_[i] = age_[last];
+			life_[i] = life_[last];
+		}
+		else i++;
+	}
+}
+
+void ParticleSystemComponent::render()
+{
+	// clear solo devuelve los billboards al pool, no libera memoria
+	bbSet_->clear();
+	for (size_t i = 0; i < count_; i++) {
+		float alpha = colour_[3];
+		if (fade_ && life_[i] > 0.0f) alpha *= 1.0f - age_[i] / life_[i];
+		bbSet_->createBillboard(px_[i], py_[i], pz_[i], Ogre::ColourValue(colour_[0], colour_[1], colour_[2], alpha));
+	}
+	bbSet_->_updateBounds();
+}
+
+void ParticleSystemComponent::play()
+{
+	emitting_ = true;
+	elapsed_ = 0.0f;
+	emitAccum_ = 0.0f;
+	emit(burst_);
+}
+
+void ParticleSystemComponent::stop()
+{
+	emitting_ = false;
+}
+
+void ParticleSystemComponent::burst(int n)
+{
+	if (n > 0) emit(n);
+}
+
+void ParticleSystemComponent::clear()
+{
+	count_ = 0;
+	bbSet_->clear();
+}
+
+bool ParticleSystemComponent::isEmitting() const
+{
+	return emitting_;
+}
+
+bool ParticleSystemComponent::isAlive() const
+{
+	return emitting_ || count_ > 0;
+}
+
+int ParticleSystemComponent::getParticleCount() const
+{
+	return (int)count_;
+}
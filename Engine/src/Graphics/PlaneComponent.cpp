@@ -33,6 +33,8 @@ void PlaneComponent::setMaterial(const std::string& matName)
 	catch (const std::exception& e) {
 		throw std::runtime_error("The texture " + matName + " no exist. " + e.what());
 	}
+	resources_.releaseAll();
+	OgreContext::getInstance()->holdResources(ent_, resources_);
 }
 
 void PlaneComponent::load(const nlohmann::json& params)
@@ -93,7 +95,8 @@ void PlaneComponent::load(const nlohmann::json& params)
 		1, 1, true, 1, 1.0, 1.0,upVector);
 
 	ent_ = OgreContext::getInstance()->getSceneManager()->createEntity(name);
-	
+	OgreContext::getInstance()->holdResources(ent_, resources_);
+
 	it = params.find("planeMaterial");
 	if (it != params.end()) {
 		std::string mat = it->get<std::string>();
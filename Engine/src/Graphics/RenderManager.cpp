@@ -1,4 +1,5 @@
 #include "..\..\include\Graphics\RenderManager.h"
+#include "EngineContext.h"
 #include "..\..\include\Graphics\RenderManager.h"
 #include "RenderManager.h"
 #include "OgreContext.h"
@@ -10,8 +11,15 @@
 #include "Camera.h"
 #include "LightComponent.h"
 #include "PlaneComponent.h"
+#include "ParticleSystemComponent.h"
+#include "AnimatorComponent.h"
+#include <OgreRenderWindow.h>
+#include <OgreViewport.h>
+#include <OgreCamera.h>
+#include <algorithm>
+#include <execution>
 
-RenderManager* RenderManager::instance_ = nullptr;
+static_assert((int)RenderManager::RenderCmpId::LastRenderCmpId == NATIVE_COMPONENTS[(int)ManID::Render], "Update NATIVE_COMPONENTS in ComponentTypes.h");
 
 RenderManager::RenderManager() : Manager(ManID::Render)
 {
@@ -21,6 +29,8 @@ RenderManager::RenderManager() : Manager(ManID::Render)
 	registerComponent("Camera", (int)RenderCmpId::Camera, []() -> Camera* { return new Camera(); });
 	registerComponent("LightComponent", (int)RenderCmpId::Light, []() -> LightComponent* { return new LightComponent(); });
 	registerComponent("PlaneComponent", (int)RenderCmpId::Plane, []() -> PlaneComponent* { return new PlaneComponent(); });
+	registerComponent("ParticleSystem", (int)RenderCmpId::ParticleSystem, []() -> ParticleSystemComponent* { return new ParticleSystemComponent(); });
+	registerComponent("Animator", (int)RenderCmpId::Animator, []() -> AnimatorComponent* { return new AnimatorComponent(); });
 }
 
 RenderManager::~RenderManager()
@@ -29,13 +39,14 @@ RenderManager::~RenderManager()
 
 RenderManager* RenderManager::getInstance()
 {
-	return instance_;
+	return EngineContext::current()->render;
 }
 
 bool RenderManager::setUpInstance() {
-	if (!instance_) {
+	EngineContext* ctx = EngineContext::current();
+	if (!ctx->render) {
 		try {
-			instance_ = new RenderManager();
+			ctx->render = new RenderManager();
 		}
 		catch (...) {
 			return false;
@@ -46,29 +57,78 @@ bool RenderManager::setUpInstance() {
 
 void RenderManager::clean()
 {
-	instance_->destroyAllComponents();
+	getInstance()->destroyAllComponents();
 }
 
 void RenderManager::destroy()
 {
-	instance_->clean();
-	delete instance_;
+	getInstance()->clean();
+	delete getInstance();
+	EngineContext::current()->render = nullptr;
 }
 
 void RenderManager::start()
 {
-	for (Component* cmp : _compsList)
-	{
-		cmp->setUp();
-	}
+	for (size_t i = 0; i < _compsList.size(); ++i)
+		_compsList[i]->setUp();
 }
 
 void RenderManager::update(float deltaTime)
 {
-	for (Component* cmp : _compsList)
-	{
-		cmp->update(deltaTime);
-	}
+	forEachActive([deltaTime](Component* cmp) { cmp->update(deltaTime); });
+	updateAnimations(deltaTime);
 	ogreRoot_->renderOneFrame();	//TODO: esto no lo esta lanzando el RenderManager
 
 }
+
+void RenderManager::updateAnimations(float deltaTime)
+{
+	if (animators_.empty()) return;
+
+	//La camara se lee una vez aqui, los animadores no tocan nodos de Ogre
+	AnimatorComponent::View view;
+	Ogre::RenderWindow* window = OgreContext::getInstance()->getRenderWindow();
+	Ogre::Camera* cam = window->getNumViewports() > 0 ? window->getViewport(0)->getCamera() : nullptr;
+	if (cam != nullptr) {
+		view.hasCamera = true;
+		Ogre::Vector3 p = cam->getDerivedPosition();
+		view.position = Vector3(p.x, p.y, p.z);
+		for (unsigned short i = 0; i < 6; i++) {
+			const Ogre::Plane& plane = cam->getFrustumPlane(i);
+			view.normals[i] = Vector3(plane.normal.x, plane.normal.y, plane.normal.z);
+			view.distances[i] = plane.d;
+		}
+	}
+
+	//Cada animador solo toca sus AnimationState, se pueden repartir entre hilos
+	EngineContext* ctx = EngineContext::current();
+	auto advance = [ctx, deltaTime, &view](AnimatorComponent* animator) {
+		if (!animator->isActive()) return;
+		EngineContext::Scope scope(ctx);
+		animator->advance(deltaTime, view);
+	};
+	if (parallelAnimation_ && animators_.size() >= PARALLEL_ANIMATORS)
+		std::for_each(std::execution::par, animators_.begin(), animators_.end(), advance);
+	else
+		std::for_each(animators_.begin(), animators_.end(), advance);
+}
+
+void RenderManager::addAnimator(AnimatorComponent* animator)
+{
+	if (std::find(animators_.begin(), animators_.end(), animator) == animators_.end())
+		animators_.push_back(animator);
+}
+
+void RenderManager::removeAnimator(AnimatorComponent* animator)
+{
+	auto it = std::find(animators_.begin(), animators_.end(), animator);
+	if (it != animators_.end()) {
+		*it = animators_.back();
+		animators_.pop_back();
+	}
+}
+
+void RenderManager::setParallelAnimation(bool parallel)
+{
+	parallelAnimation_ = parallel;
+}
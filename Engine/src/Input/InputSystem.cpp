@@ -1,4 +1,5 @@
 #include "InputSystem.h"
+#include "EngineContext.h"
 
 #include <iostream>
 
@@ -9,8 +10,6 @@
 #include <SDL_gamecontroller.h>
 #include <SDL_events.h>
 
-InputSystem* InputSystem::instance_ = nullptr;
-
 InputSystem::InputSystem()
 {
 }
@@ -21,12 +20,13 @@ InputSystem::~InputSystem()
 
 InputSystem* InputSystem::getInstance()
 {
-	return instance_;
+	return EngineContext::current()->input;
 }
 
 bool InputSystem::setUpInstance() {
-	if (instance_ == nullptr)
-		instance_ = new InputSystem();
+	EngineContext* ctx = EngineContext::current();
+	if (!ctx->input)
+		ctx->input = new InputSystem();
 	return true;
 }
 
@@ -36,8 +36,9 @@ void InputSystem::clean()
 
 void InputSystem::destroy()
 {
-	instance_->clean();
-	delete instance_;
+	getInstance()->clean();
+	delete getInstance();
+	EngineContext::current()->input = nullptr;
 }
 
 bool InputSystem::handleInput(const SDL_Event& e)
@@ -1,8 +1,10 @@
 #include "LUAManager.h"
+#include "EngineContext.h"
 #include <iostream>
 
 //physics
 #include <Rigidbody.h>
+#include <TriggerComponent.h>
 #include <PhysicsManager.h>
 
 //Papagayo
@@ -14,6 +16,7 @@
 #include <Transform.h>
 #include <Entity.h>
 #include <CommonManager.h>
+#include <Reflection.h>
 
 //input
 #include <./Input/InputSystem.h>
@@ -23,6 +26,8 @@
 #include <Camera.h>
 #include <LightComponent.h>
 #include <PlaneComponent.h>
+#include <ParticleSystemComponent.h>
+#include <AnimatorComponent.h>
 #include <RenderManager.h>
 #include <OgreContext.h>
 
@@ -31,6 +36,13 @@
 #include "UILabel.h"
 #include "UIManager.h"
 #include "UIImage.h"
+#include "UISlider.h"
+
+//Audio
+#include "AudioEmitter.h"
+#include "NavigationManager.h"
+#include "CrowdAgent.h"
+#include "NetworkManager.h"
 
 //LUA
 #include "LuaComponent.h"
@@ -46,7 +58,6 @@
 
 using namespace luabridge;
 
-LUAManager* LUAManager::instance_ = nullptr;
 
 
 bool LUAManager::CheckLua(lua_State* L, int r)
@@ -68,14 +79,15 @@ LUAManager::~LUAManager()
 
 LUAManager* LUAManager::getInstance()
 {
-	return instance_;
+	return EngineContext::current()->lua;
 }
 
 bool LUAManager::setUpInstance()
 {
-	if (instance_ == nullptr) {
+	EngineContext* ctx = EngineContext::current();
+	if (!ctx->lua) {
 		try {
-			instance_ = new LUAManager();
+			ctx->lua = new LUAManager();
 		}
 		catch (...) {
 			return false;
@@ -86,36 +98,182 @@ bool LUAManager::setUpInstance()
 
 void LUAManager::start()
 {
-	for (Component* cmp : _compsList)
-	{
-		cmp->setUp();
-	}
+	// Por indice: los start de Lua pueden crear componentes
+	for (size_t i = 0; i < _compsList.size(); ++i)
+		_compsList[i]->setUp();
 }
 
 void LUAManager::update(float deltaTime)
 {
-	for (Component* cmp : _compsList)
-	{
-		cmp->update(deltaTime);
-	}
+	forEachActive([deltaTime](Component* cmp) { cmp->update(deltaTime); });
 }
 
 void LUAManager::fixedUpdate(float deltaTime)
 {
-	for (Component* cmp : _compsList)
-	{
-		static_cast<LuaComponent*>(cmp)->fixedUpdate(deltaTime);
-	}
+	forEachActive([deltaTime](Component* cmp) { static_cast<LuaComponent*>(cmp)->fixedUpdate(deltaTime); });
 }
 
 void LUAManager::clean()
 {
-	instance_->destroyAllComponents();
+	getInstance()->destroyAllComponents();
 }
 
 void LUAManager::destroy() {
-	instance_->clean();
-	delete instance_;
+	getInstance()->clean();
+	delete getInstance();
+	EngineContext::current()->lua = nullptr;
+}
+
+/// <summary>
+/// Asocia una funcion de lua a un evento de un componente de UI ("click",
+/// "hoverEnter", "hoverExit", "valueChanged"). La funcion recibe el valor
+/// del evento y se llama desde el update del UIManager. Con nil se quita
+/// </summary>
+template<class T>
+static void setUICallback(T* comp, const std::string& eventName, luabridge::LuaRef callback)
+{
+	UIComponent::UIEvent ev = UIComponent::getEventByName(eventName);
+	if (ev == UIComponent::UIEvent::LastUIEvent) {
+		std::cout << "WARNING: evento de UI desconocido: " << eventName << "\n";
+		return;
+	}
+	if (!callback.isFunction()) {
+		comp->setCallback(ev, nullptr);
+		return;
+	}
+	comp->setCallback(ev, [callback, eventName](float value) {
+		try {
+			callback(value);
+		}
+		catch (const std::exception& e) {
+			std::cout << "ERROR en el callback " << eventName << ": " << e.what() << "\n";
+		}
+	});
+}
+
+/// <summary>
+/// Devuelve el camino de una peticion como tabla de Vector3, o nil si aun
+/// no esta listo o ha fallado
+/// </summary>
+static luabridge::LuaRef getNavPath(NavigationManager* nav, int id, lua_State* L)
+{
+	std::vector<Vector3> path;
+	if (!nav->getPath(id, path))
+		return luabridge::LuaRef(L);
+	luabridge::LuaRef t = luabridge::newTable(L);
+	for (size_t i = 0; i < path.size(); i++)
+		t[i + 1] = path[i];
+	return t;
+}
+
+// Numeros de una tabla de lua (desde 1), como los arrays del json
+static void readLuaFloats(const luabridge::LuaRef& value, float* out, int n, const std::string& path)
+{
+	if (!value.isTable() || value.length() < n)
+		throw Reflection::Error(path, "expected a table of " + std::to_string(n) + " numbers");
+	for (int i = 0; i < n; i++) {
+		luabridge::LuaRef v = value[i + 1];
+		if (!v.isNumber())
+			throw Reflection::Error(path + "[" + std::to_string(i + 1) + "]", "expected a number");
+		out[i] = v.cast<float>();
+	}
+}
+
+// Valor de un campo leido de Lua, se guarda aqui hasta aplicarlo
+struct LuaFieldValue {
+	bool b = false;
+	int i = 0;
+	float x = 0;
+	std::string s;
+	std::pair<float, float> p;
+	Vector3 v;
+	std::vector<float> list;
+};
+
+// Comprueba el tipo y deja el valor en out; devuelve lo que hay que pasarle a set
+static const void* readLuaField(const Reflection::Field& f, const luabridge::LuaRef& value, const std::string& path, LuaFieldValue& out)
+{
+	using Reflection::FieldType;
+	switch (f.type) {
+	case FieldType::Bool:
+		if (!value.isBool()) throw Reflection::Error(path, "expected a boolean");
+		out.b = value.cast<bool>();
+		return &out.b;
+	case FieldType::Int:
+		if (!value.isNumber()) throw Reflection::Error(path, "expected an integer");
+		out.i = value.cast<int>();
+		return &out.i;
+	case FieldType::Float:
+		if (!value.isNumber()) throw Reflection::Error(path, "expected a number");
+		out.x = value.cast<float>();
+		return &out.x;
+	case FieldType::String:
+		if (!value.isString()) throw Reflection::Error(path, "expected a string");
+		out.s = value.cast<std::string>();
+		return &out.s;
+	case FieldType::Vector2: {
+		float v[2];
+		readLuaFloats(value, v, 2, path);
+		out.p = std::pair<float, float>(v[0], v[1]);
+		return &out.p;
+	}
+	case FieldType::Vector3: {
+		// Vale un Vector3 o una tabla {x, y, z}
+		if (value.isInstance<Vector3>())
+			out.v = value.cast<Vector3>();
+		else {
+			float v[3];
+			readLuaFloats(value, v, 3, path);
+			out.v = Vector3(v[0], v[1], v[2]);
+		}
+		return &out.v;
+	}
+	case FieldType::FloatList:
+		if (!value.isTable()) throw Reflection::Error(path, "expected a table of numbers");
+		out.list.resize(value.length());
+		readLuaFloats(value, out.list.data(), (int)out.list.size(), path);
+		return &out.list;
+	}
+	throw Reflection::Error(path, "unknown field type");
+}
+
+/// <summary>
+/// Cambia desde lua los campos declarados del componente con una tabla, p.ej.
+/// tr:setParams({ position = {0, 2, 0}, rotation = Vector3(0, 90, 0) }).
+/// Solo cambia los que estan en la tabla; los obligatorios solo se exigen al
+/// cargar la escena. Se leen y comprueban todos antes de aplicar ninguno,
+/// asi un error no deja el componente a medias
+/// </summary>
+static void setLuaParams(Component* comp, luabridge::LuaRef params)
+{
+	const Reflection::TypeInfo* type = comp->getTypeInfo();
+	if (type == nullptr) {
+		std::cout << "WARNING: component has no declared parameters\n";
+		return;
+	}
+	try {
+		if (!params.isTable())
+			throw Reflection::Error(type->getName(), "parameters must be a table");
+
+		const std::vector<Reflection::Field>& fields = type->getFields();
+		LuaFieldValue values[Reflection::TypeInfo::MAX_FIELDS];
+		const void* read[Reflection::TypeInfo::MAX_FIELDS] = {};
+		for (size_t i = 0; i < fields.size(); i++) {
+			luabridge::LuaRef value = params[fields[i].name];
+			if (value.isNil()) continue;
+			std::string path = type->getName() + "." + fields[i].name;
+			if (fields[i].isLoadOnly)
+				throw Reflection::Error(path, "can only be set when loading");
+			read[i] = readLuaField(fields[i], value, path, values[i]);
+		}
+
+		for (size_t i = 0; i < fields.size(); i++)
+			if (read[i] != nullptr)
+				fields[i].set(comp, read[i]);
+	}
+	catch (const Reflection::Error& e) {
+		std::cout << e.what();
+	}
 }
 
 //Aqui van todas las funciones y clases correspondientes 
@@ -146,7 +304,9 @@ void LUAManager::registerClassAndFunctions(lua_State* L) {
 	//common
 	getGlobalNamespace(L).beginClass<Component>("Component")
 		.addFunction("isActive", &Component::isActive)
+		.addFunction("setActive", &Component::setActive)
 		.addFunction("getEntity", &Component::getEntity)
+		.addFunction("setParams", &setLuaParams)
 		.endClass();
 
 	
@@ -155,8 +315,16 @@ void LUAManager::registerClassAndFunctions(lua_State* L) {
 		.addFunction("setPosition", &Transform::setPos)
 		.addFunction("getRotation", &Transform::getRot)
 		.addFunction("setRotation", &Transform::setRot)
+		.addFunction("getVelocity", &Transform::getVel)
+		.addFunction("setVelocity", &Transform::setVel)
+		.addFunction("isKinematic", &Transform::isKinematic)
+		.addFunction("setKinematic", &Transform::setKinematic)
 		.addFunction("getDimensions", &Transform::getDimensions)
 		.addFunction("setDimensions", &Transform::setDimensions)
+		.addFunction("getParent", &Transform::getParent)
+		.addFunction("setParent", &Transform::setParent)
+		.addFunction("getWorldPosition", &Transform::getWorldPos)
+		.addFunction("getWorldScale", &Transform::getWorldScale)
 		.endClass();
 
 	//phisics
@@ -183,6 +351,13 @@ void LUAManager::registerClassAndFunctions(lua_State* L) {
 		.addFunction("setFriction", &RigidBody::setFriction)
 		.endClass();
 
+	getGlobalNamespace(L).deriveClass<TriggerComponent, Component>("Trigger")
+		.addFunction("isInside", &TriggerComponent::isInside)
+		.addFunction("getOverlapCount", &TriggerComponent::getOverlapCount)
+		.addFunction("setOffset", &TriggerComponent::setOffset)
+		.addFunction("getOffset", &TriggerComponent::getOffset)
+		.endClass();
+
 	//graphics
 	getGlobalNamespace(L).deriveClass<MeshComponent,Component>("Mesh")
 		.addFunction("setActive", &MeshComponent::setActive)
@@ -209,6 +384,28 @@ void LUAManager::registerClassAndFunctions(lua_State* L) {
 	getGlobalNamespace(L).deriveClass<PlaneComponent, Component>("Plane")
 		.addFunction("setMaterial", &PlaneComponent::setMaterial)
 		.endClass();
+	getGlobalNamespace(L).deriveClass<ParticleSystemComponent, Component>("ParticleSystem")
+		.addFunction("play", &ParticleSystemComponent::play)
+		.addFunction("stop", &ParticleSystemComponent::stop)
+		.addFunction("burst", &ParticleSystemComponent::burst)
+		.addFunction("clear", &ParticleSystemComponent::clear)
+		.addFunction("isEmitting", &ParticleSystemComponent::isEmitting)
+		.addFunction("isAlive", &ParticleSystemComponent::isAlive)
+		.addFunction("getParticleCount", &ParticleSystemComponent::getParticleCount)
+		.endClass();
+
+	getGlobalNamespace(L).deriveClass<AnimatorComponent, Component>("Animator")
+		.addFunction("play", &AnimatorComponent::play)
+		.addFunction("crossFade", &AnimatorComponent::crossFade)
+		.addFunction("blend", &AnimatorComponent::blend)
+		.addFunction("stop", &AnimatorComponent::stop)
+		.addFunction("isPlaying", &AnimatorComponent::isPlaying)
+		.addFunction("hasAnimation", &AnimatorComponent::hasAnimation)
+		.addFunction("getCurrentAnimation", &AnimatorComponent::getCurrentAnimation)
+		.addFunction("setSpeed", &AnimatorComponent::setSpeed)
+		.addFunction("getSpeed", &AnimatorComponent::getSpeed)
+		.addFunction("getUpdateInterval", &AnimatorComponent::getUpdateInterval)
+		.endClass();
 
 	getGlobalNamespace(L).beginClass<OgreContext>("OgreContext")
 		.addFunction("getWindowWidth", &OgreContext::getWindowWidth)
@@ -223,15 +420,100 @@ void LUAManager::registerClassAndFunctions(lua_State* L) {
 		.addFunction("buttonWasPressed", &UIButton::buttonWasPressed)
 		.addFunction("buttonNotPressed", &UIButton::buttonNotPressed)
 		.addFunction("setText", &UIButton::setText)
+		.addFunction("setNumber", &UIButton::setNumber)
+		.addFunction("setFormatted", &UIButton::setFormatted)
+		.addFunction("getText", &UIButton::getText)
+		.addFunction("setCallback", &setUICallback<UIButton>)
 		.endClass();
 
 	getGlobalNamespace(L).deriveClass<UIImage, Component>("Image")
 		.addFunction("setProperty", &UIComponent::setProperty)
 		.addFunction("setActive", &UIComponent::setActive)
+		.addFunction("setCallback", &setUICallback<UIImage>)
+		.endClass();
+
+	getGlobalNamespace(L).deriveClass<UISlider, Component>("Slider")
+		.addFunction("setProperty", &UIComponent::setProperty)
+		.addFunction("setActive", &UIComponent::setActive)
+		.addFunction("getValue", &UISlider::getValue)
+		.addFunction("setValue", &UISlider::setValue)
+		.addFunction("setCallback", &setUICallback<UISlider>)
 		.endClass();
 
 	getGlobalNamespace(L).deriveClass<UILabel, Component>("Label")
 		.addFunction("setText", &UILabel::setText)
+		.addFunction("setNumber", &UILabel::setNumber)
+		.addFunction("setFormatted", &UILabel::setFormatted)
+		.addFunction("getText", &UILabel::getText)
+		.addFunction("setCallback", &setUICallback<UILabel>)
+		.endClass();
+
+	//Audio
+	getGlobalNamespace(L).deriveClass<AudioEmitter, Component>("AudioEmitter")
+		.addFunction("play", &AudioEmitter::play)
+		.addFunction("stop", &AudioEmitter::stop)
+		.addFunction("isPlaying", &AudioEmitter::isPlaying)
+		.addFunction("setVolume", &AudioEmitter::setVolume)
+		.addFunction("getVolume", &AudioEmitter::getVolume)
+		.endClass();
+
+	//Estado de la peticion: 0 invalida, 1 pendiente, 2 lista, 3 fallida
+	getGlobalNamespace(L).beginClass<NavigationManager>("NavigationManager")
+		.addFunction("requestPath", &NavigationManager::requestPath)
+		.addFunction("getPathStatus", [](NavigationManager* n, int id) { return (int)n->getPathStatus(id); })
+		.addFunction("getPath", &getNavPath)
+		.addFunction("releasePath", &NavigationManager::releasePath)
+		.addFunction("isWalkable", &NavigationManager::isWalkable)
+		.addFunction("hasNavMesh", &NavigationManager::hasNavMesh)
+		.endClass();
+
+	getGlobalNamespace(L).deriveClass<CrowdAgent, Component>("CrowdAgent")
+		.addFunction("moveTo", &CrowdAgent::moveTo)
+		.addFunction("setDesiredVelocity", &CrowdAgent::setDesiredVelocity)
+		.addFunction("stop", &CrowdAgent::stop)
+		.addFunction("isMoving", &CrowdAgent::isMoving)
+		.addFunction("getVelocity", &CrowdAgent::getVelocity)
+		.addFunction("setMaxSpeed", &CrowdAgent::setMaxSpeed)
+		.addFunction("getMaxSpeed", &CrowdAgent::getMaxSpeed)
+		.endClass();
+
+	//Modo: 0 sin red, 1 servidor, 2 cliente, 3 loopback
+	getGlobalNamespace(L).beginClass<NetworkManager>("NetworkManager")
+		.addFunction("startServer", [](NetworkManager* n, int port) { return n->startServer((uint16_t)port); })
+		.addFunction("connect", [](NetworkManager* n, const std::string& host, int port) { return n->connect(host, (uint16_t)port); })
+		.addFunction("startLoopback", &NetworkManager::startLoopback)
+		.addFunction("stop", &NetworkManager::stop)
+		.addFunction("getMode", [](const NetworkManager* n) { return (int)n->getMode(); })
+		.addFunction("isConnected", &NetworkManager::isConnected)
+		.addFunction("setTickRate", &NetworkManager::setTickRate)
+		.addFunction("setInterestRadius", &NetworkManager::setInterestRadius)
+		.addFunction("getBytesPerSecond", [](const NetworkManager* n) { return n->getStats().bytesPerSecond; })
+		.addFunction("getSnapshotBytes", [](const NetworkManager* n) { return n->getStats().avgSnapshotBytes; })
+		.addFunction("getSerializeMs", [](const NetworkManager* n) { return n->getStats().serializeMs; })
+		.addFunction("getClientCount", [](const NetworkManager* n) { return n->getStats().clients; })
+		.addFunction("getSnapshotsLost", [](const NetworkManager* n) {
+			return n->getMode() == NetworkManager::Mode::Loopback ? n->getLoopbackClientStats().snapshotsLost : n->getStats().snapshotsLost; })
+		.endClass();
+
+	getGlobalNamespace(L).beginClass<FramePacer>("FramePacer")
+		.addFunction("setTargetFps", &FramePacer::setTargetFps)
+		.addFunction("getTargetFps", &FramePacer::getTargetFps)
+		.addFunction("setBackgroundFps", &FramePacer::setBackgroundFps)
+		.addFunction("getFps", [](const FramePacer* p) { return p->getStats().fps; })
+		.addFunction("getFrameMs", [](const FramePacer* p) { return p->getStats().avgMs; })
+		.addFunction("getMaxFrameMs", [](const FramePacer* p) { return p->getStats().maxMs; })
+		.endClass();
+
+	getGlobalNamespace(L).beginClass<AudioSystem>("AudioSystem")
+		.addFunction("setBusVolume", &AudioSystem::setBusVolume)
+		.addFunction("getBusVolume", &AudioSystem::getBusVolume)
+		.addFunction("setBusMute", &AudioSystem::setBusMute)
+		.addFunction("isBusMuted", &AudioSystem::isBusMuted)
+		.addFunction("setBusPaused", &AudioSystem::setBusPaused)
+		.addFunction("setBusLowpass", &AudioSystem::setBusLowpass)
+		.addFunction("setBusReverb", &AudioSystem::setBusReverb)
+		.addFunction("setBusDucking", &AudioSystem::setBusDucking)
+		.addFunction("removeBusDucking", &AudioSystem::removeBusDucking)
 		.endClass();
 
 	getGlobalNamespace(L).beginClass<Scene>("Scene")
@@ -249,8 +531,11 @@ void LUAManager::registerClassAndFunctions(lua_State* L) {
 		.addFunction("getInputManager", &LUAManager::getInputManager)
 		.addFunction("getLight", &LUAManager::getLightComponent)
 		.addFunction("getRigidbody", &LUAManager::getRigidbody)
+		.addFunction("getTrigger", &LUAManager::getTrigger)
 		.addFunction("getCamera", &LUAManager::getCamera)
 		.addFunction("getPlane", &LUAManager::getPlaneComponent)
+		.addFunction("getParticleSystem", &LUAManager::getParticleSystem)
+		.addFunction("getAnimator", &LUAManager::getAnimator)
 		.addFunction("getMesh", &LUAManager::getMeshComponent)
 		.addFunction("getTransform", &LUAManager::getTransform)
 		.addFunction("getLuaClass", &LUAManager::getLuaClass)
@@ -264,15 +549,23 @@ void LUAManager::registerClassAndFunctions(lua_State* L) {
 		.addFunction("closeApp", &LUAManager::closeApp)
 		.addFunction("setMusic", &LUAManager::setMusic)
 		.addFunction("getUIImage", &LUAManager::getUIImage)
+		.addFunction("getUISlider", &LUAManager::getUISlider)
 		.addFunction("playSound", &LUAManager::playSound)
+		.addFunction("getAudioEmitter", &LUAManager::getAudioEmitter)
+		.addFunction("getAudio", &LUAManager::getAudio)
+		.addFunction("getFramePacer", &LUAManager::getFramePacer)
+		.addFunction("getNavigation", &LUAManager::getNavigation)
+		.addFunction("getCrowdAgent", &LUAManager::getCrowdAgent)
+		.addFunction("getNetwork", &LUAManager::getNetwork)
 		.endClass();
 }
 
 void LUAManager::setMusic(std::string music) {
 
+	if (!AudioSystem::getInstance()) return;
 	try {
 		AudioSystem::getInstance()->stopAllChannels();
-		AudioSystem::getInstance()->playSound(music, { 0, 0, 0 });
+		AudioSystem::getInstance()->playMusic(music);
 	}
 	catch (std::exception& e) {
 		std::cout << "El nombre /" << music << "/ es inapropiado.\n" << e.what() << std::endl;
@@ -301,10 +594,7 @@ void LUAManager::changeScene(std::string name)
 
 RigidBody* LUAManager::getRigidbody(Entity* ent)
 {
-	RigidBody* r = nullptr;
-	if(ent->hasComponent((int)ManID::Physics, (int)PhysicsManager::PhysicsCmpId::RigigbodyId))
-		r = static_cast<RigidBody*>(ent->getComponent((int)ManID::Physics, (int)PhysicsManager::PhysicsCmpId::RigigbodyId));
-	return r;
+	return ent->get<RigidBody>();
 }
 
 InputSystem* LUAManager::getInputManager()
@@ -314,42 +604,42 @@ InputSystem* LUAManager::getInputManager()
 
 MeshComponent* LUAManager::getMeshComponent(Entity* ent)
 {
-	MeshComponent* m = nullptr;
-	if(ent->hasComponent((int)ManID::Render, (int)RenderManager::RenderCmpId::Mesh))
-		m = static_cast<MeshComponent*>(ent->getComponent((int)ManID::Render, (int)RenderManager::RenderCmpId::Mesh));
-	return m;
+	return ent->get<MeshComponent>();
+}
+
+ParticleSystemComponent* LUAManager::getParticleSystem(Entity* ent)
+{
+	return ent->get<ParticleSystemComponent>();
+}
+
+TriggerComponent* LUAManager::getTrigger(Entity* ent)
+{
+	return ent->get<TriggerComponent>();
+}
+
+AnimatorComponent* LUAManager::getAnimator(Entity* ent)
+{
+	return ent->get<AnimatorComponent>();
 }
 
 PlaneComponent* LUAManager::getPlaneComponent(Entity* ent)
 {
-	PlaneComponent* m = nullptr;
-	if(ent->hasComponent((int)ManID::Render, (int)RenderManager::RenderCmpId::Plane))
-		m = static_cast<PlaneComponent*>(ent->getComponent((int)ManID::Render, (int)RenderManager::RenderCmpId::Plane));
-	return m;
+	return ent->get<PlaneComponent>();
 }
 
 LightComponent* LUAManager::getLightComponent(Entity* ent)
 {
-	LightComponent* m = nullptr;
-	if(ent->hasComponent((int)ManID::Render, (int)RenderManager::RenderCmpId::Light))
-		m = static_cast<LightComponent*>(ent->getComponent((int)ManID::Render, (int)RenderManager::RenderCmpId::Light));
-	return m;
+	return ent->get<LightComponent>();
 }
 
 Camera* LUAManager::getCamera(Entity* ent)
 {
-	Camera* m = nullptr;
-	if (ent->hasComponent((int)ManID::Render, (int)RenderManager::RenderCmpId::Camera))
-		m = static_cast<Camera*>(ent->getComponent((int)ManID::Render, (int)RenderManager::RenderCmpId::Camera));
-	return m;
+	return ent->get<Camera>();
 }
 
 Transform* LUAManager::getTransform(Entity* ent)
 {
-	Transform* m = nullptr;
-	if (ent->hasComponent((int)ManID::Common, (int)CommonManager::CommonCmpId::TransId))
-		m = static_cast<Transform*>(ent->getComponent((int)ManID::Common, (int)CommonManager::CommonCmpId::TransId));
-	return m;
+	return ent->get<Transform>();
 }
 
 luabridge::LuaRef LUAManager::getLuaClass(const std::string& c_name)
@@ -375,39 +665,69 @@ Entity* LUAManager::instantiate(std::string prefabName)
 
 UIButton* LUAManager::getUIButton(Entity* ent)
 {
-	UIButton* b = nullptr;
-	if (ent->hasComponent((int)ManID::UI, (int)UIManager::UICmpId::Button))
-		b = static_cast<UIButton*>(ent->getComponent((int)ManID::UI, (int)UIManager::UICmpId::Button));
-	return b;
+	return ent->get<UIButton>();
 }
 
 UILabel* LUAManager::getUILabel(Entity* ent)
 {
-	UILabel* b = nullptr;
-	if (ent->hasComponent((int)ManID::UI, (int)UIManager::UICmpId::Label))
-		b = static_cast<UILabel*>(ent->getComponent((int)ManID::UI, (int)UIManager::UICmpId::Label));
-	return b;
+	return ent->get<UILabel>();
+}
+
+CrowdAgent* LUAManager::getCrowdAgent(Entity* ent)
+{
+	return ent->get<CrowdAgent>();
+}
+
+NavigationManager* LUAManager::getNavigation()
+{
+	return NavigationManager::getInstance();
+}
+
+NetworkManager* LUAManager::getNetwork()
+{
+	return NetworkManager::getInstance();
+}
+
+FramePacer* LUAManager::getFramePacer()
+{
+	// Sin ventana no hay bucle que limitar
+	if (EngineContext::current()->isHeadless()) return nullptr;
+	return PapagayoEngine::getInstance()->getFramePacer();
+}
+
+AudioSystem* LUAManager::getAudio()
+{
+	return AudioSystem::getInstance();
+}
+
+AudioEmitter* LUAManager::getAudioEmitter(Entity* ent)
+{
+	return ent->get<AudioEmitter>();
+}
+
+UISlider* LUAManager::getUISlider(Entity* ent)
+{
+	return ent->get<UISlider>();
 }
 
 UIImage* LUAManager::getUIImage(Entity* ent)
 {
-	UIImage* b = nullptr;
-	if (ent->hasComponent((int)ManID::UI, (int)UIManager::UICmpId::Image))
-		b = static_cast<UIImage*>(ent->getComponent((int)ManID::UI, (int)UIManager::UICmpId::Image));
-	return b;
+	return ent->get<UIImage>();
 }
 
 luabridge::LuaRef LUAManager::getLuaSelf(Entity* ent, const std::string& c_name)
 {
 	luabridge::LuaRef b = luabridge::LuaRef(L);
-	if (ent->hasComponent((int)ManID::LUA, enum_map_[c_name]))
-		b = static_cast<LuaComponent*>(ent->getComponent((int)ManID::LUA, enum_map_[c_name]))->getSelf();
+	Component* c = ent->getComponent((int)ManID::LUA, getCompID(c_name));
+	if (c != nullptr)
+		b = static_cast<LuaComponent*>(c)->getSelf();
 	return b;
 }
 
 void LUAManager::playSound(const std::string& strSoundName)
 {
-	AudioSystem::getInstance()->playSound(strSoundName, Vector3(0,0,0));
+	if (AudioSystem::getInstance())
+		AudioSystem::getInstance()->playSound(strSoundName, Vector3(0,0,0));
 }
 
 void LUAManager::addRegistry(const std::string& compName)
@@ -427,6 +747,7 @@ void LUAManager::addRegistry(const std::string& compName)
 
 OgreContext* LUAManager::getOgreContext()
 {
+	if (EngineContext::current()->isHeadless()) return nullptr;
 	return OgreContext::getInstance();
 }
 
@@ -441,7 +762,7 @@ lua_State* LUAManager::getLuaState() const
 }
 
 void LUAManager::closeApp() {
-	PapagayoEngine::getInstance()->closeApp();
+	EngineContext::current()->close();
 }
 
 LUAManager::LUAManager() : Manager(ManID::LUA), registeredFiles(0)
@@ -33,3 +33,19 @@ void LuaCollisionObject::onCollisionExit(Entity* e)
 		LUAManager::getInstance()->getLuaClass(_ptr->getFileName())["onCollisionExit"](_ptr->getSelf(), LUAManager::getInstance(), e);
 	}
 }
+
+void LuaCollisionObject::onTriggerEnter(Entity* e)
+{
+	if (LUAManager::getInstance()->getLuaClass(_ptr->getFileName())["onTriggerEnter"].isFunction())
+	{
+		LUAManager::getInstance()->getLuaClass(_ptr->getFileName())["onTriggerEnter"](_ptr->getSelf(), LUAManager::getInstance(), e);
+	}
+}
+
+void LuaCollisionObject::onTriggerExit(Entity* e)
+{
+	if (LUAManager::getInstance()->getLuaClass(_ptr->getFileName())["onTriggerExit"].isFunction())
+	{
+		LUAManager::getInstance()->getLuaClass(_ptr->getFileName())["onTriggerExit"](_ptr->getSelf(), LUAManager::getInstance(), e);
+	}
+}
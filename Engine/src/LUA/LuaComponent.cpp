@@ -4,6 +4,8 @@
 #include "lua.hpp"
 #include "Entity.h"
 #include "LuaCollisionObject.h"
+#include "PhysicsManager.h"
+#include "TriggerComponent.h"
 #include "checkML.h"
 
 LuaComponent::LuaComponent(const std::string& fileName, int id) : Component(LUAManager::getInstance(), id), fileName_(fileName)
@@ -33,10 +35,17 @@ void LuaComponent::load(const nlohmann::json& params)
 		throw std::exception("Assigned LUA component couldn't be instantiated\n");
 	}
 
-	if (_entity->hasComponent((int)ManID::Physics, 0)) {
+	if (_entity->has<RigidBody>()) {
 		if (class_["onCollisionEnter"].isFunction() || class_["onCollisionStay"].isFunction() || class_["onCollisionExit"].isFunction())
 		{
-			static_cast<RigidBody*>(_entity->getComponent((int)ManID::Physics, 0))->setUserPtr(new LuaCollisionObject(this));
+			_entity->get<RigidBody>()->setUserPtr(new LuaCollisionObject(this));
+		}
+	}
+
+	if (_entity->has<TriggerComponent>()) {
+		if (class_["onTriggerEnter"].isFunction() || class_["onTriggerExit"].isFunction())
+		{
+			_entity->get<TriggerComponent>()->setUserPtr(new LuaCollisionObject(this));
 		}
 	}
 
@@ -3,14 +3,16 @@
 #include "Scene/Scene.h"
 #include "Entity.h"
 #include "Component.h"
-#include "PapagayoEngine.h"
+#include "EngineContext.h"
 #include "Manager.h"
 
 #include <fstream>
 #include <string>
 #include <exception> 
 #include <iostream>
+#include <algorithm>
 #include <LUA/LUAManager.h>
+#include "AudioSystem.h"
 
 
 std::vector<std::string> LoaderSystem::loadScenes(const std::string& fileName)
@@ -30,7 +32,7 @@ std::vector<std::string> LoaderSystem::loadScenes(const std::string& fileName)
 }
 
 
-void LoaderSystem::loadEntities(const std::string& fileName, Scene* scene)
+nlohmann::json LoaderSystem::readScene(const std::string& fileName)
 {
 	std::fstream i(SCENES_FILE_PATH + fileName + FILE_EXTENSION);	// TO DO: poner la ruta definitiva cuando este la carpeta final
 	if (!i.is_open()) {
@@ -38,6 +40,121 @@ void LoaderSystem::loadEntities(const std::string& fileName, Scene* scene)
 	}
 	nlohmann::json j;
 	i >> j;
+	i.close();
+	return j;
+}
+
+// Los prefabs se leen una vez y se reutilizan en todas las entidades que los usan
+const nlohmann::json& LoaderSystem::getPrefab(const std::string& fileName)
+{
+	auto cached = prefabs_.find(fileName);
+	if (cached != prefabs_.end())
+		return cached->second;
+
+	std::fstream i(PREFAB_FILE_PATH + fileName + FILE_EXTENSION);
+	if (!i.is_open()) {
+		throw std::runtime_error("ERROR: Loading scene " + fileName + " failed, file missing\n");
+	}
+	nlohmann::json prefJson;
+	i >> prefJson;
+	i.close();
+	return prefabs_.emplace(fileName, std::move(prefJson)).first->second;
+}
+
+void LoaderSystem::preloadScene(const std::string& fileName)
+{
+	nlohmann::json j = readScene(fileName);
+	auto entities = j.find("Entities");
+	if (entities != j.end() && entities->is_array()) {
+		for (const auto& e : *entities) {
+			auto pref = e.find("Prefab");
+			if (pref != e.end() && pref->is_string())
+				getPrefab(pref->get<std::string>());
+		}
+	}
+	preloaded_[fileName] = std::move(j);
+}
+
+void LoaderSystem::preloadSceneSounds(const std::string& fileName)
+{
+	auto it = preloaded_.find(fileName);
+	if (it == preloaded_.end() || !AudioSystem::getInstance()) return;
+	auto sounds = it->second.find("Sounds");
+	if (sounds != it->second.end())
+		AudioSystem::getInstance()->preloadSounds(sounds.value());
+}
+
+std::vector<std::string> LoaderSystem::getLuaComponents(const std::string& fileName)
+{
+	std::vector<std::string> scripts;
+	auto it = preloaded_.find(fileName);
+	if (it == preloaded_.end()) return scripts;
+
+	auto addFrom = [&scripts](const nlohmann::json& comps) {
+		if (!comps.is_array()) return;
+		for (const auto& c : comps) {
+			auto type = c.find("Type"), name = c.find("Component");
+			if (type == c.end() || name == c.end() || !name->is_string() || *type != "LUA") continue;
+			std::string script = name->get<std::string>();
+			if (std::find(scripts.begin(), scripts.end(), script) == scripts.end())
+				scripts.push_back(script);
+		}
+	};
+	auto entities = it->second.find("Entities");
+	if (entities == it->second.end() || !entities->is_array()) return scripts;
+	for (const auto& e : *entities) {
+		auto pref = e.find("Prefab");
+		if (pref != e.end() && pref->is_string()) {
+			const nlohmann::json& p = getPrefab(pref->get<std::string>());
+			auto comps = p.find("Components");
+			if (comps != p.end()) addFrom(*comps);
+		}
+		auto comps = e.find("Components");
+		if (comps != e.end()) addFrom(*comps);
+	}
+	return scripts;
+}
+
+bool LoaderSystem::getResourceGroups(const std::string& fileName, std::vector<std::string>& groups)
+{
+	// Se lee la escena si hace falta, loadEntities la aprovecha despues
+	auto it = preloaded_.find(fileName);
+	if (it == preloaded_.end()) {
+		preloadScene(fileName);
+		it = preloaded_.find(fileName);
+	}
+
+	auto declared = it->second.find("ResourceGroups");
+	if (declared == it->second.end())
+		return false;
+	if (!declared->is_array())
+		throw std::exception("ERROR: ResourceGroups must be an array\n");
+	for (const auto& g : *declared) {
+		if (!g.is_string())
+			throw std::exception("ERROR: ResourceGroups must be an array of names\n");
+		groups.push_back(g.get<std::string>());
+	}
+	return true;
+}
+
+void LoaderSystem::loadEntities(const std::string& fileName, Scene* scene)
+{
+	// Si ya se ha leido durante el arranque no se vuelve a abrir
+	nlohmann::json j;
+	auto pre = preloaded_.find(fileName);
+	if (pre != preloaded_.end()) {
+		j = std::move(pre->second);
+		preloaded_.erase(pre);
+	}
+	else
+		j = readScene(fileName);
+
+	// Los sonidos de la escena se empiezan a cargar en segundo plano
+	// mientras se crean las entidades
+	auto sounds = j.find("Sounds");
+	if (sounds != j.end() && AudioSystem::getInstance())
+		AudioSystem::getInstance()->preloadSounds(sounds.value());
+
 	// -- -- //
 	nlohmann::json entities = j["Entities"];
 	if (entities.is_null() || !entities.is_array())
@@ -61,8 +178,6 @@ void LoaderSystem::loadEntities(const std::string& fileName, Scene* scene)
 		}
 		scene->addEntity(name, ent);
 	}
-
-	i.close();
 }
 
 void LoaderSystem::loadComponents(const nlohmann::json& comps, Entity* entity)
@@ -71,7 +186,7 @@ void LoaderSystem::loadComponents(const nlohmann::json& comps, Entity* entity)
 		throw std::exception("ERROR: Components not found\n");
 	int compSize = comps.size();
 
-	auto mans = PapagayoEngine::getInstance()->getManagers();
+	EngineContext* ctx = EngineContext::current();
 	nlohmann::json type;
 	nlohmann::json component;
 	nlohmann::json params;
@@ -90,10 +205,18 @@ void LoaderSystem::loadComponents(const nlohmann::json& comps, Entity* entity)
 		component = it.value();
 		Component* c;
 
+		Manager* man = ctx->getManager(type.get<std::string>());
+		if (man == nullptr) {
+			// Sin ventana no hay render, interfaz ni audio: se salta el componente
+			if (ctx->isHeadless())
+				continue;
+			throw std::exception("ERROR: Component type not registered\n");
+		}
+
 		// si no se ha cargado este script de lua, aadelo como posible componente
 		std::string name = component;
 		if (type == "LUA") {
-			if (mans[type]->getCompID(component) == -1) {
+			if (man->getCompID(component) == -1) {
 				try {
 					LUAManager::getInstance()->addRegistry(component);
 				}
@@ -103,21 +226,21 @@ void LoaderSystem::loadComponents(const nlohmann::json& comps, Entity* entity)
 				}
 			}
 		}
-		if (!entity->hasComponent(mans[type]->getId(), mans[type]->getCompID(component))){
-			c = mans[type]->create(component, entity);
-				if (c == nullptr)
-					throw std::exception("ERROR: Component couldn't be created, it is not registered\n");
+		// El nombre solo se busca una vez, lo demas va por id
+		int compId = man->getCompID(name);
+		c = entity->getComponent(man->getId(), compId);
+		if (c == nullptr) {
+			c = man->create(compId, entity);
+			if (c == nullptr)
+				throw std::exception("ERROR: Component couldn't be created, it is not registered\n");
 		}
 		// Si hay parametros, se cargan; si no, se crea el componente por defecto
-		else {
-			c = entity->getComponent(mans[type]->getId(), mans[type]->getCompID(component));
-		}
 		it = comps[i].find("Parameters");
 		if (it != comps[i].end() && it.value().is_object()) {
 			try { c->load(it.value()); }
-			catch (std::exception e) {
+			catch (const std::exception& e) {
 				//resetear los valores del componente si hay algun parametro con un formato erroneo
-				std::cout << "WARNING: Component " + component.get<std::string>() + " parameters are wrong, reseting to default\n";
+				std::cout << "WARNING: Component " + component.get<std::string>() + " parameters are wrong, reseting to default\n" << e.what();
 				c->init();
 				//throw std::exception("WARNING: Component parametrs are wrong\n");
 			}
@@ -165,39 +288,23 @@ void LoaderSystem::loadPrefabs(nlohmann::json& pref, Entity* ent, std::string& e
 		throw std::exception("ERROR: Prefab files not found\n");
 
 	std::string fileName = it.value().get<std::string>();
-	std::fstream i(PREFAB_FILE_PATH + fileName + FILE_EXTENSION);
-
-	if (!i.is_open()) {
-		throw std::runtime_error("ERROR: Loading scene " + fileName + " failed, file missing\n");
-	}
+	const nlohmann::json& prefJson = getPrefab(fileName);
 
-	nlohmann::json prefJson;
-	i >> prefJson;
-
-	it = prefJson.find("Components");
+	auto comps = prefJson.find("Components");
 
-	if(it != prefJson.end() && it.value().is_array())
-		loadComponents(it.value(), ent);
+	if(comps != prefJson.end() && comps.value().is_array())
+		loadComponents(comps.value(), ent);
 
-	it = prefJson.find("Name");
-	if (it != prefJson.end() && it.value().is_string())
-		entName = it.value();
-
-	i.close();
+	auto prefName = prefJson.find("Name");
+	if (prefName != prefJson.end() && prefName.value().is_string())
+		entName = prefName.value();
 }
 
 void LoaderSystem::loadPrefabByName(std::string fileName, Entity* ent)
 {
-	std::fstream i(PREFAB_FILE_PATH + fileName + FILE_EXTENSION);
-
-	if (!i.is_open()) {
-		throw std::runtime_error("ERROR: Loading scene " + fileName + " failed, file missing\n");
-	}
-
-	nlohmann::json prefJson;
-	i >> prefJson;
-
-	loadComponents(prefJson["Components"], ent);
-
-	i.close();
+	const nlohmann::json& prefJson = getPrefab(fileName);
+	auto comps = prefJson.find("Components");
+	if (comps == prefJson.end())
+		throw std::exception("ERROR: Components not found\n");
+	loadComponents(comps.value(), ent);
 }
@@ -1,13 +1,17 @@
 #include "Managers/SceneManager.h"
+#include "EngineContext.h"
 #include "Scene/Scene.h"
 #include "LoaderSystem.h"
-
-#include "PapagayoEngine.h"
-#include "OgreContext.h"
-#include "OgreRenderWindow.h"
-
-SceneManager* SceneManager::instance_= nullptr;
-Scene* SceneManager::currentScene_ = nullptr;
+#include "Graphics/OgreContext.h"
+#include "ResourceCache.h"
+
+namespace {
+	// Sin ventana no se cargan recursos de Ogre
+	OgreContext* resourceContext()
+	{
+		return EngineContext::current()->isHeadless() ? nullptr : OgreContext::getInstance();
+	}
+}
 
 SceneManager::~SceneManager()
 {
@@ -15,19 +19,20 @@ SceneManager::~SceneManager()
 
 SceneManager* SceneManager::getInstance()
 {
-	return instance_;
+	return EngineContext::current()->scenes;
 }
 
 Scene* SceneManager::getCurrentScene()
 {
-	return currentScene_;
+	return getInstance()->currentScene_;
 }
 
 bool SceneManager::setupInstance()
 {
-	if (instance_ == nullptr) {
+	EngineContext* ctx = EngineContext::current();
+	if (!ctx->scenes) {
 		try {
-			instance_ = new SceneManager();
+			ctx->scenes = new SceneManager();
 		}
 		catch (...) {
 			return false;
@@ -39,22 +44,42 @@ bool SceneManager::setupInstance()
 
 void SceneManager::clean()
 {
-	instance_->cleanupScene();
+	getInstance()->cleanupScene();
 }
 
 void SceneManager::destroy() {
-	instance_->clean();
-	delete instance_->loader_;
-	delete instance_;
+	getInstance()->clean();
+	if (OgreContext* ogre = resourceContext())
+		ogre->releaseResourceGroups(getInstance()->resourceGroups_);
+	delete getInstance()->loader_;
+	delete getInstance();
+	EngineContext::current()->scenes = nullptr;
 }
 
 void SceneManager::loadScene(const std::string& sceneName)
 {
+	//pide los recursos de la nueva escena antes de soltar los de la anterior,
+	//asi los grupos que comparten no se descargan
+	std::vector<std::string> previous = std::move(resourceGroups_);
+	resourceGroups_.clear();
+	if (OgreContext* ogre = resourceContext()) {
+		resourceGroups_ = getSceneResourceGroups(sceneName);
+		ogre->acquireResourceGroups(resourceGroups_);
+		ogre->releaseResourceGroups(previous);
+	}
+
 	//crea escena vacia
 	currentScene_ = new Scene();
 	currentScene_->setName(sceneName);
 	//la llena de objetos
 	loader_->loadEntities(sceneName, currentScene_);
+
+	//lo que solo usaba la escena anterior se descarga si no cabe, y con ello
+	//los grupos que se han quedado vacios
+	if (OgreContext* ogre = resourceContext()) {
+		ResourceCache::getInstance()->trim();
+		ogre->unloadEvictedGroups();
+	}
 }
 
 void SceneManager::cleanupScene()
@@ -75,13 +100,14 @@ void SceneManager::update()
 	currentScene_->eraseEntities();
 	if (change_) {
 		//cleanupScene();
-		PapagayoEngine::getInstance()->clean();
+		EngineContext* ctx = EngineContext::current();
+		ctx->clean();
 		loadScene(nextScene_);
 		
 		change_ = false;
 		nextScene_ = "";
 		
-		PapagayoEngine::getInstance()->start();
+		ctx->start();
 	}
 }
 
@@ -96,6 +122,9 @@ void SceneManager::changeScene(const std::string& sceneName)
 	if (exist) {
 		nextScene_ = sceneName;
 		change_ = true;
+		//se lee la escena y sus recursos se preparan hasta el cambio
+		if (OgreContext* ogre = resourceContext())
+			ogre->prefetchResourceGroups(getSceneResourceGroups(sceneName));
 	}
 	else {
 		throw std::runtime_error("ERROR: Scene: " + sceneName + " doesn't exist\n");	
@@ -104,6 +133,40 @@ void SceneManager::changeScene(const std::string& sceneName)
 
 void SceneManager::createStartScene(const std::string& startScene) {
 	
-	sceneFiles_ = loader_->loadScenes(startScene);
+	if (sceneFiles_.empty())
+		sceneFiles_ = loader_->loadScenes(startScene);
 	loadScene(sceneFiles_[0]);
 }
+
+void SceneManager::preloadStartScene(const std::string& startScene)
+{
+	sceneFiles_ = loader_->loadScenes(startScene);
+	if (!sceneFiles_.empty())
+		loader_->preloadScene(sceneFiles_[0]);
+}
+
+void SceneManager::preloadStartSceneSounds()
+{
+	if (!sceneFiles_.empty())
+		loader_->preloadSceneSounds(sceneFiles_[0]);
+}
+
+void SceneManager::prefetchStartSceneResources()
+{
+	OgreContext* ogre = resourceContext();
+	if (ogre && !sceneFiles_.empty())
+		ogre->prefetchResourceGroups(getSceneResourceGroups(sceneFiles_[0]));
+}
+
+std::vector<std::string> SceneManager::getSceneResourceGroups(const std::string& sceneName)
+{
+	std::vector<std::string> groups;
+	if (!loader_->getResourceGroups(sceneName, groups))
+		groups = OgreContext::getInstance()->getResourceGroups();
+	return groups;
+}
+
+std::vector<std::string> SceneManager::getStartSceneLuaComponents()
+{
+	return sceneFiles_.empty() ? std::vector<std::string>() : loader_->getLuaComponents(sceneFiles_[0]);
+}
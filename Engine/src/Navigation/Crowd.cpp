@@ -0,0 +1,252 @@
+#include "Crowd.h"
+#include "CrowdAgent.h"
+#include "NavMesh.h"
+#include "SimdMath.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	const float EPSILON = 1e-4f;
+	// Lejos de todo, sus pesos salen 0
+	const float FAR_AWAY = 1e9f;
+	// Segundos que mira hacia delante al evitar obstaculos
+	const float LOOK_AHEAD = 0.5f;
+}
+
+std::vector<std::vector<float>*> Crowd::arrays()
+{
+	return { &px, &py, &pz, &vx, &vz, &desiredX, &desiredZ, &radius, &maxSpeed, &maxForce,
+		&neighbourRadius, &separationWeight, &alignmentWeight, &avoidanceWeight };
+}
+
+size_t Crowd::addAgent(CrowdAgent* agent)
+{
+	for (auto* arr : arrays())
+		arr->push_back(0.0f);
+	owners.push_back(agent);
+	return owners.size() - 1;
+}
+
+// El ultimo ocupa el hueco del que se va
+void Crowd::removeAgent(size_t slot)
+{
+	size_t last = owners.size() - 1;
+	if (slot != last) {
+		for (auto* arr : arrays())
+			(*arr)[slot] = (*arr)[last];
+		owners[slot] = owners[last];
+		owners[slot]->slot_ = slot;
+	}
+	for (auto* arr : arrays())
+		arr->pop_back();
+	owners.pop_back();
+}
+
+void Crowd::update(float deltaTime, const NavMesh* mesh)
+{
+	const size_t n = owners.size();
+	if (n == 0 || deltaTime <= 0.0f) return;
+
+	// Una pasada de lectura: posiciones y velocidades deseadas
+	live_.resize(n);
+	for (size_t i = 0; i < n; i++) {
+		owners[i]->prepare(*this);
+		live_[i] = owners[i]->isActive() && owners[i]->tr_ != nullptr;
+	}
+
+	for (auto* arr : { &sepX_, &sepZ_, &aliX_, &aliZ_, &avoidX_, &avoidZ_ })
+		arr->assign(n, 0.0f);
+
+	buildHash();
+	for (size_t i = 0; i < n; i++) {
+		if (!live_[i]) continue;
+		neighbourForces(i);
+		if (mesh) avoidObstacles(i, mesh);
+	}
+	integrate(deltaTime);
+
+	// Una pasada de escritura a Transform o RigidBody
+	for (CrowdAgent* agent : owners)
+		agent->apply(*this, deltaTime);
+}
+
+void Crowd::cellOf(float x, float z, int& cx, int& cz) const
+{
+	cx = (int)std::floor(x / cellSize_);
+	cz = (int)std::floor(z / cellSize_);
+}
+
+uint32_t Crowd::hashCell(int cx, int cz) const
+{
+	return ((uint32_t)cx * 73856093u ^ (uint32_t)cz * 19349663u) & hashMask_;
+}
+
+void Crowd::buildHash()
+{
+	const size_t n = owners.size();
+
+	// Celda del tamanyo del mayor radio de vecindad: basta mirar las 3x3 de alrededor
+	size_t liveCount = 0;
+	cellSize_ = EPSILON;
+	for (size_t i = 0; i < n; i++) {
+		if (!live_[i]) continue;
+		cellSize_ = std::max(cellSize_, neighbourRadius[i]);
+		liveCount++;
+	}
+
+	uint32_t tableSize = 1;
+	while (tableSize < 2 * liveCount) tableSize <<= 1;
+	hashMask_ = tableSize - 1;
+
+	agentKey_.resize(n);
+	cellStart_.assign(tableSize + 1, 0);
+	for (size_t i = 0; i < n; i++) {
+		if (!live_[i]) continue;
+		int cx, cz;
+		cellOf(px[i], pz[i], cx, cz);
+		agentKey_[i] = hashCell(cx, cz);
+		cellStart_[agentKey_[i] + 1]++;
+	}
+	for (uint32_t k = 0; k < tableSize; k++)
+		cellStart_[k + 1] += cellStart_[k];
+
+	sorted_.resize(liveCount);
+	std::vector<uint32_t> fill(cellStart_.begin(), cellStart_.end() - 1);
+	for (size_t i = 0; i < n; i++)
+		if (live_[i])
+			sorted_[fill[agentKey_[i]]++] = (uint32_t)i;
+}
+
+// Separacion: empuja en contra de los vecinos, mas fuerte cuanto mas cerca.
+// Alineacion: tiende a la velocidad media de los vecinos.
+// Los pesos caen a 0 fuera del radio de vecindad, asi no hace falta filtrar
+// los candidatos y se procesan de 4 en 4 sin saltos
+void Crowd::neighbourForces(size_t i)
+{
+	candX_.clear(); candZ_.clear(); candVX_.clear(); candVZ_.clear();
+
+	int cx, cz;
+	cellOf(px[i], pz[i], cx, cz);
+	uint32_t visited[9];
+	int visitedCount = 0;
+	for (int dz = -1; dz <= 1; dz++) {
+		for (int dx = -1; dx <= 1; dx++) {
+			uint32_t key = hashCell(cx + dx, cz + dz);
+			// Dos celdas pueden caer en la misma entrada de la tabla
+			if (std::find(visited, visited + visitedCount, key) != visited + visitedCount) continue;
+			visited[visitedCount++] = key;
+
+			for (uint32_t k = cellStart_[key]; k < cellStart_[key + 1]; k++) {
+				uint32_t j = sorted_[k];
+				if (j == i) continue;
+				candX_.push_back(px[j]);
+				candZ_.push_back(pz[j]);
+				candVX_.push_back(vx[j]);
+				candVZ_.push_back(vz[j]);
+			}
+		}
+	}
+	if (candX_.empty()) return;
+
+	while (candX_.size() % 4 != 0) {
+		candX_.push_back(FAR_AWAY);
+		candZ_.push_back(FAR_AWAY);
+		candVX_.push_back(0.0f);
+		candVZ_.push_back(0.0f);
+	}
+
+	using namespace simd;
+	const float r2 = neighbourRadius[i] * neighbourRadius[i];
+	const float4 vr2 = splat(r2), vInvR2 = splat(1.0f / r2), zero = splat(0.0f), eps = splat(EPSILON);
+	const float4 x = splat(px[i]), z = splat(pz[i]);
+	float4 sepX = zero, sepZ = zero, aliX = zero, aliZ = zero, aliW = zero;
+
+	for (size_t k = 0; k < candX_.size(); k += 4) {
+		float4 dx = sub(x, loadu(&candX_[k]));
+		float4 dz = sub(z, loadu(&candZ_[k]));
+		float4 d2 = madd(dx, dx, mul(dz, dz));
+		float4 falloff = max(zero, sub(vr2, d2));
+
+		float4 ws = div(falloff, madd(d2, vr2, eps));
+		sepX = madd(dx, ws, sepX);
+		sepZ = madd(dz, ws, sepZ);
+
+		float4 wa = mul(falloff, vInvR2);
+		aliX = madd(loadu(&candVX_[k]), wa, aliX);
+		aliZ = madd(loadu(&candVZ_[k]), wa, aliZ);
+		aliW = add(aliW, wa);
+	}
+
+	sepX_[i] = hsum(sepX);
+	sepZ_[i] = hsum(sepZ);
+	float w = hsum(aliW);
+	if (w > EPSILON) {
+		aliX_[i] = hsum(aliX) / w - vx[i];
+		aliZ_[i] = hsum(aliZ) / w - vz[i];
+	}
+}
+
+// Sondea la malla delante del agente; si se sale, busca la primera direccion
+// girada que siga siendo transitable y si no hay ninguna frena
+void Crowd::avoidObstacles(size_t i, const NavMesh* mesh)
+{
+	float speed = std::sqrt(vx[i] * vx[i] + vz[i] * vz[i]);
+	if (speed < EPSILON) return;
+
+	float dirX = vx[i] / speed, dirZ = vz[i] / speed;
+	float probe = radius[i] + speed * LOOK_AHEAD;
+	if (mesh->isWalkable(Vector3(px[i] + dirX * probe, py[i], pz[i] + dirZ * probe))) return;
+
+	const float angles[] = { 0.785f, -0.785f, 1.571f, -1.571f };
+	for (float a : angles) {
+		float c = std::cos(a), s = std::sin(a);
+		float altX = dirX * c - dirZ * s, altZ = dirX * s + dirZ * c;
+		if (mesh->isWalkable(Vector3(px[i] + altX * probe, py[i], pz[i] + altZ * probe))) {
+			avoidX_[i] = (altX - dirX) * maxSpeed[i];
+			avoidZ_[i] = (altZ - dirZ) * maxSpeed[i];
+			return;
+		}
+	}
+	avoidX_[i] = -vx[i];
+	avoidZ_[i] = -vz[i];
+}
+
+// Suma de fuerzas limitada a maxForce y velocidad limitada a maxSpeed,
+// para todos los agentes a la vez
+void Crowd::integrate(float deltaTime)
+{
+	using namespace simd;
+	const size_t n = owners.size();
+	const float4 dt = splat(deltaTime), one = splat(1.0f), eps = splat(EPSILON);
+
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		float4 vX = loadu(&vx[i]), vZ = loadu(&vz[i]);
+		float4 sW = loadu(&separationWeight[i]), aW = loadu(&alignmentWeight[i]), oW = loadu(&avoidanceWeight[i]);
+
+		float4 fX = sub(loadu(&desiredX[i]), vX);
+		float4 fZ = sub(loadu(&desiredZ[i]), vZ);
+		fX = madd(loadu(&sepX_[i]), sW, madd(loadu(&aliX_[i]), aW, madd(loadu(&avoidX_[i]), oW, fX)));
+		fZ = madd(loadu(&sepZ_[i]), sW, madd(loadu(&aliZ_[i]), aW, madd(loadu(&avoidZ_[i]), oW, fZ)));
+
+		float4 fLen = sqrt(madd(fX, fX, mul(fZ, fZ)));
+		float4 fScale = mul(min(one, div(loadu(&maxForce[i]), add(fLen, eps))), dt);
+		vX = madd(fX, fScale, vX);
+		vZ = madd(fZ, fScale, vZ);
+
+		float4 vLen = sqrt(madd(vX, vX, mul(vZ, vZ)));
+		float4 vScale = min(one, div(loadu(&maxSpeed[i]), add(vLen, eps)));
+		storeu(&vx[i], mul(vX, vScale));
+		storeu(&vz[i], mul(vZ, vScale));
+	}
+	for (; i < n; i++) {
+		float fX = desiredX[i] - vx[i] + sepX_[i] * separationWeight[i] + aliX_[i] * alignmentWeight[i] + avoidX_[i] * avoidanceWeight[i];
+		float fZ = desiredZ[i] - vz[i] + sepZ_[i] * separationWeight[i] + aliZ_[i] * alignmentWeight[i] + avoidZ_[i] * avoidanceWeight[i];
+		float fScale = std::min(1.0f, maxForce[i] / (std::sqrt(fX * fX + fZ * fZ) + EPSILON)) * deltaTime;
+		vx[i] += fX * fScale;
+		vz[i] += fZ * fScale;
+		float vScale = std::min(1.0f, maxSpeed[i] / (std::sqrt(vx[i] * vx[i] + vz[i] * vz[i]) + EPSILON));
+		vx[i] *= vScale;
+		vz[i] *= vScale;
+	}
+}
@@ -0,0 +1,218 @@
+#include "CrowdAgent.h"
+#include "Crowd.h"
+#include "NavigationManager.h"
+#include "Entity.h"
+#include "CommonManager.h"
+#include "Transform.h"
+#include "PhysicsManager.h"
+#include "Rigidbody.h"
+#include <checkML.h>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	float distance2D(const Vector3& a, const Vector3& b) {
+		float dx = b.x - a.x, dz = b.z - a.z;
+		return std::sqrt(dx * dx + dz * dz);
+	}
+}
+
+CrowdAgent::CrowdAgent() :
+	Component(NavigationManager::getInstance(), (int)NavigationManager::NavCmpId::CrowdAgent)
+{
+	slot_ = NavigationManager::getInstance()->getCrowd().addAgent(this);
+	init();
+}
+
+CrowdAgent::~CrowdAgent()
+{
+	NavigationManager* nav = NavigationManager::getInstance();
+	if (pathId_ >= 0) nav->releasePath(pathId_);
+	nav->getCrowd().removeAgent(slot_);
+}
+
+void CrowdAgent::init()
+{
+	Crowd& c = NavigationManager::getInstance()->getCrowd();
+	c.radius[slot_] = 0.5f;
+	c.maxSpeed[slot_] = 3.0f;
+	c.maxForce[slot_] = 10.0f;
+	c.neighbourRadius[slot_] = 2.0f;
+	c.separationWeight[slot_] = 2.0f;
+	c.alignmentWeight[slot_] = 0.5f;
+	c.avoidanceWeight[slot_] = 2.0f;
+}
+
+void CrowdAgent::load(const nlohmann::json& params)
+{
+	Crowd& c = NavigationManager::getInstance()->getCrowd();
+	const std::pair<const char*, std::vector<float>*> fields[] = {
+		{ "radius", &c.radius }, { "maxSpeed", &c.maxSpeed }, { "maxForce", &c.maxForce },
+		{ "neighbourRadius", &c.neighbourRadius }, { "separation", &c.separationWeight },
+		{ "alignment", &c.alignmentWeight }, { "avoidance", &c.avoidanceWeight }
+	};
+	for (const auto& f : fields) {
+		auto it = params.find(f.first);
+		if (it != params.end()) (*f.second)[slot_] = it->get<float>();
+	}
+
+	auto it = params.find("arriveRadius");
+	if (it != params.end()) arriveRadius_ = it->get<float>();
+}
+
+void CrowdAgent::setUp()
+{
+	tr_ = _entity->get<Transform>();
+	if (_entity->has<RigidBody>()) {
+		RigidBody* rb = _entity->get<RigidBody>();
+		// A los estaticos y cinematicos no se les puede dar velocidad
+		if (!rb->isStatic() && !rb->isKinematic()) rb_ = rb;
+	}
+}
+
+// El Crowd los actualiza todos juntos desde el NavigationManager
+void CrowdAgent::update(float deltaTime)
+{
+}
+
+void CrowdAgent::moveTo(const Vector3& pos)
+{
+	NavigationManager* nav = NavigationManager::getInstance();
+	if (pathId_ >= 0) nav->releasePath(pathId_);
+
+	moving_ = true;
+	manual_ = false;
+	target_ = pos;
+	path_.clear();
+	waypoint_ = 0;
+	// Sin malla se va en linea recta
+	pathId_ = tr_ ? nav->requestPath(tr_->getWorldPos(), pos) : -1;
+	if (pathId_ < 0) path_.push_back(pos);
+}
+
+void CrowdAgent::setDesiredVelocity(const Vector3& vel)
+{
+	stop();
+	manual_ = true;
+	manualVel_ = vel;
+}
+
+void CrowdAgent::stop()
+{
+	if (pathId_ >= 0) NavigationManager::getInstance()->releasePath(pathId_);
+	pathId_ = -1;
+	moving_ = false;
+	manual_ = false;
+	path_.clear();
+}
+
+bool CrowdAgent::isMoving() const
+{
+	return moving_;
+}
+
+Vector3 CrowdAgent::getVelocity() const
+{
+	const Crowd& c = NavigationManager::getInstance()->getCrowd();
+	return Vector3(c.vx[slot_], 0.0f, c.vz[slot_]);
+}
+
+void CrowdAgent::setMaxSpeed(float speed)
+{
+	NavigationManager::getInstance()->getCrowd().maxSpeed[slot_] = speed;
+}
+
+float CrowdAgent::getMaxSpeed() const
+{
+	return NavigationManager::getInstance()->getCrowd().maxSpeed[slot_];
+}
+
+void CrowdAgent::pollPath()
+{
+	NavigationManager* nav = NavigationManager::getInstance();
+	NavigationManager::PathStatus status = nav->getPathStatus(pathId_);
+	if (status == NavigationManager::PathStatus::Pending) return;
+
+	if (status == NavigationManager::PathStatus::Ready) {
+		nav->getPath(pathId_, path_);
+		// El primer punto es donde estaba al pedirlo
+		waypoint_ = path_.size() > 1 ? 1 : 0;
+	}
+	else
+		moving_ = false;
+	nav->releasePath(pathId_);
+	pathId_ = -1;
+}
+
+// Avanza por los puntos del camino y frena al llegar al ultimo
+Vector3 CrowdAgent::steerToPath(const Vector3& pos, float speed)
+{
+	// Mientras llega el camino se va directo al objetivo
+	if (path_.empty()) {
+		float d = distance2D(pos, target_);
+		return d > arriveRadius_ ? Vector3(target_.x - pos.x, 0, target_.z - pos.z) * (speed / d) : Vector3();
+	}
+
+	while (waypoint_ + 1 < path_.size() && distance2D(pos, path_[waypoint_]) < arriveRadius_)
+		waypoint_++;
+
+	const Vector3& wp = path_[waypoint_];
+	float d = distance2D(pos, wp);
+	bool last = waypoint_ + 1 == path_.size();
+	if (last && d < arriveRadius_) {
+		stop();
+		return Vector3();
+	}
+	if (last) speed *= std::min(1.0f, d / (arriveRadius_ * 4.0f));
+	return Vector3(wp.x - pos.x, 0, wp.z - pos.z) * (speed / std::max(d, 1e-4f));
+}
+
+void CrowdAgent::prepare(Crowd& c)
+{
+	// Aun sin setUp (p.ej. recien instanciado): se queda quieto
+	if (!tr_) {
+		c.desiredX[slot_] = c.desiredZ[slot_] = 0.0f;
+		return;
+	}
+	Vector3 pos = tr_->getWorldPos();
+	c.px[slot_] = pos.x;
+	c.py[slot_] = pos.y;
+	c.pz[slot_] = pos.z;
+	// Con fisica la velocidad real la lleva Bullet (choques, empujones)
+	if (rb_) {
+		const Vector3& v = rb_->getLinearVelocity();
+		c.vx[slot_] = v.x;
+		c.vz[slot_] = v.z;
+	}
+
+	Vector3 desired;
+	if (isActive()) {
+		if (pathId_ >= 0) pollPath();
+		if (moving_) desired = steerToPath(pos, c.maxSpeed[slot_]);
+		else if (manual_) desired = manualVel_;
+	}
+	c.desiredX[slot_] = desired.x;
+	c.desiredZ[slot_] = desired.z;
+}
+
+void CrowdAgent::apply(Crowd& c, float deltaTime)
+{
+	if (!isActive() || !tr_) return;
+
+	float vx = c.vx[slot_], vz = c.vz[slot_];
+	if (rb_) {
+		const Vector3& v = rb_->getLinearVelocity();
+		rb_->setLinearVelocity(Vector3(vx, v.y, vz));
+	}
+	else {
+		// El paso es en el mundo, se pasa al espacio del padre
+		Vector3 step(vx * deltaTime, 0.0f, vz * deltaTime);
+		Transform* parent = tr_->getParent();
+		if (parent != nullptr) {
+			Vector3 scale = parent->getWorldScale();
+			step = parent->getWorldRotation().conjugate().rotate(step);
+			step = Vector3(step.x / scale.x, step.y / scale.y, step.z / scale.z);
+		}
+		tr_->setPos(tr_->getPos() + step);
+	}
+}
@@ -0,0 +1,358 @@
+#include "NavMesh.h"
+#include <algorithm>
+#include <cmath>
+#include <climits>
+#include <deque>
+#include <queue>
+#include <limits>
+
+namespace {
+	const float SQRT2 = 1.41421356f;
+
+	// Datos temporales del A*, uno por hilo para no reservar en cada consulta.
+	// stamp marca que celdas tienen g valido en la busqueda actual
+	struct SearchScratch {
+		std::vector<float> g;
+		std::vector<int> parent;
+		std::vector<uint32_t> stamp;
+		uint32_t generation = 0;
+
+		void prepare(size_t n) {
+			if (g.size() != n) {
+				g.assign(n, 0.0f);
+				parent.assign(n, -1);
+				stamp.assign(n, 0);
+				generation = 0;
+			}
+			if (++generation == 0) {
+				std::fill(stamp.begin(), stamp.end(), 0);
+				generation = 1;
+			}
+		}
+	};
+	thread_local SearchScratch scratch;
+
+	struct OpenNode {
+		float f;
+		int cell;
+		bool operator<(const OpenNode& o) const { return f > o.f; }
+	};
+
+	float octile(int ax, int az, int bx, int bz) {
+		int dx = std::abs(ax - bx), dz = std::abs(az - bz);
+		return (float)(dx + dz) + (SQRT2 - 2.0f) * (float)std::min(dx, dz);
+	}
+}
+
+void NavMesh::build(const NavMeshConfig& config, const std::vector<NavBox>& geometry)
+{
+	config_ = config;
+	config_.cellSize = std::max(config_.cellSize, 0.01f);
+	width_ = depth_ = 0;
+	height_.clear();
+	walkable_.clear();
+
+	Vector3 bmin = config_.boundsMin, bmax = config_.boundsMax;
+	if (config_.autoBounds) {
+		if (geometry.empty()) return;
+		bmin = geometry[0].min;
+		bmax = geometry[0].max;
+		for (const NavBox& b : geometry) {
+			bmin = Vector3(std::min(bmin.x, b.min.x), std::min(bmin.y, b.min.y), std::min(bmin.z, b.min.z));
+			bmax = Vector3(std::max(bmax.x, b.max.x), std::max(bmax.y, b.max.y), std::max(bmax.z, b.max.z));
+		}
+	}
+
+	const float cell = config_.cellSize;
+	origin_ = bmin;
+	width_ = std::max(1, (int)std::ceil((bmax.x - bmin.x) / cell));
+	depth_ = std::max(1, (int)std::ceil((bmax.z - bmin.z) / cell));
+	const size_t n = (size_t)width_ * depth_;
+
+	// Voxelizado: cada caja anyade un tramo solido a las columnas que toca
+	std::vector<std::vector<std::pair<float, float>>> spans(n);
+	for (const NavBox& b : geometry) {
+		int x0 = std::max(0, (int)std::floor((b.min.x - origin_.x) / cell));
+		int x1 = std::min(width_ - 1, (int)std::ceil((b.max.x - origin_.x) / cell) - 1);
+		int z0 = std::max(0, (int)std::floor((b.min.z - origin_.z) / cell));
+		int z1 = std::min(depth_ - 1, (int)std::ceil((b.max.z - origin_.z) / cell) - 1);
+		for (int z = z0; z <= z1; z++)
+			for (int x = x0; x <= x1; x++)
+				spans[index(x, z)].push_back({ b.min.y, b.max.y });
+	}
+
+	// El suelo de cada columna es la cara superior del primer tramo con hueco
+	// suficiente encima para el agente
+	height_.assign(n, 0.0f);
+	walkable_.assign(n, 0);
+	for (size_t i = 0; i < n; i++) {
+		auto& s = spans[i];
+		if (s.empty()) continue;
+		std::sort(s.begin(), s.end());
+
+		std::vector<std::pair<float, float>> merged;
+		for (const auto& span : s) {
+			if (!merged.empty() && span.first <= merged.back().second)
+				merged.back().second = std::max(merged.back().second, span.second);
+			else
+				merged.push_back(span);
+		}
+
+		for (size_t j = 0; j < merged.size(); j++) {
+			float ceiling = j + 1 < merged.size() ? merged[j + 1].first : std::numeric_limits<float>::max();
+			if (ceiling - merged[j].second >= config_.agentHeight) {
+				height_[i] = merged[j].second;
+				walkable_[i] = 1;
+				break;
+			}
+		}
+	}
+
+	erode();
+}
+
+// Quita las celdas a menos de agentRadius de un obstaculo o de un escalon
+// demasiado alto, asi los caminos ya tienen en cuenta el tamanyo del agente
+void NavMesh::erode()
+{
+	int r = (int)std::ceil(config_.agentRadius / config_.cellSize);
+	if (r <= 0) return;
+
+	const int n = width_ * depth_;
+	std::vector<int> dist(n, INT_MAX);
+	std::deque<int> queue;
+
+	// Primero los obstaculos (0) y despues los bordes (1) para que el BFS salga en orden
+	for (int i = 0; i < n; i++)
+		if (!walkable_[i]) { dist[i] = 0; queue.push_back(i); }
+	for (int z = 0; z < depth_; z++) {
+		for (int x = 0; x < width_; x++) {
+			int i = index(x, z);
+			if (!walkable_[i]) continue;
+			const int nx[4] = { x - 1, x + 1, x, x };
+			const int nz[4] = { z, z, z - 1, z + 1 };
+			for (int k = 0; k < 4; k++) {
+				if (!inside(nx[k], nz[k]) || !canStep(i, index(nx[k], nz[k]))) {
+					dist[i] = 1;
+					queue.push_back(i);
+					break;
+				}
+			}
+		}
+	}
+
+	while (!queue.empty()) {
+		int c = queue.front();
+		queue.pop_front();
+		if (dist[c] >= r) continue;
+		int cx = c % width_, cz = c / width_;
+		for (int dz = -1; dz <= 1; dz++) {
+			for (int dx = -1; dx <= 1; dx++) {
+				if (!inside(cx + dx, cz + dz)) continue;
+				int nb = index(cx + dx, cz + dz);
+				if (dist[c] + 1 < dist[nb]) {
+					dist[nb] = dist[c] + 1;
+					queue.push_back(nb);
+				}
+			}
+		}
+	}
+
+	for (int i = 0; i < n; i++)
+		if (walkable_[i] && dist[i] <= r) walkable_[i] = 0;
+}
+
+bool NavMesh::toCell(const Vector3& pos, int& x, int& z) const
+{
+	x = (int)std::floor((pos.x - origin_.x) / config_.cellSize);
+	z = (int)std::floor((pos.z - origin_.z) / config_.cellSize);
+	return inside(x, z);
+}
+
+Vector3 NavMesh::toWorld(int x, int z) const
+{
+	return Vector3(origin_.x + (x + 0.5f) * config_.cellSize, height_[index(x, z)],
+		origin_.z + (z + 0.5f) * config_.cellSize);
+}
+
+bool NavMesh::canStep(int a, int b) const
+{
+	return walkable_[a] && walkable_[b] && std::abs(height_[a] - height_[b]) <= config_.maxClimb;
+}
+
+bool NavMesh::isWalkable(const Vector3& pos) const
+{
+	int x, z;
+	return toCell(pos, x, z) && walkable_[index(x, z)];
+}
+
+bool NavMesh::snapToCell(const Vector3& pos, int& x, int& z, int maxCells) const
+{
+	if (width_ == 0) return false;
+	toCell(pos, x, z);
+	x = std::max(0, std::min(width_ - 1, x));
+	z = std::max(0, std::min(depth_ - 1, z));
+	if (walkable_[index(x, z)]) return true;
+
+	// Anillos crecientes alrededor de la celda, gana la mas cercana del primero con alguna
+	for (int r = 1; r <= maxCells; r++) {
+		int best = -1;
+		int bestDist = INT_MAX;
+		for (int dz = -r; dz <= r; dz++) {
+			for (int dx = -r; dx <= r; dx++) {
+				if (std::max(std::abs(dx), std::abs(dz)) != r) continue;
+				int cx = x + dx, cz = z + dz;
+				if (!inside(cx, cz) || !walkable_[index(cx, cz)]) continue;
+				int d = dx * dx + dz * dz;
+				if (d < bestDist) { bestDist = d; best = index(cx, cz); }
+			}
+		}
+		if (best >= 0) {
+			x = best % width_;
+			z = best / width_;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool NavMesh::closestWalkable(const Vector3& pos, Vector3& out, int maxCells) const
+{
+	int x, z;
+	if (!snapToCell(pos, x, z, maxCells)) return false;
+	out = toWorld(x, z);
+	return true;
+}
+
+// Recorre todas las celdas que cruza el segmento entre los centros de a y b
+bool NavMesh::lineOfSight(int ax, int az, int bx, int bz) const
+{
+	int dx = std::abs(bx - ax), dz = std::abs(bz - az);
+	int sx = bx > ax ? 1 : -1, sz = bz > az ? 1 : -1;
+	int x = ax, z = az;
+	int prev = index(x, z);
+	int err = dx - dz;
+	dx *= 2;
+	dz *= 2;
+
+	for (int steps = std::abs(bx - ax) + std::abs(bz - az); steps > 0; steps--) {
+		if (err > 0) {
+			x += sx;
+			err -= dz;
+		}
+		else if (err < 0) {
+			z += sz;
+			err += dx;
+		}
+		else {
+			// Pasa justo por la esquina: tienen que valer las dos celdas laterales
+			if (!canStep(prev, index(x + sx, z)) || !canStep(prev, index(x, z + sz))) return false;
+			x += sx;
+			z += sz;
+			err += dx - dz;
+			steps--;
+		}
+		int cur = index(x, z);
+		if (!canStep(prev, cur)) return false;
+		prev = cur;
+	}
+	return true;
+}
+
+bool NavMesh::findPath(const Vector3& from, const Vector3& to, std::vector<Vector3>& out) const
+{
+	out.clear();
+	int sx, sz, gx, gz;
+	if (!snapToCell(from, sx, sz, 4) || !snapToCell(to, gx, gz, 4)) return false;
+
+	const int start = index(sx, sz), goal = index(gx, gz);
+	const size_t n = (size_t)width_ * depth_;
+	SearchScratch& s = scratch;
+	s.prepare(n);
+
+	std::priority_queue<OpenNode> open;
+	s.g[start] = 0.0f;
+	s.parent[start] = -1;
+	s.stamp[start] = s.generation;
+	open.push({ octile(sx, sz, gx, gz), start });
+
+	bool found = false;
+	while (!open.empty()) {
+		OpenNode node = open.top();
+		open.pop();
+		int c = node.cell;
+		if (c == goal) { found = true; break; }
+
+		int cx = c % width_, cz = c / width_;
+		// Nodo repetido con un coste peor que el que ya tenemos
+		if (node.f > s.g[c] + octile(cx, cz, gx, gz) + 1e-4f) continue;
+
+		for (int dz = -1; dz <= 1; dz++) {
+			for (int dx = -1; dx <= 1; dx++) {
+				if (dx == 0 && dz == 0) continue;
+				int nx = cx + dx, nz = cz + dz;
+				if (!inside(nx, nz)) continue;
+				int nb = index(nx, nz);
+				if (!canStep(c, nb)) continue;
+				bool diagonal = dx != 0 && dz != 0;
+				// Sin cortar esquinas
+				if (diagonal && (!canStep(c, index(cx + dx, cz)) || !canStep(c, index(cx, cz + dz)))) continue;
+
+				float g = s.g[c] + (diagonal ? SQRT2 : 1.0f);
+				if (s.stamp[nb] == s.generation && g >= s.g[nb]) continue;
+				s.stamp[nb] = s.generation;
+				s.g[nb] = g;
+				s.parent[nb] = c;
+				open.push({ g + octile(nx, nz, gx, gz), nb });
+			}
+		}
+	}
+	if (!found) return false;
+
+	std::vector<int> cells;
+	for (int c = goal; c != -1; c = s.parent[c])
+		cells.push_back(c);
+	std::reverse(cells.begin(), cells.end());
+
+	// Los extremos son los puntos pedidos si caen en su celda, si no el centro
+	Vector3 startPos = isWalkable(from) ? Vector3(from.x, height_[start], from.z) : toWorld(sx, sz);
+	Vector3 goalPos = isWalkable(to) ? Vector3(to.x, height_[goal], to.z) : toWorld(gx, gz);
+
+	// Suavizado: desde cada punto se salta al mas lejano que se ve en linea recta
+	out.push_back(startPos);
+	size_t anchor = 0;
+	const size_t last = cells.size() - 1;
+	while (anchor < last) {
+		size_t next = anchor + 1;
+		int ax = cells[anchor] % width_, az = cells[anchor] / width_;
+		for (size_t j = anchor + 2; j <= last; j++) {
+			if (!lineOfSight(ax, az, cells[j] % width_, cells[j] / width_)) break;
+			next = j;
+		}
+		if (next != last)
+			out.push_back(toWorld(cells[next] % width_, cells[next] / width_));
+		anchor = next;
+	}
+	out.push_back(goalPos);
+	return true;
+}
+
+int NavMesh::getWidth() const
+{
+	return width_;
+}
+
+int NavMesh::getDepth() const
+{
+	return depth_;
+}
+
+int NavMesh::getWalkableCount() const
+{
+	return (int)std::count(walkable_.begin(), walkable_.end(), 1);
+}
+
+const NavMeshConfig& NavMesh::getConfig() const
+{
+	return config_;
+}
@@ -0,0 +1,58 @@
+#include "NavMeshComponent.h"
+#include "NavigationManager.h"
+#include <checkML.h>
+
+NavMeshComponent::NavMeshComponent() :
+	Component(NavigationManager::getInstance(), (int)NavigationManager::NavCmpId::NavMesh)
+{
+}
+
+NavMeshComponent::~NavMeshComponent()
+{
+}
+
+void NavMeshComponent::init()
+{
+	config_ = NavMeshConfig();
+}
+
+void NavMeshComponent::load(const nlohmann::json& params)
+{
+	auto it = params.find("cellSize");
+	if (it != params.end()) config_.cellSize = it->get<float>();
+
+	it = params.find("agentRadius");
+	if (it != params.end()) config_.agentRadius = it->get<float>();
+
+	it = params.find("agentHeight");
+	if (it != params.end()) config_.agentHeight = it->get<float>();
+
+	it = params.find("maxClimb");
+	if (it != params.end()) config_.maxClimb = it->get<float>();
+
+	// Si no se dan limites se usan los de la geometria
+	auto itMin = params.find("boundsMin");
+	auto itMax = params.find("boundsMax");
+	if (itMin != params.end() && itMax != params.end()) {
+		config_.boundsMin = Vector3(itMin->get<std::vector<float>>());
+		config_.boundsMax = Vector3(itMax->get<std::vector<float>>());
+		config_.autoBounds = false;
+	}
+
+	// Los MeshComponent sin rigidbody y sin velocidad cuentan como estaticos
+	it = params.find("includeMeshes");
+	if (it != params.end()) includeMeshes_ = it->get<bool>();
+
+	// Ignora la malla guardada de la escena y la vuelve a hornear
+	it = params.find("rebake");
+	if (it != params.end()) forceRebake_ = it->get<bool>();
+}
+
+void NavMeshComponent::update(float deltaTime)
+{
+}
+
+const NavMeshConfig& NavMeshComponent::getConfig() const
+{
+	return config_;
+}
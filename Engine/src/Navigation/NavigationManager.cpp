@@ -0,0 +1,277 @@
+#include "NavigationManager.h"
+#include "EngineContext.h"
+#include "NavMeshComponent.h"
+#include "CrowdAgent.h"
+#include "Entity.h"
+#include "CommonManager.h"
+#include "Transform.h"
+#include "PhysicsManager.h"
+#include "Rigidbody.h"
+#include "RenderManager.h"
+#include "MeshComponent.h"
+#include "Managers/SceneManager.h"
+#include "Scene/Scene.h"
+#include "MathConversions.h"
+#include <btBulletDynamicsCommon.h>
+#include <OgreEntity.h>
+#include <OgreAxisAlignedBox.h>
+#include <checkML.h>
+#include <iostream>
+#include <algorithm>
+
+std::atomic<unsigned int> NavigationManager::liveWorkers_(0);
+
+static_assert((int)NavigationManager::NavCmpId::LastNavCmpId == NATIVE_COMPONENTS[(int)ManID::Navigation], "Update NATIVE_COMPONENTS in ComponentTypes.h");
+
+NavigationManager::NavigationManager() : Manager(ManID::Navigation)
+{
+	registerComponent("NavMesh", (int)NavCmpId::NavMesh, []() -> NavMeshComponent* { return new NavMeshComponent(); });
+	registerComponent("CrowdAgent", (int)NavCmpId::CrowdAgent, []() -> CrowdAgent* { return new CrowdAgent(); });
+
+	// Se deja un nucleo libre para el hilo principal y el resto se reparte
+	// entre los contextos: cada uno coge lo que quede, hasta 4 y al menos 1
+	unsigned int hw = std::thread::hardware_concurrency();
+	unsigned int cores = hw > 1 ? hw - 1 : 1u;
+	unsigned int used = liveWorkers_.load();
+	unsigned int count;
+	do {
+		count = std::max(1u, std::min(4u, cores > used ? cores - used : 0u));
+	} while (!liveWorkers_.compare_exchange_weak(used, used + count));
+	for (unsigned int i = 0; i < count; i++)
+		workers_.emplace_back(&NavigationManager::workerLoop, this);
+}
+
+NavigationManager::~NavigationManager()
+{
+	{
+		std::lock_guard<std::mutex> lock(mtx_);
+		quit_ = true;
+	}
+	cv_.notify_all();
+	for (std::thread& t : workers_)
+		t.join();
+	liveWorkers_ -= (unsigned int)workers_.size();
+}
+
+NavigationManager* NavigationManager::getInstance()
+{
+	return EngineContext::current()->nav;
+}
+
+bool NavigationManager::setUpInstance()
+{
+	EngineContext* ctx = EngineContext::current();
+	if (!ctx->nav) {
+		try {
+			ctx->nav = new NavigationManager();
+		}
+		catch (...) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void NavigationManager::clean()
+{
+	NavigationManager* nav = getInstance();
+	// Las peticiones de la escena anterior ya no tienen sentido
+	{
+		std::lock_guard<std::mutex> lock(nav->mtx_);
+		nav->requests_.clear();
+		nav->queue_.clear();
+	}
+	nav->current_ = nullptr;
+	nav->settings_ = nullptr;
+	nav->destroyAllComponents();
+}
+
+void NavigationManager::destroy()
+{
+	getInstance()->clean();
+	delete getInstance();
+	EngineContext::current()->nav = nullptr;
+}
+
+void NavigationManager::start()
+{
+	for (size_t i = 0; i < _compsList.size(); ++i)
+		_compsList[i]->setUp();
+
+	// Solo las escenas con un NavMesh tienen malla
+	settings_ = nullptr;
+	for (Component* cmp : _compsList) {
+		if (cmp->getId() == (int)NavCmpId::NavMesh) {
+			settings_ = static_cast<NavMeshComponent*>(cmp);
+			break;
+		}
+	}
+	if (!settings_) return;
+
+	const std::string& scene = SceneManager::getInstance()->getCurrentScene()->getName();
+	auto it = cache_.find(scene);
+	if (it != cache_.end() && !settings_->forceRebake_)
+		current_ = it->second;
+	else
+		rebake();
+}
+
+void NavigationManager::update(float deltaTime)
+{
+	crowd_.update(deltaTime, current_.get());
+}
+
+void NavigationManager::rebake()
+{
+	if (!settings_) return;
+	current_ = bake(settings_->config_, settings_->includeMeshes_);
+	cache_[SceneManager::getInstance()->getCurrentScene()->getName()] = current_;
+}
+
+std::shared_ptr<const NavMesh> NavigationManager::bake(const NavMeshConfig& config, bool includeMeshes)
+{
+	std::vector<NavBox> geometry;
+	gatherGeometry(geometry, includeMeshes);
+
+	auto mesh = std::make_shared<NavMesh>();
+	mesh->build(config, geometry);
+	std::cout << "NavMesh: " << geometry.size() << " objetos, " << mesh->getWidth() << "x" << mesh->getDepth()
+		<< " celdas, " << mesh->getWalkableCount() << " transitables\n";
+	return mesh;
+}
+
+void NavigationManager::gatherGeometry(std::vector<NavBox>& geometry, bool includeMeshes)
+{
+	// Rigidbodies estaticos, con la caja que ya calcula Bullet
+	// Solo los activos, que van al principio
+	PhysicsManager* phys = PhysicsManager::getInstance();
+	for (size_t i = 0; i < phys->getActiveCount(); ++i) {
+		Component* c = phys->getComponents()[i];
+		if (c->getId() != (int)PhysicsManager::PhysicsCmpId::RigigbodyId) continue;
+		RigidBody* rb = static_cast<RigidBody*>(c);
+		if (!rb->isStatic() || rb->isTrigger()) continue;
+		btVector3 mn, mx;
+		rb->getBtRb()->getAabb(mn, mx);
+		geometry.push_back({ cvt(mn), cvt(mx) });
+	}
+
+	if (!includeMeshes || !RenderManager::getInstance()) return;
+
+	// Meshes que no mueve nadie: sin rigidbody y sin velocidad
+	RenderManager* render = RenderManager::getInstance();
+	for (size_t i = 0; i < render->getActiveCount(); ++i) {
+		Component* cmp = render->getComponents()[i];
+		if (cmp->getId() != (int)RenderManager::RenderCmpId::Mesh) continue;
+		Entity* ent = cmp->getEntity();
+		if (ent->has<RigidBody>()) continue;
+		Transform* tr = ent->get<Transform>();
+		if (!tr || !tr->getVel().isZero()) continue;
+
+		MeshComponent* mesh = static_cast<MeshComponent*>(cmp);
+		if (!mesh->getOgreEntity()) continue;
+		// Caja local del mesh llevada al mundo con el transform: hasta el
+		// primer frame el nodo de Ogre no tiene aun su posicion
+		const Ogre::AxisAlignedBox& box = mesh->getOgreEntity()->getBoundingBox();
+		if (box.isNull() || box.isInfinite()) continue;
+		const Matrix4& world = tr->getWorldMatrix();
+		const Ogre::AxisAlignedBox::Corners corners = box.getAllCorners();
+		NavBox worldBox;
+		worldBox.min = worldBox.max = world.transformPoint(cvt(corners[0]));
+		for (int k = 1; k < 8; ++k) {
+			Vector3 p = world.transformPoint(cvt(corners[k]));
+			worldBox.min = Vector3(std::min(worldBox.min.x, p.x), std::min(worldBox.min.y, p.y), std::min(worldBox.min.z, p.z));
+			worldBox.max = Vector3(std::max(worldBox.max.x, p.x), std::max(worldBox.max.y, p.y), std::max(worldBox.max.z, p.z));
+		}
+		geometry.push_back(worldBox);
+	}
+}
+
+Crowd& NavigationManager::getCrowd()
+{
+	return crowd_;
+}
+
+bool NavigationManager::hasNavMesh() const
+{
+	return current_ != nullptr;
+}
+
+bool NavigationManager::isWalkable(const Vector3& pos) const
+{
+	return current_ && current_->isWalkable(pos);
+}
+
+int NavigationManager::requestPath(const Vector3& from, const Vector3& to)
+{
+	if (!current_) return -1;
+
+	int id;
+	{
+		std::lock_guard<std::mutex> lock(mtx_);
+		id = nextId_++;
+		PathRequest& req = requests_[id];
+		req.from = from;
+		req.to = to;
+		req.mesh = current_;
+		queue_.push_back(id);
+	}
+	cv_.notify_one();
+	return id;
+}
+
+NavigationManager::PathStatus NavigationManager::getPathStatus(int id)
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	auto it = requests_.find(id);
+	return it == requests_.end() ? PathStatus::Invalid : it->second.status;
+}
+
+bool NavigationManager::getPath(int id, std::vector<Vector3>& out)
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	auto it = requests_.find(id);
+	if (it == requests_.end() || it->second.status != PathStatus::Ready) return false;
+	out = it->second.path;
+	return true;
+}
+
+void NavigationManager::releasePath(int id)
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	requests_.erase(id);
+}
+
+bool NavigationManager::findPath(const Vector3& from, const Vector3& to, std::vector<Vector3>& out) const
+{
+	return current_ && current_->findPath(from, to, out);
+}
+
+// Cada peticion lleva su propia referencia a la malla, asi un cambio de escena
+// o un rehorneado no invalida las que estan en curso
+void NavigationManager::workerLoop()
+{
+	std::unique_lock<std::mutex> lock(mtx_);
+	while (true) {
+		cv_.wait(lock, [this] { return quit_ || !queue_.empty(); });
+		if (quit_) return;
+
+		int id = queue_.front();
+		queue_.pop_front();
+		auto it = requests_.find(id);
+		if (it == requests_.end()) continue;
+		Vector3 from = it->second.from, to = it->second.to;
+		std::shared_ptr<const NavMesh> mesh = it->second.mesh;
+
+		lock.unlock();
+		std::vector<Vector3> path;
+		bool ok = mesh->findPath(from, to, path);
+		lock.lock();
+
+		// Puede haberse liberado mientras se calculaba
+		it = requests_.find(id);
+		if (it == requests_.end()) continue;
+		it->second.status = ok ? PathStatus::Ready : PathStatus::Failed;
+		it->second.path = std::move(path);
+		it->second.mesh = nullptr;
+	}
+}
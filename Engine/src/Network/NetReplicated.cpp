@@ -0,0 +1,133 @@
+#include "NetReplicated.h"
+#include "NetworkManager.h"
+#include "Entity.h"
+#include "CommonManager.h"
+#include "Transform.h"
+#include "PhysicsManager.h"
+#include "Rigidbody.h"
+#include "LUA/LUAManager.h"
+#include <LuaBridge.h>
+#include <checkML.h>
+#include <iostream>
+
+namespace {
+	// FNV-1a de 32 bits
+	uint32_t hashName(const std::string& s) {
+		uint32_t h = 2166136261u;
+		for (unsigned char c : s) {
+			h ^= c;
+			h *= 16777619u;
+		}
+		return h;
+	}
+}
+
+NetReplicated::NetReplicated() :
+	Component(NetworkManager::getInstance(), (int)NetworkManager::NetCmpId::Replicated)
+{
+	init();
+}
+
+NetReplicated::~NetReplicated()
+{
+	NetworkManager::getInstance()->unregisterReplicated(this);
+}
+
+void NetReplicated::init()
+{
+}
+
+void NetReplicated::load(const nlohmann::json& params)
+{
+	auto it = params.find("velocity");
+	if (it != params.end()) velocity_ = it->get<bool>();
+
+	it = params.find("alwaysRelevant");
+	if (it != params.end()) alwaysRelevant_ = it->get<bool>();
+
+	it = params.find("focus");
+	if (it != params.end()) focus_ = it->get<bool>();
+
+	it = params.find("luaClass");
+	if (it != params.end()) luaClass_ = it->get<std::string>();
+
+	it = params.find("luaFields");
+	if (it != params.end()) {
+		luaFields_ = it->get<std::vector<std::string>>();
+		if (luaFields_.size() > EntityState::MAX_LUA_FIELDS) {
+			std::cout << "WARNING: NetReplicated solo replica " << EntityState::MAX_LUA_FIELDS << " campos de Lua\n";
+			luaFields_.resize(EntityState::MAX_LUA_FIELDS);
+		}
+	}
+}
+
+void NetReplicated::setUp()
+{
+	netId_ = hashName(_entity->getName());
+	tr_ = _entity->get<Transform>();
+	rb_ = _entity->get<RigidBody>();
+	NetworkManager::getInstance()->registerReplicated(this);
+}
+
+// El NetworkManager recoge y aplica los estados de todos a la vez
+void NetReplicated::update(float deltaTime)
+{
+}
+
+uint32_t NetReplicated::getNetId() const
+{
+	return netId_;
+}
+
+bool NetReplicated::isAlwaysRelevant() const
+{
+	return alwaysRelevant_;
+}
+
+bool NetReplicated::isFocus() const
+{
+	return focus_;
+}
+
+Vector3 NetReplicated::getPos() const
+{
+	return tr_ ? tr_->getPos() : Vector3();
+}
+
+void NetReplicated::capture(EntityState& state, const QuantizationConfig& q) const
+{
+	state.setPos(tr_->getPos(), q);
+	state.setRot(tr_->getRot(), q);
+	state.hasVel = velocity_;
+	if (velocity_)
+		state.setVel(rb_ ? rb_->getLinearVelocity() : tr_->getVel(), q);
+
+	state.luaCount = 0;
+	if (luaFields_.empty()) return;
+	luabridge::LuaRef self = LUAManager::getInstance()->getLuaSelf(_entity, luaClass_);
+	if (!self.isTable()) return;
+	for (const std::string& f : luaFields_) {
+		luabridge::LuaRef v = self[f];
+		state.lua[state.luaCount++] = v.isNumber() ? v.cast<float>() : 0.0f;
+	}
+}
+
+void NetReplicated::restore(const EntityState& state, const QuantizationConfig& q)
+{
+	// Con fisica se mueve el cuerpo para que Bullet no lo devuelva a su sitio
+	if (rb_) {
+		rb_->setPosition(state.getPos(q));
+		if (state.hasVel) rb_->setLinearVelocity(state.getVel(q));
+	}
+	else {
+		tr_->setPos(state.getPos(q));
+		if (state.hasVel) tr_->setVel(state.getVel(q));
+	}
+	tr_->setRot(state.getRot(q));
+
+	if (luaFields_.empty()) return;
+	luabridge::LuaRef self = LUAManager::getInstance()->getLuaSelf(_entity, luaClass_);
+	if (!self.isTable()) return;
+	for (size_t i = 0; i < luaFields_.size() && i < state.luaCount; i++)
+		self[luaFields_[i]] = state.lua[i];
+}
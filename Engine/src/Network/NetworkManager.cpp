@@ -0,0 +1,243 @@
+#include "NetworkManager.h"
+#include "EngineContext.h"
+#include "NetReplicated.h"
+#include "Entity.h"
+#include <checkML.h>
+#include <iostream>
+#include <chrono>
+
+static_assert((int)NetworkManager::NetCmpId::LastNetCmpId == NATIVE_COMPONENTS[(int)ManID::Network], "Update NATIVE_COMPONENTS in ComponentTypes.h");
+
+NetworkManager::NetworkManager() : Manager(ManID::Network)
+{
+	registerComponent("NetReplicated", (int)NetCmpId::Replicated, []() -> NetReplicated* { return new NetReplicated(); });
+}
+
+NetworkManager::~NetworkManager()
+{
+	stop();
+}
+
+NetworkManager* NetworkManager::getInstance()
+{
+	return EngineContext::current()->net;
+}
+
+bool NetworkManager::setUpInstance()
+{
+	EngineContext* ctx = EngineContext::current();
+	if (!ctx->net) {
+		try {
+			ctx->net = new NetworkManager();
+		}
+		catch (...) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// La conexion sobrevive a los cambios de escena, solo se van los componentes
+void NetworkManager::clean()
+{
+	NetworkManager* net = getInstance();
+	net->destroyAllComponents();
+	net->byId_.clear();
+	net->applied_ = 0;
+}
+
+void NetworkManager::destroy()
+{
+	getInstance()->clean();
+	delete getInstance();
+	EngineContext::current()->net = nullptr;
+}
+
+void NetworkManager::start()
+{
+	for (size_t i = 0; i < _compsList.size(); ++i)
+		_compsList[i]->setUp();
+}
+
+void NetworkManager::update(float deltaTime)
+{
+	if (mode_ == Mode::Offline) return;
+
+	Packet packet;
+	if (server_) {
+		while (serverTransport_->receive(packet))
+			server_->handlePacket(packet);
+	}
+
+	if (client_) {
+		// El foco es el jugador local
+		for (auto& r : byId_) {
+			if (r.second->isFocus()) {
+				client_->setFocus(r.second->getPos());
+				break;
+			}
+		}
+		client_->update(deltaTime);
+		while (clientTransport_->receive(packet)) {
+			if (client_->handlePacket(packet) && mode_ == Mode::Client)
+				applySnapshot(*client_->getLatest());
+		}
+	}
+
+	if (server_) {
+		tickTimer_ += deltaTime;
+		float step = 1.0f / tickRate_;
+		if (tickTimer_ >= step) {
+			serverTick(tickTimer_);
+			// Si el frame ha sido muy largo no se acumulan ticks
+			tickTimer_ = tickTimer_ >= 2.0f * step ? 0.0f : tickTimer_ - step;
+		}
+	}
+}
+
+void NetworkManager::serverTick(float deltaTime)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	world_.entities.clear();
+	always_.clear();
+	for (auto& r : byId_) {
+		if (!r.second->isActive()) continue;
+		world_.entities.emplace_back(r.first, EntityState());
+		r.second->capture(world_.entities.back().second, q_);
+		always_.push_back(r.second->isAlwaysRelevant());
+	}
+	float gatherMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	server_->tick(world_, always_, deltaTime);
+	// El coste del tick incluye recoger el estado de la escena
+	stats_ = server_->getStats();
+	stats_.serializeMs += gatherMs;
+}
+
+void NetworkManager::applySnapshot(const Snapshot& snap)
+{
+	// Los snapshots pueden llegar desordenados
+	if (snap.sequence <= applied_) return;
+	applied_ = snap.sequence;
+
+	// Las entidades que el cliente no conoce (creadas en el servidor) se ignoran
+	for (const auto& e : snap.entities) {
+		auto it = byId_.find(e.first);
+		if (it != byId_.end() && !it->second->isFocus())
+			it->second->restore(e.second, q_);
+	}
+}
+
+bool NetworkManager::startServer(uint16_t port)
+{
+	stop();
+	auto udp = std::make_unique<UdpTransport>();
+	if (!udp->open(port)) {
+		std::cout << "WARNING: no se ha podido abrir el puerto " << port << "\n";
+		return false;
+	}
+	serverTransport_ = std::move(udp);
+	server_ = std::make_unique<ReplicationServer>(serverTransport_.get(), q_);
+	server_->setInterestRadius(interestRadius_);
+	mode_ = Mode::Server;
+	return true;
+}
+
+bool NetworkManager::connect(const std::string& host, uint16_t port)
+{
+	stop();
+	auto udp = std::make_unique<UdpTransport>();
+	int peer = -1;
+	if (!udp->open(0) || (peer = udp->addPeer(host, port)) < 0) {
+		std::cout << "WARNING: no se ha podido conectar con " << host << ":" << port << "\n";
+		return false;
+	}
+	clientTransport_ = std::move(udp);
+	client_ = std::make_unique<ReplicationClient>(clientTransport_.get(), peer, q_);
+	mode_ = Mode::Client;
+	return true;
+}
+
+// El cliente local solo decodifica, la escena ya es la del servidor
+void NetworkManager::startLoopback(float latencyMs, float jitterMs, float lossPercent)
+{
+	stop();
+	LinkConditions conditions;
+	conditions.latencyMs = latencyMs;
+	conditions.jitterMs = jitterMs;
+	conditions.lossPercent = lossPercent;
+
+	std::unique_ptr<LoopbackTransport> a, b;
+	LoopbackTransport::createPair(conditions, a, b);
+	serverTransport_ = std::move(a);
+	clientTransport_ = std::move(b);
+	server_ = std::make_unique<ReplicationServer>(serverTransport_.get(), q_);
+	server_->setInterestRadius(interestRadius_);
+	client_ = std::make_unique<ReplicationClient>(clientTransport_.get(), 0, q_);
+	mode_ = Mode::Loopback;
+}
+
+void NetworkManager::stop()
+{
+	if (client_) {
+		client_->disconnect();
+		client_ = nullptr;
+	}
+	server_ = nullptr;
+	clientTransport_ = nullptr;
+	serverTransport_ = nullptr;
+	mode_ = Mode::Offline;
+	tickTimer_ = 0.0f;
+	applied_ = 0;
+	stats_ = ReplicationStats();
+}
+
+NetworkManager::Mode NetworkManager::getMode() const
+{
+	return mode_;
+}
+
+bool NetworkManager::isConnected() const
+{
+	if (server_) return true;
+	return client_ && client_->isConnected();
+}
+
+void NetworkManager::setTickRate(float hz)
+{
+	if (hz > 0.0f) tickRate_ = hz;
+}
+
+void NetworkManager::setInterestRadius(float radius)
+{
+	interestRadius_ = radius;
+	if (server_) server_->setInterestRadius(radius);
+}
+
+const ReplicationStats& NetworkManager::getStats() const
+{
+	if (server_) return stats_;
+	if (client_) return client_->getStats();
+	return emptyStats_;
+}
+
+const ReplicationStats& NetworkManager::getLoopbackClientStats() const
+{
+	return client_ && server_ ? client_->getStats() : emptyStats_;
+}
+
+void NetworkManager::registerReplicated(NetReplicated* rep)
+{
+	auto res = byId_.emplace(rep->getNetId(), rep);
+	if (!res.second && res.first->second != rep)
+		std::cout << "WARNING: " << rep->getEntity()->getName() << " tiene el mismo id de red que "
+			<< res.first->second->getEntity()->getName() << ", no se replica\n";
+}
+
+void NetworkManager::unregisterReplicated(NetReplicated* rep)
+{
+	auto it = byId_.find(rep->getNetId());
+	if (it != byId_.end() && it->second == rep)
+		byId_.erase(it);
+}
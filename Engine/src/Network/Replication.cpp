@@ -0,0 +1,255 @@
+#include "Replication.h"
+#include <chrono>
+#include <algorithm>
+
+const float ReplicationServer::TIMEOUT = 5.0f;
+
+namespace {
+	std::vector<uint8_t> typeOnly(PacketType type) {
+		return std::vector<uint8_t>(1, (uint8_t)type);
+	}
+}
+
+//----------------------- SERVIDOR -----------------------//
+
+ReplicationServer::ReplicationServer(Transport* transport, const QuantizationConfig& q) :
+	transport_(transport), q_(q)
+{
+}
+
+void ReplicationServer::setInterestRadius(float radius)
+{
+	interestRadius_ = radius;
+}
+
+void ReplicationServer::handlePacket(const Packet& packet)
+{
+	if (packet.data.empty()) return;
+	BitReader r(packet.data.data() + 1, packet.data.size() - 1);
+
+	switch ((PacketType)packet.data[0]) {
+	case PacketType::Hello: {
+		// El cliente no tiene ninguna base (es nuevo o se ha reconectado):
+		// lo siguiente que le llegue tiene que ser completo. La secuencia
+		// sigue, asi los acks atrasados no coinciden con nada nuevo
+		Client& c = clients_[packet.peer];
+		c.lastAck = 0;
+		c.history.clear();
+		c.silence = 0.0f;
+		break;
+	}
+	case PacketType::Ack: {
+		auto it = clients_.find(packet.peer);
+		if (it == clients_.end()) break;
+		Client& c = it->second;
+		uint32_t seq = r.readVarint();
+		bool hasFocus = r.readBool();
+		Vector3 focus;
+		if (hasFocus) focus = Vector3(r.readFloat(), r.readFloat(), r.readFloat());
+		if (r.overflow()) break;
+		// Los acks pueden llegar desordenados
+		if (seq > c.lastAck) c.lastAck = seq;
+		c.hasFocus = hasFocus;
+		c.focus = focus;
+		c.silence = 0.0f;
+		break;
+	}
+	case PacketType::Bye:
+		clients_.erase(packet.peer);
+		break;
+	default:
+		break;
+	}
+}
+
+const Snapshot* ReplicationServer::findBaseline(const Client& c) const
+{
+	if (c.lastAck == 0) return nullptr;
+	for (const Snapshot& s : c.history)
+		if (s.sequence == c.lastAck) return &s;
+	return nullptr;
+}
+
+void ReplicationServer::tick(const Snapshot& world, const std::vector<bool>& always, float deltaTime)
+{
+	auto start = std::chrono::steady_clock::now();
+	const float r2 = interestRadius_ * interestRadius_;
+	size_t totalBytes = 0;
+
+	for (auto it = clients_.begin(); it != clients_.end();) {
+		Client& c = it->second;
+		c.silence += deltaTime;
+		if (c.silence > TIMEOUT) {
+			it = clients_.erase(it);
+			continue;
+		}
+
+		// Interes: solo lo que esta cerca del foco del cliente
+		Snapshot snap;
+		snap.sequence = ++c.sequence;
+		snap.entities.reserve(world.entities.size());
+		for (size_t i = 0; i < world.entities.size(); i++) {
+			const auto& e = world.entities[i];
+			if (c.hasFocus && !always[i] && (e.second.getPos(q_) - c.focus).squareMagnitude() > r2) continue;
+			snap.entities.push_back(e);
+		}
+
+		const Snapshot* base = findBaseline(c);
+		BitWriter w;
+		w.writeBits((uint32_t)PacketType::Snapshot, 8);
+		w.writeVarint(snap.sequence);
+		w.writeVarint(base ? base->sequence : 0);
+		writeSnapshot(w, snap, base, q_);
+		transport_->send(it->first, w.data());
+
+		c.bytesWindow += w.sizeBytes();
+		totalBytes += w.sizeBytes();
+		c.history.push_back(std::move(snap));
+		if (c.history.size() > HISTORY) c.history.pop_front();
+		++it;
+	}
+
+	// Ventanas de un segundo para el ancho de banda
+	windowTime_ += deltaTime;
+	if (windowTime_ >= 1.0f) {
+		float sum = 0.0f;
+		for (auto& c : clients_) {
+			c.second.bytesPerSecond = c.second.bytesWindow / windowTime_;
+			c.second.bytesWindow = 0;
+			sum += c.second.bytesPerSecond;
+		}
+		stats_.bytesPerSecond = clients_.empty() ? 0.0f : sum / clients_.size();
+		windowTime_ = 0.0f;
+	}
+
+	stats_.clients = (int)clients_.size();
+	stats_.entities = (int)world.entities.size();
+	if (!clients_.empty()) {
+		stats_.snapshots++;
+		float bytes = (float)totalBytes / clients_.size();
+		stats_.avgSnapshotBytes += (bytes - stats_.avgSnapshotBytes) * 0.1f;
+	}
+	stats_.serializeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+const ReplicationStats& ReplicationServer::getStats() const
+{
+	return stats_;
+}
+
+int ReplicationServer::getClientCount() const
+{
+	return (int)clients_.size();
+}
+
+//----------------------- CLIENTE -----------------------//
+
+ReplicationClient::ReplicationClient(Transport* transport, int serverPeer, const QuantizationConfig& q) :
+	transport_(transport), serverPeer_(serverPeer), q_(q)
+{
+}
+
+void ReplicationClient::update(float deltaTime)
+{
+	if (history_.empty()) {
+		helloTimer_ -= deltaTime;
+		if (helloTimer_ <= 0.0f) {
+			transport_->send(serverPeer_, typeOnly(PacketType::Hello));
+			helloTimer_ = 0.5f;
+		}
+	}
+
+	windowTime_ += deltaTime;
+	if (windowTime_ >= 1.0f) {
+		stats_.bytesPerSecond = bytesWindow_ / windowTime_;
+		bytesWindow_ = 0;
+		windowTime_ = 0.0f;
+	}
+}
+
+const Snapshot* ReplicationClient::find(uint32_t sequence) const
+{
+	for (const Snapshot& s : history_)
+		if (s.sequence == sequence) return &s;
+	return nullptr;
+}
+
+bool ReplicationClient::handlePacket(const Packet& packet)
+{
+	if (packet.peer != serverPeer_ || packet.data.empty() || (PacketType)packet.data[0] != PacketType::Snapshot)
+		return false;
+	bytesWindow_ += packet.data.size();
+
+	auto start = std::chrono::steady_clock::now();
+	BitReader r(packet.data.data() + 1, packet.data.size() - 1);
+	uint32_t seq = r.readVarint();
+	uint32_t baseSeq = r.readVarint();
+
+	// Repetido o mas viejo que el que ya tenemos
+	uint32_t latest = history_.empty() ? 0 : history_.back().sequence;
+	if (seq <= latest) return false;
+
+	const Snapshot* base = nullptr;
+	if (baseSeq != 0) {
+		base = find(baseSeq);
+		// Sin la base no se puede reconstruir; el servidor mandara otro
+		if (!base) return false;
+	}
+
+	Snapshot snap;
+	snap.sequence = seq;
+	if (!readSnapshot(r, snap, base, q_)) return false;
+
+	if (latest != 0 && seq > latest + 1) stats_.snapshotsLost += seq - latest - 1;
+	stats_.snapshots++;
+	stats_.entities = (int)snap.entities.size();
+	stats_.avgSnapshotBytes += (packet.data.size() - stats_.avgSnapshotBytes) * 0.1f;
+
+	history_.push_back(std::move(snap));
+	if (history_.size() > HISTORY) history_.pop_front();
+	sendAck(seq);
+
+	stats_.serializeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return true;
+}
+
+void ReplicationClient::sendAck(uint32_t sequence)
+{
+	BitWriter w;
+	w.writeBits((uint32_t)PacketType::Ack, 8);
+	w.writeVarint(sequence);
+	w.writeBool(hasFocus_);
+	if (hasFocus_) {
+		w.writeFloat(focus_.x);
+		w.writeFloat(focus_.y);
+		w.writeFloat(focus_.z);
+	}
+	transport_->send(serverPeer_, w.data());
+}
+
+void ReplicationClient::setFocus(const Vector3& focus)
+{
+	hasFocus_ = true;
+	focus_ = focus;
+}
+
+void ReplicationClient::disconnect()
+{
+	transport_->send(serverPeer_, typeOnly(PacketType::Bye));
+	history_.clear();
+}
+
+const Snapshot* ReplicationClient::getLatest() const
+{
+	return history_.empty() ? nullptr : &history_.back();
+}
+
+bool ReplicationClient::isConnected() const
+{
+	return !history_.empty();
+}
+
+const ReplicationStats& ReplicationClient::getStats() const
+{
+	return stats_;
+}
@@ -0,0 +1,208 @@
+#include "Snapshot.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	enum FieldMask : uint32_t {
+		FieldPos = 1,
+		FieldRot = 2,
+		FieldVel = 4,
+		FieldLua = 8,
+		FieldCount = 4
+	};
+
+	float wrapAngle(float deg) {
+		deg = std::fmod(deg, 360.0f);
+		return deg < 0.0f ? deg + 360.0f : deg;
+	}
+
+	bool sameVec(const uint32_t* a, const uint32_t* b) {
+		return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+	}
+
+	// Cada componente va como diferencia corta si cabe, si no completo
+	void writeVec(BitWriter& w, const uint32_t* v, const uint32_t* base, int bits, int deltaBits) {
+		const int32_t limit = 1 << (deltaBits - 1);
+		for (int i = 0; i < 3; i++) {
+			if (base) {
+				int32_t d = (int32_t)v[i] - (int32_t)base[i];
+				if (d >= -limit && d < limit) {
+					w.writeBool(true);
+					w.writeBits((uint32_t)(d + limit), deltaBits);
+					continue;
+				}
+				w.writeBool(false);
+			}
+			w.writeBits(v[i], bits);
+		}
+	}
+
+	void readVec(BitReader& r, uint32_t* v, const uint32_t* base, int bits, int deltaBits) {
+		const int32_t limit = 1 << (deltaBits - 1);
+		for (int i = 0; i < 3; i++) {
+			if (base && r.readBool())
+				v[i] = (uint32_t)((int32_t)base[i] + (int32_t)r.readBits(deltaBits) - limit);
+			else
+				v[i] = r.readBits(bits);
+		}
+	}
+
+	uint32_t changedFields(const EntityState& s, const EntityState* b) {
+		if (!b) return FieldPos | FieldRot | (s.hasVel ? (uint32_t)FieldVel : 0u) | (s.luaCount ? (uint32_t)FieldLua : 0u);
+		uint32_t mask = 0;
+		if (!sameVec(s.pos, b->pos)) mask |= FieldPos;
+		if (!sameVec(s.rot, b->rot)) mask |= FieldRot;
+		if (s.hasVel != b->hasVel || (s.hasVel && !sameVec(s.vel, b->vel))) mask |= FieldVel;
+		if (s.luaCount != b->luaCount || !std::equal(s.lua, s.lua + s.luaCount, b->lua)) mask |= FieldLua;
+		return mask;
+	}
+}
+
+void EntityState::setPos(const Vector3& p, const QuantizationConfig& q)
+{
+	pos[0] = quantize(p.x, q.worldMin, q.worldMax, q.posBits);
+	pos[1] = quantize(p.y, q.worldMin, q.worldMax, q.posBits);
+	pos[2] = quantize(p.z, q.worldMin, q.worldMax, q.posBits);
+}
+
+void EntityState::setRot(const Vector3& r, const QuantizationConfig& q)
+{
+	rot[0] = quantize(wrapAngle(r.x), 0.0f, 360.0f, q.rotBits);
+	rot[1] = quantize(wrapAngle(r.y), 0.0f, 360.0f, q.rotBits);
+	rot[2] = quantize(wrapAngle(r.z), 0.0f, 360.0f, q.rotBits);
+}
+
+void EntityState::setVel(const Vector3& v, const QuantizationConfig& q)
+{
+	hasVel = true;
+	vel[0] = quantize(v.x, -q.velMax, q.velMax, q.velBits);
+	vel[1] = quantize(v.y, -q.velMax, q.velMax, q.velBits);
+	vel[2] = quantize(v.z, -q.velMax, q.velMax, q.velBits);
+}
+
+Vector3 EntityState::getPos(const QuantizationConfig& q) const
+{
+	return Vector3(dequantize(pos[0], q.worldMin, q.worldMax, q.posBits),
+		dequantize(pos[1], q.worldMin, q.worldMax, q.posBits),
+		dequantize(pos[2], q.worldMin, q.worldMax, q.posBits));
+}
+
+Vector3 EntityState::getRot(const QuantizationConfig& q) const
+{
+	return Vector3(dequantize(rot[0], 0.0f, 360.0f, q.rotBits),
+		dequantize(rot[1], 0.0f, 360.0f, q.rotBits),
+		dequantize(rot[2], 0.0f, 360.0f, q.rotBits));
+}
+
+Vector3 EntityState::getVel(const QuantizationConfig& q) const
+{
+	return Vector3(dequantize(vel[0], -q.velMax, q.velMax, q.velBits),
+		dequantize(vel[1], -q.velMax, q.velMax, q.velBits),
+		dequantize(vel[2], -q.velMax, q.velMax, q.velBits));
+}
+
+const EntityState* Snapshot::find(uint32_t netId) const
+{
+	auto it = std::lower_bound(entities.begin(), entities.end(), netId,
+		[](const std::pair<uint32_t, EntityState>& e, uint32_t id) { return e.first < id; });
+	return it != entities.end() && it->first == netId ? &it->second : nullptr;
+}
+
+void writeSnapshot(BitWriter& w, const Snapshot& snap, const Snapshot* base, const QuantizationConfig& q)
+{
+	// Actualizaciones: ids ordenados, se manda la diferencia con el anterior
+	std::vector<std::pair<const std::pair<uint32_t, EntityState>*, uint32_t>> updates;
+	for (const auto& e : snap.entities) {
+		const EntityState* b = base ? base->find(e.first) : nullptr;
+		uint32_t mask = changedFields(e.second, b);
+		if (mask) updates.push_back({ &e, mask });
+	}
+
+	w.writeVarint((uint32_t)updates.size());
+	uint32_t prevId = 0;
+	for (const auto& u : updates) {
+		const uint32_t id = u.first->first;
+		const EntityState& s = u.first->second;
+		const EntityState* b = base ? base->find(id) : nullptr;
+
+		w.writeVarint(id - prevId);
+		prevId = id;
+		w.writeBits(u.second, FieldCount);
+		if (u.second & FieldPos) writeVec(w, s.pos, b ? b->pos : nullptr, q.posBits, q.deltaBits);
+		if (u.second & FieldRot) writeVec(w, s.rot, b ? b->rot : nullptr, q.rotBits, q.deltaBits);
+		if (u.second & FieldVel) {
+			w.writeBool(s.hasVel);
+			if (s.hasVel) writeVec(w, s.vel, b && b->hasVel ? b->vel : nullptr, q.velBits, q.deltaBits);
+		}
+		if (u.second & FieldLua) {
+			w.writeBits(s.luaCount, 3);
+			for (int i = 0; i < s.luaCount; i++) w.writeFloat(s.lua[i]);
+		}
+	}
+
+	// Las que estaban en la base y ya no (destruidas o fuera de interes)
+	std::vector<uint32_t> removed;
+	if (base) {
+		for (const auto& e : base->entities)
+			if (!snap.find(e.first)) removed.push_back(e.first);
+	}
+	w.writeVarint((uint32_t)removed.size());
+	prevId = 0;
+	for (uint32_t id : removed) {
+		w.writeVarint(id - prevId);
+		prevId = id;
+	}
+}
+
+bool readSnapshot(BitReader& r, Snapshot& out, const Snapshot* base, const QuantizationConfig& q)
+{
+	out.entities = base ? base->entities : std::vector<std::pair<uint32_t, EntityState>>();
+
+	uint32_t count = r.readVarint();
+	uint32_t prevId = 0;
+	std::vector<std::pair<uint32_t, EntityState>> updates;
+	updates.reserve(count);
+	for (uint32_t n = 0; n < count && !r.overflow(); n++) {
+		uint32_t id = prevId + r.readVarint();
+		prevId = id;
+		const EntityState* b = base ? base->find(id) : nullptr;
+		EntityState s = b ? *b : EntityState();
+
+		uint32_t mask = r.readBits(FieldCount);
+		if (mask & FieldPos) readVec(r, s.pos, b ? b->pos : nullptr, q.posBits, q.deltaBits);
+		if (mask & FieldRot) readVec(r, s.rot, b ? b->rot : nullptr, q.rotBits, q.deltaBits);
+		if (mask & FieldVel) {
+			s.hasVel = r.readBool();
+			if (s.hasVel) readVec(r, s.vel, b && b->hasVel ? b->vel : nullptr, q.velBits, q.deltaBits);
+		}
+		if (mask & FieldLua) {
+			s.luaCount = (uint8_t)std::min<uint32_t>(r.readBits(3), EntityState::MAX_LUA_FIELDS);
+			for (int i = 0; i < s.luaCount; i++) s.lua[i] = r.readFloat();
+		}
+		updates.push_back({ id, s });
+	}
+
+	uint32_t removedCount = r.readVarint();
+	std::vector<uint32_t> removed;
+	prevId = 0;
+	for (uint32_t n = 0; n < removedCount && !r.overflow(); n++) {
+		prevId += r.readVarint();
+		removed.push_back(prevId);
+	}
+	if (r.overflow()) return false;
+
+	// Se mezclan base, actualizaciones y borrados manteniendo el orden por id
+	for (const auto& u : updates) {
+		auto it = std::lower_bound(out.entities.begin(), out.entities.end(), u.first,
+			[](const std::pair<uint32_t, EntityState>& e, uint32_t id) { return e.first < id; });
+		if (it != out.entities.end() && it->first == u.first) it->second = u.second;
+		else out.entities.insert(it, u);
+	}
+	if (!removed.empty()) {
+		out.entities.erase(std::remove_if(out.entities.begin(), out.entities.end(),
+			[&removed](const std::pair<uint32_t, EntityState>& e) {
+				return std::binary_search(removed.begin(), removed.end(), e.first);
+			}), out.entities.end());
+	}
+	return true;
+}
@@ -0,0 +1,179 @@
+#include "Transport.h"
+#include <iostream>
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+typedef int socklen_t;
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	// Los snapshots grandes pasan del MTU y se fragmentan a nivel IP
+	const size_t MAX_DATAGRAM = 65507;
+
+	uint64_t packAddr(const sockaddr_in& a) {
+		return ((uint64_t)ntohl(a.sin_addr.s_addr) << 16) | ntohs(a.sin_port);
+	}
+
+	sockaddr_in unpackAddr(uint64_t packed) {
+		sockaddr_in a = {};
+		a.sin_family = AF_INET;
+		a.sin_addr.s_addr = htonl((uint32_t)(packed >> 16));
+		a.sin_port = htons((uint16_t)(packed & 0xffff));
+		return a;
+	}
+}
+
+UdpTransport::UdpTransport()
+{
+#ifdef _WIN32
+	WSADATA wsa;
+	WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+}
+
+UdpTransport::~UdpTransport()
+{
+	close();
+#ifdef _WIN32
+	WSACleanup();
+#endif
+}
+
+bool UdpTransport::open(uint16_t port)
+{
+	close();
+	socket_ = (intptr_t)::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (socket_ < 0) {
+		std::cout << "ERROR: no se pudo crear el socket UDP\n";
+		return false;
+	}
+
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(port);
+	if (::bind(socket_, (sockaddr*)&addr, sizeof(addr)) != 0) {
+		std::cout << "ERROR: no se pudo abrir el puerto UDP " << port << "\n";
+		close();
+		return false;
+	}
+
+	// No bloqueante: el manager lee todo lo que haya cada frame
+#ifdef _WIN32
+	u_long nonBlocking = 1;
+	ioctlsocket(socket_, FIONBIO, &nonBlocking);
+#else
+	fcntl((int)socket_, F_SETFL, fcntl((int)socket_, F_GETFL, 0) | O_NONBLOCK);
+#endif
+	return true;
+}
+
+void UdpTransport::close()
+{
+	if (socket_ < 0) return;
+#ifdef _WIN32
+	closesocket(socket_);
+#else
+	::close((int)socket_);
+#endif
+	socket_ = -1;
+	peerIds_.clear();
+	peerAddrs_.clear();
+}
+
+int UdpTransport::peerFor(uint64_t addr)
+{
+	auto it = peerIds_.find(addr);
+	if (it != peerIds_.end()) return it->second;
+	int id = (int)peerAddrs_.size();
+	peerIds_[addr] = id;
+	peerAddrs_.push_back(addr);
+	return id;
+}
+
+int UdpTransport::addPeer(const std::string& host, uint16_t port)
+{
+	addrinfo hints = {};
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	addrinfo* result = nullptr;
+	if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || !result) {
+		std::cout << "ERROR: no se encuentra el host " << host << "\n";
+		return -1;
+	}
+	sockaddr_in addr = *(sockaddr_in*)result->ai_addr;
+	freeaddrinfo(result);
+	addr.sin_port = htons(port);
+	return peerFor(packAddr(addr));
+}
+
+bool UdpTransport::send(int peer, const std::vector<uint8_t>& data)
+{
+	if (socket_ < 0 || peer < 0 || peer >= (int)peerAddrs_.size()) return false;
+	sockaddr_in addr = unpackAddr(peerAddrs_[peer]);
+	return ::sendto(socket_, (const char*)data.data(), (int)data.size(), 0, (sockaddr*)&addr, sizeof(addr)) == (int)data.size();
+}
+
+bool UdpTransport::receive(Packet& out)
+{
+	if (socket_ < 0) return false;
+	recvBuffer_.resize(MAX_DATAGRAM);
+	sockaddr_in from = {};
+	socklen_t len = sizeof(from);
+	int n = ::recvfrom(socket_, (char*)recvBuffer_.data(), (int)recvBuffer_.size(), 0, (sockaddr*)&from, &len);
+	if (n <= 0) return false;
+	out.peer = peerFor(packAddr(from));
+	out.data.assign(recvBuffer_.begin(), recvBuffer_.begin() + n);
+	return true;
+}
+
+LoopbackTransport::LoopbackTransport(std::shared_ptr<Link> link, int side) : link_(link), side_(side)
+{
+}
+
+void LoopbackTransport::createPair(const LinkConditions& conditions, std::unique_ptr<LoopbackTransport>& a, std::unique_ptr<LoopbackTransport>& b)
+{
+	auto link = std::make_shared<Link>();
+	link->conditions = conditions;
+	a.reset(new LoopbackTransport(link, 0));
+	b.reset(new LoopbackTransport(link, 1));
+}
+
+// Solo hay un par, el otro extremo del enlace
+bool LoopbackTransport::send([[maybe_unused]] int peer, const std::vector<uint8_t>& data)
+{
+	Link& l = *link_;
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	if (unit(l.rng) * 100.0f < l.conditions.lossPercent) return true;	// perdido por el camino
+
+	float delayMs = l.conditions.latencyMs + (unit(l.rng) * 2.0f - 1.0f) * l.conditions.jitterMs;
+	auto deliverAt = Clock::now() + std::chrono::microseconds((long long)(std::max(0.0f, delayMs) * 1000.0f));
+
+	// Con jitter pueden llegar desordenados, como en UDP
+	auto& queue = l.queues[1 - side_];
+	auto it = std::upper_bound(queue.begin(), queue.end(), deliverAt,
+		[](const Clock::time_point& t, const InFlight& p) { return t < p.deliverAt; });
+	queue.insert(it, { deliverAt, data });
+	return true;
+}
+
+bool LoopbackTransport::receive(Packet& out)
+{
+	auto& queue = link_->queues[side_];
+	if (queue.empty() || queue.front().deliverAt > Clock::now()) return false;
+	out.peer = 0;
+	out.data = std::move(queue.front().data);
+	queue.pop_front();
+	return true;
+}
@@ -3,83 +3,30 @@
 #include <stdexcept>
 #include <iostream>
 
-#include <SDL_timer.h>
+#include <SDL_events.h>
 #include "OgreRoot.h"
+#include "OgreRenderWindow.h"
 #include "Vector3.h"
 
 //-------MANAGER/SYSTEM---------//
-#include "Managers/SceneManager.h"
-#include "Scene/Scene.h"
 #include "Graphics/OgreContext.h"
 #include "Input/InputSystem.h"
-#include "CommonManager.h"
-#include "Graphics/RenderManager.h"
-#include "Physics/PhysicsManager.h"
 #include "UIManager.h"
-#include "LUA/LUAManager.h"
-#include "LoaderSystem.h"
 #include "AudioSystem.h"
+#include "LUA/LUAManager.h"
+#include "Managers/SceneManager.h"
+#include "StartupGraph.h"
 
 //-----------COMPONENT----------//
 #include "OgrePlane.h"
 
 PapagayoEngine* PapagayoEngine::instance_ = nullptr;
 
-PapagayoEngine::PapagayoEngine(const std::string& appName) : appName_(appName) {
-
-	// OGRE CONTEXT
-	if (!OgreContext::setUpInstance(appName_)) {
-		throw std::exception("ERROR: Couldn't load OgreContext\n");
-	}
-	ogre = OgreContext::getInstance();
-
-	// INPUT SYSTEM
-	if (!InputSystem::setUpInstance()) {
-		throw std::exception("ERROR: Couldn't load InputSystem\n");
-	}
-	input = InputSystem::getInstance();
-
-	// UI MANAGER
-	if (!UIManager::setUpInstance()) {
-		throw std::exception("ERROR: Couldn't load UIManager\n");
-	}
-	gui = UIManager::getInstance();
-
-	// PHYSICS
-	if (!PhysicsManager::setUpInstance()) {
-		throw std::exception("ERROR: Couldn't load PhysicsManager\n");
-	}
-	phys = PhysicsManager::getInstance();
-
-	// RENDER
-	if (!RenderManager::setUpInstance()) {
-		throw std::exception("ERROR: Couldn't load RenderManager\n");
-	}
-	render = RenderManager::getInstance();
-
-	// SCENE MANAGER
-	if (!SceneManager::setupInstance()) {
-		throw std::exception("ERROR: Couldn't load SceneManager\n");
-	}
-	mSM = SceneManager::getInstance();
-
-	// COMMON MANAGER
-	if (!CommonManager::setUpInstance()) {
-		throw std::exception("ERROR: Couldn't load CommonManager\n");
-	}
-	common = CommonManager::getInstance();
-
-	// LUA MANAGER
-	if (!LUAManager::setUpInstance()) {
-		throw std::exception("ERROR: Couldn't load LuaManager\n");
-	}
-	lua = LUAManager::getInstance();
+PapagayoEngine::PapagayoEngine(const std::string& appName) : ogre(nullptr), appName_(appName), context_(false) {
 
-	// AUDIO
-	if (!AudioSystem::setupInstance()) {
-		throw std::exception("ERROR: Couldn't load AudioSystem\n");
-	}
-	audio = AudioSystem::getInstance();
+	// El hilo principal trabaja siempre con el contexto con ventana.
+	// Los managers se crean en init, junto al resto del arranque
+	EngineContext::bind(&context_);
 }
 
 PapagayoEngine::~PapagayoEngine()
@@ -108,102 +55,81 @@ bool PapagayoEngine::setupInstance(const std::string& appName)
 void PapagayoEngine::destroy()
 {
 	// se borran todos los managers del motor
-	// sistemas
-	input->destroy();
-	audio->destroy();
-
-	// fisicas
-	phys->destroy();
-
-	// render
-	render->destroy();
-	gui->destroy();
-	ogre->destroy();
-
-
-	// common
-	common->destroy();
-
-	// logica
-	lua->destroy();
-
-
-	// escena
-	mSM->destroy();
+	context_.destroy();
 
 	delete instance_;
 }
 
 void PapagayoEngine::clean()
 {
-	input->clean();
-	audio->clean();
-
-	// render
-	render->clean();
-	gui->clean();
-	ogre->clean();
-
-	// fisicas
-	phys->clean();
-
-	// common
-	common->clean();
-
-	// logica
-	lua->clean();
-
-	// escena
-	mSM->clean();
+	context_.clean();
 }
 
 void PapagayoEngine::init(std::string schemeName, std::string schemeFile,
 	std::string fontFile, std::string startScene, std::string music, std::string skyPlane, float iniVolume)
 {
-	try { ogre->setUpInstance("PAPAGAYO ENGINE"); }
-	catch (const std::exception& e)
-	{
-		throw std::runtime_error("OgreContext init fail \n" + (std::string)e.what() + "\n");
-	}
-
-	try { mSM->setupInstance(); }
-	catch (const std::exception& e)
-	{
-		throw std::runtime_error("SceneManager init fail \n" + (std::string)e.what() + "\n");
-	}
+	// Cada paso empieza cuando acaban aquellos de los que depende; lo de
+	// Ogre y CEGUI en este hilo, lo demas en paralelo
+	StartupGraph graph;
+	context_.addSetUpSteps(graph, appName_);
 
-	manRegistry_["Physics"] = phys;
-	manRegistry_["Common"] = common;
-	manRegistry_["Render"] = render;
-	manRegistry_["LUA"] = LUAManager::getInstance();
-	manRegistry_["UI"] = gui;
 	//Estas 3 lineas de ui deber�an cargarse en funci�n de 
 	//unos string que se reciban como parametro, de manera
 	//que sea el usuario el que decida que configuracion
 	//desea usuar.
+	graph.addStep("scheme", [schemeName, schemeFile]() {
+		try {
+			UIManager::getInstance()->loadScheme(schemeName, schemeFile);
+		}
+		catch (const std::exception& e) {
+			throw std::runtime_error("Fallo al cargar Scheme. Revise el nombre de el Scheme.\n" + (std::string)e.what() + "\n");
+		}
+	}, { "UIManager" }, true);
 
-	try {
-		gui->loadScheme(schemeName, schemeFile);
-	}
-	catch (const std::exception& e) {
-		throw std::runtime_error("Fallo al cargar Scheme. Revise el nombre de el Scheme.\n" + (std::string)e.what() + "\n");
-	}
+	graph.addStep("font", [fontFile]() {
+		try
+		{
+			UIManager::getInstance()->loadFont(fontFile);
+		}
+		catch (const std::exception& e)
+		{
+			throw std::runtime_error("Fallo al cargar Fuente. Revise el nombre de la fuente.\n" + (std::string)e.what() + "\n");
+		}
+	}, { "scheme" }, true);
+
+	//Mezclador de audio antes de la primera escena para que sus sonidos ya salgan por su bus
+	graph.addStep("buses", []() { AudioSystem::getInstance()->loadBuses(); }, { "AudioSystem" });
+
+	//El JSON de la escena se lee mientras arrancan Ogre y FMOD
+	graph.addStep("sceneParse", [startScene]() { SceneManager::getInstance()->preloadStartScene(startScene); }, { "SceneManager" });
+	graph.addStep("sceneSounds", []() { SceneManager::getInstance()->preloadStartSceneSounds(); }, { "sceneParse", "buses" });
+	//Los grupos de recursos de la escena se leen de disco en la cola de Ogre
+	graph.addStep("sceneResources", []() { SceneManager::getInstance()->prefetchStartSceneResources(); },
+		{ "sceneParse", "OgreContext" }, true);
+
+	//Los scripts de la escena se compilan antes de crear las entidades. Si
+	//alguno falla se deja para el loader, que ya avisa y pone el de por defecto
+	graph.addStep("luaScripts", []() {
+		LUAManager* lua = LUAManager::getInstance();
+		for (const std::string& script : SceneManager::getInstance()->getStartSceneLuaComponents()) {
+			if (lua->getCompID(script) != -1) continue;
+			try { lua->addRegistry(script); }
+			catch (const std::exception&) {}
+		}
+	}, { "sceneParse", "LUAManager" });
 
-	try
-	{
-		gui->loadFont(fontFile);
-	}
-	catch (const std::exception& e)
-	{
-		throw std::runtime_error("Fallo al cargar Fuente. Revise el nombre de la fuente.\n" + (std::string)e.what() + "\n");
-	}
+	graph.addStep("startScene", [this, startScene]() { context_.loadScenes(startScene); },
+		{ "managers", "font", "sceneSounds", "sceneResources", "luaScripts" }, true);
 
-	mSM->createStartScene(startScene);
+	graph.run(&context_);
+	graph.printReport();
+
+	ogre = OgreContext::getInstance();
+	AudioSystem* audio = context_.audio;
 
 	try
 	{
-		audio->loadSound(music, true, true);
-		audio->playSound(music, { 0,0,0 }, nullptr, iniVolume);
+		audio->playMusic(music, iniVolume);
 	}
 	catch (const std::exception& e)
 	{
@@ -225,9 +151,7 @@ void PapagayoEngine::init(std::string schemeName, std::string schemeFile,
 
 void PapagayoEngine::start()
 {
-	render->start();
-	phys->start();
-	lua->start();
+	context_.start();
 }
 
 void PapagayoEngine::update(float delta)
@@ -236,20 +160,19 @@ void PapagayoEngine::update(float delta)
 		SDL_Event event;
 		bool run = true;
 		while (SDL_PollEvent(&event) && run) {
-			run = input->handleInput(event);
-			gui->captureInput(event);
+			if (event.type == SDL_WINDOWEVENT)
+				handleWindowEvent(event.window);
+			run = context_.input->handleInput(event);
+			context_.gui->captureInput(event);
 		}
 
 		//Basicamente no va a actualizar nada mas
 		//y se cerraria el programa
 		if (!run) {
-			running_ = run;
+			context_.close();
 		}
 		else {
-			lua->update(delta);
-			phys->update(delta);
-			render->update(delta);
-			mSM->update();
+			context_.step(delta);
 		}
 	}
 	catch (const std::exception& e)
@@ -262,64 +185,64 @@ void PapagayoEngine::update(float delta)
 
 }
 
-void PapagayoEngine::fixedUpdate(float delta) {
-	try {
-		lua->fixedUpdate(delta);
-		phys->fixedUpdate(delta);
-	}
-	catch (const std::exception& e)
-	{
-		throw std::runtime_error("Fallo en el fixedUpdate:\n" + (std::string)e.what() + "\n");
-	}
-	catch (...) {
-		throw "Excepcion no controlada en fixedUpdate\n";
-	}
-}
-
 void PapagayoEngine::run() {
-	//running_ = false;
 	// ciclo principal de juego
-	startTime = SDL_GetTicks();
-	float deltaSum = 0;
-	float deltaTime = 0;
-	while (running_) {
-
-		//RETARDO DE FPS
-		//auto current = SDL_GetTicks();
-		//auto elapsed = current - startTime;
-		//startTime = current;
-		//lag += elapsed;
-
-		//while (lag >= frame_rate) {
-		//	lag -= frame_rate;
-		//}
-
-		deltaSum += deltaTime;
+	pacer_.setVSync(ogre->getRenderWindow()->isVSyncEnabled());
+	pacer_.reset();
+	while (context_.isRunning()) {
+		float deltaTime = pacer_.beginFrame();
 
+		// update y fixedUpdate del contexto
 		update(deltaTime);
 
-		if (deltaSum > sToCallFixedUpdate) {
-			fixedUpdate(deltaTime);
-			deltaSum = 0;
-		}
+		// Espera lo que falte del frame en vez de girar en vacio
+		pacer_.endFrame();
+	}
+}
 
-		deltaTime = SDL_GetTicks() - startTime;
-		deltaTime /= 1000;
-		startTime = SDL_GetTicks();
+void PapagayoEngine::handleWindowEvent(const SDL_WindowEvent& e)
+{
+	switch (e.event)
+	{
+	case SDL_WINDOWEVENT_FOCUS_GAINED:
+		pacer_.setFocused(true);
+		break;
+	case SDL_WINDOWEVENT_FOCUS_LOST:
+		pacer_.setFocused(false);
+		break;
+	case SDL_WINDOWEVENT_MINIMIZED:
+		pacer_.setMinimized(true);
+		break;
+	case SDL_WINDOWEVENT_RESTORED:
+	case SDL_WINDOWEVENT_MAXIMIZED:
+		pacer_.setMinimized(false);
+		break;
+	default:
+		break;
 	}
 }
 
+FramePacer* PapagayoEngine::getFramePacer()
+{
+	return &pacer_;
+}
+
 void PapagayoEngine::closeApp()
 {
-	running_ = false;
+	context_.close();
 }
 
 const std::map<std::string, Manager*>& PapagayoEngine::getManagers()
 {
-	return manRegistry_;
+	return context_.getManagers();
 }
 
 const std::map<std::string, Manager*>& PapagayoEngine::getManagers() const
 {
-	return manRegistry_;
+	return context_.getManagers();
+}
+
+EngineContext* PapagayoEngine::getContext()
+{
+	return &context_;
 }
\ No newline at end of file
@@ -20,6 +20,14 @@ void CollisionObject::onCollisionStay(Entity* other)
 {
 }
 
+void CollisionObject::onTriggerEnter(Entity* other)
+{
+}
+
+void CollisionObject::onTriggerExit(Entity* other)
+{
+}
+
 void CollisionObject::setEntity(Entity* ent)
 {
 	coll_ent_ = ent;
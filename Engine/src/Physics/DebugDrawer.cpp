@@ -1,20 +1,5 @@
 #include "DebugDrawer.h"
-
-inline btVector3 convertVector(const Ogre::Vector3& V) {
-    return btVector3(V.x, V.y, V.z);
-}
-
-inline Ogre::Vector3 cvt(const btVector3& V) {
-    return Ogre::Vector3(V.x(), V.y(), V.z());
-}
-
-inline btQuaternion convertVector(const Ogre::Quaternion& Q) {
-    return { Q.x, Q.y, Q.z, Q.w };
-};
-
-inline Ogre::Quaternion convertVector(const btQuaternion& Q) {
-    return Ogre::Quaternion(Q.w(), Q.x(), Q.y(), Q.z());
-};
+#include "MathConversions.h"
 
 bool OgreDebugDrawer::frameStarted(const Ogre::FrameEvent& evt)
 {
@@ -99,9 +84,9 @@ void OgreDebugDrawer::drawLine(const btVector3& from, const btVector3& to, const
 {
     Ogre::ColourValue c(color.getX(), color.getY(), color.getZ());
     c.saturate();
-    mLines_->position(cvt(from));
+    mLines_->position(toOgre(from));
     mLines_->colour(c);
-    mLines_->position(cvt(to));
+    mLines_->position(toOgre(to));
     mLines_->colour(c);
 }
 
@@ -109,11 +94,11 @@ void OgreDebugDrawer::drawTriangle(const btVector3& v0, const btVector3& v1, con
 {
     Ogre::ColourValue c(color.getX(), color.getY(), color.getZ(), alpha);
     c.saturate();
-    mTriangles_->position(cvt(v0));
+    mTriangles_->position(toOgre(v0));
     mTriangles_->colour(c);
-    mTriangles_->position(cvt(v1));
+    mTriangles_->position(toOgre(v1));
     mTriangles_->colour(c);
-    mTriangles_->position(cvt(v2));
+    mTriangles_->position(toOgre(v2));
     mTriangles_->colour(c);
 }
 
@@ -121,8 +106,8 @@ void OgreDebugDrawer::drawContactPoint(const btVector3& PointOnB, const btVector
 {
     mContactPoints_->resize(mContactPoints_->size() + 1);
     auto& p = *(mContactPoints_->end() - 1);
-    p.from = cvt(PointOnB);
-    p.to = p.from + cvt(normalOnB) * distance;
+    p.from = toOgre(PointOnB);
+    p.to = p.from + toOgre(normalOnB) * distance;
     p.dieTime = Ogre::Root::getSingleton().getTimer()->getMilliseconds() + lifeTime;
     p.color.r = color.x();
     p.color.g = color.y();
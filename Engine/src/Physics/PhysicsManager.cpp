@@ -1,25 +1,53 @@
 #include "PhysicsManager.h"
+#include "EngineContext.h"
 #include "Vector3.h"
 #include <btBulletCollisionCommon.h>
 #include <btBulletDynamicsCommon.h>
+#include <LinearMath/btPoolAllocator.h>
+#include <BulletCollision/CollisionDispatch/btGhostObject.h>
 #include "DebugDrawer.h"
 #include "Rigidbody.h"
+#include "TriggerComponent.h"
 #include "Entity.h"
 #include "OgreContext.h"
 #include "CollisionObject.h"
+#include "PhysicsMemory.h"
+#include <algorithm>
+#include <iostream>
 
-PhysicsManager* PhysicsManager::instance_ = nullptr;
+static_assert((int)PhysicsManager::PhysicsCmpId::LastPhysicsCmpId == NATIVE_COMPONENTS[(int)ManID::Physics], "Update NATIVE_COMPONENTS in ComponentTypes.h");
+
+namespace {
+	// Los pares con un trigger se quedan en el broadphase: sin algoritmo de
+	// colision ni manifold, la lista del ghost es lo unico que se usa
+	class TriggerDispatcher : public btCollisionDispatcher
+	{
+	public:
+		TriggerDispatcher(btCollisionConfiguration* config) : btCollisionDispatcher(config) {}
+
+		virtual bool needsCollision(const btCollisionObject* body0, const btCollisionObject* body1) override
+		{
+			if (body0->getInternalType() == btCollisionObject::CO_GHOST_OBJECT ||
+				body1->getInternalType() == btCollisionObject::CO_GHOST_OBJECT)
+				return false;
+			return btCollisionDispatcher::needsCollision(body0, body1);
+		}
+	};
+}
 
 PhysicsManager* PhysicsManager::getInstance()
 {
-	return instance_;
+	return EngineContext::current()->phys;
 }
 
 bool PhysicsManager::setUpInstance() {
-	if (instance_ == nullptr) {
+	EngineContext* ctx = EngineContext::current();
+	if (!ctx->phys) {
 		try {
-			instance_ = new PhysicsManager();
-			instance_->init(Vector3(0.0, -9.8, 0.0));
+			// Antes de que Bullet reserve nada
+			PhysicsMemory::install();
+			ctx->phys = new PhysicsManager();
+			ctx->phys->init(Vector3(0.0, -9.8, 0.0));
 		}
 		catch (...) {
 			return false;
@@ -30,7 +58,8 @@ bool PhysicsManager::setUpInstance() {
 }
 
 PhysicsManager::PhysicsManager() : Manager(ManID::Physics) {
-	registerComponent("RigidBody", 0, []() -> RigidBody* { return new RigidBody(); });
+	registerComponent("RigidBody", (int)PhysicsCmpId::RigigbodyId, []() -> RigidBody* { return new RigidBody(); });
+	registerComponent("Trigger", (int)PhysicsCmpId::TriggerId, []() -> TriggerComponent* { return new TriggerComponent(); });
 
 };
 
@@ -107,11 +136,19 @@ void PhysicsManager::checkCollision()
 
 void PhysicsManager::init(const Vector3 gravity) {
 
-	collConfig = new btDefaultCollisionConfiguration();
+	// Pools de manifolds y algoritmos del tamanyo que hizo falta en ejecuciones anteriores
+	PhysicsMemory* mem = PhysicsMemory::getInstance();
+	mem->beginContext();
+	btDefaultCollisionConstructionInfo info;
+	info.m_defaultMaxPersistentManifoldPoolSize = mem->getManifoldPoolSize();
+	info.m_defaultMaxCollisionAlgorithmPoolSize = mem->getAlgorithmPoolSize();
+	collConfig = new btDefaultCollisionConfiguration(info);
 
-	collDispatcher = new btCollisionDispatcher(collConfig);
+	collDispatcher = new TriggerDispatcher(collConfig);
 
 	broadPhaseInterface = new btDbvtBroadphase();
+	ghostPairCallback = new btGhostPairCallback();
+	broadPhaseInterface->getOverlappingPairCache()->setInternalGhostPairCallback(ghostPairCallback);
 	constraintSolver = new btSequentialImpulseConstraintSolver();
 
 	dynamicsWorld = new btDiscreteDynamicsWorld(collDispatcher, broadPhaseInterface,
@@ -120,6 +157,8 @@ void PhysicsManager::init(const Vector3 gravity) {
 	dynamicsWorld->setGravity(btVector3(gravity.x, gravity.y, gravity.z));
 
 #ifdef _DEBUG
+	// Las simulaciones sin ventana no tienen donde pintar
+	if (EngineContext::current()->isHeadless()) return;
 	mDebugDrawer_ = new OgreDebugDrawer(OgreContext::getInstance()->getSceneManager());
 	mDebugDrawer_->setDebugMode(btIDebugDraw::DBG_DrawWireframe);
 	dynamicsWorld->setDebugDrawer(mDebugDrawer_);
@@ -134,11 +173,17 @@ void PhysicsManager::destroyWorld()
 
 	delete broadPhaseInterface; broadPhaseInterface = nullptr;
 
+	delete ghostPairCallback; ghostPairCallback = nullptr;
+
 	delete constraintSolver; constraintSolver = nullptr;
 
 	delete mDebugDrawer_; mDebugDrawer_ = nullptr;
 
 	delete dynamicsWorld; dynamicsWorld = nullptr;
+
+	// Lo usado en este mundo, junto con el de los demas, dimensiona los pools
+	// de la siguiente ejecucion
+	PhysicsMemory::getInstance()->endContext(memStats_);
 }
 
 void PhysicsManager::destroyRigidBody(btRigidBody* body)
@@ -147,6 +192,8 @@ void PhysicsManager::destroyRigidBody(btRigidBody* body)
 	if (it != contacts.end()) {
 		contacts.erase(it);
 	}
+	for (TriggerComponent* t : triggers_)
+		t->forget(body);
 	dynamicsWorld->removeCollisionObject(body);
 	delete body->getCollisionShape();
 	delete body->getMotionState();
@@ -159,6 +206,11 @@ btDiscreteDynamicsWorld* PhysicsManager::getWorld() const
 	return dynamicsWorld;
 }
 
+PhysicsMemory::Stats& PhysicsManager::getMemoryStats()
+{
+	return memStats_;
+}
+
 btRigidBody* PhysicsManager::createRB(Vector3 pos, float mass, int group, int mask)
 {
 	btTransform transform;
@@ -175,6 +227,98 @@ btRigidBody* PhysicsManager::createRB(Vector3 pos, float mass, int group, int ma
 	return rb;
 }
 
+btCollisionShape* PhysicsManager::createShape(const nlohmann::json& shape)
+{
+	if (!shape.is_object())
+		return nullptr;
+	auto it = shape.find("id");
+	if (it == shape.end() || !it->is_string())
+		return nullptr;
+
+	std::string shapeName = it->get<std::string>();
+	btCollisionShape* shapeColl = nullptr;
+	if (shapeName == "Box") {
+		auto size = shape.find("size");
+		if (size != shape.end()) {
+			std::vector<float> s = size->get<std::vector<float>>();
+			shapeColl = new btBoxShape(btVector3(s[0], s[1], s[2]));
+		}
+		else {
+			shapeColl = new btBoxShape(btVector3(1.0f, 1.0f, 1.0f));
+		}
+	}
+	else if (shapeName == "Sphere") {
+		auto radius = shape.find("radius");
+		if (radius != shape.end()) {
+			float r = radius->get<float>();
+			shapeColl = new btSphereShape(r);
+		}
+		else {
+			shapeColl = new btSphereShape(1.0f);
+		}
+	}
+	else if (shapeName == "Cylinder") {
+		auto size = shape.find("size");
+		if (size != shape.end()) {
+			std::vector<float> s = size->get<std::vector<float>>();
+			shapeColl = new btCylinderShape(btVector3(s[0], s[1], s[2]));
+		}
+		else {
+			shapeColl = new btCylinderShape(btVector3(1.0f, 1.0f, 1.0f));
+		}
+	}
+	else if (shapeName == "Cone") {
+		auto radius = shape.find("radius");
+		auto height = shape.find("height");
+
+		if (radius != shape.end() && height != shape.end()) {
+			float r = radius->get<float>();
+			float h = height->get<float>();
+			shapeColl = new btConeShape(r, h);
+		}
+		else {
+			shapeColl = new btConeShape(1.0f, 1.0f);
+		}
+	}
+	else if (shapeName == "Capsule") {
+		auto radius = shape.find("radius");
+		auto height = shape.find("height");
+		if (radius != shape.end() && height != shape.end()) {
+			float r = radius->get<float>();
+			float h = height->get<float>();
+			shapeColl = new btCapsuleShape(r, h);
+		}
+		else {
+			shapeColl = new btCapsuleShape(1.0f, 1.0f);
+		}
+	}
+	else {
+		std::cout << "WARNING: Unknown collision shape " << shapeName << "\n";
+	}
+	return shapeColl;
+}
+
+void PhysicsManager::addTrigger(TriggerComponent* trigger)
+{
+	if (std::find(triggers_.begin(), triggers_.end(), trigger) == triggers_.end())
+		triggers_.push_back(trigger);
+}
+
+void PhysicsManager::removeTrigger(TriggerComponent* trigger)
+{
+	triggers_.erase(std::remove(triggers_.begin(), triggers_.end(), trigger), triggers_.end());
+}
+
+void PhysicsManager::checkTriggers()
+{
+	// Primero todos los solapes y luego los avisos, que pueden tocar otros triggers
+	for (TriggerComponent* t : triggers_)
+		if (t->isActive())
+			t->refreshOverlaps();
+	for (size_t i = 0; i < triggers_.size(); i++)
+		triggers_[i]->dispatchEvents();
+}
+
 void PhysicsManager::addComponent(Entity* ent, int compId)
 {
 
@@ -182,21 +326,35 @@ void PhysicsManager::addComponent(Entity* ent, int compId)
 
 void PhysicsManager::start()
 {
-	for (Component* cmp : _compsList)
-	{
-		cmp->setUp();
-	}
+	for (size_t i = 0; i < _compsList.size(); ++i)
+		_compsList[i]->setUp();
+}
+
+void PhysicsManager::stepWorld(float deltaTime)
+{
+	// Los triggers siguen a su transform
+	for (TriggerComponent* t : triggers_)
+		if (t->isActive())
+			t->syncTransform();
+
+	PhysicsMemory* mem = PhysicsMemory::getInstance();
+	mem->beginStep();
+	dynamicsWorld->stepSimulation(deltaTime, 10);
+	mem->endStep();
+
+	// Los manifolds que no caben en el pool tambien cuentan, el de algoritmos satura
+	mem->recordCollisionPools(collDispatcher->getNumManifolds(),
+		collConfig->getCollisionAlgorithmPool()->getUsedCount());
 }
 
 void PhysicsManager::update(float deltaTime)
 {
-	dynamicsWorld->stepSimulation(1.f / 60.f, 10);
+	stepWorld(1.f / 60.f);
 
 	checkCollision();
+	checkTriggers();
 
-	for (auto it = _compsList.begin(); it != _compsList.end(); ++it) {
-		(*it)->update(deltaTime);
-	}
+	forEachActive([deltaTime](Component* cmp) { cmp->update(deltaTime); });
 
 #ifdef _DEBUG
 	dynamicsWorld->debugDrawWorld();
@@ -206,46 +364,47 @@ void PhysicsManager::update(float deltaTime)
 
 void PhysicsManager::fixedUpdate(float deltaTime)
 {
-	dynamicsWorld->stepSimulation(deltaTime, 10);
+	stepWorld(deltaTime);
 
 	checkCollision();
+	checkTriggers();
 }
 
 void PhysicsManager::clean()
 {
-	instance_->destroyAllComponents();
+	getInstance()->destroyAllComponents();
 }
 
 void PhysicsManager::destroy()
 {
-	instance_->clean();
-	instance_->destroyWorld();
-	delete instance_;
+	PhysicsManager* phys = getInstance();
+	phys->clean();
+	phys->destroyWorld();
+	delete phys;
+	EngineContext::current()->phys = nullptr;
 }
 
 void PhysicsManager::destroyAllComponents()
 {
 	while (!_compsList.empty()) {
-		auto i = _compsList.begin();
-		destroyRigidBody(static_cast<RigidBody*>((*i))->getBtRb());
-		delete* i;
-		_compsList.erase(i);
+		Component* c = _compsList.back();
+		removeFromList(c);
+		if (c->getId() == (int)PhysicsCmpId::RigigbodyId)
+			destroyRigidBody(static_cast<RigidBody*>(c)->getBtRb());
+		delete c;
 	}
 }
 
 bool PhysicsManager::destroyComponent(Entity* ent, int compId)
 {
-	auto i = _compsList.begin();
-	while (i != _compsList.end()) {
-		if (ent == (*i)->getEntity()) {
-			destroyRigidBody(static_cast<RigidBody*>((*i))->getBtRb());
-			delete* i;
-			_compsList.erase(i);
+	for (Component* c : _compsList) {
+		if (ent == c->getEntity() && c->getId() == compId) {
+			removeFromList(c);
+			if (compId == (int)PhysicsCmpId::RigigbodyId)
+				destroyRigidBody(static_cast<RigidBody*>(c)->getBtRb());
+			delete c;
 			return true;
 		}
-		else {
-			++i;
-		}
 	}
 
 	return false;
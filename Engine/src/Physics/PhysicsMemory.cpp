@@ -0,0 +1,434 @@
+#include "PhysicsMemory.h"
+#include "PhysicsManager.h"
+#include "EngineContext.h"
+#include "LinearMath/btAlignedAllocator.h"
+
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+
+const size_t PhysicsMemory::BLOCK_SIZES[NUM_CLASSES] = { 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+const std::string PhysicsMemory::POOLS_FILE_PATH = "Resources/physicsPools.json";
+
+namespace {
+	// Los de Bullet por defecto
+	const int DEFAULT_POOL_SIZE = 4096;
+	const int MIN_POOL_SIZE = 256;
+	// Bloques que se anaden como minimo cuando el pool se queda corto
+	const int MIN_GROWTH = 16;
+	// Bloques que una cache coge del pool de una vez, y los que puede tener
+	// antes de devolver la mitad
+	const size_t REFILL_BLOCKS = 32;
+	const size_t MAX_CACHED = 2 * REFILL_BLOCKS;
+
+	// Pasos en curso en este hilo
+	thread_local int stepDepth = 0;
+	// Trivial, se puede leer aun despues de destruirse la cache del hilo
+	thread_local bool cacheGone = false;
+
+	// Pico con margen, sin bajar de golpe de lo que se uso la vez anterior
+	int tune(int peak, int previous, int minimum)
+	{
+		return std::max({ peak + peak / 4, previous / 2, minimum });
+	}
+
+	void mergeInto(PhysicsMemory::Stats& to, const PhysicsMemory::Stats& from)
+	{
+		to.peakBytes = std::max(to.peakBytes, from.peakBytes);
+		for (int c = 0; c < PhysicsMemory::NUM_CLASSES; c++)
+			to.peakBlocks[c] = std::max(to.peakBlocks[c], from.peakBlocks[c]);
+		to.largeAllocs += from.largeAllocs;
+		to.stepHeapHits += from.stepHeapHits;
+		to.peakManifolds = std::max(to.peakManifolds, from.peakManifolds);
+		to.peakAlgorithms = std::max(to.peakAlgorithms, from.peakAlgorithms);
+	}
+}
+
+PhysicsMemory::PhysicsMemory()
+{
+	poolStats_.manifoldPool = DEFAULT_POOL_SIZE;
+	poolStats_.algorithmPool = DEFAULT_POOL_SIZE;
+
+	std::fstream i(POOLS_FILE_PATH);
+	if (!i.is_open())
+		return;
+
+	nlohmann::json config;
+	try {
+		i >> config;
+		loadConfig(config);
+	}
+	catch (const std::exception& e) {
+		std::cout << "WARNING: couldn't read " << POOLS_FILE_PATH << "\n" << e.what() << "\n";
+	}
+}
+
+PhysicsMemory* PhysicsMemory::getInstance()
+{
+	// No se destruye nunca: Bullet puede liberar memoria durante la salida
+	static PhysicsMemory* instance = new PhysicsMemory();
+	return instance;
+}
+
+void PhysicsMemory::install()
+{
+	static std::once_flag once;
+	std::call_once(once, []() {
+		getInstance();
+		btAlignedAllocSetCustom(&PhysicsMemory::allocate, &PhysicsMemory::deallocate);
+	});
+}
+
+#pragma region Configuracion
+
+void PhysicsMemory::loadConfig(const nlohmann::json& config)
+{
+	if (!config.is_object())
+		throw std::exception("ERROR: Physics pools config must be an object\n");
+
+	auto it = config.find("autoTune");
+	if (it != config.end()) {
+		if (!it->is_boolean())
+			throw std::exception("ERROR: Physics pools autoTune must be a boolean\n");
+		autoTune_ = it->get<bool>();
+	}
+
+	const char* pools[2] = { "manifoldPool", "algorithmPool" };
+	int* sizes[2] = { &poolStats_.manifoldPool, &poolStats_.algorithmPool };
+	for (int p = 0; p < 2; p++) {
+		it = config.find(pools[p]);
+		if (it == config.end()) continue;
+		if (!it->is_number_integer() || it->get<int>() <= 0)
+			throw std::runtime_error("ERROR: Physics pool " + std::string(pools[p]) + " must be a positive integer\n");
+		*sizes[p] = it->get<int>();
+	}
+
+	it = config.find("blocks");
+	if (it == config.end())
+		return;
+	if (!it->is_object())
+		throw std::exception("ERROR: Physics pools blocks must be an object\n");
+	for (auto b = it->begin(); b != it->end(); ++b) {
+		int c = -1;
+		for (int k = 0; k < NUM_CLASSES; k++)
+			if (b.key() == std::to_string(BLOCK_SIZES[k]))
+				c = k;
+		if (c < 0 || !b->is_number_integer() || b->get<int>() < 0)
+			throw std::runtime_error("ERROR: Physics pools block " + b.key() + " is not a block size with a block count\n");
+		loadedBlocks_[c] = b->get<int>();
+		reserve(BLOCK_SIZES[c], loadedBlocks_[c]);
+	}
+}
+
+nlohmann::json PhysicsMemory::tunedConfig() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	Stats peaks = merged_;
+	mergeInto(peaks, orphan_);
+	// Cada mundo tiene sus propios pools de colision: basta el mayor pico.
+	// Los bloques se comparten, hacen falta para todos los que iban a la vez
+	int contexts = std::max(1, poolStats_.peakContexts);
+
+	nlohmann::json config;
+	config["autoTune"] = autoTune_;
+	config["manifoldPool"] = tune(peaks.peakManifolds, poolStats_.manifoldPool, MIN_POOL_SIZE);
+	config["algorithmPool"] = tune(peaks.peakAlgorithms, poolStats_.algorithmPool, MIN_POOL_SIZE);
+
+	nlohmann::json blocks = nlohmann::json::object();
+	for (int c = 0; c < NUM_CLASSES; c++) {
+		int n = tune(peaks.peakBlocks[c] * contexts, loadedBlocks_[c], 0);
+		if (n > 0)
+			blocks[std::to_string(BLOCK_SIZES[c])] = n;
+	}
+	config["blocks"] = blocks;
+	return config;
+}
+
+void PhysicsMemory::beginContext()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	liveContexts_++;
+	poolStats_.peakContexts = std::max(poolStats_.peakContexts, liveContexts_);
+}
+
+void PhysicsMemory::endContext(const Stats& stats)
+{
+	nlohmann::json config;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		mergeInto(merged_, stats);
+		if (liveContexts_ > 0) liveContexts_--;
+		if (liveContexts_ > 0 || !autoTune_)
+			return;
+	}
+	config = tunedConfig();
+
+	// Solo lo escribe el ultimo, pero puede abrirse otro mundo entretanto
+	static std::mutex fileMutex;
+	std::lock_guard<std::mutex> lock(fileMutex);
+	std::ofstream o(POOLS_FILE_PATH);
+	if (!o.is_open()) {
+		std::cout << "WARNING: couldn't write " << POOLS_FILE_PATH << "\n";
+		return;
+	}
+	o << config.dump(1, '\t');
+}
+
+int PhysicsMemory::getManifoldPoolSize() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return poolStats_.manifoldPool;
+}
+
+int PhysicsMemory::getAlgorithmPoolSize() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return poolStats_.algorithmPool;
+}
+
+#pragma endregion
+
+#pragma region Allocator
+
+PhysicsMemory::ThreadCache::ThreadCache()
+{
+	// Devolver un bloque nunca reserva
+	for (auto& blocks : free)
+		blocks.reserve(MAX_CACHED + 1);
+}
+
+PhysicsMemory::ThreadCache::~ThreadCache()
+{
+	cacheGone = true;
+	PhysicsMemory* mem = getInstance();
+	for (int c = 0; c < NUM_CLASSES; c++)
+		mem->drain(c, free[c], 0);
+}
+
+PhysicsMemory::ThreadCache* PhysicsMemory::threadCache()
+{
+	if (cacheGone)
+		return nullptr;
+	thread_local ThreadCache cache;
+	return &cache;
+}
+
+PhysicsMemory::Stats* PhysicsMemory::contextStats()
+{
+	EngineContext* ctx = EngineContext::current();
+	return ctx != nullptr && ctx->phys != nullptr ? &ctx->phys->getMemoryStats() : nullptr;
+}
+
+int PhysicsMemory::sizeClass(size_t size)
+{
+	for (int c = 0; c < NUM_CLASSES; c++)
+		if (size <= BLOCK_SIZES[c])
+			return c;
+	return -1;
+}
+
+void PhysicsMemory::grow(int c, int count)
+{
+	Pool& pool = pools_[c];
+	char* chunk = static_cast<char*>(std::malloc(count * BLOCK_SIZES[c]));
+	if (chunk == nullptr)
+		throw std::bad_alloc();
+	pool.chunks.push_back(chunk);
+
+	poolStats_.capacity[c] += count;
+	poolStats_.reservedBytes += count * BLOCK_SIZES[c];
+	pool.free.reserve(poolStats_.capacity[c]);
+	for (int i = count - 1; i >= 0; i--)
+		pool.free.push_back(chunk + i * BLOCK_SIZES[c]);
+}
+
+void PhysicsMemory::refill(int c, std::vector<void*>& cache, Stats* stats)
+{
+	bool heapHit = false;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		Pool& pool = pools_[c];
+		if (pool.free.empty()) {
+			poolStats_.poolGrowths++;
+			heapHit = true;
+			// Crece a la mitad de lo que ya tiene, como minimo lo que se va a coger
+			grow(c, std::max({ MIN_GROWTH, (int)REFILL_BLOCKS, poolStats_.capacity[c] / 2 }));
+		}
+		size_t n = std::min(REFILL_BLOCKS, pool.free.size());
+		cache.insert(cache.end(), pool.free.end() - n, pool.free.end());
+		pool.free.resize(pool.free.size() - n);
+	}
+	if (heapHit)
+		noteHeapHit(stats);
+}
+
+void PhysicsMemory::drain(int c, std::vector<void*>& cache, size_t keep)
+{
+	if (cache.size() <= keep) return;
+	std::lock_guard<std::mutex> lock(mutex_);
+	Pool& pool = pools_[c];
+	pool.free.insert(pool.free.end(), cache.begin() + keep, cache.end());
+	cache.resize(keep);
+}
+
+void PhysicsMemory::noteHeapHit(Stats* stats)
+{
+	if (stepDepth == 0) return;
+	if (stats != nullptr) {
+		stats->stepHeapHits++;
+		return;
+	}
+	std::lock_guard<std::mutex> lock(mutex_);
+	orphan_.stepHeapHits++;
+}
+
+void PhysicsMemory::noteUse(Stats* stats, int c, long long bytes, int blocks)
+{
+	auto apply = [&](Stats& s) {
+		s.bytesInUse += bytes;
+		s.peakBytes = std::max(s.peakBytes, s.bytesInUse);
+		if (c < 0) {
+			if (bytes > 0) s.largeAllocs++;
+			return;
+		}
+		s.blocksInUse[c] += blocks;
+		s.peakBlocks[c] = std::max(s.peakBlocks[c], s.blocksInUse[c]);
+	};
+	if (stats != nullptr) {
+		apply(*stats);
+		return;
+	}
+	std::lock_guard<std::mutex> lock(mutex_);
+	apply(orphan_);
+}
+
+void PhysicsMemory::reserve(size_t blockSize, int count)
+{
+	int c = sizeClass(blockSize);
+	if (c < 0 || count <= 0) return;
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (poolStats_.capacity[c] < count)
+		grow(c, count - poolStats_.capacity[c]);
+}
+
+void* PhysicsMemory::allocate(size_t size)
+{
+	PhysicsMemory* mem = getInstance();
+	Stats* stats = contextStats();
+	int c = sizeClass(size + sizeof(Header));
+
+	Header* h;
+	if (c < 0) {
+		h = static_cast<Header*>(std::malloc(sizeof(Header) + size));
+		if (h == nullptr)
+			return nullptr;
+		mem->noteHeapHit(stats);
+	}
+	else {
+		ThreadCache* cache = threadCache();
+		if (cache != nullptr) {
+			std::vector<void*>& blocks = cache->free[c];
+			if (blocks.empty())
+				mem->refill(c, blocks, stats);
+			h = static_cast<Header*>(blocks.back());
+			blocks.pop_back();
+		}
+		else {
+			// El hilo esta terminando: un bloque suelto del pool
+			std::vector<void*> one;
+			mem->refill(c, one, stats);
+			h = static_cast<Header*>(one.back());
+			one.pop_back();
+			mem->drain(c, one, 0);
+		}
+	}
+	h->sizeClass = c;
+	h->size = size;
+	mem->noteUse(stats, c, (long long)size, 1);
+	return h + 1;
+}
+
+void PhysicsMemory::deallocate(void* ptr)
+{
+	if (ptr == nullptr) return;
+	PhysicsMemory* mem = getInstance();
+	Header* h = static_cast<Header*>(ptr) - 1;
+	int c = h->sizeClass;
+	mem->noteUse(contextStats(), c, -(long long)h->size, -1);
+
+	if (c < 0) {
+		std::free(h);
+		return;
+	}
+	ThreadCache* cache = threadCache();
+	if (cache == nullptr) {
+		std::lock_guard<std::mutex> lock(mem->mutex_);
+		mem->pools_[c].free.push_back(h);
+		return;
+	}
+	std::vector<void*>& blocks = cache->free[c];
+	blocks.push_back(h);
+	if (blocks.size() > MAX_CACHED)
+		mem->drain(c, blocks, REFILL_BLOCKS);
+}
+
+#pragma endregion
+
+#pragma region Estadisticas
+
+void PhysicsMemory::beginStep()
+{
+	stepDepth++;
+}
+
+void PhysicsMemory::endStep()
+{
+	if (stepDepth > 0) stepDepth--;
+}
+
+void PhysicsMemory::recordCollisionPools(int manifolds, int algorithms)
+{
+	Stats* stats = contextStats();
+	if (stats == nullptr) return;
+	stats->peakManifolds = std::max(stats->peakManifolds, manifolds);
+	stats->peakAlgorithms = std::max(stats->peakAlgorithms, algorithms);
+}
+
+PhysicsMemory::Stats PhysicsMemory::getStats() const
+{
+	Stats* stats = contextStats();
+	return stats != nullptr ? *stats : Stats();
+}
+
+PhysicsMemory::Stats PhysicsMemory::getMergedStats() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return merged_;
+}
+
+PhysicsMemory::PoolStats PhysicsMemory::getPoolStats() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return poolStats_;
+}
+
+void PhysicsMemory::printStats() const
+{
+	Stats s = getStats();
+	PoolStats p = getPoolStats();
+	std::cout << "---- Physics memory ----\n";
+	std::cout << "Bullet: " << s.bytesInUse / 1024 << " KB in use, " << s.peakBytes / 1024 << " KB peak, "
+		<< p.reservedBytes / 1024 << " KB pooled by " << p.peakContexts << " worlds\n";
+	std::cout << p.poolGrowths << " pool growths, " << s.largeAllocs << " large allocations, "
+		<< s.stepHeapHits << " heap allocations during steps\n";
+	std::cout << "Manifolds: " << s.peakManifolds << "/" << p.manifoldPool
+		<< ", algorithms: " << s.peakAlgorithms << "/" << p.algorithmPool << "\n";
+	for (int c = 0; c < NUM_CLASSES; c++) {
+		if (p.capacity[c] == 0) continue;
+		std::cout << BLOCK_SIZES[c] << " B: " << s.blocksInUse[c] << " used, " << s.peakBlocks[c] << " peak, "
+			<< p.capacity[c] << " pooled\n";
+	}
+}
+
+#pragma endregion
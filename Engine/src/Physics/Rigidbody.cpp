@@ -13,6 +13,7 @@
 
 //includes de nuestro proyecto
 #include "Vector3.h"
+#include "MathConversions.h"
 #include "Entity.h"
 #include "PhysicsManager.h"
 #include "Transform.h"
@@ -27,14 +28,7 @@
 #include <Managers/SceneManager.h>
 #include <Scene/Scene.h>
 #include <CollisionObject.h>
-
-inline Vector3 cvt(const btVector3& V) {
-	return Vector3(V.x(), V.y(), V.z());
-}
-
-inline btVector3 cvt(const Vector3& V) {
-	return btVector3(V.x, V.y, V.z);
-}
+#include "Reflection.h"
 
 RigidBody::RigidBody() : Component(PhysicsManager::getInstance(), 0)
 {
@@ -43,6 +37,9 @@ RigidBody::RigidBody() : Component(PhysicsManager::getInstance(), 0)
 
 RigidBody::~RigidBody()
 {
+	// El transform vuelve a moverse solo (si aun existe: puede haberse destruido antes)
+	if (tr_ != nullptr && _entity != nullptr && _entity->get<Transform>() == tr_)
+		tr_->setPhysicsDriven(false);
 	if(st) delete st;
 	st = nullptr;
 	if(co) 
@@ -61,13 +58,12 @@ RigidBody::~RigidBody()
 void RigidBody::setUp()
 {
 	co->setEntity(_entity);
-	tr_ = static_cast<Transform*>(_entity->getComponent((int)ManID::Common, (int)CommonManager::CommonCmpId::TransId));
-	btQuaternion q;
-	Vector3 vRot = tr_->getRot();
-	q.setEulerZYX(vRot.x, vRot.y, vRot.z);
-	rb->setWorldTransform(btTransform(q, cvt(tr_->getPos())));
+	tr_ = _entity->get<Transform>();
+	// La posicion la lleva Bullet, el CommonManager no debe integrarla
+	tr_->setPhysicsDriven(true);
+	rb->setWorldTransform(btTransform(cvt(tr_->getWorldRotation()), cvt(tr_->getWorldPos())));
 
-	MeshComponent* mesh = static_cast<MeshComponent*>(_entity->getComponent((int)ManID::Render, (int)RenderManager::RenderCmpId::Mesh));
+	MeshComponent* mesh = _entity->get<MeshComponent>();
 	if (meshShape && mesh) {
 		Ogre::MeshPtr meshPtr = mesh->getOgreEntity()->getMesh();
 
@@ -103,180 +99,96 @@ void RigidBody::update(float deltaTime)
 	tr_->setRot(Vector3(roll, pitch, yaw));
 }
 
-void RigidBody::load(const nlohmann::json& params)
+void RigidBody::setActive(bool act)
 {
-	//Masa
-	auto it = params.find("mass");
-	if (it != params.end()) {
-		float m = it->get<float>();
-		rb->setMassProps(m, btVector3(1.0, 1.0, 1.0));
-	}
-
-	//Restitucion
-	it = params.find("restitution");
-	if (it != params.end()) {
-		float rest = it->get<float>();
-		setRestitution(rest);
-	}
-
-	//Damping
-	it = params.find("dampingLin");
-	auto aux = params.find("dampingAng");
-	if (it != params.end() && aux != params.end()) {
-		float dL = it->get<float>();
-		float dA = it->get<float>();
-		rb->setDamping(dL, dA);
-	}
-
-	//Gravedad
-	it = params.find("gravity");
-	if (it != params.end()) {
-		std::vector<float> newGrav = it->get<std::vector<float>>();
-		setGravity(newGrav);
+	if (act == _active) return;
+	btDiscreteDynamicsWorld* world = PhysicsManager::getInstance()->getWorld();
+	if (!act) {
+		group_ = getGroup();
+		mask_ = getMask();
+		world->removeRigidBody(rb);
 	}
-
-	//Velocidad Lineal
-	it = params.find("linealVel");
-	if (it != params.end()) {
-		std::vector<float> vel = it->get<std::vector<float>>();
-		setLinearVelocity(vel);
-	}
-
-	//Friccion
-	it = params.find("friction");
-	if (it != params.end()) {
-		float friction = it->get<float>();
-		setFriction(friction);
-	}
-
-	//Estados del rigidbody
-	it = params.find("state");
-	if (it != params.end()) {
-		std::string state = it->get<std::string>();
-		if (state == "Kinematic") {
-			setKinematic(true);
-		}
-		else if (state == "Trigger") {
-			setTrigger(true);
-		}
-		else if (state == "Static") {
-			setStatic(true);
-		}
-		else {
-			std::cout << "RIGIDBODY:JSON_READING_STATE: " << state << " //FALLO AL LEER EL ESTADO. SE DEJARA POR DEFECTO\n";
+	else {
+		world->addRigidBody(rb, group_, mask_);
+		// Vuelve donde este ahora el transform y sin la velocidad de antes
+		if (tr_ != nullptr) {
+			btTransform t(cvt(tr_->getWorldRotation()), cvt(tr_->getWorldPos()));
+			rb->setWorldTransform(t);
+			rb->setInterpolationWorldTransform(t);
+			if (rb->getMotionState() != nullptr)
+				rb->getMotionState()->setWorldTransform(t);
 		}
+		rb->setLinearVelocity(btVector3(0, 0, 0));
+		rb->setAngularVelocity(btVector3(0, 0, 0));
+		rb->activate(true);
 	}
+	Component::setActive(act);
+}
 
-	//Para determinar que tipo de shapeCollision coger
-	it = params.find("mShape");
-	if (it != params.end()) {
-		bool mShape = it->get<bool>();
-		meshShape = mShape;
-	}
+void RigidBody::load(const nlohmann::json& params)
+{
+	loadFields(params);
 
 	//Formas de la colision
 	if (!meshShape) {
-		it = params.find("shape");
+		auto it = params.find("shape");
 		if (it != params.end()) {
-			auto shape = it.value();
-			//auto shape = it.value().find("id");
-			if (shape.is_object()) {
-				it = shape.find("id");
-				if (it != shape.end())
-				{
-					std::string shapeName = it.value().get<std::string>();
-					//std::string shapeName = shape.value().get<std::string>();
-					btCollisionShape* shapeColl = nullptr;
-					if (shapeName == "Box") {
-						auto size = shape.find("size");
-						if (size != shape.end()) {
-							std::vector<float> s = size->get<std::vector<float>>();
-							shapeColl = new btBoxShape(btVector3(s[0], s[1], s[2]));
-						}
-						else {
-							shapeColl = new btBoxShape(btVector3(1.0f, 1.0f, 1.0f));
-						}
-					}
-					else if (shapeName == "Sphere") {
-						auto radius = shape.find("radius");
-						if (radius != shape.end()) {
-							float r = radius->get<float>();
-							shapeColl = new btSphereShape(r);
-						}
-						else {
-							shapeColl = new btSphereShape(1.0f);
-						}
-					}
-					else if (shapeName == "Cylinder") {
-						auto size = shape.find("size");
-						if (size != shape.end()) {
-							std::vector<float> s = size->get<std::vector<float>>();
-							shapeColl = new btCylinderShape(btVector3(s[0], s[1], s[2]));
-						}
-						else {
-							shapeColl = new btCylinderShape(btVector3(1.0f, 1.0f, 1.0f));
-						}
-					}
-					else if (shapeName == "Cone") {
-						auto radius = shape.find("radius");
-						auto height = shape.find("height");
-
-						if (radius != shape.end() && height != shape.end()) {
-							float r = radius->get<float>();
-							float h = height->get<float>();
-							shapeColl = new btConeShape(r, h);
-						}
-						else {
-							shapeColl = new btConeShape(1.0f, 1.0f);
-						}
-					}
-					else if (shapeName == "Capsule") {
-						auto radius = shape.find("radius");
-						auto height = shape.find("height");
-						if (radius != shape.end() && height != shape.end()) {
-							float r = radius->get<float>();
-							float h = height->get<float>();
-							shapeColl = new btCapsuleShape(r, h);
-						}
-						else {
-							shapeColl = new btCapsuleShape(1.0f, 1.0f);
-						}
-					}
-
-					setCollisionShape(shapeColl);
-				}
-				
-			}
+			btCollisionShape* shapeColl = PhysicsManager::getInstance()->createShape(it.value());
+			if (shapeColl != nullptr)
+				setCollisionShape(shapeColl);
 		}
 	}
+}
 
-	// Grupo
-	it = params.find("group");
-	if (it != params.end() && it->is_number()) {
-		 rb->getBroadphaseProxy()->m_collisionFilterGroup = it->get<short>();
+const Reflection::TypeInfo* RigidBody::getTypeInfo() const
+{
+	static const Reflection::TypeInfo info("RigidBody", {
+		REFLECT_FIELD(RigidBody, float, "mass", self.mass,
+			{ self.mass = v; self.rb->setMassProps(v, btVector3(1.0, 1.0, 1.0)); }),
+		REFLECT_FIELD(RigidBody, float, "restitution", self.rb->getRestitution(), self.setRestitution(v)),
+		REFLECT_FIELD(RigidBody, float, "dampingLin", self.rb->getLinearDamping(),
+			self.rb->setDamping(v, self.rb->getAngularDamping())),
+		REFLECT_FIELD(RigidBody, float, "dampingAng", self.rb->getAngularDamping(),
+			self.rb->setDamping(self.rb->getLinearDamping(), v)),
+		REFLECT_FIELD(RigidBody, Vector3, "gravity", cvt(self.rb->getGravity()), self.setGravity(v)),
+		REFLECT_FIELD(RigidBody, Vector3, "linealVel", cvt(self.rb->getLinearVelocity()), self.setLinearVelocity(v)),
+		REFLECT_FIELD(RigidBody, float, "friction", self.rb->getFriction(), self.setFriction(v)),
+		REFLECT_FIELD(RigidBody, std::string, "state", self.getState(), self.setState(v)),
+		//Para determinar que tipo de shapeCollision coger, se usa en el setUp
+		REFLECT_MEMBER(RigidBody, "mShape", meshShape).loadOnly(),
+		REFLECT_PROPERTY(RigidBody, int, "group", getGroup, setGroup),
+		REFLECT_PROPERTY(RigidBody, int, "mask", getMask, setMask),
+		REFLECT_FIELD(RigidBody, Vector3, "linearFactor", cvt(self.rb->getLinearFactor()), self.setLinearFactor(v)),
+		REFLECT_FIELD(RigidBody, Vector3, "angularFactor", cvt(self.rb->getAngularFactor()), self.setAngularFactor(v))
+	});
+	return &info;
+}
+
+//Estados del rigidbody
+void RigidBody::setState(const std::string& state)
+{
+	if (state == "Kinematic") {
+		setKinematic(true);
 	}
-
-	// Mascara
-	it = params.find("mask");
-	if (it != params.end() && it->is_number()) {
-		rb->getBroadphaseProxy()->m_collisionFilterMask = it->get<short>();
+	else if (state == "Trigger") {
+		setTrigger(true);
 	}
-
-	// Factor lineal
-	it = params.find("linearFactor");
-	if (it != params.end()) {
-		std::vector<float> newLinFact = it->get<std::vector<float>>();
-		setLinearFactor(newLinFact);
+	else if (state == "Static") {
+		setStatic(true);
 	}
-
-	// Factor Angular
-	it = params.find("angularFactor");
-	if (it != params.end()) {
-		std::vector<float> newAngFact = it->get<std::vector<float>>();
-		setAngularFactor(newAngFact);
+	else if (state != "Dynamic") {
+		std::cout << "RIGIDBODY:JSON_READING_STATE: " << state << " //FALLO AL LEER EL ESTADO. SE DEJARA POR DEFECTO\n";
 	}
 }
 
+std::string RigidBody::getState() const
+{
+	if (isKinematic()) return "Kinematic";
+	if (isTrigger()) return "Trigger";
+	if (isStatic()) return "Static";
+	return "Dynamic";
+}
+
 #pragma endregion
 
 #pragma region Setters
@@ -369,6 +281,20 @@ void RigidBody::setAngularFactor(const Vector3& axis)
 {
 	rb->setAngularFactor(cvt(axis));
 }
+
+void RigidBody::setGroup(int group)
+{
+	group_ = group;
+	if (rb->getBroadphaseProxy() != nullptr)
+		rb->getBroadphaseProxy()->m_collisionFilterGroup = group;
+}
+
+void RigidBody::setMask(int mask)
+{
+	mask_ = mask;
+	if (rb->getBroadphaseProxy() != nullptr)
+		rb->getBroadphaseProxy()->m_collisionFilterMask = mask;
+}
 #pragma endregion
 
 #pragma region Getters
@@ -432,12 +358,13 @@ btRigidBody* RigidBody::getBtRb() const
 
 int RigidBody::getGroup() const
 {
-
+	if (rb->getBroadphaseProxy() == nullptr) return group_;
 	return rb->getBroadphaseProxy()->m_collisionFilterGroup;
 }
 
 int RigidBody::getMask() const
 {
+	if (rb->getBroadphaseProxy() == nullptr) return mask_;
 	return rb->getBroadphaseProxy()->m_collisionFilterMask;
 }
 
@@ -486,7 +413,7 @@ bool RigidBody::collidesWithEntity(Entity* other) const
 	if (other == nullptr) return false;
 
 	//Se obtiene el rb de la otra entidad
-	auto* otherRigidBody = reinterpret_cast<RigidBody*>(other->getComponent((int)ManID::Physics, 0));
+	auto* otherRigidBody = other->get<RigidBody>();
 
 	if (!otherRigidBody->isActive())
 		return false;
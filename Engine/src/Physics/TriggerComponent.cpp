@@ -0,0 +1,262 @@
+#include "TriggerComponent.h"
+#include "PhysicsManager.h"
+#include "CollisionObject.h"
+#include "Transform.h"
+#include "CommonManager.h"
+#include "Entity.h"
+#include "MathConversions.h"
+#include "Reflection.h"
+
+#include "btBulletCollisionCommon.h"
+#include "btBulletDynamicsCommon.h"
+#include "BulletCollision/CollisionDispatch/btGhostObject.h"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+TriggerComponent::TriggerComponent() :
+	Component(PhysicsManager::getInstance(), (int)PhysicsManager::PhysicsCmpId::TriggerId)
+{
+	ghost_ = new btPairCachingGhostObject();
+	shape_ = new btBoxShape(btVector3(1.0f, 1.0f, 1.0f));
+	ghost_->setCollisionShape(shape_);
+	// Sin respuesta: nunca empuja ni se calcula su contacto
+	ghost_->setCollisionFlags(ghost_->getCollisionFlags() | btCollisionObject::CF_NO_CONTACT_RESPONSE);
+	co_ = new CollisionObject();
+	ghost_->setUserPointer((void*)co_);
+	init();
+}
+
+TriggerComponent::~TriggerComponent()
+{
+	PhysicsManager* phys = PhysicsManager::getInstance();
+	if (phys != nullptr) {
+		phys->removeTrigger(this);
+		removeFromWorld();
+	}
+	delete ghost_;
+	delete shape_;
+	delete co_;
+}
+
+void TriggerComponent::init()
+{
+	offset_ = Vector3();
+	// Los triggers no se detectan entre ellos
+	group_ = btBroadphaseProxy::SensorTrigger;
+	mask_ = btBroadphaseProxy::AllFilter & ~btBroadphaseProxy::SensorTrigger;
+}
+
+void TriggerComponent::load(const nlohmann::json& params)
+{
+	loadFields(params);
+
+	// Misma forma que en el rigidbody: { "id": "Box", "size": [x, y, z] }...
+	auto it = params.find("shape");
+	if (it != params.end()) {
+		btCollisionShape* shape = PhysicsManager::getInstance()->createShape(*it);
+		if (shape != nullptr)
+			setShape(shape);
+	}
+}
+
+const Reflection::TypeInfo* TriggerComponent::getTypeInfo() const
+{
+	static const Reflection::TypeInfo info("Trigger", {
+		REFLECT_PROPERTY(TriggerComponent, Vector3, "offset", getOffset, setOffset),
+		REFLECT_PROPERTY(TriggerComponent, int, "group", getGroup, setGroup),
+		REFLECT_PROPERTY(TriggerComponent, int, "mask", getMask, setMask)
+	});
+	return &info;
+}
+
+void TriggerComponent::setUp()
+{
+	tr_ = _entity->get<Transform>();
+	co_->setEntity(_entity);
+	syncTransform();
+	if (_active)
+		addToWorld();
+	PhysicsManager::getInstance()->addTrigger(this);
+}
+
+// Se mueve con el transform en PhysicsManager::stepWorld
+void TriggerComponent::update(float deltaTime)
+{
+}
+
+void TriggerComponent::setActive(bool act)
+{
+	if (act == _active) return;
+	if (!act) {
+		removeFromWorld();
+		for (const btCollisionObject* obj : inside_)
+			exited_.push_back(entityOf(obj));
+		inside_.clear();
+		entered_.clear();
+		dispatchEvents();
+	}
+	else {
+		syncTransform();
+		addToWorld();
+	}
+	Component::setActive(act);
+}
+
+void TriggerComponent::addToWorld()
+{
+	if (inWorld_) return;
+	PhysicsManager::getInstance()->getWorld()->addCollisionObject(ghost_, group_, mask_);
+	inWorld_ = true;
+}
+
+void TriggerComponent::removeFromWorld()
+{
+	if (!inWorld_) return;
+	PhysicsManager::getInstance()->getWorld()->removeCollisionObject(ghost_);
+	inWorld_ = false;
+}
+
+void TriggerComponent::syncTransform()
+{
+	if (tr_ == nullptr) return;
+	btTransform t(cvt(tr_->getWorldRotation()), cvt(tr_->getWorldPos()));
+	// El desplazamiento gira con la entidad
+	t.setOrigin(t * cvt(offset_));
+	ghost_->setWorldTransform(t);
+}
+
+Entity* TriggerComponent::entityOf(const btCollisionObject* obj) const
+{
+	CollisionObject* co = static_cast<CollisionObject*>(obj->getUserPointer());
+	Entity* ent = co != nullptr ? co->getEntity() : nullptr;
+	return ent != _entity ? ent : nullptr;
+}
+
+void TriggerComponent::refreshOverlaps()
+{
+	// La lista del ghost la mantiene el btGhostPairCallback con cada par
+	// que el broadphase anade o quita, aqui solo se recorre
+	overlaps_.clear();
+	int n = ghost_->getNumOverlappingObjects();
+	for (int i = 0; i < n; i++) {
+		const btCollisionObject* obj = ghost_->getOverlappingObject(i);
+		if (entityOf(obj) != nullptr)
+			overlaps_.push_back(obj);
+	}
+	if (overlaps_.empty() && inside_.empty())
+		return;
+
+	std::less<const btCollisionObject*> less;
+	std::sort(overlaps_.begin(), overlaps_.end(), less);
+
+	// Las dos listas ordenadas: lo que solo esta en una ha entrado o salido
+	size_t a = 0, b = 0;
+	while (a < overlaps_.size() || b < inside_.size()) {
+		if (b == inside_.size() || (a < overlaps_.size() && less(overlaps_[a], inside_[b])))
+			entered_.push_back(entityOf(overlaps_[a++]));
+		else if (a == overlaps_.size() || less(inside_[b], overlaps_[a]))
+			exited_.push_back(entityOf(inside_[b++]));
+		else {
+			a++;
+			b++;
+		}
+	}
+	inside_.swap(overlaps_);
+}
+
+void TriggerComponent::dispatchEvents()
+{
+	for (Entity* ent : exited_) {
+		co_->onTriggerExit(ent);
+		if (onExit_) onExit_(ent);
+	}
+	for (Entity* ent : entered_) {
+		co_->onTriggerEnter(ent);
+		if (onEnter_) onEnter_(ent);
+	}
+	exited_.clear();
+	entered_.clear();
+}
+
+void TriggerComponent::forget(const btCollisionObject* obj)
+{
+	inside_.erase(std::remove(inside_.begin(), inside_.end(), obj), inside_.end());
+}
+
+void TriggerComponent::setShape(btCollisionShape* shape)
+{
+	if (shape == nullptr || shape == shape_) return;
+	ghost_->setCollisionShape(shape);
+	delete shape_;
+	shape_ = shape;
+}
+
+void TriggerComponent::setOffset(const Vector3& offset)
+{
+	offset_ = offset;
+	syncTransform();
+}
+
+const Vector3& TriggerComponent::getOffset() const
+{
+	return offset_;
+}
+
+// El filtro se aplica al entrar en el mundo, si ya esta se vuelve a meter
+void TriggerComponent::setGroup(int group)
+{
+	group_ = group;
+	if (inWorld_) {
+		removeFromWorld();
+		addToWorld();
+	}
+}
+
+int TriggerComponent::getGroup() const
+{
+	return group_;
+}
+
+void TriggerComponent::setMask(int mask)
+{
+	mask_ = mask;
+	if (inWorld_) {
+		removeFromWorld();
+		addToWorld();
+	}
+}
+
+int TriggerComponent::getMask() const
+{
+	return mask_;
+}
+
+void TriggerComponent::setUserPtr(CollisionObject* co)
+{
+	if (co == nullptr) return;
+	delete co_;
+	co_ = co;
+	co_->setEntity(_entity);
+	ghost_->setUserPointer((void*)co_);
+}
+
+void TriggerComponent::setCallbacks(const TriggerCallback& onEnter, const TriggerCallback& onExit)
+{
+	onEnter_ = onEnter;
+	onExit_ = onExit;
+}
+
+bool TriggerComponent::isInside(Entity* ent) const
+{
+	for (const btCollisionObject* obj : inside_)
+		if (entityOf(obj) == ent)
+			return true;
+	return false;
+}
+
+int TriggerComponent::getOverlapCount() const
+{
+	return (int)inside_.size();
+}
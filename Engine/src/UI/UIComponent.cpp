@@ -1,20 +1,16 @@
 #include "UIComponent.h"
-#include <glm/glm.hpp>
 #include "UIManager.h"
 #include "CommonManager.h"
 #include "Transform.h"
 #include "Entity.h"
+#include "Reflection.h"
 #include "CEGUI/Window.h"
+#include "CEGUI/CEGUI.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <math.h>
 
-inline glm::vec2 cvt(const vector2& V) {
-	return glm::vec2(V.first, V.second);
-}
-
-inline vector2  cvt(const glm::vec2& V) {
-	return std::pair<float, float>(V.x, V.y);
-}
-
 vector2 UIComponent::normalizeVector2(const vector2& v)
 {
 	float x = std::pow(v.first, 2);
@@ -37,13 +33,100 @@ UIComponent::UIComponent(int id) : Component(UIManager::getInstance(), id)
 
 }
 
+UIComponent::UIEvent UIComponent::getEventByName(const std::string& eventName)
+{
+	if (eventName == "click") return UIEvent::Click;
+	if (eventName == "hoverEnter") return UIEvent::HoverEnter;
+	if (eventName == "hoverExit") return UIEvent::HoverExit;
+	if (eventName == "valueChanged") return UIEvent::ValueChanged;
+	return UIEvent::LastUIEvent;
+}
+
 UIComponent::~UIComponent()
 {
+	if (textDirty)
+		UIManager::getInstance()->cancelText(this);
+	UIManager::getInstance()->releaseWindow(uiWindow, changedProps, !layoutWindow);
+}
+
+void UIComponent::setWindow(CEGUI::Window* w, bool fromLayout)
+{
+	if (uiWindow != nullptr && uiWindow != w) {
+		UIManager::getInstance()->releaseWindow(uiWindow, changedProps, !layoutWindow);
+		changedProps.clear();
+	}
+	uiWindow = w;
+	layoutWindow = fromLayout;
+	if (uiWindow != nullptr)
+		UIManager::getInstance()->bindWindow(uiWindow, this);
+}
+
+CEGUI::Window* UIComponent::findLayoutWindow()
+{
+	if (layoutName.empty())
+		return nullptr;
+
+	CEGUI::Window* w = UIManager::getInstance()->getLayoutWindow(layoutName, layoutPath);
+	if (w == nullptr)
+		std::cout << "WARNING: no se encuentra la ventana " << layoutPath << " en el layout " << layoutName << "\n";
+	return w;
+}
+
+void UIComponent::bindLayoutWindow(CEGUI::Window* w, const nlohmann::json& params)
+{
+	setWindow(w, true);
+	//Sin parametro se queda lo que diga el layout
+	if (params.find("position") != params.end())
+		setPosition(pos);
+	if (params.find("size") != params.end())
+		setSize(size);
+	if (params.find("text") != params.end())
+		uiWindow->setText(text);
+}
+
+void UIComponent::loadWindowParams(const nlohmann::json& params)
+{
+	//Propiedades de la ventana
+	auto it = params.find("property");
+	if (it != params.end()) {
+		std::vector<std::vector<std::string>> prop =
+			it->get<std::vector<std::vector<std::string>>>();
+		for (int i = 0; i < prop.size(); i++) {
+			setProperty(prop.at(i).at(0), prop.at(i).at(1));
+		}
+	}
+
+	it = params.find("active");
+	if (it != params.end()) {
+		bool ac = it->get<bool>();
+		setActive(ac);
+	}
+}
+
+const Reflection::TypeInfo* UIComponent::getTypeInfo() const
+{
+	//Sin ventana solo se guardan los valores, la ventana se crea en el load de
+	//cada uno con ellos. Con ventana (desde Lua) se aplican a ella
+	static const Reflection::TypeInfo info("UIComponent", {
+		REFLECT_FIELD(UIComponent, vector2, "position", self.pos,
+			{ if (self.uiWindow) self.setPosition(v); else self.pos = v; }),
+		REFLECT_FIELD(UIComponent, vector2, "size", self.size,
+			{ if (self.uiWindow) self.setSize(v); else self.size = v; }),
+		REFLECT_FIELD(UIComponent, std::string, "name", self.name,
+			{ if (self.uiWindow) self.setName(v); else self.name = v; }),
+		REFLECT_FIELD(UIComponent, std::string, "text", self.text,
+			{ if (self.uiWindow) self.setText(v); else self.text = v; }),
+		//Eligen la ventana, solo cuentan al cargar
+		REFLECT_MEMBER(UIComponent, "type", type).loadOnly(),
+		REFLECT_MEMBER(UIComponent, "layout", layoutName).loadOnly(),
+		REFLECT_MEMBER(UIComponent, "window", layoutPath).loadOnly()
+	});
+	return &info;
 }
 
 void UIComponent::setActive(bool act)
 {
-	_active = act;
+	Component::setActive(act);
 	if (_active && !uiWindow->isVisible()) {
 		uiWindow->show();
 	}
@@ -59,17 +142,17 @@ void UIComponent::setPosition(const vector2& p)
 	CEGUI::UDim y(pos.second, 0);
 	CEGUI::UVector2 pU(x, y);
 
-	uiWindow->setPosition(pU);
+	setProperty("Position", CEGUI::PropertyHelper<CEGUI::UVector2>::toString(pU).c_str());
 }
 
 void UIComponent::setSize(const vector2& s)
 {
 	size = s;
-	CEGUI::UDim x(size.first, 0);
-	CEGUI::UDim y(size.second, 0);
-	CEGUI::UVector2 sU(x, y);
+	CEGUI::UDim x(0, size.first);
+	CEGUI::UDim y(0, size.second);
+	CEGUI::USize sU(x, y);
 
-	uiWindow->setPosition(sU);
+	setProperty("Size", CEGUI::PropertyHelper<CEGUI::USize>::toString(sU).c_str());
 }
 
 void UIComponent::setName(const std::string& n)
@@ -80,12 +163,77 @@ void UIComponent::setName(const std::string& n)
 
 void UIComponent::setProperty(const std::string nameProp, const std::string value)
 {
-	try
-	{
-		uiWindow->setProperty(nameProp, value);
+	if (std::find(changedProps.begin(), changedProps.end(), nameProp) == changedProps.end())
+		changedProps.push_back(nameProp);
+	//Se aplica en el update del UIManager, una vez por frame
+	UIManager::getInstance()->queueProperty(uiWindow, nameProp, value);
+}
+
+void UIComponent::changeText(const char* t)
+{
+	//Comparar no reserva memoria, y si es igual CEGUI no tiene que recolocar el texto
+	if (text == t)
+		return;
+	text.assign(t);
+	if (!textDirty) {
+		textDirty = true;
+		UIManager::getInstance()->queueText(this);
 	}
-	catch (const std::exception& e )
-	{
-		std::cout << e.what() << std::endl;
+}
+
+void UIComponent::setText(const std::string& t)
+{
+	changeText(t.c_str());
+}
+
+void UIComponent::setNumber(double value, int decimals)
+{
+	char buffer[64];
+	std::snprintf(buffer, sizeof(buffer), "%.*f", std::max(0, decimals), value);
+	changeText(buffer);
+}
+
+void UIComponent::setFormatted(const char* format, double value, int decimals)
+{
+	char number[64];
+	std::snprintf(number, sizeof(number), "%.*f", std::max(0, decimals), value);
+
+	const char* hole = std::strstr(format, "{}");
+	if (hole == nullptr) {
+		changeText(format);
+		return;
 	}
+	//Sin limite de longitud; tras crecer la primera vez ya no reserva memoria
+	static thread_local std::string buffer;
+	buffer.assign(format, hole - format);
+	buffer.append(number);
+	buffer.append(hole + 2);
+	changeText(buffer.c_str());
+}
+
+const std::string& UIComponent::getText() const
+{
+	return text;
+}
+
+void UIComponent::applyText()
+{
+	textDirty = false;
+	if (uiWindow != nullptr)
+		uiWindow->setText(text);
+}
+
+void UIComponent::setCallback(UIEvent ev, const UICallback& callback)
+{
+	if (ev == UIEvent::LastUIEvent)
+		return;
+	callbacks[(int)ev] = callback;
+}
+
+void UIComponent::dispatchEvent(UIEvent ev, float value)
+{
+	if (ev == UIEvent::Click)
+		onClicked();
+	if (callbacks[(int)ev])
+		callbacks[(int)ev](value);
 }
@@ -1,5 +1,6 @@
 #include "UILabel.h"
 #include "UIManager.h"
+#include "Reflection.h"
 
 #include "CEGUI/Window.h"
 #include "CEGUI/CEGUI.h"
@@ -27,66 +28,24 @@ void UILabel::init()
 	name = "LabelDefault";
 	type = "Label";
 
-	uiWindow = UIManager::getInstance()->createLabel(text, pos, size, name, type);
+	setWindow(UIManager::getInstance()->createLabel(text, pos, size, name, type));
 }
 
 void UILabel::load(const nlohmann::json& params)
 {
-	//--------------ASIGNACIONES_UI_COMPONENT--------------//
-	auto it = params.find("position");
-	if (it != params.end()) {
-		std::vector<float> p = it->get<std::vector<float>>();
-		pos.first = p[0];
-		pos.second = p[1];
-	}
+	loadFields(params);
 
-	it = params.find("size");
-	if (it != params.end()) {
-		std::vector<float> s = it->get<std::vector<float>>();
-		size.first = s[0];
-		size.second = s[1];
-	}
+	CEGUI::Window* fromLayout = findLayoutWindow();
+	if (fromLayout != nullptr)
+		bindLayoutWindow(fromLayout, params);
+	else
+		setWindow(UIManager::getInstance()->createLabel(text, pos, size, name, type));
 
-	it = params.find("name");
-	if (it != params.end()) {
-		std::string n = it->get<std::string>();
-		name = n;
-	}
-
-	it = params.find("type");
-	if (it != params.end()) {
-		std::string t = it->get<std::string>();
-		type = t;
-	}
-
-//----------MENSAJE_LABEL------------------//
-	it = params.find("text");
-	if (it != params.end()) {
-		std::string t = it->get<std::string>();
-		text = t;
-	}
-
-	uiWindow = UIManager::getInstance()->createLabel(text, pos, size, name, type);
-	
-	//Propiedades de la Imagen
-	it = params.find("property");
-	if (it != params.end()) {
-		std::vector<std::vector<std::string>> prop =
-			it->get<std::vector<std::vector<std::string>>>();
-		for (int i = 0; i < prop.size(); i++) {
-			setProperty(prop.at(i).at(0), prop.at(i).at(1));
-		}
-	}
-
-	it = params.find("active");
-	if (it != params.end()) {
-		bool ac = it->get<bool>();
-		setActive(ac);
-	}
+	loadWindowParams(params);
 }
 
-void UILabel::setText(std::string t)
+const Reflection::TypeInfo* UILabel::getTypeInfo() const
 {
-	text = t;
-	uiWindow->setText(text);
-}
\ No newline at end of file
+	static const Reflection::TypeInfo info("UILabel", {}, UIComponent::getTypeInfo());
+	return &info;
+}
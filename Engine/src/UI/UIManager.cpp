@@ -1,34 +1,28 @@
 #include "UIManager.h"
+#include "EngineContext.h"
 //INCLUDE COMPONENTS
 #include "UIButton.h"
 #include "UISlider.h"
 #include "UILabel.h"
 #include "UIImage.h"
 #include "UIPointer.h"
+#include "UIComponent.h"
 
 //INCLUDE CEGUI
 #include <CEGUI/CEGUI.h>
 #include <CEGUI/MouseCursor.h>
 #include <CEGUI/RendererModules/Ogre/Renderer.h>
 #include "CEGUI/RendererModules/Ogre/ResourceProvider.h"
-#include <glm/glm.hpp>
 
 //ADDITIONAL INCLUDES
 #include "OgreContext.h"
 #include <iostream>
+#include <algorithm>
 
+static_assert((int)UIManager::UICmpId::LastUICmpId == NATIVE_COMPONENTS[(int)ManID::UI], "Update NATIVE_COMPONENTS in ComponentTypes.h");
 
 #pragma region Generales
 
-inline glm::vec2 cvt(const vector2& V) {
-	return glm::vec2(V.first, V.second);
-}
-
-inline vector2 cvt(const glm::vec2& V) {
-	return vector2(V.x, V.y);
-}
-
-UIManager* UIManager::instance_ = nullptr;
 
 UIManager::UIManager() : Manager(ManID::UI)
 {
@@ -53,6 +47,8 @@ UIManager::UIManager() : Manager(ManID::UI)
 	CEGUI::WidgetLookManager::setDefaultResourceGroup("Looknfeel");
 	CEGUI::WindowManager::setDefaultResourceGroup("Layouts");
 	CEGUI::AnimationManager::setDefaultResourceGroup("Animations");
+	//Los grupos de la interfaz no dependen de la escena, se cargan siempre
+	OgreContext::getInstance()->acquireResourceGroups({ "Imagesets", "Fonts", "Schemes", "Looknfeel", "Layouts", "Animations" });
 
 	guiWinMng = &CEGUI::WindowManager::getSingleton();
 	winRoot = guiWinMng->createWindow("DefaultWindow", "rootWindow");
@@ -67,13 +63,14 @@ UIManager::~UIManager()
 
 UIManager* UIManager::getInstance()
 {
-	return instance_;
+	return EngineContext::current()->gui;
 }
 
 bool UIManager::setUpInstance() {
-	if (instance_ == nullptr) {
+	EngineContext* ctx = EngineContext::current();
+	if (!ctx->gui) {
 		try {
-			instance_ = new UIManager();
+			ctx->gui = new UIManager();
 		}
 		catch (...) {
 			return false;
@@ -84,17 +81,32 @@ bool UIManager::setUpInstance() {
 
 void UIManager::clean()
 {
-	instance_->destroyAllComponents();
-	for (int i = 0; i < instance_->ceguiWindows.size(); i++) {
-		instance_->guiWinMng->destroyWindow(instance_->ceguiWindows[i]);
+	UIManager* ui = getInstance();
+	//Los componentes devuelven sus ventanas al pool al destruirse
+	ui->destroyAllComponents();
+	//Los layouts no se destruyen, se quitan de la pantalla hasta que otra escena los pida
+	for (auto& layout : ui->layouts) {
+		if (layout.second->getParent() != nullptr)
+			layout.second->getParent()->removeChild(layout.second);
 	}
+	ui->pendingProps.clear();
+	ui->pendingTexts.clear();
+	ui->eventQueue.clear();
 }
 
 void UIManager::destroy()
 {
+	UIManager* ui = getInstance();
 	clean();
+	for (auto& pool : ui->windowPool) {
+		for (CEGUI::Window* window : pool.second)
+			ui->guiWinMng->destroyWindow(window);
+	}
+	for (auto& layout : ui->layouts)
+		ui->guiWinMng->destroyWindow(layout.second);
 	CEGUI::OgreRenderer::destroySystem();
-	delete instance_;
+	delete ui;
+	EngineContext::current()->gui = nullptr;
 }
 
 void UIManager::start()
@@ -103,6 +115,40 @@ void UIManager::start()
 
 void UIManager::update(float deltaTime)
 {
+	//Primero los eventos, asi lo que cambien los callbacks se aplica este mismo frame
+	dispatchEvents();
+	applyPendingProperties();
+}
+
+void UIManager::dispatchEvents()
+{
+	//Un callback puede generar mas eventos, esos se despachan el frame siguiente
+	size_t count = eventQueue.size();
+	for (size_t i = 0; i < count; i++) {
+		QueuedEvent ev = eventQueue[i];
+		//Se busca al despachar por si el componente se ha destruido desde que llego el evento
+		auto it = windowOwners.find(ev.window);
+		if (it != windowOwners.end())
+			it->second->dispatchEvent(ev.type, ev.value);
+	}
+	eventQueue.erase(eventQueue.begin(), eventQueue.begin() + count);
+}
+
+void UIManager::applyPendingProperties()
+{
+	for (auto& prop : pendingProps) {
+		try {
+			prop.first.first->setProperty(prop.first.second, prop.second);
+		}
+		catch (const std::exception& e) {
+			std::cout << e.what() << std::endl;
+		}
+	}
+	pendingProps.clear();
+
+	for (UIComponent* comp : pendingTexts)
+		comp->applyText();
+	pendingTexts.clear();
 }
 
 void UIManager::windowResized(Ogre::RenderWindow* rw)
@@ -126,15 +172,40 @@ void UIManager::loadFont(const std::string& filename)
 	CEGUI::FontManager::getSingleton().createFromFile(filename);
 }
 
-void UIManager::loadLayout(const std::string& layaoutFile) {
-	try {
-		CEGUI::Window* layout = guiWinMng->loadLayoutFromFile(layaoutFile);
+CEGUI::Window* UIManager::loadLayout(const std::string& layaoutFile) {
+	CEGUI::Window* layout = nullptr;
+	auto it = layouts.find(layaoutFile);
+	if (it != layouts.end()) {
+		layout = it->second;
+	}
+	else {
+		try {
+			layout = guiWinMng->loadLayoutFromFile(layaoutFile);
+			layouts[layaoutFile] = layout;
+		}
+		catch (std::exception& e) {
+			std::cout << e.what();
+			return nullptr;
+		}
+	}
+
+	if (layout->getParent() == nullptr)
 		winRoot->addChild(layout);
+	return layout;
+}
+
+CEGUI::Window* UIManager::getLayoutWindow(const std::string& layoutFile, const std::string& path)
+{
+	CEGUI::Window* layout = loadLayout(layoutFile);
+	if (layout == nullptr || path.empty())
+		return layout;
+	try {
+		return layout->getChild(path);
 	}
 	catch (std::exception& e) {
 		std::cout << e.what();
+		return nullptr;
 	}
-
 }
 
 void UIManager::setFont(const std::string& fontFile)
@@ -174,16 +245,13 @@ void UIManager::setMouseVisibility(bool b)
 CEGUI::Window* UIManager::createButton(const std::string& text, const vector2& position, const vector2& size,
 	const std::string& name, const std::string& type)
 {
-	CEGUI::Window* button = NULL;
-	button = guiWinMng->createWindow(schemeName + "/" + type, name);  // Create Window
+	CEGUI::Window* button = acquireWindow(type, name);
 
 	setWidgetDestRect(button, position, size);
 
 	button->setText(text);
 	winRoot->addChild(button);
 
-	ceguiWindows.push_back(button);
-
 	button->activate();
 
 	return button;
@@ -192,14 +260,10 @@ CEGUI::Window* UIManager::createButton(const std::string& text, const vector2& p
 CEGUI::Window* UIManager::createSlider(const vector2& position, const vector2& size,
 	const std::string& name, const std::string& type)
 {
-	CEGUI::Window* slider = CEGUI::WindowManager::getSingleton().createWindow(
-		schemeName + "/" + type);
+	CEGUI::Window* slider = acquireWindow(type, name);
 	setWidgetDestRect(slider, position, size);
-	slider->setName(name);
 	winRoot->addChild(slider);
 
-	ceguiWindows.push_back(slider);
-
 	slider->activate();
 
 	return slider;
@@ -208,16 +272,13 @@ CEGUI::Window* UIManager::createSlider(const vector2& position, const vector2& s
 CEGUI::Window* UIManager::createLabel(const std::string& text, const vector2& position, const vector2& size,
 	const std::string& name, const std::string& type)
 {
-	CEGUI::Window* label = CEGUI::WindowManager::getSingleton().createWindow(
-		schemeName + "/" + type, name);
+	CEGUI::Window* label = acquireWindow(type, name);
 	setWidgetDestRect(label, position, size);
 
 	label->setText(text);
 
 	winRoot->addChild(label);
 
-	ceguiWindows.push_back(label);
-
 	label->activate();
 
 	return label;
@@ -226,26 +287,143 @@ CEGUI::Window* UIManager::createLabel(const std::string& text, const vector2& po
 CEGUI::Window* UIManager::createImage(const vector2& position, const vector2& size,
 	const std::string& name, const std::string& type)
 {
-	CEGUI::Window* staticImage =
-		CEGUI::WindowManager::getSingleton().createWindow(
-			schemeName + "/" + type, name);
+	CEGUI::Window* staticImage = acquireWindow(type, name);
 	setWidgetDestRect(staticImage, position, size);
 
 	winRoot->addChild(staticImage);
-	
-	ceguiWindows.push_back(staticImage);
 
 	staticImage->activate();
 
 	return staticImage;
 }
 
+CEGUI::Window* UIManager::acquireWindow(const std::string& type, const std::string& name)
+{
+	std::string fullType = schemeName + "/" + type;
+	std::vector<CEGUI::Window*>& pool = windowPool[fullType];
+	if (pool.empty())
+		return guiWinMng->createWindow(fullType, name);
+
+	//Una ventana con el mismo nombre suele ser el mismo widget de la escena anterior
+	auto it = std::find_if(pool.begin(), pool.end(),
+		[&name](CEGUI::Window* w) { return w->getName() == name; });
+	if (it == pool.end())
+		it = pool.end() - 1;
+	CEGUI::Window* window = *it;
+	*it = pool.back();
+	pool.pop_back();
+
+	if (window->getName() != name)
+		window->setName(name);
+	window->show();
+	return window;
+}
+
 void UIManager::setWidgetDestRect(CEGUI::Window* widget, vector2 position, vector2 size)
 {
-	widget->setPosition(CEGUI::UVector2(CEGUI::UDim(cvt(position).x, 0),
-		CEGUI::UDim(cvt(position).y, 0)));
+	widget->setPosition(CEGUI::UVector2(CEGUI::UDim(position.first, 0),
+		CEGUI::UDim(position.second, 0)));
 	widget->setSize(
-		CEGUI::USize(CEGUI::UDim(0, cvt(size).x), CEGUI::UDim(0, cvt(size).y)));
+		CEGUI::USize(CEGUI::UDim(0, size.first), CEGUI::UDim(0, size.second)));
+}
+
+#pragma endregion
+
+#pragma region Pool
+
+void UIManager::bindWindow(CEGUI::Window* window, UIComponent* owner)
+{
+	windowOwners[window] = owner;
+	//Cada ventana se suscribe una sola vez, aunque pase por varios componentes
+	if (eventWindows.insert(window).second) {
+		window->subscribeEvent(CEGUI::PushButton::EventClicked,
+			CEGUI::Event::Subscriber(&UIManager::onWindowClicked, this));
+		window->subscribeEvent(CEGUI::Window::EventMouseEntersArea,
+			CEGUI::Event::Subscriber(&UIManager::onWindowHoverEnter, this));
+		window->subscribeEvent(CEGUI::Window::EventMouseLeavesArea,
+			CEGUI::Event::Subscriber(&UIManager::onWindowHoverExit, this));
+		window->subscribeEvent(CEGUI::Slider::EventValueChanged,
+			CEGUI::Event::Subscriber(&UIManager::onWindowValueChanged, this));
+	}
+}
+
+void UIManager::releaseWindow(CEGUI::Window* window, const std::vector<std::string>& changedProps, bool pooled)
+{
+	if (window == nullptr)
+		return;
+	windowOwners.erase(window);
+
+	//Los cambios pendientes de la ventana ya no se aplican
+	auto it = pendingProps.lower_bound(std::make_pair(window, std::string()));
+	while (it != pendingProps.end() && it->first.first == window)
+		it = pendingProps.erase(it);
+
+	//Las ventanas de los layouts conservan su estado, son siempre las mismas
+	if (!pooled)
+		return;
+
+	for (const std::string& prop : changedProps) {
+		try {
+			window->setProperty(prop, window->getPropertyDefault(prop));
+		}
+		catch (const std::exception& e) {
+			std::cout << e.what() << std::endl;
+		}
+	}
+	window->hide();
+	window->setText("");
+	if (window->getParent() != nullptr)
+		window->getParent()->removeChild(window);
+	windowPool[window->getType().c_str()].push_back(window);
+}
+
+void UIManager::queueProperty(CEGUI::Window* window, const std::string& prop, const std::string& value)
+{
+	pendingProps[std::make_pair(window, prop)] = value;
+}
+
+void UIManager::queueText(UIComponent* comp)
+{
+	pendingTexts.push_back(comp);
+}
+
+void UIManager::cancelText(UIComponent* comp)
+{
+	auto it = std::find(pendingTexts.begin(), pendingTexts.end(), comp);
+	if (it != pendingTexts.end())
+		pendingTexts.erase(it);
+}
+
+void UIManager::queueEvent(const CEGUI::EventArgs& e, UIComponent::UIEvent type, float value)
+{
+	const CEGUI::WindowEventArgs& args = static_cast<const CEGUI::WindowEventArgs&>(e);
+	eventQueue.push_back({ args.window, type, value });
+}
+
+bool UIManager::onWindowClicked(const CEGUI::EventArgs& e)
+{
+	queueEvent(e, UIComponent::UIEvent::Click);
+	return true;
+}
+
+bool UIManager::onWindowHoverEnter(const CEGUI::EventArgs& e)
+{
+	queueEvent(e, UIComponent::UIEvent::HoverEnter);
+	return false;
+}
+
+bool UIManager::onWindowHoverExit(const CEGUI::EventArgs& e)
+{
+	queueEvent(e, UIComponent::UIEvent::HoverExit);
+	return false;
+}
+
+bool UIManager::onWindowValueChanged(const CEGUI::EventArgs& e)
+{
+	const CEGUI::WindowEventArgs& args = static_cast<const CEGUI::WindowEventArgs&>(e);
+	CEGUI::Slider* slider = dynamic_cast<CEGUI::Slider*>(args.window);
+	queueEvent(e, UIComponent::UIEvent::ValueChanged, slider != nullptr ? slider->getCurrentValue() : 0.0f);
+	return true;
 }
 
 #pragma endregion
@@ -1,5 +1,6 @@
 #include "UIPointer.h"
 #include "UIManager.h"
+#include "Reflection.h"
 #include <glm/glm.hpp>
 
 UIPointer::UIPointer() : Component(UIManager::getInstance(), (int)UIManager::UICmpId::Pointer)
@@ -22,18 +23,16 @@ void UIPointer::init()
 
 void UIPointer::load(const nlohmann::json& params)
 {
-	auto it = params.find("pointerImage");
-	if (it != params.end()) {
-		std::string i = it->get<std::string>();
-		pointer = i;
-	}
-
-	it = params.find("visible");
-	if (it != params.end()) {
-		bool v = it->get<bool>();
-		visible = v;
-	}
+	loadFields(params);
+}
 
-	UIManager::getInstance()->setMouseImage(pointer);
-	UIManager::getInstance()->setMouseVisibility(visible);
+const Reflection::TypeInfo* UIPointer::getTypeInfo() const
+{
+	static const Reflection::TypeInfo info("UIPointer", {
+		REFLECT_FIELD(UIPointer, std::string, "pointerImage", self.pointer,
+			{ self.pointer = v; UIManager::getInstance()->setMouseImage(v); }),
+		REFLECT_FIELD(UIPointer, bool, "visible", self.visible,
+			{ self.visible = v; UIManager::getInstance()->setMouseVisibility(v); })
+	});
+	return &info;
 }
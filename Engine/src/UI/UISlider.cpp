@@ -1,5 +1,6 @@
 #include "UISlider.h"
 #include "UIManager.h"
+#include "Reflection.h"
 
 #include "CEGUI/Window.h"
 #include "CEGUI/CEGUI.h"
@@ -24,55 +25,34 @@ void UISlider::init()
 
 	name = "SliderDefault";
 	type = "Slider";
-	uiWindow = UIManager::getInstance()->createSlider(pos, size, name, type);
+	setWindow(UIManager::getInstance()->createSlider(pos, size, name, type));
 }
 
 void UISlider::load(const nlohmann::json& params)
 {
-	//--------------ASIGNACIONES_UI_COMPONENT--------------//
-	auto it = params.find("position");
-	if (it != params.end()) {
-		std::vector<float> p = it->get<std::vector<float>>();
-		pos.first = p[0];
-		pos.second = p[1];
-	}
+	loadFields(params);
 
-	it = params.find("size");
-	if (it != params.end()) {
-		std::vector<float> s = it->get<std::vector<float>>();
-		size.first = s[0];
-		size.second = s[1];
-	}
+	CEGUI::Window* fromLayout = findLayoutWindow();
+	if (fromLayout != nullptr)
+		bindLayoutWindow(fromLayout, params);
+	else
+		setWindow(UIManager::getInstance()->createSlider(pos, size, name, type));
 
-	it = params.find("name");
-	if (it != params.end()) {
-		std::string n = it->get<std::string>();
-		name = n;
-	}
-
-	it = params.find("type");
-	if (it != params.end()) {
-		std::string t = it->get<std::string>();
-		type = t;
-	}
-
-	uiWindow = UIManager::getInstance()->createSlider(pos, size, name, type);
+	loadWindowParams(params);
+}
 
-	//------------ASIGNACIONES_UI_IMAGE--------------//
+const Reflection::TypeInfo* UISlider::getTypeInfo() const
+{
+	static const Reflection::TypeInfo info("UISlider", {}, UIComponent::getTypeInfo());
+	return &info;
+}
 
-	//Propiedades de la Imagen
-	it = params.find("property");
-	if (it != params.end()) {
-		std::vector<std::vector<std::string>> prop =
-			it->get<std::vector<std::vector<std::string>>>();
-		for (int i = 0; i < prop.size(); i++) {
-			setProperty(prop.at(i).at(0), prop.at(i).at(1));
-		}
-	}
+float UISlider::getValue() const
+{
+	return static_cast<CEGUI::Slider*>(uiWindow)->getCurrentValue();
+}
 
-	it = params.find("active");
-	if (it != params.end()) {
-		bool ac = it->get<bool>();
-		setActive(ac);
-	}
+void UISlider::setValue(float value)
+{
+	static_cast<CEGUI::Slider*>(uiWindow)->setCurrentValue(value);
 }